@@ -11,6 +11,7 @@ build_dir="build"
 if [ "${CMAKE_BUILD_TYPE,,}" = "release" ]; then
   build_dir="build_rel"
 fi
+tools_dir="build_tools" # native tools run during the build
 
 target="$1"
 if [ -z "$target" ]; then target="client"; fi
@@ -22,6 +23,8 @@ if [ "$target" = "clean" ]; then
   for file in "${compiled_resources[@]}"; do
     rm "${file}.h"
   done
+  echo "Cleaning build tools..."
+  rm -r "$tools_dir"
   target="client"
 fi
 
@@ -33,24 +36,32 @@ if [ ! -d "$build_dir" ]; then
   mkdir "$build_dir"
 fi
 
-# compile resources
-compiled_resources_total=0
-compiled_resources_up_to_date=0
-for file in "${compiled_resources[@]}"; do
-  ((++compiled_resources_total))
-  result=$(./compile_resource_to_raw_string.sh "$file")
-  if grep -Fq "up to date" <<< "$result"; then
-    ((++compiled_resources_up_to_date))
-  fi
-done
-compiled_resources_updated=$((compiled_resources_total - compiled_resources_up_to_date))
-echo "Compiled resources: $compiled_resources_updated updated, $compiled_resources_up_to_date up to date ($compiled_resources_total total)"
+# build the native resource compiler, when it's missing or out of date
+resource_compiler="$tools_dir/resource_compiler"
+resource_compiler_sources=(
+  resource_compiler.cpp
+  wgsl/minifier.cpp
+  wgsl/parser.cpp
+  wgsl/reflection.cpp
+  wgsl/tokenizer.cpp
+  wgsl/types.cpp
+)
+if [ ! -x "$resource_compiler" ] || [ -n "$(find "${resource_compiler_sources[@]}" fnv1a.h wgsl/*.h -newer "$resource_compiler")" ]; then
+  echo "Building the resource compiler..."
+  mkdir -p "$tools_dir"
+  "${HOST_CXX:-c++}" -std=c++2b -O2 -I. "${resource_compiler_sources[@]}" -o "$resource_compiler" || exit 1
+fi
+
+# compile resources, all in one invocation; headers are only rewritten when their contents change
+result=$("$resource_compiler" "${compiled_resources[@]}") || exit 1
+echo "$result"
+compiled_resources_updated=$(sed -n 's/^Compiled resources: \([0-9]*\) updated.*/\1/p' <<< "$result")
 
 if [ "$compiled_resources_updated" != 0 ]; then
   # validate shaders
   if ! [ -z "$(which naga)" ]; then
     echo "Validating shaders with naga-cli"
-    naga --bulk-validate render/shaders/*.wgsl || exit 1
+    naga --bulk-validate render/shaders/*.wgsl render/shaders/examples/*.wgsl || exit 1
   fi
 fi
 
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "render/cpu_renderer.h"
+#include "render/shaders/default.wgsl.h"
+#include "render/uniforms.h"
+#include "render/work_stealing_pool.h"
+#include "timing/statistics.h"
+#include "wgsl/program.h"
+#include "wgsl/reference_renderer.h"
+
+// native benchmark of the CPU fallback renderer: reports throughput at several thread counts, and checks its
+// output against the default shader run through the WGSL interpreter, which serves as the golden image
+
+namespace {
+
+float measure_megapixels_per_second(unsigned int threads, vec2ui const &size, unsigned int repeats) {
+  /// Render the image repeatedly and return the median throughput
+  render::cpu_renderer renderer{threads};
+  renderer.resize(size);
+  renderer.render(vec2f{0.0f, 0.0f});                                           // warm up caches and threads
+  std::vector<float> rates;
+  for(unsigned int i{0}; i != repeats; ++i) {
+    auto const start{std::chrono::steady_clock::now()};
+    renderer.render(vec2f{0.0f, 0.0f});
+    std::chrono::duration<float> const elapsed{std::chrono::steady_clock::now() - start};
+    rates.emplace_back(static_cast<float>(size.x) * static_cast<float>(size.y) / 1.0e6f / elapsed.count());
+  }
+  return timing::summarise(rates).p50;
+}
+
+bool check_against_reference(vec2ui const &size, int tolerance) {
+  /// Compare the CPU renderer's image with the WGSL interpreter's rendering of the shader it ports
+  render::cpu_renderer renderer;
+  renderer.resize(size);
+  renderer.render(vec2f{0.0f, 0.0f});
+
+  wgsl::program shader{render::shaders::default_wgsl};
+  render::uniforms uniforms{};
+  shader.set_uniform(0, 0, std::as_bytes(std::span{&uniforms, 1}));
+  wgsl::reference_renderer reference{shader};
+  auto const golden{reference.render(
+    {
+      .attributes{
+        {.location{0}, .components{2}, .values{-1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{1}, .components{2}, .values{ 0.0f,  0.0f,  1.0f,  0.0f,   0.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{2}, .components{2}, .values{ 0.0f,  0.0f,  0.0f,  0.0f,   0.0f, 0.0f,  0.0f, 0.0f}}, // a single render::instance covering the viewport
+        {.location{3}, .components{2}, .values{ 1.0f,  1.0f,  1.0f,  1.0f,   1.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{4}, .components{2}, .values{ 0.0f,  0.0f,  0.0f,  0.0f,   0.0f, 0.0f,  0.0f, 0.0f}},
+        {.location{5}, .components{2}, .values{ 1.0f,  1.0f,  1.0f,  1.0f,   1.0f, 1.0f,  1.0f, 1.0f}},
+      },
+      .indices{0, 1, 2,  2, 1, 3},
+    },
+    size.x,
+    size.y
+  )};
+
+  auto const pixels{renderer.get_pixels()};
+  int max_difference{0};
+  size_t differing_channels{0};
+  for(size_t i{0}; i != pixels.size(); ++i) {
+    auto const expected{static_cast<int>(std::lround(std::clamp(golden.pixels[i], 0.0f, 1.0f) * 255.0f))};
+    auto const difference{std::abs(static_cast<int>(pixels[i]) - expected)};
+    max_difference = std::max(max_difference, difference);
+    if(difference > tolerance) ++differing_channels;
+  }
+  std::cout << "Compared with the WGSL reference at " << size.x << "x" << size.y << ": max difference " << max_difference
+            << ", " << differing_channels << " channels beyond tolerance " << tolerance << '\n';
+  return differing_channels == 0;
+}
+
+}
+
+auto main(int argc, char *argv[])->int {
+  vec2ui size{1920, 1080};
+  unsigned int repeats{10};
+  bool check{false};
+  std::span const args{argv + 1, static_cast<size_t>(argc - 1)};
+  for(size_t i{0}; i != args.size(); ++i) {
+    std::string const arg{args[i]};
+    try {
+      if(arg == "--check") {
+        check = true;
+      } else if(arg == "--size" && i + 2 < args.size()) {
+        size.x = static_cast<unsigned int>(std::stoul(args[++i]));
+        size.y = static_cast<unsigned int>(std::stoul(args[++i]));
+      } else {
+        repeats = std::max(1u, static_cast<unsigned int>(std::stoul(arg)));
+      }
+    } catch(std::exception const &e) {
+      std::cerr << "Usage: " << argv[0] << " [frames] [--size w h] [--check]\n";
+      std::cerr << "Exception: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  try {
+    auto const hardware_threads{render::work_stealing_pool::get_default_thread_count()};
+    std::vector<unsigned int> thread_counts{1, 2, 4};
+    std::erase_if(thread_counts, [&](unsigned int count){return count >= hardware_threads;});
+    thread_counts.emplace_back(hardware_threads);
+
+    std::cout << "CPU renderer at " << size.x << "x" << size.y << ", median of " << repeats << " frames\n";
+    float single_thread_rate{0.0f};
+    for(auto const threads : thread_counts) {
+      auto const rate{measure_megapixels_per_second(threads, size, repeats)};
+      if(threads == 1) single_thread_rate = rate;
+      std::cout << "  " << threads << " threads: " << rate << " Mpx/s (" << rate / single_thread_rate << "x)\n";
+    }
+
+    if(check && !check_against_reference(vec2ui{256, 256}, 2)) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
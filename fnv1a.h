@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+constexpr uint64_t fnv1a_offset_basis{0xcbf29ce484222325ull};
+constexpr uint64_t fnv1a_prime{0x100000001b3ull};
+
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = fnv1a_offset_basis) {
+  /// 64-bit FNV-1a hash of a string, usable at compile time
+  /// Pass a previous result as the hash to continue hashing across several inputs
+  // See http://www.isthe.com/chongo/tech/comp/fnv/
+  for(char const c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= fnv1a_prime;
+  }
+  return hash;
+}
+
+constexpr uint64_t fnv1a(uint64_t value, uint64_t hash = fnv1a_offset_basis) {
+  /// 64-bit FNV-1a hash of an integer value, taken one byte at a time from least significant
+  for(unsigned int i{0}; i != sizeof(value); ++i) {
+    hash ^= (value >> (i * 8u)) & 0xffu;
+    hash *= fnv1a_prime;
+  }
+  return hash;
+}
@@ -1,14 +1,48 @@
 #include "gui_renderer.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
 #include <emscripten/html5.h>
 #include <imgui/imgui_impl_emscripten.h>
 #include <imgui/imgui_impl_wgpu.h>
 #include <imgui/imgui_stdlib.h>
 #include "logstorm/logstorm.h"
+#include "render/gpu_profiler.h"
+#include "timing/cpu_profiler.h"
 
 namespace gui {
 
-gui_renderer::gui_renderer(logstorm::manager &this_logger)
-  :logger{this_logger} {
+namespace {
+
+struct quality_tier {
+  char const *name;
+  int iterations;
+};
+constexpr std::array quality_tiers{                                             // presets for the shader's escape iterations
+  quality_tier{"Low",      32},
+  quality_tier{"Medium",   64},
+  quality_tier{"High",    256},
+  quality_tier{"Ultra",  1024},
+};
+
+void draw_summary_text(char const *name, timing::summary const &summary) {
+  /// Output a single line summarising a set of timings
+  ImGui::Text("%s: avg %.2fms, p50 %.2fms, p99 %.2fms, max %.2fms",
+    name,
+    static_cast<double>(summary.avg),
+    static_cast<double>(summary.p50),
+    static_cast<double>(summary.p99),
+    static_cast<double>(summary.max)
+  );
+}
+
+}
+
+gui_renderer::gui_renderer(logstorm::manager &this_logger, timing::cpu_profiler const &this_cpu_profiler, render::gpu_profiler const &this_gpu_profiler)
+  :logger{this_logger},
+   cpu_profiler{this_cpu_profiler},
+   gpu_profiler{this_gpu_profiler} {
   /// Construct the top level GUI and initialise ImGUI
   logger << "GUI: Initialising";
   #ifndef NDEBUG
@@ -34,14 +68,33 @@ void gui_renderer::draw() {
   ImGui_ImplWGPU_NewFrame();
   ImGui_ImplEmscripten_NewFrame();
   ImGui::NewFrame();
+  input_active = is_input_active();
 
   draw_shader_code_window();
+  draw_performance_window();
+  if(gallery) draw_gallery_window();
 
   //ImGui::ShowDemoWindow();
 
   ImGui::Render();                                                              // finalise draw data (actual rendering of draw data is done by the renderer later)
 }
 
+bool gui_renderer::is_input_active() const {
+  /// Whether ImGui received any input this frame, or is in the middle of an interaction
+  /// Must be called between NewFrame() and Render(), while this frame's input is still queued
+  auto const &imgui_io{ImGui::GetIO()};
+  if(imgui_io.MouseDelta.x * imgui_io.MouseDelta.x + imgui_io.MouseDelta.y * imgui_io.MouseDelta.y > 0.0f) return true; // mouse moved, so hover state may have changed
+  if(std::abs(imgui_io.MouseWheel) > 0.0f || std::abs(imgui_io.MouseWheelH) > 0.0f) return true;
+  for(bool const down : imgui_io.MouseDown) {
+    if(down) return true;
+  }
+  if(!imgui_io.InputQueueCharacters.empty()) return true;
+  for(int key{ImGuiKey_NamedKey_BEGIN}; key != ImGuiKey_NamedKey_END; ++key) {
+    if(ImGui::IsKeyDown(static_cast<ImGuiKey>(key))) return true;
+  }
+  return ImGui::IsAnyItemActive();
+}
+
 void gui_renderer::draw_shader_code_window() {
   /// Draw the shader code editor window
   if(!ImGui::Begin("Shader")) {
@@ -55,6 +108,188 @@ void gui_renderer::draw_shader_code_window() {
 
   ImGui::InputTextMultiline("#shader_code", &shader_code, available_space);
   if(ImGui::Button("Update")) shader_code_updated = true;
+  ImGui::SameLine();
+  ImGui::Checkbox("Animate", &animate);
+  ImGui::SetItemTooltip("Redraw every frame, rather than only when something changes - needed for time-dependent shaders");
+
+  ImGui::End();
+}
+
+void gui_renderer::draw_performance_window() {
+  /// Draw the window showing CPU and GPU frame timings
+  if(!ImGui::Begin("Performance")) {
+    ImGui::End();
+    return;
+  }
+  ImGui::SetWindowSize(ImVec2(450, 500), ImGuiCond_FirstUseEver);
+
+  if(ImGui::CollapsingHeader("CPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+    for(auto const &section : cpu_profiler.get_sections()) {
+      std::array<float, timing::cpu_profiler::history_length> samples;
+      size_t const count{section.samples.snapshot(samples)};
+      std::span<float const> const valid_samples{samples.data(), count};
+      auto const summary{timing::summarise(valid_samples)};
+      std::array<float, 32> buckets;
+      timing::histogram(valid_samples, 0.0f, summary.max, buckets);
+
+      ImGui::PushID(section.name.c_str());
+      draw_summary_text(section.name.c_str(), summary);
+      ImGui::PlotLines("##history", samples.data(), static_cast<int>(count), 0, nullptr, 0.0f, summary.max, ImVec2(0, 40)); // recent samples, oldest first
+      ImGui::PlotHistogram("##histogram", buckets.data(), static_cast<int>(buckets.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 40)); // distribution from zero to the maximum
+      ImGui::PopID();
+    }
+  }
+
+  if(ImGui::CollapsingHeader("Render scale", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::BeginDisabled(!gpu_profiler.is_enabled());
+    ImGui::Checkbox("Automatic", &render_scale_automatic);
+    ImGui::SetItemTooltip("Adjust the render scale to hold the target scene GPU time - requires timestamp queries");
+    ImGui::SameLine();
+    ImGui::SliderFloat("Target", &render_scale_target_ms, 1.0f, 33.0f, "%.1fms");
+    ImGui::EndDisabled();
+    ImGui::BeginDisabled(render_scale_automatic);
+    ImGui::SliderFloat("Scale", &render_scale, 0.25f, 1.0f, "%.2f");
+    ImGui::EndDisabled();
+    ImGui::SliderFloat("Pixel ratio cap", &max_device_pixel_ratio, 0.0f, 4.0f, max_device_pixel_ratio > 0.0f ? "%.2f" : "none");
+    ImGui::SetItemTooltip("Limit the device pixel ratio the canvas is sized for, to reduce the pixel count on high DPI displays");
+  }
+
+  if(ImGui::CollapsingHeader("Frame pacing", ImGuiTreeNodeFlags_DefaultOpen)) {
+    if(ImGui::SliderInt("Frames in flight", &max_frames_in_flight, 1, 4)) frame_pacing_updated = true;
+    ImGui::SetItemTooltip("Submitted frames the GPU may still be working on - fewer lowers input latency, more tolerates uneven frame times");
+    auto const present_mode_name{[](void *data, int index){return (*static_cast<std::vector<std::string>*>(data))[static_cast<size_t>(index)].c_str();}};
+    if(ImGui::Combo("Present mode", &present_mode, present_mode_name, &present_mode_names, static_cast<int>(present_mode_names.size()))) frame_pacing_updated = true;
+    ImGui::SetItemTooltip("The present modes this surface supports - browsers generally only offer Fifo, synchronised to the display");
+    ImGui::Text("In flight: %u, deferred: %llu", frames_in_flight, static_cast<unsigned long long>(frames_deferred));
+    if(input_latency.count != 0) draw_summary_text("Input latency", input_latency);
+  }
+
+  if(ImGui::CollapsingHeader("Shader quality", ImGuiTreeNodeFlags_DefaultOpen)) {
+    auto const quality_name{[](void*, int index){return static_cast<size_t>(index) == quality_tiers.size() ? "Custom" : quality_tiers[static_cast<size_t>(index)].name;}};
+    if(ImGui::Combo("Quality", &shader_quality, quality_name, nullptr, static_cast<int>(quality_tiers.size()) + 1)) {
+      if(static_cast<size_t>(shader_quality) != quality_tiers.size()) {
+        shader_iterations = quality_tiers[static_cast<size_t>(shader_quality)].iterations;
+        shader_variant_updated = true;
+      }
+    }
+    ImGui::SetItemTooltip("Specialise the shader's override constants - each setting is its own pipeline, cached once compiled");
+    if(ImGui::SliderInt("Iterations", &shader_iterations, 1, 4096, "%d", ImGuiSliderFlags_Logarithmic)) {
+      shader_quality = static_cast<int>(quality_tiers.size());                  // custom
+    }
+    if(ImGui::IsItemDeactivatedAfterEdit()) shader_variant_updated = true;      // only compile once the slider is released
+  }
+
+  if(ImGui::CollapsingHeader("Scene geometry", ImGuiTreeNodeFlags_DefaultOpen)) {
+    constexpr std::array geometry_names{"Quad", "Fullscreen triangle"};
+    if(ImGui::Combo("Geometry", &scene_geometry, geometry_names.data(), static_cast<int>(geometry_names.size()))) scene_geometry_updated = true;
+    ImGui::SetItemTooltip("The fullscreen triangle needs no vertex or index buffers, but draws no instances, so no parameter sweep");
+    ImGui::BeginDisabled(geometry_benchmark_running || !gpu_profiler.is_enabled());
+    if(ImGui::Button(geometry_benchmark_running ? "Benchmarking..." : "Benchmark")) geometry_benchmark_requested = true;
+    ImGui::SetItemTooltip("Alternate between both geometries for a few seconds, timing the scene pass - requires timestamp queries");
+    ImGui::EndDisabled();
+    for(size_t index{0}; index != geometry_names.size(); ++index) {
+      if(geometry_benchmark_results[index].count != 0) draw_summary_text(geometry_names[index], geometry_benchmark_results[index]);
+    }
+  }
+
+  if(ImGui::CollapsingHeader("Compute path", ImGuiTreeNodeFlags_DefaultOpen)) {
+    if(ImGui::Checkbox("Enabled##compute", &compute)) compute_updated = true;
+    ImGui::SetItemTooltip("Shade the scene in a compute pass writing a storage texture, rather than rasterising it");
+    if(ImGui::SliderInt("Workgroup width", &compute_workgroup_width, 1, 32)) compute_updated = true;
+    if(ImGui::SliderInt("Workgroup height", &compute_workgroup_height, 1, 32)) compute_updated = true;
+    ImGui::BeginDisabled(compute_benchmark_running || !gpu_profiler.is_enabled());
+    if(ImGui::Button(compute_benchmark_running ? "Benchmarking...##compute" : "Benchmark##compute")) compute_benchmark_requested = true;
+    ImGui::SetItemTooltip("Alternate between fragment and compute shading for a few seconds, timing the scene - requires timestamp queries");
+    ImGui::EndDisabled();
+    constexpr std::array path_names{"Fragment", "Compute"};
+    for(size_t index{0}; index != path_names.size(); ++index) {
+      if(compute_benchmark_results[index].count != 0) draw_summary_text(path_names[index], compute_benchmark_results[index]);
+    }
+  }
+
+  if(ImGui::CollapsingHeader("Parameter sweep", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::BeginDisabled(scene_geometry != 0);                                  // only the quad is drawn per instance
+    if(ImGui::Checkbox("Enabled##sweep", &sweep)) sweep_updated = true;
+    ImGui::SetItemTooltip("Draw a grid of thumbnails, each with a different input offset, in a single instanced indirect draw");
+    ImGui::SameLine();
+    if(ImGui::SliderInt("Grid size", &sweep_grid_size, 1, 32)) sweep_updated = true;
+    if(ImGui::SliderFloat("Range", &sweep_range, 0.0f, 4.0f, "%.2f")) sweep_updated = true;
+    ImGui::EndDisabled();
+  }
+
+  if(ImGui::CollapsingHeader("Gallery", ImGuiTreeNodeFlags_DefaultOpen)) {
+    if(ImGui::Checkbox("Enabled##gallery", &gallery)) gallery_updated = true;
+    ImGui::SetItemTooltip("Render many uniform variants into tiles of an atlas each frame, in a single pass");
+    ImGui::SameLine();
+    if(ImGui::SliderInt("Variants", &gallery_variants, 1, 256)) gallery_updated = true;
+    if(ImGui::SliderInt("Tile size", &gallery_tile_size, 16, 512)) gallery_updated = true;
+    if(ImGui::SliderFloat("Range##gallery", &gallery_range, 0.0f, 4.0f, "%.2f")) gallery_updated = true;
+  }
+
+  if(ImGui::CollapsingHeader("Progressive rendering", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::Checkbox("Enabled", &progressive);
+    ImGui::SetItemTooltip("Draw the scene a few tiles per frame, for shaders too heavy to draw in one frame");
+    ImGui::SameLine();
+    ImGui::SliderInt("Tiles per frame", &progressive_tiles_per_frame, 1, 64);
+    ImGui::ProgressBar(progressive_progress);
+  }
+
+  if(ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+    if(gpu_profiler.is_enabled()) {
+      auto const &scope_names{gpu_profiler.get_scope_names()};
+      for(unsigned int scope{0}; scope != scope_names.size(); ++scope) {
+        draw_summary_text(scope_names[scope].c_str(), gpu_profiler.get_scope_summary(scope));
+      }
+      draw_summary_text("frame", gpu_profiler.get_frame_summary());
+    } else {
+      ImGui::TextUnformatted("Timestamp queries unavailable on this device");
+    }
+  }
+
+  ImGui::End();
+}
+
+void gui_renderer::draw_gallery_window() {
+  /// Draw the window showing the gallery atlas, and its throughput compared to drawing the scene alone
+  bool const visible{ImGui::Begin("Gallery", &gallery)};
+  if(!gallery) gallery_updated = true;                                          // closing the window disables the gallery
+  if(!visible) {
+    ImGui::End();
+    return;
+  }
+  ImGui::SetWindowSize(ImVec2(540, 600), ImGuiCond_FirstUseEver);
+
+  if(gpu_profiler.is_enabled()) {
+    auto const &scope_names{gpu_profiler.get_scope_names()};
+    auto const scope_average{[&](std::string_view name){
+      /// Average GPU time of the named scope in milliseconds, or zero if it hasn't been measured
+      auto const it{std::ranges::find(scope_names, name)};
+      if(it == scope_names.end()) return 0.0f;
+      return gpu_profiler.get_scope_summary(static_cast<unsigned int>(it - scope_names.begin())).avg;
+    }};
+    auto const per_second{[](float count, float milliseconds){
+      return milliseconds > 0.0f ? count * 1000.0f / milliseconds : 0.0f;
+    }};
+    float const gallery_ms{scope_average("gallery")};
+    float const scene_ms{scope_average("scene")};
+    ImGui::Text("Gallery: %u variants in %.2fms, %.0f variants/s",
+      gallery_variant_count,
+      static_cast<double>(gallery_ms),
+      static_cast<double>(per_second(static_cast<float>(gallery_variant_count), gallery_ms))
+    );
+    ImGui::Text("Single view: %.2fms, %.0f views/s",
+      static_cast<double>(scene_ms),
+      static_cast<double>(per_second(1.0f, scene_ms))
+    );
+  } else {
+    ImGui::TextUnformatted("Timestamp queries unavailable on this device");
+  }
+
+  if(gallery_texture != 0) {
+    ImVec2 const available_space{ImGui::GetContentRegionAvail()};
+    float const scale{std::min(1.0f, std::min(available_space.x / gallery_width, available_space.y / gallery_height))}; // shrink to fit, but never enlarge
+    ImGui::Image(static_cast<ImTextureID>(gallery_texture), ImVec2(gallery_width * scale, gallery_height * scale));
+  }
 
   ImGui::End();
 }
@@ -1,27 +1,87 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "clipboard.h"
 #include "logstorm/logstorm_forward.h"
+#include "timing/statistics.h"
 
 class ImGui_ImplWGPU_InitInfo;
 
+namespace render {
+class gpu_profiler;
+}
+namespace timing {
+class cpu_profiler;
+}
+
 namespace gui {
 
 class gui_renderer {
   logstorm::manager &logger;
+  timing::cpu_profiler const &cpu_profiler;                                     // CPU timings of the main loop, for display
+  render::gpu_profiler const &gpu_profiler;                                     // GPU timings of the render passes, for display
 
   clipboard clipboard;
 
 public:
   std::string shader_code;
   bool shader_code_updated{false};
+  bool animate{false};                                                          // whether to redraw every frame, rather than only on changes
+  float render_scale{1.0f};                                                     // fraction of the viewport size to render the scene at
+  bool render_scale_automatic{false};                                           // whether to choose the render scale automatically
+  float render_scale_target_ms{8.0f};                                           // scene GPU time the automatic render scale aims for
+  float max_device_pixel_ratio{0.0f};                                           // cap on the device pixel ratio the surface is sized for, zero for none
+  int max_frames_in_flight{2};                                                  // submitted frames the GPU may still be working on
+  std::vector<std::string> present_mode_names;                                  // the present modes the surface supports
+  int present_mode{0};                                                          // index into the present mode names
+  bool frame_pacing_updated{false};
+  unsigned int frames_in_flight{0};                                             // for display
+  uint64_t frames_deferred{0};                                                  // frames not drawn because too many were in flight, for display
+  timing::summary input_latency{};                                              // from sampling input to the GPU completing the frame, for display
+  int shader_quality{1};                                                        // index of the quality tier the shader is specialised for, or of "Custom"
+  int shader_iterations{64};                                                    // escape iterations the shader is specialised with
+  bool shader_variant_updated{false};
+  int scene_geometry{0};                                                        // index of how the scene covers the viewport: quad or fullscreen triangle
+  bool scene_geometry_updated{false};
+  bool geometry_benchmark_requested{false};
+  bool geometry_benchmark_running{false};                                       // for display
+  std::array<timing::summary, 2> geometry_benchmark_results{};                  // scene GPU time with each geometry in the latest benchmark, for display
+  bool compute{false};                                                          // whether to shade the scene with a compute pass rather than fragments
+  int compute_workgroup_width{8};                                               // the compute pass's workgroup size in invocations
+  int compute_workgroup_height{8};
+  bool compute_updated{false};
+  bool compute_benchmark_requested{false};
+  bool compute_benchmark_running{false};                                        // for display
+  std::array<timing::summary, 2> compute_benchmark_results{};                   // scene GPU time with fragments and with compute in the latest benchmark, for display
+  bool sweep{false};                                                            // whether to draw a grid of thumbnails sweeping the shader's input
+  int sweep_grid_size{16};                                                      // thumbnails along each side of the grid
+  float sweep_range{1.0f};                                                      // range of input offsets swept across the grid
+  bool sweep_updated{false};
+  bool gallery{false};                                                          // whether to render a gallery of variants into an atlas
+  int gallery_variants{64};                                                     // how many uniform variants the gallery renders
+  int gallery_tile_size{128};                                                   // width and height of each variant's tile in the atlas, in pixels
+  float gallery_range{1.0f};                                                    // range of input offsets the variants span
+  bool gallery_updated{false};
+  uintptr_t gallery_texture{0};                                                 // texture view of the gallery atlas, for display
+  float gallery_width{0.0f};                                                    // size of the gallery atlas in pixels
+  float gallery_height{0.0f};
+  unsigned int gallery_variant_count{0};                                        // variants the renderer is drawing each frame, for throughput
+  bool progressive{false};                                                      // whether to render the scene progressively in tiles
+  int progressive_tiles_per_frame{4};
+  float progressive_progress{1.0f};                                             // how much of the progressive image is complete, for display
+  bool input_active{false};                                                     // whether the GUI saw input this frame, so the scene behind it needs redrawing
 
-  gui_renderer(logstorm::manager &logger);
+  gui_renderer(logstorm::manager &logger, timing::cpu_profiler const &cpu_profiler, render::gpu_profiler const &gpu_profiler);
 
   void init(ImGui_ImplWGPU_InitInfo &wgpu_info);
 
   void draw();
+  bool is_input_active() const;
   void draw_shader_code_window();
+  void draw_performance_window();
+  void draw_gallery_window();
 };
 
 }
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <imgui/imgui_impl_wgpu.h>
+#include <magic_enum/magic_enum.hpp>
+#include "logstorm/logstorm.h"
+#include "platform/platform.h"
+#include "platform/platform_headless.h"
+#include "platform/recording_webgpu.h"
+#include "render/webgpu_renderer.h"
+#include "timing/statistics.h"
+
+// native entry point: drives the renderer against the recording WebGPU backend for a fixed number of frames,
+// then reports the API calls made, the heap allocations made, and the CPU time spent encoding each frame
+
+namespace {
+
+std::atomic<uint64_t> renderer_allocations{0};                                  // heap allocations made outside the WebGPU backend
+std::atomic<uint64_t> backend_allocations{0};                                   // heap allocations made by the recording backend, which a browser wouldn't make
+
+void count_allocation() {
+  /// Attribute a heap allocation to the backend if it's inside an API call, or to the renderer otherwise
+  (platform::recording_webgpu::is_in_api_call() ? backend_allocations : renderer_allocations).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<float> to_samples(std::vector<uint64_t> const &counts) {
+  /// Convert counts to samples for summarising
+  std::vector<float> samples;
+  samples.reserve(counts.size());
+  for(auto const count : counts) samples.emplace_back(static_cast<float>(count));
+  return samples;
+}
+
+}
+
+// replacements for the global allocation functions, counting every allocation; the array and nothrow forms call these
+void *operator new(std::size_t size) {
+  count_allocation();
+  if(void *pointer{std::malloc(std::max<std::size_t>(size, 1))}) return pointer;
+  throw std::bad_alloc{};
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  count_allocation();
+  auto const alignment_bytes{static_cast<std::size_t>(alignment)};
+  if(void *pointer{std::aligned_alloc(alignment_bytes, (std::max<std::size_t>(size, 1) + alignment_bytes - 1) / alignment_bytes * alignment_bytes)}) return pointer; // the size must be a multiple of the alignment
+  throw std::bad_alloc{};
+}
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, std::align_val_t /*alignment*/) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+  std::free(pointer);
+}
+
+class headless_runner {
+  logstorm::manager logger{logstorm::manager::build_with_sink<logstorm::sink::console>()}; // logging system
+  render::webgpu_renderer renderer{logger};                                     // WebGPU rendering system
+
+  unsigned int const frames_to_run;                                             // frames to measure before exiting
+  bool const check_allocations;                                                 // whether to fail if the renderer allocates in any measured frame
+  render::webgpu_renderer::scene_geometry const geometry;                       // how the scene covers the viewport, to compare the encode cost of each
+  static constexpr unsigned int warmup_frames{10};                              // frames to run before measuring, while pipelines and targets settle
+  unsigned int frame{0};
+
+  std::vector<float> encode_times;                                              // CPU time spent in draw() each measured frame, in ms
+  std::vector<float> objects_created;                                           // API objects created each measured frame
+  std::vector<uint64_t> allocations;                                            // heap allocations the renderer made in draw() each measured frame
+  std::vector<uint64_t> backend_allocations_per_frame;                          // heap allocations the recording backend made in draw() each measured frame
+  std::map<std::string_view, uint64_t> total_counts;                            // API calls made over all measured frames, by function
+
+  void loop_main();
+  std::ptrdiff_t get_allocating_frames() const;
+  void report() const;
+
+public:
+  headless_runner(unsigned int this_frames_to_run, bool this_check_allocations, render::webgpu_renderer::scene_geometry this_geometry);
+};
+
+headless_runner::headless_runner(unsigned int this_frames_to_run, bool this_check_allocations, render::webgpu_renderer::scene_geometry this_geometry)
+  : frames_to_run{this_frames_to_run},
+    check_allocations{this_check_allocations},
+    geometry{this_geometry} {
+  /// Run the renderer headless
+  encode_times.reserve(frames_to_run);
+  objects_created.reserve(frames_to_run);
+  allocations.reserve(frames_to_run);
+  backend_allocations_per_frame.reserve(frames_to_run);
+
+  renderer.init(
+    [&](render::webgpu_renderer::webgpu_data const& webgpu){
+      ImGui::CreateContext();
+      ImGui::GetIO().IniFilename = nullptr;                                     // don't write window positions to disk
+      ImGui_ImplWGPU_InitInfo imgui_wgpu_info;
+      imgui_wgpu_info.Device = webgpu.device.Get();
+      imgui_wgpu_info.RenderTargetFormat = static_cast<WGPUTextureFormat>(webgpu.surface_preferred_format);
+      ImGui_ImplWGPU_Init(&imgui_wgpu_info);
+
+      renderer.idle.set_animate(true);                                          // draw every frame, so each one measures a full encode
+      renderer.set_scene_geometry(geometry);                                    // compiled during the warmup frames
+    },
+    [&]{
+      loop_main();
+    }
+  );
+}
+
+void headless_runner::loop_main() {
+  /// Main pseudo-loop
+  platform::recording_webgpu::process_events();                                 // deliver completions the browser would have delivered between frames
+  platform::recording_webgpu::reset_counts();
+
+  auto &io{ImGui::GetIO()};
+  auto const &canvas_size{platform::headless::get_settings().canvas_css_size};
+  io.DisplaySize = ImVec2{canvas_size.x, canvas_size.y};
+  io.DeltaTime = 1.0f / 60.0f;
+  ImGui_ImplWGPU_NewFrame();
+  ImGui::NewFrame();
+  ImGui::ShowDemoWindow();
+  ImGui::Render();
+
+  vec2f const rotation{static_cast<float>(frame) * 0.0001f, 0.0f};              // vary the input so uniforms change every frame
+  uint64_t const renderer_allocations_before{renderer_allocations.load(std::memory_order_relaxed)};
+  uint64_t const backend_allocations_before{backend_allocations.load(std::memory_order_relaxed)};
+  auto const encode_start{std::chrono::steady_clock::now()};
+  renderer.draw(rotation);
+  std::chrono::duration<float, std::milli> const encode_time{std::chrono::steady_clock::now() - encode_start};
+  auto const draw_allocations{renderer_allocations.load(std::memory_order_relaxed) - renderer_allocations_before};
+  auto const draw_backend_allocations{backend_allocations.load(std::memory_order_relaxed) - backend_allocations_before};
+
+  ++frame;
+  if(frame <= warmup_frames) return;
+
+  encode_times.emplace_back(encode_time.count());
+  objects_created.emplace_back(static_cast<float>(platform::recording_webgpu::get_objects_created()));
+  allocations.emplace_back(draw_allocations);
+  backend_allocations_per_frame.emplace_back(draw_backend_allocations);
+  for(auto const &[function, count] : platform::recording_webgpu::get_counts()) {
+    total_counts[function] += count;
+  }
+
+  if(encode_times.size() != frames_to_run) return;
+  report();
+  if(check_allocations && get_allocating_frames() != 0) {
+    std::cerr << "ERROR: The renderer allocated on the heap in " << get_allocating_frames() << " steady-state frames" << std::endl;
+    std::exit(EXIT_FAILURE);                                                    // rather than cancelling the main loop, which exits successfully
+  }
+  platform::cancel_main_loop();
+}
+
+std::ptrdiff_t headless_runner::get_allocating_frames() const {
+  /// The number of measured frames in which the renderer made any heap allocations
+  return std::ranges::count_if(allocations, [](uint64_t count){return count != 0;});
+}
+
+void headless_runner::report() const {
+  /// Output the API calls per frame and the distribution of CPU encode times
+  auto const frames{static_cast<double>(encode_times.size())};
+  uint64_t total_calls{0};
+  std::vector<std::pair<std::string_view, uint64_t>> sorted_counts{total_counts.begin(), total_counts.end()};
+  std::ranges::sort(sorted_counts, [](auto const &lhs, auto const &rhs){return lhs.second > rhs.second;});
+  for(auto const &[function, count] : sorted_counts) {
+    total_calls += count;
+  }
+
+  std::cout << "Measured " << encode_times.size() << " frames after " << warmup_frames << " warmup frames, scene geometry " << magic_enum::enum_name(geometry) << '\n';
+  std::cout << "API calls per frame: " << static_cast<double>(total_calls) / frames << '\n';
+  for(auto const &[function, count] : sorted_counts) {
+    std::cout << "  " << function << ": " << static_cast<double>(count) / frames << '\n';
+  }
+
+  auto const objects{timing::summarise(objects_created)};
+  std::cout << "API objects created per frame: avg " << objects.avg << ", max " << objects.max << "; "
+            << platform::recording_webgpu::get_objects_live() << " live at exit\n";
+
+  auto const renderer_heap{timing::summarise(to_samples(allocations))};
+  auto const backend_heap{timing::summarise(to_samples(backend_allocations_per_frame))};
+  std::cout << "Heap allocations per frame by the renderer: avg " << renderer_heap.avg << ", max " << std::ranges::max(allocations) << ", "
+            << get_allocating_frames() << " frames allocating; by the recording backend: avg " << backend_heap.avg << '\n';
+
+  auto const encode{timing::summarise(encode_times)};
+  std::cout << "CPU encode time ms: min " << encode.min << ", avg " << encode.avg << ", p50 " << encode.p50
+            << ", p99 " << encode.p99 << ", max " << encode.max << '\n';
+}
+
+auto main(int argc, char *argv[])->int {
+  unsigned int frames{600};
+  bool check_allocations{false};
+  auto geometry{render::webgpu_renderer::scene_geometry::quad};
+  for(int i{1}; i != argc; ++i) {
+    std::string const arg{argv[i]};
+    if(arg == "--log-calls") {
+      platform::recording_webgpu::set_log_calls(true);
+    } else if(arg == "--check-allocations") {
+      check_allocations = true;
+    } else if(arg == "--geometry" && i + 1 != argc) {
+      auto const requested_geometry{magic_enum::enum_cast<render::webgpu_renderer::scene_geometry>(argv[++i])};
+      if(!requested_geometry) {
+        std::cerr << "Unknown geometry " << argv[i] << ", expected quad or fullscreen_triangle" << std::endl;
+        return EXIT_FAILURE;
+      }
+      geometry = *requested_geometry;
+    } else {
+      try {
+        frames = std::max(1u, static_cast<unsigned int>(std::stoul(arg)));
+      } catch(std::exception const &e) {
+        std::cerr << "Usage: " << argv[0] << " [frames] [--geometry quad|fullscreen_triangle] [--log-calls] [--check-allocations]\n";
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  try {
+    headless_runner runner{frames, check_allocations, geometry};
+    std::unreachable();
+
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
@@ -1,22 +1,43 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <functional>
 #include <map>
+#include <string>
 #include <emscripten/html5.h>
 #include <imgui/imgui_impl_wgpu.h>
+#include <magic_enum/magic_enum.hpp>
 #include "logstorm/logstorm.h"
 #include "gui/gui_renderer.h"
+#include "platform/platform.h"
+#include "render/cpu_renderer.h"
+#include "render/resize_manager.h"
+#include "render/tile_scheduler.h"
 #include "render/webgpu_renderer.h"
+#include "timing/cpu_profiler.h"
 
 using namespace std::string_literals;
 
 class game_manager {
   logstorm::manager logger{logstorm::manager::build_with_sink<logstorm::sink::emscripten_out>()}; // logging system
   render::webgpu_renderer renderer{logger};                                     // WebGPU rendering system
-  gui::gui_renderer gui{logger};                                                // GUI top level
+
+  enum class cpu_section : unsigned int {                                       // sections of the main loop measured by the CPU profiler
+    interval,                                                                   // time between the starts of consecutive frames
+    frame,                                                                      // all work done in one iteration of the main loop
+    gui,
+    render,
+  };
+  timing::cpu_profiler cpu_profiler{timing::cpu_profiler::from_enum<cpu_section>()}; // CPU timing of the main loop
+  std::chrono::steady_clock::time_point last_frame_start;                       // used to measure the interval between frames
+
+  gui::gui_renderer gui{logger, cpu_profiler, renderer.get_gpu_profiler()};     // GUI top level
 
   vec2f mouse_pos_rel{};                                                        // relative mouse position
 
   void loop_main();
+  void update_gallery();
 
 public:
   game_manager();
@@ -32,6 +53,11 @@ game_manager::game_manager() {
 
       gui.init(imgui_wgpu_info);
       gui.shader_code = renderer.get_shader();
+      auto const &present_modes{renderer.get_present_modes()};
+      for(auto const present_mode : present_modes) {
+        gui.present_mode_names.emplace_back(magic_enum::enum_name(present_mode));
+      }
+      gui.present_mode = static_cast<int>(std::ranges::find(present_modes, renderer.get_present_mode()) - present_modes.begin());
     },
     [&]{
       loop_main();
@@ -42,20 +68,189 @@ game_manager::game_manager() {
 
 void game_manager::loop_main() {
   /// Main pseudo-loop
-  gui.draw();
+  auto const frame_start{std::chrono::steady_clock::now()};
+  if(last_frame_start != std::chrono::steady_clock::time_point{}) {
+    cpu_profiler.record(cpu_section::interval, std::chrono::duration<float, std::milli>{frame_start - last_frame_start}.count());
+  }
+  last_frame_start = frame_start;
+  auto const frame_timer{cpu_profiler.time(cpu_section::frame)};
+
+  {
+    auto const gui_timer{cpu_profiler.time(cpu_section::gui)};
+    gui.draw();
+  }
 
   if(gui.shader_code_updated) {
     renderer.update_shader(gui.shader_code);
     gui.shader_code_updated = false;
   }
 
-  mouse_pos_rel += vec2f{ImGui::GetMouseDragDelta()} * 0.00001f * vec2f{-1.0f, 1.0f};
-  renderer.draw(mouse_pos_rel);
+  if(gui.shader_variant_updated) {
+    render::shader_variant variant;
+    variant.set(render::webgpu_renderer::shader_parameters::iterations, static_cast<uint32_t>(gui.shader_iterations));
+    renderer.set_shader_variant(variant);
+    gui.shader_variant_updated = false;
+  }
+
+  if(gui.scene_geometry_updated) {
+    renderer.set_scene_geometry(static_cast<render::webgpu_renderer::scene_geometry>(gui.scene_geometry));
+    gui.scene_geometry_updated = false;
+  }
+  if(gui.geometry_benchmark_requested) {
+    renderer.start_geometry_benchmark(8);                                       // four phases with each geometry
+    gui.geometry_benchmark_requested = false;
+  }
+  {
+    auto const &benchmark{renderer.get_geometry_benchmark()};
+    gui.geometry_benchmark_running = benchmark.is_running();
+    for(unsigned int configuration{0}; configuration != gui.geometry_benchmark_results.size(); ++configuration) {
+      gui.geometry_benchmark_results[configuration] = benchmark.get_summary(configuration);
+    }
+  }
+
+  if(gui.compute_updated) {
+    renderer.set_compute(gui.compute, vec2ui{static_cast<unsigned int>(gui.compute_workgroup_width), static_cast<unsigned int>(gui.compute_workgroup_height)});
+    gui.compute_workgroup_width = static_cast<int>(renderer.get_compute_workgroup_size().x); // show the size after clamping to the device's limits
+    gui.compute_workgroup_height = static_cast<int>(renderer.get_compute_workgroup_size().y);
+    gui.compute_updated = false;
+  }
+  if(gui.compute_benchmark_requested) {
+    renderer.start_compute_benchmark(8);                                        // four phases with each path
+    gui.compute_benchmark_requested = false;
+  }
+  {
+    auto const &benchmark{renderer.get_compute_benchmark()};
+    gui.compute_benchmark_running = benchmark.is_running();
+    for(unsigned int configuration{0}; configuration != gui.compute_benchmark_results.size(); ++configuration) {
+      gui.compute_benchmark_results[configuration] = benchmark.get_summary(configuration);
+    }
+  }
+
+  if(gui.sweep_updated) {
+    auto const grid_size{gui.sweep ? static_cast<unsigned int>(gui.sweep_grid_size) : 1u};
+    renderer.set_instance_grid(grid_size, grid_size, vec2f{gui.sweep_range, gui.sweep_range});
+    gui.sweep_updated = false;
+  }
+
+  vec2f const mouse_delta{vec2f{ImGui::GetMouseDragDelta()} * 0.00001f * vec2f{-1.0f, 1.0f}};
+  mouse_pos_rel += mouse_delta;
+
+  if(gui.gallery_updated || (gui.gallery && mouse_delta.length_sq() > 0.0f)) {
+    update_gallery();
+    gui.gallery_updated = false;
+  }
+  gui.gallery_texture = reinterpret_cast<uintptr_t>(renderer.get_gallery_view().Get());
+  gui.gallery_width = static_cast<float>(renderer.get_gallery_size().x);
+  gui.gallery_height = static_cast<float>(renderer.get_gallery_size().y);
+  gui.gallery_variant_count = renderer.get_gallery_variant_count();
+
+  renderer.idle.set_animate(gui.animate);
+  renderer.set_render_scale_automatic(gui.render_scale_automatic, gui.render_scale_target_ms);
+  if(gui.render_scale_automatic) {
+    gui.render_scale = renderer.get_render_scale();                             // show the scale that was chosen
+  } else {
+    renderer.set_render_scale(gui.render_scale);
+  }
+  renderer.set_max_device_pixel_ratio(gui.max_device_pixel_ratio);
+  if(gui.frame_pacing_updated) {
+    renderer.set_max_frames_in_flight(static_cast<unsigned int>(gui.max_frames_in_flight));
+    renderer.set_present_mode(renderer.get_present_modes()[static_cast<size_t>(gui.present_mode)]);
+    gui.frame_pacing_updated = false;
+  }
+  {
+    auto const &pacer{renderer.get_frame_pacer()};
+    gui.frames_in_flight = pacer.get_frames_in_flight();
+    gui.frames_deferred = pacer.stats.deferred;
+    gui.input_latency = pacer.get_latency_summary();
+  }
+  renderer.set_progressive(gui.progressive, static_cast<unsigned int>(gui.progressive_tiles_per_frame));
+  gui.progressive_progress = renderer.get_progressive_progress();
+  if(gui.input_active) renderer.idle.request(render::idle_scheduler::reason::input);
+
+  {
+    auto const render_timer{cpu_profiler.time(cpu_section::render)};
+    renderer.draw(mouse_pos_rel);
+  }
+}
+
+void game_manager::update_gallery() {
+  /// Generate the gallery's variants, a grid of inputs spanning the chosen range around the current position
+  if(!gui.gallery) {
+    renderer.disable_gallery();
+    return;
+  }
+  auto const variant_count{static_cast<unsigned int>(gui.gallery_variants)};
+  auto const columns{static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(variant_count))))};
+  auto const rows{(variant_count + columns - 1) / columns};
+  std::vector<render::uniforms> variants(variant_count);
+  for(unsigned int i{0}; i != variant_count; ++i) {
+    vec2f const cell{
+      (static_cast<float>(i % columns) + 0.5f) / static_cast<float>(columns) - 0.5f, // -0.5 to 0.5 across the grid
+      (static_cast<float>(i / columns) + 0.5f) / static_cast<float>(rows) - 0.5f,
+    };
+    variants[i].input = mouse_pos_rel + cell * gui.gallery_range;
+  }
+  auto const tile_size{static_cast<unsigned int>(gui.gallery_tile_size)};
+  renderer.set_gallery(variants, vec2ui{tile_size, tile_size});
+}
+
+class fallback_manager {
+  /// Shows the default shader rendered on the CPU, for browsers without WebGPU
+  logstorm::manager logger{logstorm::manager::build_with_sink<logstorm::sink::emscripten_out>()}; // logging system
+  render::cpu_renderer renderer;                                                // CPU rendering system
+  render::resize_manager resizer;                                               // tracks the canvas size
+  render::tile_scheduler tiles;                                                 // spreads rendering each image over several frames, to stay responsive
+
+  void loop_main();
+
+public:
+  fallback_manager();
+};
+
+fallback_manager::fallback_manager() {
+  /// Run the CPU fallback
+  if(renderer.get_thread_count() == 1) {                                        // this build has no pthreads support, so the browser only gets the main thread
+    logger << "WebGPU unavailable, falling back to single-threaded CPU rendering";
+    platform::set_status("WebGPU unavailable: rendering on the CPU, single-threaded");
+  } else {
+    logger << "WebGPU unavailable, falling back to CPU rendering with " << renderer.get_thread_count() << " threads";
+    platform::set_status("WebGPU unavailable: rendering on the CPU");
+  }
+  tiles.tiles_per_frame = 4 * renderer.get_thread_count();
+  platform::run_main_loop([](void *data){
+    static_cast<fallback_manager*>(data)->loop_main();
+  }, this);
+}
+
+void fallback_manager::loop_main() {
+  /// Main pseudo-loop: render the next few tiles, restarting the image whenever the canvas changes size
+  auto const now{render::resize_manager::clock::now()};
+  resizer.observe(platform::get_canvas_css_size(), platform::get_device_pixel_ratio(), now);
+  if(resizer.apply(now)) {
+    auto const &size{resizer.get_surface_size()};
+    platform::set_canvas_size(size);
+    renderer.resize(size);
+    tiles.configure(size.x, size.y, render::cpu_renderer::tile_size);
+  }
+
+  auto const batch{tiles.next_batch()};
+  if(batch.empty()) return;                                                     // the image is complete
+  renderer.render_tiles(batch, vec2f{0.0f, 0.0f});
+  platform::present_rgba8(renderer.get_pixels(), renderer.get_size());
 }
 
 auto main()->int {
   try {
-    game_manager game;
+    if(platform::is_webgpu_available()) {
+      game_manager game;
+      std::unreachable();
+    }
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  try {
+    fallback_manager fallback;
     std::unreachable();
 
   } catch (std::exception const &e) {
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <webgpu/webgpu_cpp.h>
+#include "vectorstorm/vector/vector2.h"
+
+namespace platform {
+
+// everything the renderer needs from its host environment; implemented for the browser by
+// platform_emscripten.cpp and for native headless runs by platform_headless.cpp
+
+[[noreturn]] void run_main_loop(void (*callback)(void *userdata), void *userdata);
+void cancel_main_loop();
+
+vec2f get_canvas_css_size();
+float get_device_pixel_ratio();
+void set_canvas_size(vec2ui const &size);
+
+bool is_webgpu_available();
+wgpu::Surface create_surface(wgpu::Instance const &instance);
+
+void present_rgba8(std::span<uint8_t const> pixels, vec2ui const &size);        // for CPU rendering without WebGPU
+void set_status(std::string const &text);                                       // a line of text shown over the canvas, or none if empty
+
+}
@@ -0,0 +1,85 @@
+#include "platform.h"
+#include <utility>
+#include <emscripten.h>
+#include <emscripten/html5.h>
+
+namespace platform {
+
+namespace {
+
+constexpr char const *canvas_selector{"#canvas"};
+
+EM_JS(bool, is_webgpu_available_js, (), {
+  return !!navigator.gpu;
+});
+
+EM_JS(void, present_rgba8_js, (char const *selector, uint8_t const *pixels, int width, int height), {
+  const canvas = document.querySelector(UTF8ToString(selector));
+  const context = canvas && canvas.getContext('2d');
+  if(!context) return;
+  const data = new Uint8ClampedArray(HEAPU8.buffer, pixels, width * height * 4).slice(); // ImageData can't view shared memory, so copy
+  context.putImageData(new ImageData(data, width, height), 0, 0);
+});
+
+EM_JS(void, set_status_js, (char const *text), {
+  if(Module.setStatus) Module.setStatus(UTF8ToString(text));
+});
+
+}
+
+void run_main_loop(void (*callback)(void *userdata), void *userdata) {
+  /// Run the callback once per display frame, using the browser's requestAnimationFrame mechanism
+  emscripten_set_main_loop_arg(callback, userdata, 0, true);                    // loop function, user data, FPS (0 to use browser requestAnimationFrame mechanism), simulate infinite loop
+  std::unreachable();
+}
+
+void cancel_main_loop() {
+  /// Stop the current main loop, so that another can be started
+  emscripten_cancel_main_loop();
+}
+
+vec2f get_canvas_css_size() {
+  /// The size of the canvas in CSS pixels
+  vec2d css_size;
+  emscripten_get_element_css_size(canvas_selector, &css_size.x, &css_size.y);
+  return static_cast<vec2f>(css_size);
+}
+
+float get_device_pixel_ratio() {
+  /// How many device pixels there are to one CSS pixel
+  return static_cast<float>(emscripten_get_device_pixel_ratio());
+}
+
+void set_canvas_size(vec2ui const &size) {
+  /// Set the size of the canvas's backing store in device pixels
+  emscripten_set_canvas_element_size(canvas_selector, static_cast<int>(size.x), static_cast<int>(size.y));
+}
+
+bool is_webgpu_available() {
+  /// Whether the browser exposes WebGPU at all; an adapter may still be unobtainable
+  return is_webgpu_available_js();
+}
+
+wgpu::Surface create_surface(wgpu::Instance const &instance) {
+  /// Create a surface for rendering to the canvas
+  wgpu::SurfaceDescriptorFromCanvasHTMLSelector surface_descriptor_from_canvas;
+  surface_descriptor_from_canvas.selector = canvas_selector;
+
+  wgpu::SurfaceDescriptor surface_descriptor{
+    .nextInChain{&surface_descriptor_from_canvas},
+    .label{"Canvas surface"},
+  };
+  return instance.CreateSurface(&surface_descriptor);
+}
+
+void present_rgba8(std::span<uint8_t const> pixels, vec2ui const &size) {
+  /// Draw an image to the canvas through a 2D context, which is only possible if WebGPU never claimed the canvas
+  present_rgba8_js(canvas_selector, pixels.data(), static_cast<int>(size.x), static_cast<int>(size.y));
+}
+
+void set_status(std::string const &text) {
+  /// Show a line of text over the canvas, through the page's status element
+  set_status_js(text.c_str());
+}
+
+}
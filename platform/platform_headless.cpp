@@ -0,0 +1,72 @@
+#include "platform.h"
+#include "platform_headless.h"
+#include <cstdlib>
+
+namespace platform {
+
+namespace {
+
+bool main_loop_cancelled{false};
+
+}
+
+namespace headless {
+
+settings &get_settings() {
+  /// Access the settings for the simulated environment
+  static settings instance;
+  return instance;
+}
+
+}
+
+void run_main_loop(void (*callback)(void *userdata), void *userdata) {
+  /// Run the callback repeatedly, as fast as possible, until the loop is cancelled
+  /// As in the browser, this never returns to its caller: a callback may cancel this loop and start another
+  /// in its place, and when a loop is cancelled without a replacement, the program exits
+  main_loop_cancelled = false;
+  while(!main_loop_cancelled) {
+    callback(userdata);
+  }
+  std::exit(EXIT_SUCCESS);
+}
+
+void cancel_main_loop() {
+  /// Stop the current main loop after its current iteration
+  main_loop_cancelled = true;
+}
+
+vec2f get_canvas_css_size() {
+  return vec2f{headless::get_settings().canvas_css_size};
+}
+
+float get_device_pixel_ratio() {
+  return headless::get_settings().device_pixel_ratio;
+}
+
+void set_canvas_size(vec2ui const &/*size*/) {
+  /// There is no canvas; the surface size is all that matters
+}
+
+bool is_webgpu_available() {
+  /// The recording backend is always available
+  return true;
+}
+
+wgpu::Surface create_surface(wgpu::Instance const &instance) {
+  /// Create a surface with no window behind it
+  wgpu::SurfaceDescriptor surface_descriptor{
+    .label{"Headless surface"},
+  };
+  return instance.CreateSurface(&surface_descriptor);
+}
+
+void present_rgba8(std::span<uint8_t const> /*pixels*/, vec2ui const &/*size*/) {
+  /// There is no canvas to show the image on
+}
+
+void set_status(std::string const &/*text*/) {
+  /// There is no page to show the status on
+}
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "vectorstorm/vector/vector2.h"
+
+namespace platform::headless {
+
+// configuration of the simulated environment for native headless runs
+
+struct settings {
+  vec2f canvas_css_size{1920.0f, 1080.0f};                                      // size of the simulated canvas in CSS pixels
+  float device_pixel_ratio{1.0f};
+};
+
+settings &get_settings();
+
+}
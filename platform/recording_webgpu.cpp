@@ -0,0 +1,829 @@
+#include "recording_webgpu.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <webgpu/webgpu.h>
+
+namespace platform::recording_webgpu {
+
+namespace {
+
+struct state {
+  call_counts counts;
+  uint64_t total_calls{0};
+  uint64_t objects_created{0};
+  uint64_t objects_live{0};
+  bool log_calls{false};
+  std::vector<std::function<void()>> deferred_callbacks;                        // asynchronous completions waiting for process_events()
+};
+
+state &get_state() {
+  /// Access the recorder's state, constructed on first use as API calls may come from static initialisers
+  static state instance;
+  return instance;
+}
+
+thread_local constinit unsigned int api_call_depth{0};                          // how many API calls are in progress on this thread, as callbacks may call back in
+
+class api_call {
+  /// Counts, and logs if requested, a call to an API function, which is in progress until this is destroyed
+public:
+  explicit api_call(std::string_view function) {
+    ++api_call_depth;                                                           // first, so the backend's own allocations below are attributed to it
+    auto &recorder{get_state()};
+    ++recorder.counts[function];
+    ++recorder.total_calls;
+    if(recorder.log_calls) std::clog << "WebGPU: " << function << '\n';
+  }
+  ~api_call() {
+    --api_call_depth;
+  }
+  api_call(api_call const&) = delete;
+  api_call &operator=(api_call const&) = delete;
+};
+
+void defer(std::function<void()> &&callback) {
+  /// Queue an asynchronous completion for delivery on the next call to process_events()
+  get_state().deferred_callbacks.emplace_back(std::move(callback));
+}
+
+}
+
+void set_log_calls(bool new_log_calls) {
+  get_state().log_calls = new_log_calls;
+}
+
+void reset_counts() {
+  /// Zero the call and object creation counts, leaving the live object count alone
+  auto &recorder{get_state()};
+  recorder.counts.clear();
+  recorder.total_calls = 0;
+  recorder.objects_created = 0;
+}
+
+call_counts const &get_counts() {
+  return get_state().counts;
+}
+
+uint64_t get_total_calls() {
+  return get_state().total_calls;
+}
+
+uint64_t get_objects_created() {
+  return get_state().objects_created;
+}
+
+uint64_t get_objects_live() {
+  return get_state().objects_live;
+}
+
+bool is_in_api_call() {
+  return api_call_depth != 0;
+}
+
+void process_events() {
+  /// Deliver deferred callbacks; any queued by the callbacks themselves wait for the next call
+  std::vector<std::function<void()>> callbacks;
+  std::swap(callbacks, get_state().deferred_callbacks);
+  for(auto &callback : callbacks) {
+    callback();
+  }
+}
+
+namespace {
+
+struct object {                                                                 // reference counted base for all API objects
+  uint32_t refcount{1};
+
+  object() {
+    auto &recorder{get_state()};
+    ++recorder.objects_created;
+    ++recorder.objects_live;
+  }
+  object(object const&) = delete;
+  object &operator=(object const&) = delete;
+  virtual ~object() {
+    --get_state().objects_live;
+  }
+};
+
+void add_ref(object *target) {
+  ++target->refcount;
+}
+
+void release(object *target) {
+  if(--target->refcount == 0) delete target;
+}
+
+template<typename T>
+T *create() {
+  /// Create an API object with a single reference owned by the caller
+  return new T;
+}
+
+template<typename T>
+T *share(T *target) {
+  /// Return an existing API object with an additional reference owned by the caller
+  add_ref(target);
+  return target;
+}
+
+}
+
+}
+
+using namespace platform::recording_webgpu;
+
+struct WGPUAdapterImpl final : object {};
+struct WGPUBindGroupImpl final : object {};
+struct WGPUBindGroupLayoutImpl final : object {};
+struct WGPUBufferImpl final : object {
+  std::vector<std::byte> contents;                                              // real storage, so mapped ranges can be read and written
+  WGPUBufferUsageFlags usage{0};
+};
+struct WGPUCommandBufferImpl final : object {};
+struct WGPUCommandEncoderImpl final : object {};
+struct WGPUComputePassEncoderImpl final : object {};
+struct WGPUComputePipelineImpl final : object {};
+struct WGPUQueueImpl final : object {};
+struct WGPUDeviceImpl final : object {
+  WGPUQueue queue{create<WGPUQueueImpl>()};
+
+  ~WGPUDeviceImpl() override {
+    release(queue);
+  }
+};
+struct WGPUInstanceImpl final : object {};
+struct WGPUPipelineLayoutImpl final : object {};
+struct WGPUQuerySetImpl final : object {
+  uint32_t count{0};
+};
+struct WGPURenderBundleImpl final : object {};
+struct WGPURenderBundleEncoderImpl final : object {};
+struct WGPURenderPassEncoderImpl final : object {};
+struct WGPURenderPipelineImpl final : object {};
+struct WGPUSamplerImpl final : object {};
+struct WGPUShaderModuleImpl final : object {};
+struct WGPUSurfaceImpl final : object {
+  WGPUTextureFormat format{WGPUTextureFormat_Undefined};
+  uint32_t width{0};
+  uint32_t height{0};
+};
+struct WGPUTextureImpl final : object {
+  WGPUTextureFormat format{WGPUTextureFormat_Undefined};
+  uint32_t width{0};
+  uint32_t height{0};
+  uint32_t depth_or_array_layers{1};
+};
+struct WGPUTextureViewImpl final : object {};
+
+namespace {
+
+constexpr std::array supported_features{
+  WGPUFeatureName_Depth32FloatStencil8,
+  WGPUFeatureName_Float32Filterable,
+  WGPUFeatureName_TimestampQuery,
+};
+
+bool has_feature(WGPUFeatureName feature) {
+  return std::ranges::find(supported_features, feature) != supported_features.end();
+}
+
+size_t enumerate_features(WGPUFeatureName *features) {
+  /// Fill in the supported features if given somewhere to write them, returning how many there are
+  if(features) std::ranges::copy(supported_features, features);
+  return supported_features.size();
+}
+
+void get_limits(WGPUSupportedLimits *supported_limits) {
+  /// Report the defaults required by the WebGPU specification
+  auto &limits{supported_limits->limits};
+  limits.maxTextureDimension1D = 8192;
+  limits.maxTextureDimension2D = 8192;
+  limits.maxTextureDimension3D = 2048;
+  limits.maxTextureArrayLayers = 256;
+  limits.maxBindGroups = 4;
+  limits.maxBindGroupsPlusVertexBuffers = 24;
+  limits.maxBindingsPerBindGroup = 1000;
+  limits.maxDynamicUniformBuffersPerPipelineLayout = 8;
+  limits.maxDynamicStorageBuffersPerPipelineLayout = 4;
+  limits.maxSampledTexturesPerShaderStage = 16;
+  limits.maxSamplersPerShaderStage = 16;
+  limits.maxStorageBuffersPerShaderStage = 8;
+  limits.maxStorageTexturesPerShaderStage = 4;
+  limits.maxUniformBuffersPerShaderStage = 12;
+  limits.maxUniformBufferBindingSize = 65536;
+  limits.maxStorageBufferBindingSize = 134217728;
+  limits.minUniformBufferOffsetAlignment = 256;
+  limits.minStorageBufferOffsetAlignment = 256;
+  limits.maxVertexBuffers = 8;
+  limits.maxBufferSize = 268435456;
+  limits.maxVertexAttributes = 16;
+  limits.maxVertexBufferArrayStride = 2048;
+  limits.maxInterStageShaderVariables = 16;
+  limits.maxColorAttachments = 8;
+  limits.maxColorAttachmentBytesPerSample = 32;
+  limits.maxComputeWorkgroupStorageSize = 16384;
+  limits.maxComputeInvocationsPerWorkgroup = 256;
+  limits.maxComputeWorkgroupSizeX = 256;
+  limits.maxComputeWorkgroupSizeY = 256;
+  limits.maxComputeWorkgroupSizeZ = 64;
+  limits.maxComputeWorkgroupsPerDimension = 65535;
+}
+
+constexpr WGPUTextureFormat preferred_format{WGPUTextureFormat_BGRA8Unorm};
+constexpr std::array surface_formats{preferred_format};
+constexpr std::array surface_present_modes{WGPUPresentMode_Fifo};
+constexpr std::array surface_alpha_modes{WGPUCompositeAlphaMode_Opaque};
+
+constexpr char const *adapter_name{"Recording WebGPU backend"};
+
+}
+
+extern "C" {
+
+// reference counting, identical for every object type; both the older Reference and newer AddRef names are provided
+#define RECORDING_WEBGPU_REFCOUNTED(type)                                       \
+  void wgpu##type##Reference(WGPU##type target) {api_call const call{__func__}; add_ref(target);} \
+  void wgpu##type##AddRef(WGPU##type target) {api_call const call{__func__}; add_ref(target);} \
+  void wgpu##type##Release(WGPU##type target) {api_call const call{__func__}; release(target);}
+RECORDING_WEBGPU_REFCOUNTED(Adapter)
+RECORDING_WEBGPU_REFCOUNTED(BindGroup)
+RECORDING_WEBGPU_REFCOUNTED(BindGroupLayout)
+RECORDING_WEBGPU_REFCOUNTED(Buffer)
+RECORDING_WEBGPU_REFCOUNTED(CommandBuffer)
+RECORDING_WEBGPU_REFCOUNTED(CommandEncoder)
+RECORDING_WEBGPU_REFCOUNTED(ComputePassEncoder)
+RECORDING_WEBGPU_REFCOUNTED(ComputePipeline)
+RECORDING_WEBGPU_REFCOUNTED(Device)
+RECORDING_WEBGPU_REFCOUNTED(Instance)
+RECORDING_WEBGPU_REFCOUNTED(PipelineLayout)
+RECORDING_WEBGPU_REFCOUNTED(QuerySet)
+RECORDING_WEBGPU_REFCOUNTED(Queue)
+RECORDING_WEBGPU_REFCOUNTED(RenderBundle)
+RECORDING_WEBGPU_REFCOUNTED(RenderBundleEncoder)
+RECORDING_WEBGPU_REFCOUNTED(RenderPassEncoder)
+RECORDING_WEBGPU_REFCOUNTED(RenderPipeline)
+RECORDING_WEBGPU_REFCOUNTED(Sampler)
+RECORDING_WEBGPU_REFCOUNTED(ShaderModule)
+RECORDING_WEBGPU_REFCOUNTED(Surface)
+RECORDING_WEBGPU_REFCOUNTED(Texture)
+RECORDING_WEBGPU_REFCOUNTED(TextureView)
+#undef RECORDING_WEBGPU_REFCOUNTED
+
+// instance
+WGPUInstance wgpuCreateInstance(WGPUInstanceDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUInstanceImpl>();
+}
+
+WGPUSurface wgpuInstanceCreateSurface(WGPUInstance /*instance*/, WGPUSurfaceDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUSurfaceImpl>();
+}
+
+void wgpuInstanceProcessEvents(WGPUInstance /*instance*/) {
+  api_call const call{__func__};
+  process_events();
+}
+
+void wgpuInstanceRequestAdapter(WGPUInstance /*instance*/, WGPURequestAdapterOptions const */*options*/, WGPURequestAdapterCallback callback, void *userdata) {
+  api_call const call{__func__};
+  callback(WGPURequestAdapterStatus_Success, create<WGPUAdapterImpl>(), nullptr, userdata);
+}
+
+// adapter
+size_t wgpuAdapterEnumerateFeatures(WGPUAdapter /*adapter*/, WGPUFeatureName *features) {
+  api_call const call{__func__};
+  return enumerate_features(features);
+}
+
+void wgpuAdapterGetInfo(WGPUAdapter /*adapter*/, WGPUAdapterInfo *info) {
+  api_call const call{__func__};
+  info->vendor = "";
+  info->architecture = "";
+  info->device = adapter_name;
+  info->description = adapter_name;
+  info->backendType = WGPUBackendType_Null;
+  info->adapterType = WGPUAdapterType_CPU;
+  info->vendorID = 0;
+  info->deviceID = 0;
+}
+
+WGPUBool wgpuAdapterGetLimits(WGPUAdapter /*adapter*/, WGPUSupportedLimits *limits) {
+  api_call const call{__func__};
+  get_limits(limits);
+  return true;
+}
+
+void wgpuAdapterGetProperties(WGPUAdapter /*adapter*/, WGPUAdapterProperties *properties) {
+  api_call const call{__func__};
+  properties->vendorID = 0;
+  properties->vendorName = "";
+  properties->architecture = "";
+  properties->deviceID = 0;
+  properties->name = adapter_name;
+  properties->driverDescription = adapter_name;
+  properties->adapterType = WGPUAdapterType_CPU;
+  properties->backendType = WGPUBackendType_Null;
+  properties->compatibilityMode = false;
+}
+
+WGPUBool wgpuAdapterHasFeature(WGPUAdapter /*adapter*/, WGPUFeatureName feature) {
+  api_call const call{__func__};
+  return has_feature(feature);
+}
+
+void wgpuAdapterRequestDevice(WGPUAdapter /*adapter*/, WGPUDeviceDescriptor const */*descriptor*/, WGPURequestDeviceCallback callback, void *userdata) {
+  api_call const call{__func__};
+  callback(WGPURequestDeviceStatus_Success, create<WGPUDeviceImpl>(), nullptr, userdata);
+}
+
+void wgpuAdapterInfoFreeMembers(WGPUAdapterInfo /*info*/) {
+  api_call const call{__func__};                                                // strings are all static
+}
+
+void wgpuAdapterPropertiesFreeMembers(WGPUAdapterProperties /*properties*/) {
+  api_call const call{__func__};                                                // strings are all static
+}
+
+// buffer
+void wgpuBufferDestroy(WGPUBuffer /*buffer*/) {
+  api_call const call{__func__};
+}
+
+void const *wgpuBufferGetConstMappedRange(WGPUBuffer buffer, size_t offset, size_t /*size*/) {
+  api_call const call{__func__};
+  return buffer->contents.data() + offset;
+}
+
+void *wgpuBufferGetMappedRange(WGPUBuffer buffer, size_t offset, size_t /*size*/) {
+  api_call const call{__func__};
+  return buffer->contents.data() + offset;
+}
+
+uint64_t wgpuBufferGetSize(WGPUBuffer buffer) {
+  api_call const call{__func__};
+  return buffer->contents.size();
+}
+
+WGPUBufferUsageFlags wgpuBufferGetUsage(WGPUBuffer buffer) {
+  api_call const call{__func__};
+  return buffer->usage;
+}
+
+void wgpuBufferMapAsync(WGPUBuffer buffer, WGPUMapModeFlags /*mode*/, size_t /*offset*/, size_t /*size*/, WGPUBufferMapCallback callback, void *userdata) {
+  api_call const call{__func__};
+  add_ref(buffer);                                                              // keep the buffer alive until the callback has run
+  defer([buffer, callback, userdata]{
+    callback(WGPUBufferMapAsyncStatus_Success, userdata);
+    release(buffer);
+  });
+}
+
+void wgpuBufferUnmap(WGPUBuffer /*buffer*/) {
+  api_call const call{__func__};
+}
+
+// command encoder
+WGPUComputePassEncoder wgpuCommandEncoderBeginComputePass(WGPUCommandEncoder /*encoder*/, WGPUComputePassDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUComputePassEncoderImpl>();
+}
+
+WGPURenderPassEncoder wgpuCommandEncoderBeginRenderPass(WGPUCommandEncoder /*encoder*/, WGPURenderPassDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPURenderPassEncoderImpl>();
+}
+
+void wgpuCommandEncoderClearBuffer(WGPUCommandEncoder /*encoder*/, WGPUBuffer buffer, uint64_t offset, uint64_t size) {
+  api_call const call{__func__};
+  auto const end{size == WGPU_WHOLE_SIZE ? buffer->contents.size() : static_cast<size_t>(offset + size)};
+  std::fill(buffer->contents.begin() + static_cast<ptrdiff_t>(offset), buffer->contents.begin() + static_cast<ptrdiff_t>(end), std::byte{0});
+}
+
+void wgpuCommandEncoderCopyBufferToBuffer(WGPUCommandEncoder /*encoder*/, WGPUBuffer source, uint64_t source_offset, WGPUBuffer destination, uint64_t destination_offset, uint64_t size) {
+  api_call const call{__func__};
+  std::memcpy(destination->contents.data() + destination_offset, source->contents.data() + source_offset, static_cast<size_t>(size));
+}
+
+void wgpuCommandEncoderCopyBufferToTexture(WGPUCommandEncoder /*encoder*/, WGPUImageCopyBuffer const */*source*/, WGPUImageCopyTexture const */*destination*/, WGPUExtent3D const */*copy_size*/) {
+  api_call const call{__func__};
+}
+
+void wgpuCommandEncoderCopyTextureToBuffer(WGPUCommandEncoder /*encoder*/, WGPUImageCopyTexture const */*source*/, WGPUImageCopyBuffer const */*destination*/, WGPUExtent3D const */*copy_size*/) {
+  api_call const call{__func__};
+}
+
+void wgpuCommandEncoderCopyTextureToTexture(WGPUCommandEncoder /*encoder*/, WGPUImageCopyTexture const */*source*/, WGPUImageCopyTexture const */*destination*/, WGPUExtent3D const */*copy_size*/) {
+  api_call const call{__func__};
+}
+
+WGPUCommandBuffer wgpuCommandEncoderFinish(WGPUCommandEncoder /*encoder*/, WGPUCommandBufferDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUCommandBufferImpl>();
+}
+
+void wgpuCommandEncoderInsertDebugMarker(WGPUCommandEncoder /*encoder*/, char const */*marker_label*/) {
+  api_call const call{__func__};
+}
+
+void wgpuCommandEncoderPopDebugGroup(WGPUCommandEncoder /*encoder*/) {
+  api_call const call{__func__};
+}
+
+void wgpuCommandEncoderPushDebugGroup(WGPUCommandEncoder /*encoder*/, char const */*group_label*/) {
+  api_call const call{__func__};
+}
+
+void wgpuCommandEncoderResolveQuerySet(WGPUCommandEncoder /*encoder*/, WGPUQuerySet /*query_set*/, uint32_t /*first_query*/, uint32_t /*query_count*/, WGPUBuffer /*destination*/, uint64_t /*destination_offset*/) {
+  api_call const call{__func__};                                                // no timestamps are taken, so the destination keeps its contents
+}
+
+void wgpuCommandEncoderWriteTimestamp(WGPUCommandEncoder /*encoder*/, WGPUQuerySet /*query_set*/, uint32_t /*query_index*/) {
+  api_call const call{__func__};
+}
+
+// compute pass encoder
+void wgpuComputePassEncoderDispatchWorkgroups(WGPUComputePassEncoder /*encoder*/, uint32_t /*workgroup_count_x*/, uint32_t /*workgroup_count_y*/, uint32_t /*workgroup_count_z*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderDispatchWorkgroupsIndirect(WGPUComputePassEncoder /*encoder*/, WGPUBuffer /*indirect_buffer*/, uint64_t /*indirect_offset*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderEnd(WGPUComputePassEncoder /*encoder*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderPopDebugGroup(WGPUComputePassEncoder /*encoder*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderPushDebugGroup(WGPUComputePassEncoder /*encoder*/, char const */*group_label*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderSetBindGroup(WGPUComputePassEncoder /*encoder*/, uint32_t /*group_index*/, WGPUBindGroup /*group*/, size_t /*dynamic_offset_count*/, uint32_t const */*dynamic_offsets*/) {
+  api_call const call{__func__};
+}
+
+void wgpuComputePassEncoderSetPipeline(WGPUComputePassEncoder /*encoder*/, WGPUComputePipeline /*pipeline*/) {
+  api_call const call{__func__};
+}
+
+// compute pipeline
+WGPUBindGroupLayout wgpuComputePipelineGetBindGroupLayout(WGPUComputePipeline /*pipeline*/, uint32_t /*group_index*/) {
+  api_call const call{__func__};
+  return create<WGPUBindGroupLayoutImpl>();
+}
+
+// device
+WGPUBindGroup wgpuDeviceCreateBindGroup(WGPUDevice /*device*/, WGPUBindGroupDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUBindGroupImpl>();
+}
+
+WGPUBindGroupLayout wgpuDeviceCreateBindGroupLayout(WGPUDevice /*device*/, WGPUBindGroupLayoutDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUBindGroupLayoutImpl>();
+}
+
+WGPUBuffer wgpuDeviceCreateBuffer(WGPUDevice /*device*/, WGPUBufferDescriptor const *descriptor) {
+  api_call const call{__func__};
+  auto *buffer{create<WGPUBufferImpl>()};
+  buffer->contents.resize(static_cast<size_t>(descriptor->size));
+  buffer->usage = descriptor->usage;
+  return buffer;
+}
+
+WGPUCommandEncoder wgpuDeviceCreateCommandEncoder(WGPUDevice /*device*/, WGPUCommandEncoderDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUCommandEncoderImpl>();
+}
+
+WGPUComputePipeline wgpuDeviceCreateComputePipeline(WGPUDevice /*device*/, WGPUComputePipelineDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUComputePipelineImpl>();
+}
+
+void wgpuDeviceCreateComputePipelineAsync(WGPUDevice /*device*/, WGPUComputePipelineDescriptor const */*descriptor*/, WGPUCreateComputePipelineAsyncCallback callback, void *userdata) {
+  api_call const call{__func__};
+  defer([callback, userdata]{
+    callback(WGPUCreatePipelineAsyncStatus_Success, create<WGPUComputePipelineImpl>(), nullptr, userdata);
+  });
+}
+
+WGPUPipelineLayout wgpuDeviceCreatePipelineLayout(WGPUDevice /*device*/, WGPUPipelineLayoutDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUPipelineLayoutImpl>();
+}
+
+WGPUQuerySet wgpuDeviceCreateQuerySet(WGPUDevice /*device*/, WGPUQuerySetDescriptor const *descriptor) {
+  api_call const call{__func__};
+  auto *query_set{create<WGPUQuerySetImpl>()};
+  query_set->count = descriptor->count;
+  return query_set;
+}
+
+WGPURenderBundleEncoder wgpuDeviceCreateRenderBundleEncoder(WGPUDevice /*device*/, WGPURenderBundleEncoderDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPURenderBundleEncoderImpl>();
+}
+
+WGPURenderPipeline wgpuDeviceCreateRenderPipeline(WGPUDevice /*device*/, WGPURenderPipelineDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPURenderPipelineImpl>();
+}
+
+void wgpuDeviceCreateRenderPipelineAsync(WGPUDevice /*device*/, WGPURenderPipelineDescriptor const */*descriptor*/, WGPUCreateRenderPipelineAsyncCallback callback, void *userdata) {
+  api_call const call{__func__};
+  defer([callback, userdata]{
+    callback(WGPUCreatePipelineAsyncStatus_Success, create<WGPURenderPipelineImpl>(), nullptr, userdata);
+  });
+}
+
+WGPUSampler wgpuDeviceCreateSampler(WGPUDevice /*device*/, WGPUSamplerDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUSamplerImpl>();
+}
+
+WGPUShaderModule wgpuDeviceCreateShaderModule(WGPUDevice /*device*/, WGPUShaderModuleDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUShaderModuleImpl>();
+}
+
+WGPUTexture wgpuDeviceCreateTexture(WGPUDevice /*device*/, WGPUTextureDescriptor const *descriptor) {
+  api_call const call{__func__};
+  auto *texture{create<WGPUTextureImpl>()};
+  texture->format = descriptor->format;
+  texture->width = descriptor->size.width;
+  texture->height = descriptor->size.height;
+  texture->depth_or_array_layers = descriptor->size.depthOrArrayLayers;
+  return texture;
+}
+
+void wgpuDeviceDestroy(WGPUDevice /*device*/) {
+  api_call const call{__func__};
+}
+
+size_t wgpuDeviceEnumerateFeatures(WGPUDevice /*device*/, WGPUFeatureName *features) {
+  api_call const call{__func__};
+  return enumerate_features(features);
+}
+
+WGPUBool wgpuDeviceGetLimits(WGPUDevice /*device*/, WGPUSupportedLimits *limits) {
+  api_call const call{__func__};
+  get_limits(limits);
+  return true;
+}
+
+WGPUQueue wgpuDeviceGetQueue(WGPUDevice device) {
+  api_call const call{__func__};
+  return share(device->queue);
+}
+
+WGPUBool wgpuDeviceHasFeature(WGPUDevice /*device*/, WGPUFeatureName feature) {
+  api_call const call{__func__};
+  return has_feature(feature);
+}
+
+void wgpuDevicePopErrorScope(WGPUDevice /*device*/, WGPUErrorCallback callback, void *userdata) {
+  api_call const call{__func__};
+  defer([callback, userdata]{
+    callback(WGPUErrorType_NoError, nullptr, userdata);
+  });
+}
+
+void wgpuDevicePushErrorScope(WGPUDevice /*device*/, WGPUErrorFilter /*filter*/) {
+  api_call const call{__func__};
+}
+
+void wgpuDeviceSetUncapturedErrorCallback(WGPUDevice /*device*/, WGPUErrorCallback /*callback*/, void */*userdata*/) {
+  api_call const call{__func__};                                                // nothing is validated, so there are never any errors
+}
+
+// query set
+void wgpuQuerySetDestroy(WGPUQuerySet /*query_set*/) {
+  api_call const call{__func__};
+}
+
+uint32_t wgpuQuerySetGetCount(WGPUQuerySet query_set) {
+  api_call const call{__func__};
+  return query_set->count;
+}
+
+// queue
+void wgpuQueueOnSubmittedWorkDone(WGPUQueue /*queue*/, WGPUQueueWorkDoneCallback callback, void *userdata) {
+  api_call const call{__func__};
+  defer([callback, userdata]{
+    callback(WGPUQueueWorkDoneStatus_Success, userdata);
+  });
+}
+
+void wgpuQueueSubmit(WGPUQueue /*queue*/, size_t /*command_count*/, WGPUCommandBuffer const */*commands*/) {
+  api_call const call{__func__};
+}
+
+void wgpuQueueWriteBuffer(WGPUQueue /*queue*/, WGPUBuffer buffer, uint64_t buffer_offset, void const *data, size_t size) {
+  api_call const call{__func__};
+  std::memcpy(buffer->contents.data() + buffer_offset, data, size);
+}
+
+void wgpuQueueWriteTexture(WGPUQueue /*queue*/, WGPUImageCopyTexture const */*destination*/, void const */*data*/, size_t /*data_size*/, WGPUTextureDataLayout const */*data_layout*/, WGPUExtent3D const */*write_size*/) {
+  api_call const call{__func__};
+}
+
+// render bundle encoder
+void wgpuRenderBundleEncoderDraw(WGPURenderBundleEncoder /*encoder*/, uint32_t /*vertex_count*/, uint32_t /*instance_count*/, uint32_t /*first_vertex*/, uint32_t /*first_instance*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderDrawIndexed(WGPURenderBundleEncoder /*encoder*/, uint32_t /*index_count*/, uint32_t /*instance_count*/, uint32_t /*first_index*/, int32_t /*base_vertex*/, uint32_t /*first_instance*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderDrawIndexedIndirect(WGPURenderBundleEncoder /*encoder*/, WGPUBuffer /*indirect_buffer*/, uint64_t /*indirect_offset*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderDrawIndirect(WGPURenderBundleEncoder /*encoder*/, WGPUBuffer /*indirect_buffer*/, uint64_t /*indirect_offset*/) {
+  api_call const call{__func__};
+}
+
+WGPURenderBundle wgpuRenderBundleEncoderFinish(WGPURenderBundleEncoder /*encoder*/, WGPURenderBundleDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPURenderBundleImpl>();
+}
+
+void wgpuRenderBundleEncoderSetBindGroup(WGPURenderBundleEncoder /*encoder*/, uint32_t /*group_index*/, WGPUBindGroup /*group*/, size_t /*dynamic_offset_count*/, uint32_t const */*dynamic_offsets*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderSetIndexBuffer(WGPURenderBundleEncoder /*encoder*/, WGPUBuffer /*buffer*/, WGPUIndexFormat /*format*/, uint64_t /*offset*/, uint64_t /*size*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderSetPipeline(WGPURenderBundleEncoder /*encoder*/, WGPURenderPipeline /*pipeline*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderBundleEncoderSetVertexBuffer(WGPURenderBundleEncoder /*encoder*/, uint32_t /*slot*/, WGPUBuffer /*buffer*/, uint64_t /*offset*/, uint64_t /*size*/) {
+  api_call const call{__func__};
+}
+
+// render pass encoder
+void wgpuRenderPassEncoderDraw(WGPURenderPassEncoder /*encoder*/, uint32_t /*vertex_count*/, uint32_t /*instance_count*/, uint32_t /*first_vertex*/, uint32_t /*first_instance*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderDrawIndexed(WGPURenderPassEncoder /*encoder*/, uint32_t /*index_count*/, uint32_t /*instance_count*/, uint32_t /*first_index*/, int32_t /*base_vertex*/, uint32_t /*first_instance*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderDrawIndexedIndirect(WGPURenderPassEncoder /*encoder*/, WGPUBuffer /*indirect_buffer*/, uint64_t /*indirect_offset*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderDrawIndirect(WGPURenderPassEncoder /*encoder*/, WGPUBuffer /*indirect_buffer*/, uint64_t /*indirect_offset*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderEnd(WGPURenderPassEncoder /*encoder*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderExecuteBundles(WGPURenderPassEncoder /*encoder*/, size_t /*bundle_count*/, WGPURenderBundle const */*bundles*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderPopDebugGroup(WGPURenderPassEncoder /*encoder*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderPushDebugGroup(WGPURenderPassEncoder /*encoder*/, char const */*group_label*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetBindGroup(WGPURenderPassEncoder /*encoder*/, uint32_t /*group_index*/, WGPUBindGroup /*group*/, size_t /*dynamic_offset_count*/, uint32_t const */*dynamic_offsets*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetBlendConstant(WGPURenderPassEncoder /*encoder*/, WGPUColor const */*colour*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetIndexBuffer(WGPURenderPassEncoder /*encoder*/, WGPUBuffer /*buffer*/, WGPUIndexFormat /*format*/, uint64_t /*offset*/, uint64_t /*size*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetPipeline(WGPURenderPassEncoder /*encoder*/, WGPURenderPipeline /*pipeline*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetScissorRect(WGPURenderPassEncoder /*encoder*/, uint32_t /*x*/, uint32_t /*y*/, uint32_t /*width*/, uint32_t /*height*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetStencilReference(WGPURenderPassEncoder /*encoder*/, uint32_t /*reference*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetVertexBuffer(WGPURenderPassEncoder /*encoder*/, uint32_t /*slot*/, WGPUBuffer /*buffer*/, uint64_t /*offset*/, uint64_t /*size*/) {
+  api_call const call{__func__};
+}
+
+void wgpuRenderPassEncoderSetViewport(WGPURenderPassEncoder /*encoder*/, float /*x*/, float /*y*/, float /*width*/, float /*height*/, float /*min_depth*/, float /*max_depth*/) {
+  api_call const call{__func__};
+}
+
+// render pipeline
+WGPUBindGroupLayout wgpuRenderPipelineGetBindGroupLayout(WGPURenderPipeline /*pipeline*/, uint32_t /*group_index*/) {
+  api_call const call{__func__};
+  return create<WGPUBindGroupLayoutImpl>();
+}
+
+// surface
+void wgpuSurfaceConfigure(WGPUSurface surface, WGPUSurfaceConfiguration const *config) {
+  api_call const call{__func__};
+  surface->format = config->format;
+  surface->width = config->width;
+  surface->height = config->height;
+}
+
+void wgpuSurfaceGetCapabilities(WGPUSurface /*surface*/, WGPUAdapter /*adapter*/, WGPUSurfaceCapabilities *capabilities) {
+  api_call const call{__func__};
+  capabilities->formatCount = surface_formats.size();
+  capabilities->formats = surface_formats.data();
+  capabilities->presentModeCount = surface_present_modes.size();
+  capabilities->presentModes = surface_present_modes.data();
+  capabilities->alphaModeCount = surface_alpha_modes.size();
+  capabilities->alphaModes = surface_alpha_modes.data();
+}
+
+void wgpuSurfaceGetCurrentTexture(WGPUSurface surface, WGPUSurfaceTexture *surface_texture) {
+  api_call const call{__func__};
+  auto *texture{create<WGPUTextureImpl>()};
+  texture->format = surface->format;
+  texture->width = surface->width;
+  texture->height = surface->height;
+  surface_texture->texture = texture;
+  surface_texture->suboptimal = false;
+  surface_texture->status = WGPUSurfaceGetCurrentTextureStatus_Success;
+}
+
+WGPUTextureFormat wgpuSurfaceGetPreferredFormat(WGPUSurface /*surface*/, WGPUAdapter /*adapter*/) {
+  api_call const call{__func__};
+  return preferred_format;
+}
+
+void wgpuSurfacePresent(WGPUSurface /*surface*/) {
+  api_call const call{__func__};
+}
+
+void wgpuSurfaceUnconfigure(WGPUSurface surface) {
+  api_call const call{__func__};
+  surface->width = 0;
+  surface->height = 0;
+}
+
+void wgpuSurfaceCapabilitiesFreeMembers(WGPUSurfaceCapabilities /*capabilities*/) {
+  api_call const call{__func__};                                                // arrays are all static
+}
+
+// texture
+WGPUTextureView wgpuTextureCreateView(WGPUTexture /*texture*/, WGPUTextureViewDescriptor const */*descriptor*/) {
+  api_call const call{__func__};
+  return create<WGPUTextureViewImpl>();
+}
+
+void wgpuTextureDestroy(WGPUTexture /*texture*/) {
+  api_call const call{__func__};
+}
+
+uint32_t wgpuTextureGetDepthOrArrayLayers(WGPUTexture texture) {
+  api_call const call{__func__};
+  return texture->depth_or_array_layers;
+}
+
+WGPUTextureFormat wgpuTextureGetFormat(WGPUTexture texture) {
+  api_call const call{__func__};
+  return texture->format;
+}
+
+uint32_t wgpuTextureGetHeight(WGPUTexture texture) {
+  api_call const call{__func__};
+  return texture->height;
+}
+
+uint32_t wgpuTextureGetWidth(WGPUTexture texture) {
+  api_call const call{__func__};
+  return texture->width;
+}
+
+}
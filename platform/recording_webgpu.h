@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string_view>
+
+namespace platform::recording_webgpu {
+
+// a null implementation of the WebGPU C API for native headless runs: every call is counted, and optionally
+// logged, but no work is done on any GPU.  Buffers have real storage so mapping behaves, textures do not.
+// Adapter and device requests complete immediately; other asynchronous callbacks are deferred until
+// process_events(), to keep the ordering the renderer sees in the browser.
+
+using call_counts = std::map<std::string_view, uint64_t>;                       // number of calls to each API function, by function name
+
+void set_log_calls(bool new_log_calls);                                         // whether to write every call to stderr as it happens
+
+void reset_counts();
+call_counts const &get_counts();
+uint64_t get_total_calls();
+
+uint64_t get_objects_created();                                                 // number of API objects created since the counts were last reset
+uint64_t get_objects_live();                                                    // number of API objects currently alive
+bool is_in_api_call();                                                          // whether the calling thread is inside an API function, to attribute its heap allocations
+
+void process_events();                                                          // deliver any deferred asynchronous callbacks
+
+}
@@ -0,0 +1,49 @@
+#include "alternating_benchmark.h"
+#include <cassert>
+
+namespace render {
+
+void alternating_benchmark::start(unsigned int phases) {
+  /// Begin a run of the given number of phases, starting with the first configuration and clearing previous results
+  assert(phases != 0);
+  for(auto &configuration_samples : samples) {
+    configuration_samples.clear();
+  }
+  phases_remaining = phases;
+  configuration = 0;
+  phase_samples = 0;
+  ++stats.runs;
+}
+
+bool alternating_benchmark::is_running() const {
+  return phases_remaining != 0;
+}
+
+unsigned int alternating_benchmark::get_configuration() const {
+  /// The configuration to use while running
+  return configuration;
+}
+
+bool alternating_benchmark::add_sample(float milliseconds) {
+  /// Record one frame's time under the current configuration, returning true if the configuration changed as a result
+  /// The run finishes when its last phase ends, which also counts as a change
+  if(!is_running()) return false;
+  if(phase_samples++ < warmup_frames) {
+    ++stats.discarded;
+  } else {
+    samples[configuration].push(milliseconds);
+    ++stats.accepted;
+  }
+  if(phase_samples != warmup_frames + frames_per_phase) return false;
+  phase_samples = 0;
+  --phases_remaining;
+  configuration = (configuration + 1) % configurations;
+  return true;
+}
+
+timing::summary alternating_benchmark::get_summary(unsigned int this_configuration) const {
+  /// Statistics of the frame times accepted for one configuration in the latest run
+  return samples.at(this_configuration).summarise();
+}
+
+}
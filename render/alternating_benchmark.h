@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "timing/sample_ring.h"
+
+namespace render {
+
+class alternating_benchmark {
+  /// Compares the cost of two configurations by alternating between them every few frames, independent of the graphics API
+  /// Alternating, rather than measuring one then the other, spreads clock and thermal changes evenly over both; the first
+  /// samples after each switch are discarded, as results arrive a few frames after the work they measure was submitted
+public:
+  static constexpr unsigned int configurations{2};
+  static constexpr size_t history_length{512};                                  // samples kept for each configuration
+
+  unsigned int frames_per_phase{32};                                            // samples taken before switching to the other configuration
+  unsigned int warmup_frames{6};                                                // samples discarded after each switch, at least the frames that may be in flight
+
+private:
+  unsigned int phases_remaining{0};                                             // zero when not running
+  unsigned int configuration{0};                                                // which configuration is being measured
+  unsigned int phase_samples{0};                                                // samples seen in this phase, including discarded ones
+  std::array<timing::sample_ring<history_length>, configurations> samples;
+
+public:
+  struct stats_data {
+    uint64_t accepted{0};
+    uint64_t discarded{0};                                                      // samples thrown away as possibly measuring the previous configuration
+    unsigned int runs{0};
+  } stats;
+
+  void start(unsigned int phases);
+  bool is_running() const;
+
+  unsigned int get_configuration() const;
+  bool add_sample(float milliseconds);
+
+  timing::summary get_summary(unsigned int configuration) const;
+};
+
+}
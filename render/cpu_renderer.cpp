@@ -0,0 +1,141 @@
+#include "cpu_renderer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace render {
+
+namespace {
+
+using lane_floats = std::array<float, cpu_renderer::lane_count>;
+
+struct vec2f_lanes {                                                            // one vec2f per lane, stored as a structure of arrays
+  lane_floats x{};
+  lane_floats y{};
+};
+
+uint8_t to_unorm8(float value) {
+  /// Quantise a colour channel as a unorm8 render target would
+  return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+}
+
+cpu_renderer::cpu_renderer(unsigned int thread_count)
+  : pool{thread_count} {
+  /// Construct a renderer with its own thread pool; a thread count of 0 uses every hardware thread available
+}
+
+void cpu_renderer::resize(vec2ui const &new_size) {
+  /// Reallocate the image for a new size; the contents are undefined until rendered
+  if(new_size == size) return;
+  size = vec2ui{new_size};
+  pixels.assign(static_cast<size_t>(size.x) * size.y * 4, 0);
+}
+
+void cpu_renderer::render(vec2f const &input) {
+  /// Render the whole image
+  std::vector<tile_scheduler::tile> tiles;
+  for(uint32_t y{0}; y < size.y; y += tile_size) {
+    for(uint32_t x{0}; x < size.x; x += tile_size) {
+      tiles.emplace_back(tile_scheduler::tile{
+        .x{x},
+        .y{y},
+        .width{ std::min(tile_size, size.x - x)},
+        .height{std::min(tile_size, size.y - y)},
+      });
+    }
+  }
+  render_tiles(tiles, input);
+}
+
+void cpu_renderer::render_tiles(std::span<tile_scheduler::tile const> tiles, vec2f const &input) {
+  /// Render some tiles of the image, in parallel
+  pool.run(tiles.size(), [&](size_t index){
+    render_tile(tiles[index], input);
+  });
+  for(auto const &tile : tiles) {
+    stats.pixels_rendered += static_cast<uint64_t>(tile.width) * tile.height;
+  }
+}
+
+void cpu_renderer::render_tile(tile_scheduler::tile const &tile, vec2f const &input) {
+  /// Shade one tile, lane_count pixels of a row at a time
+  /// Each step follows the shader's arithmetic in the same order, in single precision, so results match the GPU's
+  /// to within the precision of its transcendental functions
+  constexpr unsigned int max_iterations{64};
+  constexpr float escape_radius_squared{128.0f};
+  vec2f const inverse_size{1.0f / static_cast<float>(size.x), 1.0f / static_cast<float>(size.y)};
+
+  for(uint32_t y{tile.y}; y != tile.y + tile.height; ++y) {
+    for(uint32_t x_start{tile.x}; x_start < tile.x + tile.width; x_start += lane_count) {
+      unsigned int const lanes{std::min(lane_count, tile.x + tile.width - x_start)};
+
+      // vs_main and interpolation: uv runs from 0 at the left and bottom to 1 at the right and top, plus the input
+      vec2f_lanes starlit_wave;                                                 // the point c being iterated
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        float const u{(static_cast<float>(x_start + lane) + 0.5f) * inverse_size.x + input.x};
+        float const v{(1.0f - (static_cast<float>(y) + 0.5f) * inverse_size.y) + input.y};
+        starlit_wave.x[lane] = u * 3.5f - 2.5f;
+        starlit_wave.y[lane] = v * 2.0f - 1.0f;
+      }
+
+      // endless_wander: iterate z = z^2 + c until it escapes, tracking a smoothed iteration count and mean distance
+      vec2f_lanes z;
+      lane_floats fading_memory{};
+      lane_floats untamed_heart{};
+      std::array<bool, lane_count> active;
+      active.fill(true);
+      for(unsigned int iteration{0}; iteration != max_iterations; ++iteration) {
+        lane_floats length_squared;
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          float const next_x{z.x[lane] * z.x[lane] - z.y[lane] * z.y[lane] + starlit_wave.x[lane]};
+          float const next_y{2.0f * z.x[lane] * z.y[lane] + starlit_wave.y[lane]};
+          z.x[lane] = next_x;
+          z.y[lane] = next_y;
+          length_squared[lane] = next_x * next_x + next_y * next_y;
+        }
+
+        bool any_active{false};
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          if(!active[lane]) continue;
+          if(length_squared[lane] > escape_radius_squared) {                    // rare, so the logs stay scalar
+            untamed_heart[lane] = static_cast<float>(iteration) - std::log2(std::log2(length_squared[lane]));
+            active[lane] = false;
+            continue;
+          }
+          float const dx{starlit_wave.x[lane] - z.x[lane]};
+          float const dy{starlit_wave.y[lane] - z.y[lane]};
+          fading_memory[lane] = (fading_memory[lane] + std::sqrt(dx * dx + dy * dy)) / 2.0f;
+          any_active = true;
+        }
+        if(!any_active) break;
+      }
+
+      // fs_main: colour from the escape time, or from the mean distance for points that never escaped
+      auto *output{&pixels[(static_cast<size_t>(y) * size.x + x_start) * 4]};
+      for(unsigned int lane{0}; lane != lanes; ++lane) {
+        float const quiet_soul{active[lane] ? std::log(fading_memory[lane] + 1.5f) : 0.0f};
+        float const heart{untamed_heart[lane]};
+        output[lane * 4 + 0] = to_unorm8(heart / 16.0f + quiet_soul);
+        output[lane * 4 + 1] = to_unorm8(0.5f + (heart / 128.0f) + quiet_soul / 4.0f);
+        output[lane * 4 + 2] = to_unorm8(0.5f - (heart / 64.0f));
+        output[lane * 4 + 3] = 255;
+      }
+    }
+  }
+}
+
+vec2ui const &cpu_renderer::get_size() const {
+  return size;
+}
+
+std::span<uint8_t const> cpu_renderer::get_pixels() const {
+  return pixels;
+}
+
+unsigned int cpu_renderer::get_thread_count() const {
+  return pool.get_thread_count();
+}
+
+}
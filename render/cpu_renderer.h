@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "vectorstorm/vector/vector2.h"
+#include "tile_scheduler.h"
+#include "work_stealing_pool.h"
+
+namespace render {
+
+class cpu_renderer {
+  /// Renders the default shader's escape-time image on the CPU, for when WebGPU is unavailable, independent of
+  /// the graphics API
+  /// A C++ port of vs_main, endless_wander and fs_main from shaders/default.wgsl drawn over the fullscreen quad,
+  /// computing a row of lane_count pixels at once so the compiler can vectorise each step, with tiles of the
+  /// image shared out over a work-stealing thread pool
+public:
+  static constexpr unsigned int lane_count{8};                                  // pixels computed together, two 128-bit SIMD registers of floats
+  static constexpr uint32_t tile_size{64};                                      // 64x64 RGBA8 tiles are 16KiB, so a tile being written stays in L1
+
+private:
+  vec2ui size;
+  std::vector<uint8_t> pixels;                                                  // RGBA8, row by row from the top, allocated only on resize
+  work_stealing_pool pool;
+
+  void render_tile(tile_scheduler::tile const &tile, vec2f const &input);
+
+public:
+  struct stats_data {
+    uint64_t pixels_rendered{0};
+  } stats;
+
+  explicit cpu_renderer(unsigned int thread_count = 0);
+
+  void resize(vec2ui const &new_size);
+  void render(vec2f const &input);
+  void render_tiles(std::span<tile_scheduler::tile const> tiles, vec2f const &input);
+
+  vec2ui const &get_size() const;
+  std::span<uint8_t const> get_pixels() const;
+  unsigned int get_thread_count() const;
+};
+
+}
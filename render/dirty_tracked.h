@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace render {
+
+template<typename T>
+class dirty_tracked {
+  /// Wraps a block of data destined for the GPU, bumping a version whenever a write actually changes
+  /// its bytes, so that uploads can be skipped on frames where nothing changed
+  /// Writes copy whole objects bytewise, so padding is carried along and never causes false changes
+  static_assert(std::is_trivially_copyable_v<T>, "dirty tracking compares object bytes, so T must be trivially copyable");
+
+  T value{};                                                                    // value-initialised, so padding starts zeroed
+  uint64_t version{1};                                                          // bumped on every change
+  uint64_t uploaded_version{0};                                                 // the version last uploaded; differs from version while dirty
+
+public:
+  struct stats_data {
+    unsigned int changes{0};                                                    // writes that changed the value
+    unsigned int uploads{0};                                                    // frames that uploaded the value
+    unsigned int skips{0};                                                      // frames that didn't need to
+  } stats;
+
+  T const &get() const;
+  uint64_t get_version() const;
+
+  bool set(T const &new_value);
+  template<typename F>
+  bool modify(F &&modifier);
+
+  bool is_dirty() const;
+  void mark_uploaded();
+  void mark_skipped();
+  void invalidate();
+};
+
+template<typename T>
+T const &dirty_tracked<T>::get() const {
+  return value;
+}
+
+template<typename T>
+uint64_t dirty_tracked<T>::get_version() const {
+  return version;
+}
+
+template<typename T>
+bool dirty_tracked<T>::set(T const &new_value) {
+  /// Replace the value, returning true and bumping the version if its bytes differ
+  if(std::memcmp(&value, &new_value, sizeof(T)) == 0) return false;
+  std::memcpy(&value, &new_value, sizeof(T));
+  ++version;
+  ++stats.changes;
+  return true;
+}
+
+template<typename T>
+template<typename F>
+bool dirty_tracked<T>::modify(F &&modifier) {
+  /// Apply a modifier function to a copy of the value, then store it if anything changed
+  T modified;
+  std::memcpy(&modified, &value, sizeof(T));                                    // copy bytewise so padding matches too
+  modifier(modified);
+  return set(modified);
+}
+
+template<typename T>
+bool dirty_tracked<T>::is_dirty() const {
+  /// Whether the value has changed since it was last uploaded
+  return version != uploaded_version;
+}
+
+template<typename T>
+void dirty_tracked<T>::mark_uploaded() {
+  /// Record that the current version has been uploaded
+  uploaded_version = version;
+  ++stats.uploads;
+}
+
+template<typename T>
+void dirty_tracked<T>::mark_skipped() {
+  /// Record that a frame reused the previously uploaded version
+  ++stats.skips;
+}
+
+template<typename T>
+void dirty_tracked<T>::invalidate() {
+  /// Force the next frame to upload, for example if the destination buffer was recreated
+  ++version;
+}
+
+}
@@ -0,0 +1,58 @@
+#include "frame_pacer.h"
+#include <algorithm>
+
+namespace render {
+
+void frame_pacer::set_max_frames_in_flight(unsigned int new_max_frames_in_flight) {
+  /// Set how many frames may be in flight at once; lowering it below those already in flight defers frames until they drain
+  max_frames_in_flight = std::clamp(new_max_frames_in_flight, 1u, max_frames_in_flight_limit);
+}
+
+unsigned int frame_pacer::get_max_frames_in_flight() const {
+  return max_frames_in_flight;
+}
+
+unsigned int frame_pacer::get_frames_in_flight() const {
+  return in_flight_count;
+}
+
+bool frame_pacer::can_submit() {
+  /// Call before drawing a frame: whether another may be submitted now, or it should be deferred until earlier ones complete
+  if(in_flight_count < max_frames_in_flight) return true;
+  ++stats.deferred;
+  return false;
+}
+
+uint64_t frame_pacer::submit(clock::time_point input_time, clock::time_point now) {
+  /// Record a frame submitted to the GPU, returning its number to pass to complete() once its work is done
+  /// Only call after can_submit() returned true
+  in_flight[(in_flight_first + in_flight_count) % in_flight.size()] = {
+    .number{next_frame},
+    .input_time{input_time},
+    .submit_time{now},
+  };
+  ++in_flight_count;
+  ++stats.submitted;
+  return next_frame++;
+}
+
+void frame_pacer::complete(uint64_t frame, clock::time_point now) {
+  /// Record that the GPU has finished a frame; as the queue executes in order, any submitted before it are finished too
+  while(in_flight_count != 0 && in_flight[in_flight_first].number <= frame) {
+    auto const &completed{in_flight[in_flight_first]};
+    stats.last_latency_ms = std::chrono::duration<float, std::milli>{now - completed.input_time}.count();
+    stats.max_latency_ms = std::max(stats.max_latency_ms, stats.last_latency_ms);
+    stats.last_gpu_ms = std::chrono::duration<float, std::milli>{now - completed.submit_time}.count();
+    latency_history.push(stats.last_latency_ms);
+    ++stats.completed;
+    in_flight_first = (in_flight_first + 1) % static_cast<unsigned int>(in_flight.size());
+    --in_flight_count;
+  }
+}
+
+timing::summary frame_pacer::get_latency_summary() const {
+  /// Distribution of input to completion latency over recent frames, in milliseconds
+  return latency_history.summarise();
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "timing/sample_ring.h"
+
+namespace render {
+
+class frame_pacer {
+  /// Limits how many submitted frames the GPU may still be working on, and measures their latency, independent of the graphics API
+  /// Each frame is tracked from submission until the GPU reports its work done; with the limit reached, new frames are deferred
+  /// rather than queued behind the others, so the CPU can't run ahead and input is sampled closer to when it's shown.
+  /// Latency is measured from when a frame's input was sampled to when its work completed, the latest point observable before
+  /// the browser presents it
+public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr unsigned int max_frames_in_flight_limit{4};                  // the most that may be allowed; browsers rarely buffer more than three
+  static constexpr unsigned int history_length{120};                            // latency samples kept for the summary
+
+private:
+  struct in_flight_frame {
+    uint64_t number{0};
+    clock::time_point input_time;                                               // when the input the frame shows was sampled
+    clock::time_point submit_time;
+  };
+  std::array<in_flight_frame, max_frames_in_flight_limit> in_flight;            // a ring of frames submitted but not yet completed, oldest first
+  unsigned int in_flight_first{0};
+  unsigned int in_flight_count{0};
+  unsigned int max_frames_in_flight{2};
+  uint64_t next_frame{0};
+
+  timing::sample_ring<history_length> latency_history;                          // input to completion, in milliseconds
+
+public:
+  struct stats_data {
+    uint64_t submitted{0};
+    uint64_t completed{0};
+    uint64_t deferred{0};                                                       // frames not drawn because too many were in flight
+    float last_latency_ms{0.0f};                                                // from sampling input to the GPU completing the frame
+    float max_latency_ms{0.0f};
+    float last_gpu_ms{0.0f};                                                    // from submission to completion
+  } stats;
+
+  void set_max_frames_in_flight(unsigned int new_max_frames_in_flight);
+  unsigned int get_max_frames_in_flight() const;
+  unsigned int get_frames_in_flight() const;
+
+  bool can_submit();
+  uint64_t submit(clock::time_point input_time, clock::time_point now);
+  void complete(uint64_t frame, clock::time_point now);
+
+  timing::summary get_latency_summary() const;
+};
+
+}
@@ -0,0 +1,222 @@
+#include "gpu_profiler.h"
+#include <cstring>
+#include <stdexcept>
+#include <magic_enum/magic_enum.hpp>
+#include "logstorm/manager.h"
+
+namespace render {
+
+gpu_profiler::gpu_profiler(logstorm::manager &this_logger)
+  : logger{this_logger} {
+  /// Construct an inactive profiler; it does nothing until initialised with a device that supports timestamp queries
+}
+
+void gpu_profiler::init(wgpu::Device const &device, std::vector<std::string> &&this_scope_names) {
+  /// Create the query set and buffers, if the device supports timestamp queries
+  scope_names = std::move(this_scope_names);
+  if(scope_names.size() > 64) throw std::runtime_error{"GPU profiler supports at most 64 scopes"}; // one bit each in measured_scopes
+  scope_history = decltype(scope_history)(scope_names.size());                  // sample rings can't be moved, so construct them in place
+  latest_scope_times.assign(scope_names.size(), 0.0f);
+  if(!device.HasFeature(wgpu::FeatureName::TimestampQuery)) {
+    logger << "WebGPU: Timestamp queries unavailable, GPU profiling disabled";
+    return;
+  }
+
+  auto const query_count{static_cast<uint32_t>(scope_names.size() * 2)};
+  timestamps.resize(query_count);
+  timestamps_size = timestamps.size() * sizeof(timestamps[0]);
+
+  wgpu::QuerySetDescriptor query_set_descriptor{
+    .label{"GPU profiler query set"},
+    .type{wgpu::QueryType::Timestamp},
+    .count{query_count},
+  };
+  query_set = device.CreateQuerySet(&query_set_descriptor);
+
+  wgpu::BufferDescriptor resolve_buffer_descriptor{
+    .label{"GPU profiler resolve buffer"},
+    .usage{wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc},
+    .size{timestamps_size},
+  };
+  resolve_buffer = device.CreateBuffer(&resolve_buffer_descriptor);
+
+  wgpu::BufferDescriptor readback_buffer_descriptor{
+    .label{"GPU profiler readback buffer"},
+    .usage{wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst},
+    .size{timestamps_size},
+  };
+  measured_scopes.assign(readback_slots, 0);
+  map_requests.reserve(readback_slots);                                         // callbacks hold pointers into this, so it must never reallocate
+  for(unsigned int slot{0}; slot != readback_slots; ++slot) {
+    readback_buffers.emplace_back(device.CreateBuffer(&readback_buffer_descriptor));
+    map_requests.emplace_back(map_request{*this, slot});
+  }
+
+  for(uint32_t scope{0}; scope != scope_names.size(); ++scope) {
+    timestamp_writes.emplace_back(wgpu::RenderPassTimestampWrites{
+      .querySet{query_set},
+      .beginningOfPassWriteIndex{scope * 2},
+      .endOfPassWriteIndex{scope * 2 + 1},
+    });
+    compute_timestamp_writes.emplace_back(wgpu::ComputePassTimestampWrites{
+      .querySet{query_set},
+      .beginningOfPassWriteIndex{scope * 2},
+      .endOfPassWriteIndex{scope * 2 + 1},
+    });
+    begin_timestamp_writes.emplace_back(wgpu::RenderPassTimestampWrites{
+      .querySet{query_set},
+      .beginningOfPassWriteIndex{scope * 2},
+    });
+    end_timestamp_writes.emplace_back(wgpu::RenderPassTimestampWrites{
+      .querySet{query_set},
+      .endOfPassWriteIndex{scope * 2 + 1},
+    });
+  }
+  logger << "WebGPU: GPU profiler enabled for " << scope_names.size() << " scopes";
+}
+
+bool gpu_profiler::is_enabled() const {
+  return static_cast<bool>(query_set);
+}
+
+void gpu_profiler::begin_frame() {
+  /// Claim a readback slot for the frame about to be encoded; if none is free, this frame goes unmeasured
+  if(!is_enabled()) return;
+  current_slot = ring.acquire();
+  if(current_slot) measured_scopes[*current_slot] = 0;
+}
+
+wgpu::RenderPassTimestampWrites const *gpu_profiler::get_timestamp_writes(unsigned int scope) {
+  /// Return the timestamp writes to attach to a render pass descriptor for this scope, or nullptr if not measuring this frame
+  if(!mark_measured(scope)) return nullptr;
+  return &timestamp_writes.at(scope);
+}
+
+wgpu::RenderPassTimestampWrites const *gpu_profiler::get_timestamp_writes(unsigned int scope, bool begins_scope, bool ends_scope) {
+  /// Return the timestamp writes for one of a run of render passes measured as a single scope, or nullptr if it needs none
+  /// The first pass of the run writes the begin timestamp and the last the end, so a run of one gets both
+  if(!begins_scope && !ends_scope) return nullptr;                              // passes in the middle of the run aren't timed separately
+  if(!mark_measured(scope)) return nullptr;
+  if(begins_scope && ends_scope) return &timestamp_writes.at(scope);
+  return begins_scope ? &begin_timestamp_writes.at(scope) : &end_timestamp_writes.at(scope);
+}
+
+wgpu::ComputePassTimestampWrites const *gpu_profiler::get_compute_timestamp_writes(unsigned int scope) {
+  /// Return the timestamp writes to attach to a compute pass descriptor for this scope, or nullptr if not measuring this frame
+  if(!mark_measured(scope)) return nullptr;
+  return &compute_timestamp_writes.at(scope);
+}
+
+bool gpu_profiler::mark_measured(unsigned int scope) {
+  /// Record that a scope's pass is encoded in this frame, returning whether this frame is being measured at all
+  /// Scopes whose passes aren't encoded in a frame are left out of its results
+  if(!current_slot) return false;
+  measured_scopes[*current_slot] |= uint64_t{1} << scope;
+  return true;
+}
+
+void gpu_profiler::resolve(wgpu::CommandEncoder const &command_encoder) {
+  /// Encode resolving this frame's queries and copying them to the readback slot, after all measured passes have ended
+  if(!current_slot) return;
+  command_encoder.ResolveQuerySet(query_set, 0, static_cast<uint32_t>(timestamps.size()), resolve_buffer, 0); // querySet, firstQuery, queryCount, destination, destinationOffset
+  command_encoder.CopyBufferToBuffer(resolve_buffer, 0, readback_buffers[*current_slot], 0, timestamps_size); // source, sourceOffset, destination, destinationOffset, size
+}
+
+void gpu_profiler::end_frame() {
+  /// Once the frame has been submitted, request mapping of its readback slot
+  if(!current_slot) return;
+  unsigned int const slot{*current_slot};
+  current_slot.reset();
+  ring.submit(slot);
+
+  readback_buffers[slot].MapAsync(
+    wgpu::MapMode::Read,
+    0,                                                                          // offset
+    timestamps_size,                                                            // size
+    [](WGPUBufferMapAsyncStatus status_c, void *data){
+      /// Readback buffer mapped callback
+      auto const &request{*static_cast<map_request*>(data)};
+      auto &profiler{request.profiler};
+      if(auto status{static_cast<wgpu::BufferMapAsyncStatus>(status_c)}; status != wgpu::BufferMapAsyncStatus::Success) {
+        profiler.logger << "ERROR: WebGPU: GPU profiler readback failed, status " << magic_enum::enum_name(status);
+        profiler.ring.release(request.slot);
+        return;
+      }
+      profiler.read_slot(request.slot);
+    },
+    &map_requests[slot]
+  );
+}
+
+void gpu_profiler::read_slot(unsigned int slot) {
+  /// Read timestamps out of a mapped readback slot into the rolling statistics, and return the slot to the ring
+  auto const &buffer{readback_buffers[slot]};
+  void const *mapped{buffer.GetConstMappedRange(0, timestamps_size)};
+  if(mapped) std::memcpy(timestamps.data(), mapped, timestamps_size);
+  buffer.Unmap();
+  ring.release(slot);
+  if(!mapped) return;
+
+  auto to_milliseconds{[](uint64_t begin, uint64_t end){
+    return static_cast<float>(end - begin) * 1.0e-6f;                           // timestamps are in nanoseconds
+  }};
+  std::optional<uint64_t> frame_begin;
+  uint64_t frame_end{0};
+  for(unsigned int scope{0}; scope != scope_names.size(); ++scope) {
+    if(!(measured_scopes[slot] & (uint64_t{1} << scope))) continue;             // this pass didn't run in this frame
+    uint64_t const begin{timestamps[scope * 2]};
+    uint64_t const end{timestamps[scope * 2 + 1]};
+    if(!frame_begin) frame_begin = begin;                                       // scopes are in the order their passes are encoded
+    frame_end = end;
+    if(end < begin) continue;                                                   // implementations may return zero or out of order values for unavailable timestamps
+    latest_scope_times[scope] = to_milliseconds(begin, end);
+    scope_history[scope].push(latest_scope_times[scope]);
+  }
+  ++frames_read;
+  if(frame_begin && *frame_begin <= frame_end) {
+    frame_history.push(to_milliseconds(*frame_begin, frame_end));
+  }
+
+  if(++frames_since_log == log_interval) {
+    frames_since_log = 0;
+    log_summary();
+  }
+}
+
+std::vector<std::string> const &gpu_profiler::get_scope_names() const {
+  return scope_names;
+}
+
+timing::summary gpu_profiler::get_scope_summary(unsigned int scope) const {
+  /// Rolling statistics for one scope's GPU time in milliseconds
+  return scope_history.at(scope).summarise();
+}
+
+timing::summary gpu_profiler::get_frame_summary() const {
+  /// Rolling statistics for the GPU time from the start of the first scope to the end of the last, in milliseconds
+  return frame_history.summarise();
+}
+
+unsigned int gpu_profiler::get_frames_read() const {
+  /// Count of frames whose results have been read back, so callers can tell when a new one has arrived
+  return frames_read;
+}
+
+float gpu_profiler::get_latest_scope_time(unsigned int scope) const {
+  /// One scope's GPU time in milliseconds from the most recent frame read back
+  return latest_scope_times.at(scope);
+}
+
+void gpu_profiler::log_summary() const {
+  /// Report rolling GPU timings for each scope and the whole frame
+  auto log_line{[&](std::string const &name, timing::summary const &summary){
+    logger << "WebGPU: GPU time " << name << ": min " << summary.min << "ms, avg " << summary.avg << "ms, p99 " << summary.p99 << "ms (" << summary.count << " samples)";
+  }};
+  for(unsigned int scope{0}; scope != scope_names.size(); ++scope) {
+    log_line(scope_names[scope], get_scope_summary(scope));
+  }
+  log_line("frame", get_frame_summary());
+  logger << "WebGPU: GPU profiler readbacks: " << ring.stats.acquired << " frames measured, " << ring.stats.skipped << " skipped waiting for a free slot";
+}
+
+}
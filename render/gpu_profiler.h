@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <webgpu/webgpu_cpp.h>
+#include "logstorm/logstorm_forward.h"
+#include "timing/sample_ring.h"
+#include "timing/statistics.h"
+#include "readback_ring.h"
+
+namespace render {
+
+class gpu_profiler {
+  /// Measures GPU time spent in render and compute passes using timestamp queries
+  /// Each scope is a pass, or a run of passes, that gets a begin and end timestamp; results are read back
+  /// asynchronously through a ring of buffers, so the queue is never stalled waiting for them
+  logstorm::manager &logger;
+
+  static constexpr unsigned int readback_slots{4};                              // how many frames of results may be in flight at once
+  static constexpr size_t history_length{256};                                  // how many samples the rolling statistics cover
+  static constexpr unsigned int log_interval{600};                              // how many frames to wait between logging summaries
+
+  std::vector<std::string> scope_names;
+  wgpu::QuerySet query_set;                                                     // two timestamps per scope
+  wgpu::Buffer resolve_buffer;                                                  // destination for resolved queries, in GPU memory
+  std::vector<wgpu::Buffer> readback_buffers;                                   // one per readback slot, mappable for reading
+  size_t timestamps_size{0};                                                    // size in bytes of one frame's resolved timestamps
+  std::vector<uint64_t> timestamps;                                             // scratch space for reading back one frame's timestamps
+
+  readback_ring ring{readback_slots};
+  std::optional<unsigned int> current_slot;                                     // the readback slot the frame being encoded will use, if any
+  std::vector<uint64_t> measured_scopes;                                        // for each readback slot, a bit for each scope measured in its frame, as not every pass runs every frame
+
+  std::vector<wgpu::RenderPassTimestampWrites> timestamp_writes;                // prebuilt for each scope
+  std::vector<wgpu::ComputePassTimestampWrites> compute_timestamp_writes;       // the same, for scopes that are compute passes
+  std::vector<wgpu::RenderPassTimestampWrites> begin_timestamp_writes;          // just the begin timestamp, for the first of several passes in a scope
+  std::vector<wgpu::RenderPassTimestampWrites> end_timestamp_writes;            // just the end timestamp, for the last of them
+
+  struct map_request {                                                          // userdata for each readback slot's map callback
+    gpu_profiler &profiler;
+    unsigned int slot{0};
+  };
+  std::vector<map_request> map_requests;
+
+  std::vector<timing::sample_ring<history_length>> scope_history;               // per-scope durations in milliseconds
+  timing::sample_ring<history_length> frame_history;                            // first begin to last end, in milliseconds
+  std::vector<float> latest_scope_times;                                        // per-scope durations from the most recent frame read back
+  unsigned int frames_read{0};                                                  // how many frames of results have been read back
+  unsigned int frames_since_log{0};
+
+public:
+  gpu_profiler(logstorm::manager &logger);
+
+  void init(wgpu::Device const &device, std::vector<std::string> &&scope_names);
+
+  bool is_enabled() const;
+
+  void begin_frame();
+  wgpu::RenderPassTimestampWrites const *get_timestamp_writes(unsigned int scope);
+  wgpu::RenderPassTimestampWrites const *get_timestamp_writes(unsigned int scope, bool begins_scope, bool ends_scope);
+  wgpu::ComputePassTimestampWrites const *get_compute_timestamp_writes(unsigned int scope);
+  void resolve(wgpu::CommandEncoder const &command_encoder);
+  void end_frame();
+
+  std::vector<std::string> const &get_scope_names() const;
+  timing::summary get_scope_summary(unsigned int scope) const;
+  timing::summary get_frame_summary() const;
+  unsigned int get_frames_read() const;
+  float get_latest_scope_time(unsigned int scope) const;
+
+private:
+  bool mark_measured(unsigned int scope);
+  void read_slot(unsigned int slot);
+  void log_summary() const;
+};
+
+}
@@ -0,0 +1,56 @@
+#include "idle_scheduler.h"
+#include <algorithm>
+
+namespace render {
+
+idle_scheduler::idle_scheduler(unsigned int initial_frames)
+  : frames_pending{initial_frames} {
+  /// Construct a scheduler that draws the given number of frames before it may go idle
+}
+
+void idle_scheduler::request(reason why) {
+  /// Request that upcoming frames be drawn because something visible changed
+  unsigned int frames{1};
+  switch(why) {
+  case reason::uniforms:
+  case reason::shader:
+  case reason::viewport:
+  case reason::progressive:
+  case reason::instances:
+  case reason::benchmark:
+  case reason::feedback:
+    break;
+  case reason::input:
+    frames = input_cooldown_frames;
+    break;
+  }
+  frames_pending = std::max(frames_pending, frames);
+}
+
+void idle_scheduler::set_animate(bool new_animate) {
+  /// Enable or disable drawing every frame regardless of changes
+  animate = new_animate;
+}
+
+bool idle_scheduler::get_animate() const {
+  return animate;
+}
+
+bool idle_scheduler::should_draw() {
+  /// Decide whether this frame should be drawn, consuming one pending frame if so
+  /// Call exactly once per frame, after all of the frame's requests have been made
+  if(animate || frames_pending != 0) {
+    if(frames_pending != 0) --frames_pending;
+    ++stats.drawn;
+    return true;
+  }
+  ++stats.skipped;
+  return false;
+}
+
+bool idle_scheduler::is_idle() const {
+  /// Whether the next frame would be skipped if nothing else is requested
+  return !animate && frames_pending == 0;
+}
+
+}
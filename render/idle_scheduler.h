@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+namespace render {
+
+class idle_scheduler {
+  /// Decides whether each frame needs to be drawn at all, independent of the graphics API
+  /// Redraws are requested when something visible changes; each request keeps drawing for a
+  /// number of frames, and with nothing outstanding (and animation off) frames are skipped
+public:
+  enum class reason : unsigned int {                                            // why a redraw was requested
+    uniforms,                                                                   // uniform data changed
+    shader,                                                                     // a new pipeline was swapped in
+    viewport,                                                                   // the render target was resized or recreated
+    input,                                                                      // GUI input activity, which can take a few frames to settle
+    progressive,                                                                // a progressive render has tiles still to draw
+    instances,                                                                  // the instances or indirect draw arguments changed
+    benchmark,                                                                  // a benchmark needs every frame drawn until it finishes
+    feedback,                                                                   // passes read the previous frame's results, so keep changing
+  };
+
+private:
+  unsigned int frames_pending;                                                  // how many more frames must be drawn before going idle
+  bool animate{false};                                                          // if set, draw every frame regardless, for time-dependent shaders
+
+public:
+  unsigned int input_cooldown_frames{3};                                        // frames to keep drawing after GUI input stops, while ImGui settles
+
+  struct stats_data {
+    uint64_t drawn{0};                                                          // frames that were drawn
+    uint64_t skipped{0};                                                        // frames that were skipped as idle
+  } stats;
+
+  explicit idle_scheduler(unsigned int initial_frames = 1);
+
+  void request(reason why);
+  void set_animate(bool new_animate);
+  bool get_animate() const;
+
+  bool should_draw();
+  bool is_idle() const;
+};
+
+}
@@ -1,11 +1,15 @@
 #pragma once
 
-#include "vectorstorm/matrix/matrix4.h"
+#include "vectorstorm/vector/vector2.h"
 
 namespace render {
 
-struct instance {
-  mat4f model;
+struct instance {                                                               // placement of one copy of the scene quad, for drawing many viewports in one call
+  vec2f position_offset{0.0f, 0.0f};                                            // clip space offset of the quad
+  vec2f position_scale{1.0f, 1.0f};                                             // clip space scale of the quad, applied before the offset
+  vec2f uv_offset{0.0f, 0.0f};                                                  // offset of the part of the scene it shows, added to the shader's input
+  vec2f uv_scale{1.0f, 1.0f};
 };
+static_assert(sizeof(instance) == sizeof(vec2f) * 4);                           // make sure the struct is packed
 
 }
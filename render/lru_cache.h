@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace render {
+
+template<typename Tkey, typename Tvalue, typename Thash = std::hash<Tkey>>
+class lru_cache {
+  /// Fixed-capacity key-value cache which evicts the least recently used entry when full
+  using entry = std::pair<Tkey, Tvalue>;
+
+  std::list<entry> entries;                                                     // most recently used entries are at the front
+  std::unordered_map<Tkey, typename std::list<entry>::iterator, Thash> index;   // lookup into the entries list
+  size_t capacity;
+
+public:
+  struct stats_data {
+    unsigned int hits{0};                                                       // lookups that found an entry
+    unsigned int misses{0};                                                     // lookups that found nothing
+    unsigned int evictions{0};                                                  // entries dropped to make room for new ones
+  } stats;
+
+  explicit lru_cache(size_t capacity);
+
+  Tvalue *find(Tkey const &key);
+  void insert(Tkey const &key, Tvalue value);
+  void clear();
+
+  size_t size() const;
+  size_t get_capacity() const;
+};
+
+template<typename Tkey, typename Tvalue, typename Thash>
+lru_cache<Tkey, Tvalue, Thash>::lru_cache(size_t this_capacity)
+  : capacity{this_capacity} {
+  /// Construct an empty cache holding at most the given number of entries
+  index.reserve(capacity);
+}
+
+template<typename Tkey, typename Tvalue, typename Thash>
+Tvalue *lru_cache<Tkey, Tvalue, Thash>::find(Tkey const &key) {
+  /// Look up an entry, marking it as most recently used; returns nullptr if not present
+  auto const it{index.find(key)};
+  if(it == index.end()) {
+    ++stats.misses;
+    return nullptr;
+  }
+  ++stats.hits;
+  entries.splice(entries.begin(), entries, it->second);                         // move to the front without invalidating iterators
+  return &it->second->second;
+}
+
+template<typename Tkey, typename Tvalue, typename Thash>
+void lru_cache<Tkey, Tvalue, Thash>::insert(Tkey const &key, Tvalue value) {
+  /// Insert or replace an entry as the most recently used, evicting the least recently used if full
+  if(capacity == 0) return;
+  if(auto const it{index.find(key)}; it != index.end()) {
+    it->second->second = std::move(value);
+    entries.splice(entries.begin(), entries, it->second);
+    return;
+  }
+  if(entries.size() == capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+    ++stats.evictions;
+  }
+  entries.emplace_front(key, std::move(value));
+  index.emplace(key, entries.begin());
+}
+
+template<typename Tkey, typename Tvalue, typename Thash>
+void lru_cache<Tkey, Tvalue, Thash>::clear() {
+  /// Drop all entries, leaving the stats intact
+  index.clear();
+  entries.clear();
+}
+
+template<typename Tkey, typename Tvalue, typename Thash>
+size_t lru_cache<Tkey, Tvalue, Thash>::size() const {
+  return entries.size();
+}
+
+template<typename Tkey, typename Tvalue, typename Thash>
+size_t lru_cache<Tkey, Tvalue, Thash>::get_capacity() const {
+  return capacity;
+}
+
+}
@@ -0,0 +1,204 @@
+#include "pass_graph.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace render {
+
+pass_graph pass_graph::parse(std::string_view source) {
+  /// Read the pass directives from a WGSL source's comments; a source without any gives an empty graph
+  /// Throws if a directive is malformed, or reads a texture no pass writes
+  pass_graph graph;
+  std::vector<std::vector<std::string_view>> input_names;                       // resolved once every pass's target is known
+  auto const find_texture{[&](std::string_view name){
+    return static_cast<unsigned int>(std::ranges::find(graph.textures, name, &texture::name) - graph.textures.begin());
+  }};
+
+  unsigned int line_number{0};
+  for(size_t line_start{0}; line_start < source.size(); ++line_number) {
+    auto line_end{source.find('\n', line_start)};
+    if(line_end == std::string_view::npos) line_end = source.size();
+    auto line{source.substr(line_start, line_end - line_start)};
+    line_start = line_end + 1;
+
+    line.remove_prefix(std::min(line.size(), line.find_first_not_of(" \t\r")));
+    if(!line.starts_with("//!")) continue;
+    line.remove_prefix(3);
+    std::vector<std::string_view> words;
+    while(!line.empty()) {
+      auto const word_start{line.find_first_not_of(" \t\r")};
+      if(word_start == std::string_view::npos) break;
+      line.remove_prefix(word_start);
+      auto const word_end{std::min(line.size(), line.find_first_of(" \t\r"))};
+      words.emplace_back(line.substr(0, word_end));
+      line.remove_prefix(word_end);
+    }
+
+    auto const fail{[&](std::string const &message){
+      throw std::runtime_error{"Pass directive on line " + std::to_string(line_number + 1) + ": " + message};
+    }};
+    if(words.empty() || words[0] != "pass") fail("expected \"pass <name> <entry point> writes <texture> [reads <texture>...]\"");
+    if(words.size() < 5 || words[3] != "writes") fail("expected \"writes <texture>\" after the pass name and entry point");
+    if(words.size() != 5 && (words[5] != "reads" || words.size() == 6)) fail("expected \"reads <texture>...\" after the target");
+    if(words.size() > 6 + max_inputs) fail("a pass may read at most " + std::to_string(max_inputs) + " textures");
+    if(std::ranges::find(graph.passes, words[1], &pass::name) != graph.passes.end()) fail("pass \"" + std::string{words[1]} + "\" is declared twice");
+
+    if(find_texture(words[4]) == graph.textures.size()) graph.textures.emplace_back(texture{.name{std::string{words[4]}}});
+    graph.passes.emplace_back(pass{
+      .name{std::string{words[1]}},
+      .entry_point{std::string{words[2]}},
+      .target{find_texture(words[4])},
+      .inputs{},                                                                // resolved once every pass is known
+    });
+    input_names.emplace_back(words.size() > 6 ? std::vector(words.begin() + 6, words.end()) : std::vector<std::string_view>{});
+  }
+  if(graph.passes.empty()) return graph;
+
+  std::vector<bool> persistent(graph.textures.size(), false);                   // whether each texture's contents are needed after the frame
+  std::vector<unsigned int> writer_counts(graph.textures.size(), 0);
+  for(unsigned int index{0}; index != graph.passes.size(); ++index) {
+    auto &this_pass{graph.passes[index]};
+    for(auto const name : input_names[index]) {
+      auto const input{find_texture(name)};
+      if(input == graph.textures.size()) throw std::runtime_error{"Pass \"" + this_pass.name + "\" reads \"" + std::string{name} + "\", which no pass writes"};
+      this_pass.inputs.emplace_back(input);
+      bool const written_earlier{std::ranges::any_of(graph.passes.begin(), graph.passes.begin() + index, [&](pass const &earlier){return earlier.target == input;})};
+      if(written_earlier) continue;
+      graph.feedback = true;                                                    // so it reads what was written in a previous frame
+      persistent[input] = true;
+    }
+    ++writer_counts[this_pass.target];
+    graph.textures[this_pass.target].writer = index;
+  }
+  persistent[graph.get_output()] = true;                                        // displayed every frame, whether or not its pass runs
+
+  for(unsigned int index{0}; index != graph.textures.size(); ++index) {
+    auto &this_texture{graph.textures[index]};
+    this_texture.transient = !persistent[index] && writer_counts[index] == 1;   // with several writers, skipped passes would need what the others wrote
+    graph.compiled.add_texture(render_graph::texture{
+      .name{this_texture.name},
+      .size{this_texture.transient ? 1u : 2u},                                  // in render targets, as persistent textures are pairs
+      .persistent{!this_texture.transient},
+    });
+  }
+  for(auto const &this_pass : graph.passes) {
+    graph.compiled.add_pass(render_graph::pass{
+      .name{this_pass.name},
+      .reads{this_pass.inputs},
+      .writes{this_pass.target},
+    });
+  }
+  graph.compiled.compile();
+  for(unsigned int index{0}; index != graph.textures.size(); ++index) {
+    graph.textures[index].allocation = graph.compiled.get_allocation(index);
+  }
+
+  graph.seen_versions.resize(graph.passes.size());
+  graph.scheduled.reserve(graph.passes.size());
+  graph.running.assign(graph.passes.size(), false);
+  return graph;
+}
+
+bool pass_graph::empty() const {
+  return passes.empty();
+}
+
+std::vector<pass_graph::pass> const &pass_graph::get_passes() const {
+  return passes;
+}
+
+std::vector<pass_graph::texture> const &pass_graph::get_textures() const {
+  return textures;
+}
+
+unsigned int pass_graph::get_output() const {
+  /// The texture to display, written by the last pass
+  return passes.back().target;
+}
+
+std::vector<unsigned int> const &pass_graph::get_order() const {
+  /// The passes that weren't culled, in the order they're encoded
+  return compiled.get_order();
+}
+
+bool pass_graph::is_culled(unsigned int pass_index) const {
+  /// Whether a pass contributes nothing to the displayed texture, so never runs
+  return compiled.is_culled(pass_index);
+}
+
+unsigned int pass_graph::get_allocation_count() const {
+  /// How many pairs or single textures the graph's textures are allocated in
+  return compiled.get_allocation_count();
+}
+
+render_graph::memory_report const &pass_graph::get_memory_report() const {
+  /// Render targets needed with and without transient textures sharing them
+  return compiled.get_memory_report();
+}
+
+bool pass_graph::has_feedback() const {
+  /// Whether any pass reads a previous frame's result, so its output keeps changing every frame
+  return feedback;
+}
+
+void pass_graph::invalidate() {
+  /// Make every pass run on the next schedule, such as when the textures or pipelines are replaced
+  ++epoch;
+}
+
+std::span<pass_graph::scheduled_pass const> pass_graph::schedule(uint64_t uniform_version) {
+  /// Choose which passes to encode this frame, skipping those whose inputs haven't changed since they last ran,
+  /// and flip the pairs each one writes
+  auto const &order{compiled.get_order()};
+  for(auto const index : order) {
+    auto const &this_pass{passes[index]};
+    auto &seen{seen_versions[index]};
+    bool changed{seen.size() != this_pass.inputs.size() + 2 || seen[0] != uniform_version || seen[1] != epoch};
+    for(size_t input{0}; !changed && input != this_pass.inputs.size(); ++input) {
+      changed = seen[input + 2] != textures[this_pass.inputs[input]].version;
+    }
+    running[index] = changed;
+    if(!changed) continue;
+
+    seen.resize(this_pass.inputs.size() + 2);                                   // only allocates the first time the pass runs
+    seen[0] = uniform_version;
+    seen[1] = epoch;
+    for(size_t input{0}; input != this_pass.inputs.size(); ++input) {
+      seen[input + 2] = textures[this_pass.inputs[input]].version;
+    }
+    textures[this_pass.target].version = ++next_version;
+  }
+
+  for(auto it{order.rbegin()}; it != order.rend(); ++it) {                      // last to first, so rerun passes get their own transient inputs rewritten too
+    if(!running[*it]) continue;
+    for(auto const input : passes[*it].inputs) {
+      auto const &read{textures[input]};
+      if(!read.transient || running[read.writer]) continue;
+      running[read.writer] = true;                                              // its output is unchanged, but wasn't kept, so needs drawing again
+      ++stats.passes_rerun;
+    }
+  }
+
+  scheduled.clear();
+  for(auto const index : order) {
+    if(!running[index]) {
+      ++stats.passes_skipped;
+      continue;
+    }
+    auto const &this_pass{passes[index]};
+    scheduled_pass step{.pass{index}};
+    for(size_t input{0}; input != this_pass.inputs.size(); ++input) {
+      step.input_sides |= textures[this_pass.inputs[input]].current << input;
+    }
+    auto &target{textures[this_pass.target]};
+    if(!target.transient) {
+      step.target_side = target.current ^ 1u;
+      target.current = step.target_side;
+    }
+    scheduled.emplace_back(step);
+    ++stats.passes_run;
+  }
+  return scheduled;
+}
+
+}
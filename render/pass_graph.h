@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "render_graph.h"
+
+namespace render {
+
+class pass_graph {
+  /// A chain of fullscreen passes described by directives in a shader's comments, independent of the graphics API
+  /// Each directive is a line of the form "//! pass <name> <fragment entry point> writes <texture> [reads <texture>...]".
+  /// Every texture is a ping-pong pair: a pass writes one side while the other keeps the latest contents, so a pass
+  /// reading a texture that isn't written earlier in the same frame, including its own target, sees the previous frame's.
+  /// Textures only read later in the frame they're written are transient instead: a single texture, which may be shared with
+  /// others whose lifetimes don't overlap, and passes that can't contribute to the displayed texture are culled.
+  /// Passes whose inputs haven't changed since they last ran are skipped, keeping their previous result, unless a pass that
+  /// runs reads a transient texture they write, as its contents aren't kept
+public:
+  static constexpr unsigned int max_inputs{8};                                  // textures each pass may read, well within the sampled texture limit
+
+  struct pass {
+    std::string name;
+    std::string entry_point;                                                    // the fragment entry point it draws with
+    unsigned int target{0};                                                     // index of the texture it writes
+    std::vector<unsigned int> inputs;                                           // indices of the textures it reads, in binding order
+  };
+
+  struct texture {
+    std::string name;
+    bool transient{false};                                                      // whether it's a single texture, only needed within the frame, rather than a pair
+    unsigned int allocation{render_graph::no_allocation};                       // the pair or single texture it uses, shared with other transient textures
+    unsigned int writer{0};                                                     // the pass writing it, for transient textures
+    unsigned int current{0};                                                    // which side of the pair holds the latest contents
+    uint64_t version{0};                                                        // changes whenever a pass writes it
+  };
+
+  struct scheduled_pass {                                                       // a pass to encode this frame, with the sides of the pairs it uses
+    unsigned int pass{0};
+    uint32_t input_sides{0};                                                    // bit n set if input n reads the second side of its pair
+    unsigned int target_side{0};                                                // the side of the target pair it writes, always the first for transient textures
+  };
+
+private:
+  std::vector<pass> passes;                                                     // in the order they're encoded each frame
+  std::vector<texture> textures;
+  render_graph compiled;                                                        // the order, culling and texture allocations
+  std::vector<std::vector<uint64_t>> seen_versions;                             // for each pass, the versions of everything it depends on when it last ran
+  std::vector<scheduled_pass> scheduled;                                        // this frame's passes, kept to reuse its storage
+  std::vector<bool> running;                                                    // for each pass, whether it runs this frame
+  uint64_t epoch{0};                                                            // changes whenever every pass must run again
+  uint64_t next_version{0};
+  bool feedback{false};                                                         // whether any pass reads a previous frame's result
+
+public:
+  struct stats_data {
+    uint64_t passes_run{0};
+    uint64_t passes_skipped{0};                                                 // passes whose inputs hadn't changed
+    uint64_t passes_rerun{0};                                                   // passes run only to rewrite a transient texture a changed pass reads
+  } stats;
+
+  static pass_graph parse(std::string_view source);
+
+  bool empty() const;
+  std::vector<pass> const &get_passes() const;
+  std::vector<texture> const &get_textures() const;
+  unsigned int get_output() const;
+  std::vector<unsigned int> const &get_order() const;
+  bool is_culled(unsigned int pass_index) const;
+  unsigned int get_allocation_count() const;
+  render_graph::memory_report const &get_memory_report() const;
+  bool has_feedback() const;
+
+  void invalidate();
+  std::span<scheduled_pass const> schedule(uint64_t uniform_version);
+};
+
+}
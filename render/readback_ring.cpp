@@ -0,0 +1,45 @@
+#include "readback_ring.h"
+#include <cassert>
+
+namespace render {
+
+readback_ring::readback_ring(unsigned int slot_count)
+  : slots(slot_count, slot_state::free) {
+  /// Construct a ring with the given number of slots, all free
+}
+
+std::optional<unsigned int> readback_ring::acquire() {
+  /// Claim the next free slot for encoding a copy into, if there is one
+  for(unsigned int i{0}; i != size(); ++i) {
+    unsigned int const slot{(next + i) % size()};
+    if(slots[slot] != slot_state::free) continue;
+    slots[slot] = slot_state::encoded;
+    next = (slot + 1) % size();
+    ++stats.acquired;
+    return slot;
+  }
+  ++stats.skipped;
+  return std::nullopt;
+}
+
+void readback_ring::submit(unsigned int slot) {
+  /// Mark an encoded slot as submitted, with its mapping now pending
+  assert(slots.at(slot) == slot_state::encoded);
+  slots.at(slot) = slot_state::mapping;
+}
+
+void readback_ring::release(unsigned int slot) {
+  /// Return a slot to the free pool once its contents have been read, or its copy abandoned
+  assert(slots.at(slot) != slot_state::free);
+  slots.at(slot) = slot_state::free;
+}
+
+readback_ring::slot_state readback_ring::get_state(unsigned int slot) const {
+  return slots.at(slot);
+}
+
+unsigned int readback_ring::size() const {
+  return static_cast<unsigned int>(slots.size());
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+namespace render {
+
+class readback_ring {
+  /// Bookkeeping for a ring of GPU readback or upload staging buffers, independent of the graphics API
+  /// Each slot cycles free -> encoded -> mapping -> free; when no slot is free the
+  /// caller skips the readback for that frame rather than waiting on the GPU
+public:
+  enum class slot_state {
+    free,                                                                       // available to receive a copy
+    encoded,                                                                    // a copy into this slot has been encoded but not yet submitted
+    mapping,                                                                    // submitted, waiting for the buffer to be mapped for reading
+  };
+
+private:
+  std::vector<slot_state> slots;
+  unsigned int next{0};                                                         // where to start looking for a free slot, for round-robin use
+
+public:
+  struct stats_data {
+    unsigned int acquired{0};                                                   // frames that got a slot
+    unsigned int skipped{0};                                                    // frames that found every slot busy
+  } stats;
+
+  explicit readback_ring(unsigned int slot_count);
+
+  std::optional<unsigned int> acquire();
+  void submit(unsigned int slot);
+  void release(unsigned int slot);
+
+  slot_state get_state(unsigned int slot) const;
+  unsigned int size() const;
+};
+
+}
@@ -0,0 +1,184 @@
+#include "render_graph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace render {
+
+unsigned int render_graph::add_texture(texture &&new_texture) {
+  /// Declare a texture, returning its index for passes to refer to
+  textures.emplace_back(std::move(new_texture));
+  return static_cast<unsigned int>(textures.size() - 1);
+}
+
+unsigned int render_graph::add_pass(pass &&new_pass) {
+  /// Declare a pass, returning its index; passes may be added in any order, as long as their dependencies don't form a cycle
+  passes.emplace_back(std::move(new_pass));
+  return static_cast<unsigned int>(passes.size() - 1);
+}
+
+void render_graph::compile() {
+  /// Order the passes, cull those that don't contribute to a persistent texture, and assign textures to allocations
+  /// Throws if the dependencies form a cycle, or a transient texture isn't written by exactly one pass before it's read
+  auto const pass_count{static_cast<unsigned int>(passes.size())};
+  auto const texture_count{static_cast<unsigned int>(textures.size())};
+
+  std::vector<std::vector<unsigned int>> writers(texture_count);                // in the order the passes were added
+  for(unsigned int index{0}; index != pass_count; ++index) {
+    for(auto const written : passes[index].writes) writers[written].emplace_back(index);
+  }
+  for(unsigned int index{0}; index != texture_count; ++index) {
+    if(!textures[index].persistent && writers[index].size() > 1) throw std::runtime_error{"Transient texture \"" + textures[index].name + "\" is written by more than one pass"};
+  }
+
+  std::vector<std::vector<unsigned int>> dependents(pass_count);
+  std::vector<unsigned int> dependency_counts(pass_count, 0);
+  auto const add_dependency{[&](unsigned int from, unsigned int to){
+    if(from == to) return;                                                      // a pass may read what it writes, if it's persistent
+    dependents[from].emplace_back(to);
+    ++dependency_counts[to];
+  }};
+  for(unsigned int index{0}; index != pass_count; ++index) {
+    for(auto const read : passes[index].reads) {
+      if(writers[read].empty() && !textures[read].persistent) throw std::runtime_error{"Pass \"" + passes[index].name + "\" reads transient texture \"" + textures[read].name + "\", which no pass writes"};
+      for(auto const writer : writers[read]) {
+        if(textures[read].persistent && writer > index) {
+          add_dependency(index, writer);                                        // it reads what was there before that pass writes it, such as the previous frame's, so must run first
+          continue;
+        }
+        add_dependency(writer, index);
+      }
+    }
+  }
+  for(auto const &texture_writers : writers) {
+    for(size_t writer{1}; writer < texture_writers.size(); ++writer) {
+      add_dependency(texture_writers[writer - 1], texture_writers[writer]);     // later writers of a persistent texture overwrite earlier ones
+    }
+  }
+
+  culled.assign(pass_count, true);
+  std::vector<unsigned int> pending;                                            // passes found to be needed, whose own dependencies haven't been visited yet
+  for(unsigned int index{0}; index != pass_count; ++index) {
+    if(std::ranges::any_of(passes[index].writes, [&](unsigned int written){return textures[written].persistent;})) {
+      culled[index] = false;
+      pending.emplace_back(index);
+    }
+  }
+  while(!pending.empty()) {
+    unsigned int const index{pending.back()};
+    pending.pop_back();
+    for(auto const read : passes[index].reads) {
+      for(auto const writer : writers[read]) {
+        if(!culled[writer]) continue;
+        culled[writer] = false;
+        pending.emplace_back(writer);
+      }
+    }
+  }
+
+  order.clear();
+  std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<>> ready; // the earliest added first, so independent passes keep the order they were added in
+  for(unsigned int index{0}; index != pass_count; ++index) {
+    if(dependency_counts[index] == 0) ready.emplace(index);
+  }
+  unsigned int visited{0};
+  while(!ready.empty()) {
+    unsigned int const index{ready.top()};
+    ready.pop();
+    ++visited;
+    if(!culled[index]) order.emplace_back(index);
+    for(auto const dependent : dependents[index]) {
+      if(--dependency_counts[dependent] == 0) ready.emplace(dependent);
+    }
+  }
+  if(visited != pass_count) {
+    auto const stuck{static_cast<size_t>(std::ranges::find_if(dependency_counts, [](unsigned int count){return count != 0;}) - dependency_counts.begin())};
+    throw std::runtime_error{"Render graph passes depend on each other in a cycle, including \"" + passes[stuck].name + "\""};
+  }
+
+  constexpr unsigned int unused{std::numeric_limits<unsigned int>::max()};
+  std::vector<unsigned int> first_uses(texture_count, unused);                  // positions in the order of the first and last passes using each texture
+  std::vector<unsigned int> last_uses(texture_count, 0);
+  for(unsigned int position{0}; position != order.size(); ++position) {
+    auto const &this_pass{passes[order[position]]};
+    for(auto const &used_textures : {std::cref(this_pass.reads), std::cref(this_pass.writes)}) {
+      for(auto const used : used_textures.get()) {
+        first_uses[used] = std::min(first_uses[used], position);
+        last_uses[used] = std::max(last_uses[used], position);
+      }
+    }
+  }
+
+  texture_allocations.assign(texture_count, no_allocation);
+  allocation_sizes.clear();
+  std::vector<uint64_t> allocation_compatibilities;
+  std::vector<unsigned int> allocation_free_after;                              // position of the last pass using each allocation, after which it may be reused
+  report = {};
+  auto const allocate{[&](unsigned int index, unsigned int free_after){
+    texture_allocations[index] = static_cast<unsigned int>(allocation_sizes.size());
+    allocation_sizes.emplace_back(textures[index].size);
+    allocation_compatibilities.emplace_back(textures[index].compatibility);
+    allocation_free_after.emplace_back(free_after);
+  }};
+
+  std::vector<unsigned int> by_first_use(texture_count);
+  std::iota(by_first_use.begin(), by_first_use.end(), 0u);
+  std::ranges::stable_sort(by_first_use, {}, [&](unsigned int index){return first_uses[index];});
+  for(auto const index : by_first_use) {
+    if(first_uses[index] == unused) continue;                                   // only used by culled passes, if at all
+    auto const &this_texture{textures[index]};
+    ++report.textures;
+    report.without_aliasing += this_texture.size;
+    if(this_texture.persistent) {
+      allocate(index, unused);                                                  // never free for another texture
+      continue;
+    }
+
+    auto const mismatch{[&](unsigned int allocation){                           // space wasted if it's big enough, otherwise growth needed, which is worse
+      uint64_t const size{allocation_sizes[allocation]};
+      return size >= this_texture.size ? std::pair{0u, size - this_texture.size} : std::pair{1u, this_texture.size - size};
+    }};
+    unsigned int best{no_allocation};
+    for(unsigned int allocation{0}; allocation != allocation_sizes.size(); ++allocation) {
+      if(allocation_compatibilities[allocation] != this_texture.compatibility || allocation_free_after[allocation] >= first_uses[index]) continue;
+      if(best == no_allocation || mismatch(allocation) < mismatch(best)) best = allocation;
+    }
+    if(best == no_allocation) {
+      allocate(index, last_uses[index]);
+      continue;
+    }
+    texture_allocations[index] = best;
+    allocation_sizes[best] = std::max(allocation_sizes[best], this_texture.size);
+    allocation_free_after[best] = last_uses[index];
+  }
+  report.allocations = static_cast<unsigned int>(allocation_sizes.size());
+  report.with_aliasing = std::accumulate(allocation_sizes.begin(), allocation_sizes.end(), uint64_t{0});
+}
+
+std::vector<unsigned int> const &render_graph::get_order() const {
+  return order;
+}
+
+bool render_graph::is_culled(unsigned int pass_index) const {
+  return culled.at(pass_index);
+}
+
+unsigned int render_graph::get_allocation(unsigned int texture_index) const {
+  /// Which allocation a texture uses, shared with any transient textures it's aliased with, or no_allocation if it's unused
+  return texture_allocations.at(texture_index);
+}
+
+unsigned int render_graph::get_allocation_count() const {
+  return static_cast<unsigned int>(allocation_sizes.size());
+}
+
+render_graph::memory_report const &render_graph::get_memory_report() const {
+  /// How much memory aliasing saves, in the units of the textures' sizes
+  return report;
+}
+
+}
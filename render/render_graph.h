@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace render {
+
+class render_graph {
+  /// Compiles a frame's passes, and the textures they read and write, into an order to encode them in, independent of the graphics API
+  /// Passes are ordered so each texture is written before it's read, and passes contributing to no persistent texture are culled.
+  /// Persistent textures, such as one shown on screen or read again next frame, get an allocation each; transient ones, written
+  /// and read within the frame, share allocations with compatible transient textures whose lifetimes don't overlap
+public:
+  static constexpr unsigned int no_allocation{~0u};                             // for textures only used by culled passes
+
+  struct texture {
+    std::string name;
+    uint64_t size{0};                                                           // memory it needs, in whatever unit the caller counts
+    uint64_t compatibility{0};                                                  // only textures with the same value, such as size and format, may share an allocation
+    bool persistent{false};                                                     // whether its contents must outlive the frame
+  };
+
+  struct pass {
+    std::string name;
+    std::vector<unsigned int> reads;                                            // persistent textures are read as written by passes added before this one, and before those added after write them
+    std::vector<unsigned int> writes;
+  };
+
+  struct memory_report {
+    unsigned int textures{0};                                                   // textures used by passes that weren't culled
+    unsigned int allocations{0};
+    uint64_t without_aliasing{0};                                               // memory if every texture had an allocation of its own
+    uint64_t with_aliasing{0};
+  };
+
+private:
+  std::vector<texture> textures;
+  std::vector<pass> passes;
+
+  std::vector<unsigned int> order;                                              // passes that weren't culled, in the order to encode them
+  std::vector<bool> culled;
+  std::vector<unsigned int> texture_allocations;                                // for each texture, the allocation it uses
+  std::vector<uint64_t> allocation_sizes;
+  memory_report report;
+
+public:
+  unsigned int add_texture(texture &&new_texture);
+  unsigned int add_pass(pass &&new_pass);
+
+  void compile();
+
+  std::vector<unsigned int> const &get_order() const;
+  bool is_culled(unsigned int pass_index) const;
+  unsigned int get_allocation(unsigned int texture_index) const;
+  unsigned int get_allocation_count() const;
+  memory_report const &get_memory_report() const;
+};
+
+}
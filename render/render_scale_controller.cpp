@@ -0,0 +1,41 @@
+#include "render_scale_controller.h"
+#include <algorithm>
+#include <cmath>
+#include "timing/statistics.h"
+
+namespace render {
+
+bool render_scale_controller::add_sample(float frame_ms) {
+  /// Record one frame's time at the current scale, returning true if the scale was changed as a result
+  samples[sample_count] = frame_ms;
+  if(++sample_count != window_size) return false;
+  sample_count = 0;
+
+  std::ranges::sort(samples);
+  float const median{timing::percentile(samples, 0.5f)};
+  if(median <= 0.0f) return false;                                              // no meaningful measurement
+  if(std::abs(median - target_ms) <= target_ms * tolerance) return false;       // close enough to the target
+
+  float const ideal_scale{scale * std::sqrt(target_ms / median)};               // the scale whose pixel count would hit the target
+  float const new_scale{std::clamp(std::clamp(ideal_scale, scale - max_step, scale + max_step), min_scale, max_scale)};
+  if(std::abs(new_scale - scale) < 0.01f) return false;                         // already at a limit, or too small a change to be worth reallocating for
+  if(new_scale > scale) {
+    ++stats.increases;
+  } else {
+    ++stats.decreases;
+  }
+  scale = new_scale;
+  return true;
+}
+
+float render_scale_controller::get_scale() const {
+  return scale;
+}
+
+void render_scale_controller::set_scale(float new_scale) {
+  /// Set the scale directly, for example when switching from manual to automatic, and restart measurement
+  scale = std::clamp(new_scale, min_scale, max_scale);
+  sample_count = 0;
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+
+namespace render {
+
+class render_scale_controller {
+  /// Chooses a render scale to hold a target frame time, independent of the graphics API
+  /// Cost is assumed to be proportional to pixel count, i.e. to the square of the scale; the
+  /// median of a window of samples is compared to the target, and the scale only moves when
+  /// that falls outside a tolerance band, so it doesn't oscillate around the target
+public:
+  static constexpr unsigned int window_size{15};                                // samples per adjustment; the median tolerates a few stale ones from before a change
+
+  float min_scale{0.25f};
+  float max_scale{1.0f};
+  float target_ms{8.0f};                                                        // frame time to aim for
+  float tolerance{0.1f};                                                        // fraction either side of the target within which the scale is left alone
+  float max_step{0.1f};                                                         // largest change in scale per adjustment
+
+private:
+  float scale{1.0f};
+  std::array<float, window_size> samples{};
+  unsigned int sample_count{0};
+
+public:
+  struct stats_data {
+    unsigned int increases{0};
+    unsigned int decreases{0};
+  } stats;
+
+  bool add_sample(float frame_ms);
+
+  float get_scale() const;
+  void set_scale(float new_scale);
+};
+
+}
@@ -0,0 +1,54 @@
+#include "resize_manager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace render {
+
+void resize_manager::observe(vec2f const &new_css_size, float new_device_pixel_ratio, clock::time_point now) {
+  /// Record the current size of the render target in CSS pixels and the device pixel ratio, which may be unchanged
+  css_size = new_css_size;
+  device_pixel_ratio = new_device_pixel_ratio;
+  if(get_target_size() == surface_size) {
+    change_time.reset();                                                        // resized back before we got round to applying it
+    return;
+  }
+  if(change_time) return;                                                       // already pending, so this change will be coalesced
+  change_time = now;
+  ++stats.changes;
+}
+
+bool resize_manager::apply(clock::time_point now) {
+  /// Call once per frame: if the size has changed, update the surface size and return true to request a reconfigure
+  if(!change_time) return false;
+  surface_size = get_target_size();
+  stats.last_latency_ms = std::chrono::duration<float, std::milli>{now - *change_time}.count();
+  stats.max_latency_ms = std::max(stats.max_latency_ms, stats.last_latency_ms);
+  ++stats.reconfigures;
+  change_time.reset();
+  return true;
+}
+
+vec2ui resize_manager::get_target_size() const {
+  /// The size in device pixels the surface should be, given the latest observations
+  float const pixel_ratio{get_effective_pixel_ratio()};
+  auto to_device_pixels{[&](float css_dimension){
+    return std::clamp(static_cast<unsigned int>(std::round(css_dimension * pixel_ratio)), 1u, max_dimension);
+  }};
+  return {to_device_pixels(css_size.x), to_device_pixels(css_size.y)};
+}
+
+vec2ui const &resize_manager::get_surface_size() const {
+  return surface_size;
+}
+
+float resize_manager::get_device_pixel_ratio() const {
+  return device_pixel_ratio;
+}
+
+float resize_manager::get_effective_pixel_ratio() const {
+  /// The device pixel ratio after applying any cap
+  if(max_device_pixel_ratio <= 0.0f) return device_pixel_ratio;
+  return std::min(device_pixel_ratio, max_device_pixel_ratio);
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include "vectorstorm/vector/vector2.h"
+
+namespace render {
+
+class resize_manager {
+  /// Decides when, and to what size, the render surface should be reconfigured, independent of the graphics API
+  /// Size changes can be observed any number of times per frame but are applied at most once per frame, so a
+  /// burst of resize events costs a single reconfigure; the surface is sized in device pixels, with the device
+  /// pixel ratio optionally capped, and clamped to the largest texture the device supports
+public:
+  using clock = std::chrono::steady_clock;
+
+  float max_device_pixel_ratio{0.0f};                                           // cap on the device pixel ratio used for sizing, or zero for no cap
+  unsigned int max_dimension{8192};                                             // largest surface dimension, normally maxTextureDimension2D
+
+private:
+  vec2f css_size;                                                               // most recently observed size in CSS pixels
+  float device_pixel_ratio{1.0f};                                               // most recently observed device pixels per CSS pixel
+  vec2ui surface_size;                                                          // size in device pixels most recently applied
+  std::optional<clock::time_point> change_time;                                 // when the earliest change not yet applied was observed
+
+public:
+  struct stats_data {
+    unsigned int changes{0};                                                    // observations that changed the target size
+    unsigned int reconfigures{0};                                               // changes actually applied; the rest were coalesced
+    float last_latency_ms{0.0f};                                                // from first observing a change to applying it
+    float max_latency_ms{0.0f};
+  } stats;
+
+  void observe(vec2f const &css_size, float device_pixel_ratio, clock::time_point now);
+  bool apply(clock::time_point now);
+
+  vec2ui get_target_size() const;
+  vec2ui const &get_surface_size() const;
+  float get_device_pixel_ratio() const;
+  float get_effective_pixel_ratio() const;
+};
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+template<typename Tkey, typename Tresource, typename Thash = std::hash<Tkey>>
+class resource_pool {
+  /// Keeps released resources for reuse by later requests with the same key, rather than creating new ones,
+  /// independent of the graphics API
+  /// Resources left unused for max_idle_frames are dropped, so sizes that stop being requested don't hold memory
+  struct entry {
+    Tresource resource;
+    uint64_t released_frame{0};                                                 // when it was returned to the pool
+  };
+
+  std::unordered_map<Tkey, std::vector<entry>, Thash> available;                // released resources, most recently released last
+  uint64_t frame{0};
+
+public:
+  unsigned int max_idle_frames{120};                                            // how long a released resource is kept for reuse
+
+  struct stats_data {
+    unsigned int created{0};                                                    // requests that found nothing to reuse
+    unsigned int reused{0};
+    unsigned int dropped{0};                                                    // resources released for too long, and let go
+  } stats;
+
+  template<typename Tcreate>
+  Tresource acquire(Tkey const &key, Tcreate &&create);
+  void release(Tkey const &key, Tresource &&resource);
+  void end_frame();
+
+  size_t size() const;
+};
+
+template<typename Tkey, typename Tresource, typename Thash>
+template<typename Tcreate>
+Tresource resource_pool<Tkey, Tresource, Thash>::acquire(Tkey const &key, Tcreate &&create) {
+  /// Take a released resource matching the key if there is one, otherwise make a new one with create(key)
+  if(auto const it{available.find(key)}; it != available.end() && !it->second.empty()) {
+    Tresource resource{std::move(it->second.back().resource)};                  // the most recently released, so the oldest are left to expire
+    it->second.pop_back();
+    ++stats.reused;
+    return resource;
+  }
+  ++stats.created;
+  return create(key);
+}
+
+template<typename Tkey, typename Tresource, typename Thash>
+void resource_pool<Tkey, Tresource, Thash>::release(Tkey const &key, Tresource &&resource) {
+  /// Return a resource to the pool, for reuse by a later request with the same key
+  available[key].emplace_back(entry{.resource{std::move(resource)}, .released_frame{frame}});
+}
+
+template<typename Tkey, typename Tresource, typename Thash>
+void resource_pool<Tkey, Tresource, Thash>::end_frame() {
+  /// Advance the frame count, dropping resources that have been released for too long
+  ++frame;
+  for(auto it{available.begin()}; it != available.end();) {
+    auto &entries{it->second};
+    auto const expired{std::erase_if(entries, [&](entry const &candidate){return frame - candidate.released_frame > max_idle_frames;})};
+    stats.dropped += static_cast<unsigned int>(expired);
+    it = entries.empty() ? available.erase(it) : std::next(it);
+  }
+}
+
+template<typename Tkey, typename Tresource, typename Thash>
+size_t resource_pool<Tkey, Tresource, Thash>::size() const {
+  /// Count of released resources waiting to be reused
+  size_t count{0};
+  for(auto const &[key, entries] : available) count += entries.size();
+  return count;
+}
+
+}
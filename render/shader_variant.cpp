@@ -0,0 +1,26 @@
+#include "shader_variant.h"
+#include <algorithm>
+
+namespace render {
+
+void shader_variant::set(std::string_view name, double value) {
+  /// Set an override constant's value, replacing any previous value
+  auto const it{std::ranges::lower_bound(constants, name, {}, &constant::name)};
+  if(it != constants.end() && it->name == name) {
+    it->value = value;
+  } else {
+    constants.emplace(it, constant{.name{std::string{name}}, .value{value}});
+  }
+}
+
+void shader_variant::reset(std::string_view name) {
+  /// Leave an override constant at the shader's own default
+  auto const it{std::ranges::lower_bound(constants, name, {}, &constant::name)};
+  if(it != constants.end() && it->name == name) constants.erase(it);
+}
+
+std::span<shader_variant::constant const> shader_variant::get_constants() const {
+  return constants;
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace render {
+
+template<typename T>
+struct shader_parameter {                                                       // a typed name for one of a shader's override constants
+  std::string_view name;
+};
+
+class shader_variant {
+  /// Values for a shader's override constants, specialising a pipeline without changing the shader's source,
+  /// independent of the graphics API
+  /// Constants are kept sorted by name, so variants setting the same values compare and hash the same
+public:
+  struct constant {
+    std::string name;
+    double value{0.0};                                                          // pipelines take every override as a double, whatever its type
+
+    bool operator==(constant const&) const = default;
+  };
+
+private:
+  std::vector<constant> constants;
+
+public:
+  template<typename T>
+  void set(shader_parameter<T> parameter, std::type_identity_t<T> value) {
+    set(parameter.name, static_cast<double>(value));
+  }
+  void set(std::string_view name, double value);
+  void reset(std::string_view name);
+
+  std::span<constant const> get_constants() const;
+
+  bool operator==(shader_variant const&) const = default;
+};
+
+}
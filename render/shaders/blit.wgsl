@@ -0,0 +1,24 @@
+// Upscale the offscreen scene texture to fill the viewport
+
+struct blit_vertex_output {
+  @builtin(position) position: vec4f,
+  @location(0) uv: vec2f,
+};
+
+@group(0) @binding(0) var scene_sampler: sampler;
+@group(0) @binding(1) var scene_texture: texture_2d<f32>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) vertex_index: u32) -> blit_vertex_output {
+  // a single triangle covering the whole viewport, with uv running from 0 to 1 across the visible part
+  let uv = vec2f(f32((vertex_index << 1u) & 2u), f32(vertex_index & 2u));
+  var output: blit_vertex_output;
+  output.position = vec4f(uv * vec2f(2.0, -2.0) + vec2f(-1.0, 1.0), 0.0, 1.0);
+  output.uv = uv;
+  return output;
+}
+
+@fragment
+fn fs_main(input: blit_vertex_output) -> @location(0) vec4f {
+  return textureSample(scene_texture, scene_sampler, input.uv);
+}
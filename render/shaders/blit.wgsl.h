@@ -0,0 +1,103 @@
+#pragma once
+
+// This file is automatically generated from render/shaders/blit.wgsl by resource_compiler
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "wgsl/reflection.h"
+
+namespace render::shaders {
+
+inline constexpr char const *blit_wgsl{R"bbe6ea92cf75ff4f(struct d{@builtin(position)position:vec4f,@location(0)c:vec2f}
+@group(0)@binding(0)var f:sampler;
+@group(0)@binding(1)var h:texture_2d<f32>;
+@vertex fn vs_main(@builtin(vertex_index)vertex_index:u32)->d{let c=vec2f(f32((vertex_index<<1u)&2u),f32(vertex_index&2u));var e:d;e.position=vec4f(c*vec2f(2.,-2.)+vec2f(-1.,1.),0.,1.);e.c=c;return e;}
+@fragment fn fs_main(i:d)->@location(0)vec4f{return textureSample(h,f,i.c);}
+)bbe6ea92cf75ff4f"};
+inline constexpr size_t blit_wgsl_size{420};
+inline constexpr uint64_t blit_wgsl_hash{0xbbe6ea92cf75ff4full};
+inline constexpr char const *blit_wgsl_source{R"52682cee8037e5a4(// Upscale the offscreen scene texture to fill the viewport
+
+struct blit_vertex_output {
+  @builtin(position) position: vec4f,
+  @location(0) uv: vec2f,
+};
+
+@group(0) @binding(0) var scene_sampler: sampler;
+@group(0) @binding(1) var scene_texture: texture_2d<f32>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) vertex_index: u32) -> blit_vertex_output {
+  // a single triangle covering the whole viewport, with uv running from 0 to 1 across the visible part
+  let uv = vec2f(f32((vertex_index << 1u) & 2u), f32(vertex_index & 2u));
+  var output: blit_vertex_output;
+  output.position = vec4f(uv * vec2f(2.0, -2.0) + vec2f(-1.0, 1.0), 0.0, 1.0);
+  output.uv = uv;
+  return output;
+}
+
+@fragment
+fn fs_main(input: blit_vertex_output) -> @location(0) vec4f {
+  return textureSample(scene_texture, scene_sampler, input.uv);
+}
+)52682cee8037e5a4"};
+inline constexpr size_t blit_wgsl_source_size{818};
+inline constexpr uint64_t blit_wgsl_source_hash{0x52682cee8037e5a4ull};
+
+namespace blit_wgsl_reflection {
+
+inline constexpr std::array<wgsl::reflection::member, 2> blit_vertex_output_members{{
+  {.name{"position"}, .offset{0}, .size{16}, .alignment{16}},
+  {.name{"uv"}, .offset{16}, .size{8}, .alignment{8}},
+}};
+inline constexpr std::array<wgsl::reflection::struct_layout, 1> structs{{
+  {.name{"blit_vertex_output"}, .size{32}, .alignment{16}, .members{blit_vertex_output_members}},
+}};
+
+inline constexpr std::array<wgsl::reflection::resource_binding, 2> bindings{{
+  {
+    .group{0},
+    .binding{0},
+    .name{"scene_sampler"},
+    .type{wgsl::reflection::binding_types::sampler},
+    .visibility{wgsl::reflection::visible_in_fragment},
+    .min_binding_size{0},
+    .type_name{"sampler"},
+    .sample_type{wgsl::reflection::sample_types::none},
+    .dimension{wgsl::reflection::texture_dimensions::none},
+    .multisampled{false},
+    .texel_format{""},
+    .access{""},
+  },
+  {
+    .group{0},
+    .binding{1},
+    .name{"scene_texture"},
+    .type{wgsl::reflection::binding_types::texture},
+    .visibility{wgsl::reflection::visible_in_fragment},
+    .min_binding_size{0},
+    .type_name{"texture_2d"},
+    .sample_type{wgsl::reflection::sample_types::floating},
+    .dimension{wgsl::reflection::texture_dimensions::d2},
+    .multisampled{false},
+    .texel_format{""},
+    .access{""},
+  },
+}};
+
+inline constexpr std::array<wgsl::reflection::override_constant, 0> overrides{{
+}};
+
+inline constexpr std::array<wgsl::reflection::vertex_input, 0> vs_main_inputs{{
+}};
+inline constexpr std::array<wgsl::reflection::vertex_input, 0> fs_main_inputs{{
+}};
+inline constexpr std::array<wgsl::reflection::entry_point, 2> entry_points{{
+  {.name{"vs_main"}, .stage{wgsl::reflection::stages::vertex}, .inputs{vs_main_inputs}},
+  {.name{"fs_main"}, .stage{wgsl::reflection::stages::fragment}, .inputs{fs_main_inputs}},
+}};
+
+} // namespace blit_wgsl_reflection
+
+} // namespace render::shaders
@@ -1,11 +1,20 @@
 alias silver_dream=mat3x3f; alias golden_light=vec4f; alias misty_horizon=vec2f;
 alias radiant_glow=vec3f; alias fleeting_time=f32; alias eternal_whisper=u32;
+alias winding_road=vec2u; alias boundless_sky=vec3u;
 
 struct soft_breeze {
   @location(0) twilight_sky: misty_horizon,
   @location(1) moonlit_path: misty_horizon,
 };
 
+// per instance: where its quad is drawn, and which part of the scene it shows
+struct wandering_cloud {
+  @location(2) distant_shore: misty_horizon,
+  @location(3) open_sky: misty_horizon,
+  @location(4) hidden_path: misty_horizon,
+  @location(5) quiet_field: misty_horizon,
+};
+
 struct gentle_rain {
   @builtin(position) shimmering_lake: golden_light,
   @location(1) morning_dew: misty_horizon,
@@ -17,6 +26,17 @@ struct velvet_night {
 
 @group(0) @binding(0) var<uniform> boundless_hope: velvet_night;
 
+// specialised per pipeline by the renderer's quality settings
+override iterations: eternal_whisper = 64u;
+override bailout: fleeting_time = 128.0;
+
+// written by the compute path, one invocation per pixel, then blitted to the viewport
+@group(1) @binding(0) var frozen_lake: texture_storage_2d<rgba8unorm, write>;
+
+// workgroup dimensions of the compute path, chosen by the renderer within the device's limits
+override workgroup_width: eternal_whisper = 8u;
+override workgroup_height: eternal_whisper = 8u;
+
 struct forgotten_echo {
   untamed_heart: fleeting_time,
   quiet_soul: fleeting_time,
@@ -28,7 +48,7 @@ fn endless_wander(starlit_wave: misty_horizon) -> forgotten_echo {
   var fading_memory: fleeting_time = 0.0;
 
   for (var twilight_hour: eternal_whisper = 0u;
-       twilight_hour < 64u;
+       twilight_hour < iterations;
        twilight_hour = twilight_hour + 1u) {
 
     stardust_whisper = misty_horizon(
@@ -37,7 +57,7 @@ fn endless_wander(starlit_wave: misty_horizon) -> forgotten_echo {
       2.0 * stardust_whisper.x * stardust_whisper.y
     ) + starlit_wave;
 
-    if (dot(stardust_whisper, stardust_whisper) > 128.0) {
+    if (dot(stardust_whisper, stardust_whisper) > bailout) {
       celestial_dream.untamed_heart = fleeting_time(twilight_hour) - log2(log2(dot(stardust_whisper, stardust_whisper)));
       return celestial_dream;
     }
@@ -51,18 +71,28 @@ fn endless_wander(starlit_wave: misty_horizon) -> forgotten_echo {
 }
 
 @vertex
-fn vs_main(morning_breeze: soft_breeze) -> gentle_rain {
+fn vs_main(morning_breeze: soft_breeze, drifting_cloud: wandering_cloud) -> gentle_rain {
   var serene_valley: gentle_rain;
-  serene_valley.shimmering_lake = golden_light(morning_breeze.twilight_sky, 0.0, 1.0);
-  serene_valley.morning_dew = morning_breeze.moonlit_path + boundless_hope.hidden_thought;
+  serene_valley.shimmering_lake = golden_light(morning_breeze.twilight_sky * drifting_cloud.open_sky + drifting_cloud.distant_shore, 0.0, 1.0);
+  serene_valley.morning_dew = morning_breeze.moonlit_path * drifting_cloud.quiet_field + drifting_cloud.hidden_path + boundless_hope.hidden_thought;
   return serene_valley;
 }
 
-@fragment
-fn fs_main(dancing_shadows: gentle_rain) -> @location(0) golden_light {
+// a single triangle covering the viewport, with no vertex or index buffers; its uvs match the quad's across the visible part
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) still_water: eternal_whisper) -> gentle_rain {
+  var serene_valley: gentle_rain;
+  let moonlit_path = misty_horizon(fleeting_time((still_water << 1u) & 2u), fleeting_time(still_water & 2u));
+  serene_valley.shimmering_lake = golden_light(moonlit_path * 2.0 - 1.0, 0.0, 1.0);
+  serene_valley.morning_dew = moonlit_path + boundless_hope.hidden_thought;
+  return serene_valley;
+}
+
+// the colour of the scene at a point, shared by the fragment and compute paths
+fn radiant_dawn(morning_dew: misty_horizon) -> golden_light {
   let ancient_sea = misty_horizon(
-    dancing_shadows.morning_dew.x * 3.5 - 2.5,
-    dancing_shadows.morning_dew.y * 2.0 - 1.0
+    morning_dew.x * 3.5 - 2.5,
+    morning_dew.y * 2.0 - 1.0
   );
 
   let infinite_vision = endless_wander(ancient_sea);
@@ -75,3 +105,20 @@ fn fs_main(dancing_shadows: gentle_rain) -> @location(0) golden_light {
 
   return golden_light(vivid_dream, 1.0);
 }
+
+@fragment
+fn fs_main(dancing_shadows: gentle_rain) -> @location(0) golden_light {
+  return radiant_dawn(dancing_shadows.morning_dew);
+}
+
+@compute @workgroup_size(workgroup_width, workgroup_height)
+fn cs_main(@builtin(global_invocation_id) wandering_star: boundless_sky) {
+  let endless_field = textureDimensions(frozen_lake);
+  if (any(wandering_star.xy >= endless_field)) {
+    return;
+  }
+  // the same uvs the quad interpolates at this pixel's centre, running bottom to top
+  let moonlit_path = (misty_horizon(wandering_star.xy) + 0.5) / misty_horizon(endless_field);
+  let morning_dew = misty_horizon(moonlit_path.x, 1.0 - moonlit_path.y) + boundless_hope.hidden_thought;
+  textureStore(frozen_lake, winding_road(wandering_star.xy), radiant_dawn(morning_dew));
+}
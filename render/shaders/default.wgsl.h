@@ -1,70 +1,255 @@
 #pragma once
 
-// This file is automatically generated from render/shaders/default.wgsl by ./compile_resource_to_raw_string.sh
+// This file is automatically generated from render/shaders/default.wgsl by resource_compiler
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "wgsl/reflection.h"
 
 namespace render::shaders {
 
-inline constexpr char const *default_wgsl{R"84186bfe3d66467a(alias silver_dream=mat3x3f; alias golden_light=vec4f; alias misty_horizon=vec2f;
+inline constexpr char const *default_wgsl{R"77d3279efe747c26(alias j=vec4f;
+alias c=vec2f;
+alias f=f32;
+struct I{@location(0)J:c,@location(1)h:c}
+struct K{@location(2)L:c,@location(3)M:c,@location(4)N:c,@location(5)O:c}
+struct k{@builtin(position)A:j,@location(1)e:c}
+struct P{s:c}
+@group(0)@binding(0)var<uniform>t:P;
+override iterations:u32=64u;
+override bailout:f=128.;
+@group(1)@binding(0)var B:texture_storage_2d<rgba8unorm,write>;
+override workgroup_width:u32=8u;
+override workgroup_height:u32=8u;
+struct C{n:f,u:f}
+fn Q(D:c)->C{var o:C;var d:c=c(0.,0.);var l:f=0.;for(var p:u32=0u;p<iterations;p=p+1u){d=c(d.x*d.x-d.y*d.y,2.*d.x*d.y)+D;if(dot(d,d)>bailout){o.n=f(p)-log2(log2(dot(d,d)));return o;}l=l+distance(D,d);l=l/2.;}o.u=log(l+1.5);return o;}
+@vertex fn vs_main(E:I,q:K)->k{var i:k;i.A=j(E.J*q.M+q.L,0.,1.);i.e=E.h*q.O+q.N+t.s;return i;}
+@vertex fn vs_fullscreen(@builtin(vertex_index)F:u32)->k{var i:k;let h=c(f((F<<1u)&2u),f(F&2u));i.A=j(h*2.-1.,0.,1.);i.e=h+t.s;return i;}
+fn G(e:c)->j{let R=c(e.x*3.5-2.5,e.y*2.-1.);let m=Q(R);let S=vec3f(m.n/16.+m.u,.5+(m.n/128.)+m.u/4.,.5-(m.n/64.));return j(S,1.);}
+@fragment fn fs_main(T:k)->@location(0)j{return G(T.e);}
+@compute@workgroup_size(workgroup_width,workgroup_height)fn cs_main(@builtin(global_invocation_id)v:vec3u){let H=textureDimensions(B);if(any(v.xy>=H)){return;}let h=(c(v.xy)+.5)/c(H);let e=c(h.x,1.-h.y)+t.s;textureStore(B,vec2u(v.xy),G(e));}
+)77d3279efe747c26"};
+inline constexpr size_t default_wgsl_size{1358};
+inline constexpr uint64_t default_wgsl_hash{0x77d3279efe747c26ull};
+inline constexpr char const *default_wgsl_source{R"45080f99502cefed(alias silver_dream=mat3x3f; alias golden_light=vec4f; alias misty_horizon=vec2f;
 alias radiant_glow=vec3f; alias fleeting_time=f32; alias eternal_whisper=u32;
+alias winding_road=vec2u; alias boundless_sky=vec3u;
+
 struct soft_breeze {
   @location(0) twilight_sky: misty_horizon,
   @location(1) moonlit_path: misty_horizon,
 };
+
+// per instance: where its quad is drawn, and which part of the scene it shows
+struct wandering_cloud {
+  @location(2) distant_shore: misty_horizon,
+  @location(3) open_sky: misty_horizon,
+  @location(4) hidden_path: misty_horizon,
+  @location(5) quiet_field: misty_horizon,
+};
+
 struct gentle_rain {
   @builtin(position) shimmering_lake: golden_light,
   @location(1) morning_dew: misty_horizon,
 };
+
 struct velvet_night {
   hidden_thought: misty_horizon,
 };
+
 @group(0) @binding(0) var<uniform> boundless_hope: velvet_night;
+
+// specialised per pipeline by the renderer's quality settings
+override iterations: eternal_whisper = 64u;
+override bailout: fleeting_time = 128.0;
+
+// written by the compute path, one invocation per pixel, then blitted to the viewport
+@group(1) @binding(0) var frozen_lake: texture_storage_2d<rgba8unorm, write>;
+
+// workgroup dimensions of the compute path, chosen by the renderer within the device's limits
+override workgroup_width: eternal_whisper = 8u;
+override workgroup_height: eternal_whisper = 8u;
+
 struct forgotten_echo {
   untamed_heart: fleeting_time,
   quiet_soul: fleeting_time,
 };
+
 fn endless_wander(starlit_wave: misty_horizon) -> forgotten_echo {
   var celestial_dream: forgotten_echo;
   var stardust_whisper: misty_horizon = misty_horizon(0.0, 0.0);
   var fading_memory: fleeting_time = 0.0;
+
   for (var twilight_hour: eternal_whisper = 0u;
-       twilight_hour < 64u;
+       twilight_hour < iterations;
        twilight_hour = twilight_hour + 1u) {
+
     stardust_whisper = misty_horizon(
       stardust_whisper.x * stardust_whisper.x -
       stardust_whisper.y * stardust_whisper.y,
       2.0 * stardust_whisper.x * stardust_whisper.y
     ) + starlit_wave;
-    if (dot(stardust_whisper, stardust_whisper) > 128.0) {
+
+    if (dot(stardust_whisper, stardust_whisper) > bailout) {
       celestial_dream.untamed_heart = fleeting_time(twilight_hour) - log2(log2(dot(stardust_whisper, stardust_whisper)));
       return celestial_dream;
     }
+
     fading_memory = fading_memory + distance(starlit_wave, stardust_whisper);
     fading_memory = fading_memory / 2.0;
   }
+
   celestial_dream.quiet_soul = log(fading_memory + 1.5);
   return celestial_dream;
 }
+
 @vertex
-fn vs_main(morning_breeze: soft_breeze) -> gentle_rain {
+fn vs_main(morning_breeze: soft_breeze, drifting_cloud: wandering_cloud) -> gentle_rain {
   var serene_valley: gentle_rain;
-  serene_valley.shimmering_lake = golden_light(morning_breeze.twilight_sky, 0.0, 1.0);
-  serene_valley.morning_dew = morning_breeze.moonlit_path + boundless_hope.hidden_thought;
+  serene_valley.shimmering_lake = golden_light(morning_breeze.twilight_sky * drifting_cloud.open_sky + drifting_cloud.distant_shore, 0.0, 1.0);
+  serene_valley.morning_dew = morning_breeze.moonlit_path * drifting_cloud.quiet_field + drifting_cloud.hidden_path + boundless_hope.hidden_thought;
   return serene_valley;
 }
-@fragment
-fn fs_main(dancing_shadows: gentle_rain) -> @location(0) golden_light {
+
+// a single triangle covering the viewport, with no vertex or index buffers; its uvs match the quad's across the visible part
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) still_water: eternal_whisper) -> gentle_rain {
+  var serene_valley: gentle_rain;
+  let moonlit_path = misty_horizon(fleeting_time((still_water << 1u) & 2u), fleeting_time(still_water & 2u));
+  serene_valley.shimmering_lake = golden_light(moonlit_path * 2.0 - 1.0, 0.0, 1.0);
+  serene_valley.morning_dew = moonlit_path + boundless_hope.hidden_thought;
+  return serene_valley;
+}
+
+// the colour of the scene at a point, shared by the fragment and compute paths
+fn radiant_dawn(morning_dew: misty_horizon) -> golden_light {
   let ancient_sea = misty_horizon(
-    dancing_shadows.morning_dew.x * 3.5 - 2.5,
-    dancing_shadows.morning_dew.y * 2.0 - 1.0
+    morning_dew.x * 3.5 - 2.5,
+    morning_dew.y * 2.0 - 1.0
   );
+
   let infinite_vision = endless_wander(ancient_sea);
+
   let vivid_dream = radiant_glow(
     infinite_vision.untamed_heart / 16.0 + infinite_vision.quiet_soul,
     0.5 + (infinite_vision.untamed_heart / 128.0) + infinite_vision.quiet_soul / 4.0,
     0.5 - (infinite_vision.untamed_heart / 64.0)
   );
+
   return golden_light(vivid_dream, 1.0);
 }
-)84186bfe3d66467a"};
+
+@fragment
+fn fs_main(dancing_shadows: gentle_rain) -> @location(0) golden_light {
+  return radiant_dawn(dancing_shadows.morning_dew);
+}
+
+@compute @workgroup_size(workgroup_width, workgroup_height)
+fn cs_main(@builtin(global_invocation_id) wandering_star: boundless_sky) {
+  let endless_field = textureDimensions(frozen_lake);
+  if (any(wandering_star.xy >= endless_field)) {
+    return;
+  }
+  // the same uvs the quad interpolates at this pixel's centre, running bottom to top
+  let moonlit_path = (misty_horizon(wandering_star.xy) + 0.5) / misty_horizon(endless_field);
+  let morning_dew = misty_horizon(moonlit_path.x, 1.0 - moonlit_path.y) + boundless_hope.hidden_thought;
+  textureStore(frozen_lake, winding_road(wandering_star.xy), radiant_dawn(morning_dew));
+}
+)45080f99502cefed"};
+inline constexpr size_t default_wgsl_source_size{4787};
+inline constexpr uint64_t default_wgsl_source_hash{0x45080f99502cefedull};
+
+namespace default_wgsl_reflection {
+
+inline constexpr std::array<wgsl::reflection::member, 2> soft_breeze_members{{
+  {.name{"twilight_sky"}, .offset{0}, .size{8}, .alignment{8}},
+  {.name{"moonlit_path"}, .offset{8}, .size{8}, .alignment{8}},
+}};
+inline constexpr std::array<wgsl::reflection::member, 4> wandering_cloud_members{{
+  {.name{"distant_shore"}, .offset{0}, .size{8}, .alignment{8}},
+  {.name{"open_sky"}, .offset{8}, .size{8}, .alignment{8}},
+  {.name{"hidden_path"}, .offset{16}, .size{8}, .alignment{8}},
+  {.name{"quiet_field"}, .offset{24}, .size{8}, .alignment{8}},
+}};
+inline constexpr std::array<wgsl::reflection::member, 2> gentle_rain_members{{
+  {.name{"shimmering_lake"}, .offset{0}, .size{16}, .alignment{16}},
+  {.name{"morning_dew"}, .offset{16}, .size{8}, .alignment{8}},
+}};
+inline constexpr std::array<wgsl::reflection::member, 1> velvet_night_members{{
+  {.name{"hidden_thought"}, .offset{0}, .size{8}, .alignment{8}},
+}};
+inline constexpr std::array<wgsl::reflection::member, 2> forgotten_echo_members{{
+  {.name{"untamed_heart"}, .offset{0}, .size{4}, .alignment{4}},
+  {.name{"quiet_soul"}, .offset{4}, .size{4}, .alignment{4}},
+}};
+inline constexpr std::array<wgsl::reflection::struct_layout, 5> structs{{
+  {.name{"soft_breeze"}, .size{16}, .alignment{8}, .members{soft_breeze_members}},
+  {.name{"wandering_cloud"}, .size{32}, .alignment{8}, .members{wandering_cloud_members}},
+  {.name{"gentle_rain"}, .size{32}, .alignment{16}, .members{gentle_rain_members}},
+  {.name{"velvet_night"}, .size{8}, .alignment{8}, .members{velvet_night_members}},
+  {.name{"forgotten_echo"}, .size{8}, .alignment{4}, .members{forgotten_echo_members}},
+}};
+
+inline constexpr std::array<wgsl::reflection::resource_binding, 2> bindings{{
+  {
+    .group{0},
+    .binding{0},
+    .name{"boundless_hope"},
+    .type{wgsl::reflection::binding_types::uniform_buffer},
+    .visibility{wgsl::reflection::visible_in_vertex | wgsl::reflection::visible_in_compute},
+    .min_binding_size{8},
+    .type_name{"velvet_night"},
+    .sample_type{wgsl::reflection::sample_types::none},
+    .dimension{wgsl::reflection::texture_dimensions::none},
+    .multisampled{false},
+    .texel_format{""},
+    .access{""},
+  },
+  {
+    .group{1},
+    .binding{0},
+    .name{"frozen_lake"},
+    .type{wgsl::reflection::binding_types::storage_texture},
+    .visibility{wgsl::reflection::visible_in_compute},
+    .min_binding_size{0},
+    .type_name{"texture_storage_2d"},
+    .sample_type{wgsl::reflection::sample_types::none},
+    .dimension{wgsl::reflection::texture_dimensions::d2},
+    .multisampled{false},
+    .texel_format{"rgba8unorm"},
+    .access{"write"},
+  },
+}};
+
+inline constexpr std::array<wgsl::reflection::override_constant, 4> overrides{{
+  {.name{"iterations"}, .type{wgsl::reflection::override_types::u32}, .visibility{wgsl::reflection::visible_in_fragment | wgsl::reflection::visible_in_compute}, .has_default{true}},
+  {.name{"bailout"}, .type{wgsl::reflection::override_types::f32}, .visibility{wgsl::reflection::visible_in_fragment | wgsl::reflection::visible_in_compute}, .has_default{true}},
+  {.name{"workgroup_width"}, .type{wgsl::reflection::override_types::u32}, .visibility{wgsl::reflection::visible_in_compute}, .has_default{true}},
+  {.name{"workgroup_height"}, .type{wgsl::reflection::override_types::u32}, .visibility{wgsl::reflection::visible_in_compute}, .has_default{true}},
+}};
+
+inline constexpr std::array<wgsl::reflection::vertex_input, 6> vs_main_inputs{{
+  {.location{0}, .name{"twilight_sky"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+  {.location{1}, .name{"moonlit_path"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+  {.location{2}, .name{"distant_shore"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+  {.location{3}, .name{"open_sky"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+  {.location{4}, .name{"hidden_path"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+  {.location{5}, .name{"quiet_field"}, .component_type{wgsl::reflection::component_types::f32}, .components{2}},
+}};
+inline constexpr std::array<wgsl::reflection::vertex_input, 0> vs_fullscreen_inputs{{
+}};
+inline constexpr std::array<wgsl::reflection::vertex_input, 0> fs_main_inputs{{
+}};
+inline constexpr std::array<wgsl::reflection::vertex_input, 0> cs_main_inputs{{
+}};
+inline constexpr std::array<wgsl::reflection::entry_point, 4> entry_points{{
+  {.name{"vs_main"}, .stage{wgsl::reflection::stages::vertex}, .inputs{vs_main_inputs}},
+  {.name{"vs_fullscreen"}, .stage{wgsl::reflection::stages::vertex}, .inputs{vs_fullscreen_inputs}},
+  {.name{"fs_main"}, .stage{wgsl::reflection::stages::fragment}, .inputs{fs_main_inputs}},
+  {.name{"cs_main"}, .stage{wgsl::reflection::stages::compute}, .inputs{cs_main_inputs}},
+}};
+
+} // namespace default_wgsl_reflection
 
 } // namespace render::shaders
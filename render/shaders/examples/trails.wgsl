@@ -0,0 +1,52 @@
+// an example pass graph, to paste into the shader editor: sparks drifting upwards leave fading trails, which lean
+// with the input, and are then coloured for display
+// Kept out of render/shaders itself so it isn't embedded; the scene's own entry points are still declared, as its
+// pipeline is built from them, though the passes replace what it draws
+
+//! pass trails fs_trails writes history reads history
+//! pass show fs_show writes colour reads history
+
+struct uniforms {
+  input: vec2f,
+};
+
+struct vertex_output {
+  @builtin(position) position: vec4f,
+  @location(1) uv: vec2f,
+};
+
+@group(0) @binding(0) var<uniform> view: uniforms;
+@group(0) @binding(1) var history_sampler: sampler;
+@group(0) @binding(2) var history: texture_2d<f32>;
+
+@vertex
+fn vs_main(@location(0) position: vec2f, @location(1) uv: vec2f) -> vertex_output {
+  return vertex_output(vec4f(position, 0.0, 1.0), uv + view.input);
+}
+
+// a single triangle covering the viewport, as each pass is drawn with
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) index: u32) -> vertex_output {
+  let uv = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+  return vertex_output(vec4f(uv * 2.0 - 1.0, 0.0, 1.0), uv + view.input);
+}
+
+@fragment
+fn fs_main(scene: vertex_output) -> @location(0) vec4f {
+  return vec4f(scene.uv, 0.0, 1.0);
+}
+
+// reads the uniforms from the fragment stage, so the pass layout must make them visible there
+@fragment
+fn fs_trails(pixel: vertex_output) -> @location(0) vec4f {
+  let drift = vec2f(view.input.x * 0.001, 0.002);
+  let previous = textureSample(history, history_sampler, pixel.position.xy / vec2f(textureDimensions(history)) + drift);
+  let spark = step(0.999, fract(sin(dot(pixel.position.xy, vec2f(12.9898, 78.233))) * 43758.5453));
+  return max(previous * 0.98, vec4f(spark));
+}
+
+@fragment
+fn fs_show(pixel: vertex_output) -> @location(0) vec4f {
+  let trail = textureLoad(history, vec2i(pixel.position.xy), 0).r;
+  return vec4f(trail, trail * 0.6, trail * 0.2, 1.0);                          // white sparks cooling to orange
+}
@@ -0,0 +1,65 @@
+#include "tile_scheduler.h"
+#include <algorithm>
+#include <cassert>
+
+namespace render {
+
+void tile_scheduler::configure(uint32_t width, uint32_t height, uint32_t tile_size, tile_order order) {
+  /// Divide a target of the given size into tiles, clipping those at the right and bottom edges, and restart
+  assert(tile_size != 0);
+  tiles.clear();
+  for(uint32_t y{0}; y < height; y += tile_size) {
+    for(uint32_t x{0}; x < width; x += tile_size) {
+      tiles.emplace_back(tile{
+        .x{x},
+        .y{y},
+        .width{ std::min(tile_size, width  - x)},
+        .height{std::min(tile_size, height - y)},
+      });
+    }
+  }
+
+  switch(order) {
+  case tile_order::rows:
+    break;
+  case tile_order::centre_out:
+    std::ranges::stable_sort(tiles, {}, [&](tile const &this_tile){
+      int64_t const dx{int64_t{this_tile.x} * 2 + this_tile.width  - width};    // twice the offset of the tile's centre from the target's centre
+      int64_t const dy{int64_t{this_tile.y} * 2 + this_tile.height - height};
+      return dx * dx + dy * dy;
+    });
+    break;
+  }
+  restart();
+}
+
+void tile_scheduler::restart() {
+  /// Invalidate the image so far and start issuing tiles from the beginning again
+  next = 0;
+  ++stats.restarts;
+}
+
+std::span<tile_scheduler::tile const> tile_scheduler::next_batch() {
+  /// Issue this frame's tiles, which is empty once the image is complete
+  size_t const count{std::min<size_t>(tiles_per_frame, tiles.size() - next)};
+  std::span<tile const> const batch{tiles.data() + next, count};
+  next += count;
+  if(count != 0 && is_complete()) ++stats.completions;
+  return batch;
+}
+
+bool tile_scheduler::is_complete() const {
+  return next == tiles.size();
+}
+
+float tile_scheduler::get_progress() const {
+  /// The fraction of tiles issued so far
+  if(tiles.empty()) return 1.0f;
+  return static_cast<float>(next) / static_cast<float>(tiles.size());
+}
+
+size_t tile_scheduler::get_tile_count() const {
+  return tiles.size();
+}
+
+}
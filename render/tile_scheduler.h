@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace render {
+
+class tile_scheduler {
+  /// Splits a render target into tiles and hands them out a few at a time over successive frames,
+  /// independent of the graphics API
+  /// Once every tile has been handed out the image is complete and no more are issued until the
+  /// scheduler is restarted, which happens whenever the content being rendered is invalidated
+public:
+  struct tile {
+    uint32_t x{0};
+    uint32_t y{0};
+    uint32_t width{0};
+    uint32_t height{0};
+  };
+
+  enum class tile_order {
+    rows,                                                                       // left to right, top to bottom
+    centre_out,                                                                 // nearest the centre first, so the area of interest resolves soonest
+  };
+
+private:
+  std::vector<tile> tiles;                                                      // every tile, in the order they're issued
+  size_t next{0};                                                               // index of the next tile to issue
+
+public:
+  unsigned int tiles_per_frame{4};                                              // budget of tiles issued per frame
+
+  struct stats_data {
+    unsigned int restarts{0};                                                   // times an image was invalidated, complete or not
+    unsigned int completions{0};                                                // times an image was completed
+  } stats;
+
+  void configure(uint32_t width, uint32_t height, uint32_t tile_size, tile_order order = tile_order::centre_out);
+  void restart();
+
+  std::span<tile const> next_batch();
+
+  bool is_complete() const;
+  float get_progress() const;
+  size_t get_tile_count() const;
+};
+
+}
@@ -0,0 +1,72 @@
+#include "uniform_allocator.h"
+#include <bit>
+#include <stdexcept>
+
+namespace render {
+
+void uniform_allocator::init(uint32_t this_alignment, uint32_t min_region_size, unsigned int this_region_count) {
+  /// Set up the ring with the given alignment, at least the given number of bytes per region, and the given number of regions
+  if(!std::has_single_bit(this_alignment)) throw std::runtime_error{"Uniform allocator: alignment must be a power of two"};
+  if(this_region_count == 0) throw std::runtime_error{"Uniform allocator: at least one region is required"};
+  alignment = this_alignment;
+  region_size = align_up(min_region_size, alignment);
+  region_count = this_region_count;
+  staging.assign(static_cast<size_t>(region_size) * region_count, std::byte{0});
+  current_region = region_count - 1;                                            // so the first frame starts at region 0
+  used = 0;
+}
+
+void uniform_allocator::begin_frame() {
+  /// Move on to the next region of the ring, discarding anything allocated in it previously
+  current_region = (current_region + 1) % region_count;
+  used = 0;
+  ++stats.frames;
+}
+
+std::optional<uint32_t> uniform_allocator::allocate(uint32_t size) {
+  /// Allocate an aligned block in the current frame's region, returning its offset from the start of the buffer
+  uint32_t const start{align_up(used, alignment)};
+  if(size == 0 || start > region_size || size > region_size - start) {
+    ++stats.failed_allocations;
+    return std::nullopt;
+  }
+  used = start + size;
+  ++stats.allocations;
+  return get_region_offset(current_region) + start;
+}
+
+uniform_allocator::range uniform_allocator::get_frame_range() const {
+  /// The range of the buffer written so far this frame
+  return {
+    .offset{get_region_offset(current_region)},
+    .size{used},
+  };
+}
+
+std::span<std::byte const> uniform_allocator::get_frame_data() const {
+  /// The staging data written so far this frame, to be uploaded to the frame range
+  auto const frame_range{get_frame_range()};
+  return {staging.data() + frame_range.offset, frame_range.size};
+}
+
+uint32_t uniform_allocator::get_alignment() const {
+  return alignment;
+}
+
+uint32_t uniform_allocator::get_buffer_size() const {
+  return region_size * region_count;
+}
+
+unsigned int uniform_allocator::get_region_count() const {
+  return region_count;
+}
+
+unsigned int uniform_allocator::get_current_region() const {
+  return current_region;
+}
+
+uint32_t uniform_allocator::get_region_offset(unsigned int region) const {
+  return region_size * region;
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace render {
+
+class uniform_allocator {
+  /// Bump allocator for per-frame uniform data, independent of the graphics API
+  /// The buffer is split into a ring of equally sized regions, one per frame; each frame
+  /// sub-allocates aligned blocks from its own region, and everything written in a frame
+  /// is contiguous so it can be uploaded with a single copy
+  uint32_t alignment{256};                                                      // offset alignment, normally minUniformBufferOffsetAlignment
+  uint32_t region_size{0};                                                      // bytes per frame region, a multiple of the alignment
+  unsigned int region_count{0};
+
+  std::vector<std::byte> staging;                                               // CPU-side copy of the whole buffer
+  unsigned int current_region{0};
+  uint32_t used{0};                                                             // bytes allocated so far in the current region
+
+public:
+  struct range {
+    uint32_t offset{0};                                                         // from the start of the buffer
+    uint32_t size{0};
+  };
+
+  struct stats_data {
+    unsigned int frames{0};
+    unsigned int allocations{0};
+    unsigned int failed_allocations{0};                                         // requests that didn't fit in the remainder of the region
+  } stats;
+
+  void init(uint32_t alignment, uint32_t min_region_size, unsigned int region_count);
+
+  void begin_frame();
+  std::optional<uint32_t> allocate(uint32_t size);
+  template<typename T>
+  std::optional<uint32_t> push(T const &value);
+
+  range get_frame_range() const;
+  std::span<std::byte const> get_frame_data() const;
+
+  uint32_t get_alignment() const;
+  uint32_t get_buffer_size() const;
+  unsigned int get_region_count() const;
+  unsigned int get_current_region() const;
+  uint32_t get_region_offset(unsigned int region) const;
+
+  static constexpr uint32_t align_up(uint32_t value, uint32_t alignment);
+};
+
+template<typename T>
+std::optional<uint32_t> uniform_allocator::push(T const &value) {
+  /// Allocate a block for a value and copy it into the staging data, returning its offset in the buffer
+  static_assert(std::is_trivially_copyable_v<T>);
+  auto const offset{allocate(sizeof(T))};
+  if(offset) std::memcpy(staging.data() + *offset, &value, sizeof(T));
+  return offset;
+}
+
+constexpr uint32_t uniform_allocator::align_up(uint32_t value, uint32_t this_alignment) {
+  /// Round a value up to the next multiple of a power-of-two alignment
+  return (value + this_alignment - 1) & ~(this_alignment - 1);
+}
+
+}
@@ -1,16 +1,25 @@
 #include "webgpu_renderer.h"
 #include "logstorm/manager.h"
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <emscripten.h>
-#include <emscripten/html5.h>
-#include <emscripten/val.h>
 #include <imgui/imgui_impl_wgpu.h>
 #include <magic_enum/magic_enum.hpp>
+#include "fnv1a.h"
+#include "platform/platform.h"
 #include "sqrt_constexpr.h"
 #include "instance.h"
+#include "shaders/blit.wgsl.h"
 #include "shaders/default.wgsl.h"
 
 
@@ -41,6 +50,194 @@ std::string enum_wgpu_name(Tcpp enum_in) {
   return enum_wgpu_name<Tcpp, Tc>(static_cast<Tc>(enum_in));
 }
 
+uint64_t hash_vertex_layouts(std::span<wgpu::VertexBufferLayout const> layouts) {
+  /// Hash the contents of a set of vertex buffer layouts, for use in a pipeline cache key
+  uint64_t hash{fnv1a_offset_basis};
+  for(auto const &layout : layouts) {
+    hash = fnv1a(layout.arrayStride, hash);
+    hash = fnv1a(static_cast<uint64_t>(layout.stepMode), hash);
+    for(auto const &attribute : std::span{layout.attributes, layout.attributeCount}) {
+      hash = fnv1a(static_cast<uint64_t>(attribute.format), hash);
+      hash = fnv1a(attribute.offset, hash);
+      hash = fnv1a(attribute.shaderLocation, hash);
+    }
+  }
+  return hash;
+}
+
+constexpr std::array<std::pair<std::string_view, wgpu::TextureFormat>, 17> storage_texel_formats{{
+  {"rgba8unorm",  wgpu::TextureFormat::RGBA8Unorm},
+  {"rgba8snorm",  wgpu::TextureFormat::RGBA8Snorm},
+  {"rgba8uint",   wgpu::TextureFormat::RGBA8Uint},
+  {"rgba8sint",   wgpu::TextureFormat::RGBA8Sint},
+  {"rgba16uint",  wgpu::TextureFormat::RGBA16Uint},
+  {"rgba16sint",  wgpu::TextureFormat::RGBA16Sint},
+  {"rgba16float", wgpu::TextureFormat::RGBA16Float},
+  {"r32uint",     wgpu::TextureFormat::R32Uint},
+  {"r32sint",     wgpu::TextureFormat::R32Sint},
+  {"r32float",    wgpu::TextureFormat::R32Float},
+  {"rg32uint",    wgpu::TextureFormat::RG32Uint},
+  {"rg32sint",    wgpu::TextureFormat::RG32Sint},
+  {"rg32float",   wgpu::TextureFormat::RG32Float},
+  {"rgba32uint",  wgpu::TextureFormat::RGBA32Uint},
+  {"rgba32sint",  wgpu::TextureFormat::RGBA32Sint},
+  {"rgba32float", wgpu::TextureFormat::RGBA32Float},
+  {"bgra8unorm",  wgpu::TextureFormat::BGRA8Unorm},
+}};
+
+wgpu::TextureViewDimension to_view_dimension(wgsl::reflection::texture_dimensions dimension) {
+  switch(dimension) {
+  case wgsl::reflection::texture_dimensions::none:       return wgpu::TextureViewDimension::Undefined;
+  case wgsl::reflection::texture_dimensions::d1:         return wgpu::TextureViewDimension::e1D;
+  case wgsl::reflection::texture_dimensions::d2:         return wgpu::TextureViewDimension::e2D;
+  case wgsl::reflection::texture_dimensions::d2_array:   return wgpu::TextureViewDimension::e2DArray;
+  case wgsl::reflection::texture_dimensions::cube:       return wgpu::TextureViewDimension::Cube;
+  case wgsl::reflection::texture_dimensions::cube_array: return wgpu::TextureViewDimension::CubeArray;
+  case wgsl::reflection::texture_dimensions::d3:         return wgpu::TextureViewDimension::e3D;
+  }
+  return wgpu::TextureViewDimension::Undefined;
+}
+
+wgpu::BindGroupLayoutEntry make_bind_group_layout_entry(wgsl::reflection::resource_binding const &binding) {
+  /// Describe a binding to WebGPU as the shader declares it, as reflected when the shader was compiled
+  /// Samplers are assumed to filter, and float textures to be filterable, as WGSL doesn't say
+  wgpu::BindGroupLayoutEntry entry{
+    .binding{binding.binding},
+    .visibility{static_cast<wgpu::ShaderStage>(binding.visibility)},            // the reflected bits match wgpu::ShaderStage's
+  };
+  switch(binding.type) {
+  case wgsl::reflection::binding_types::uniform_buffer:
+    entry.buffer = {.type{wgpu::BufferBindingType::Uniform}, .minBindingSize{binding.min_binding_size}};
+    break;
+  case wgsl::reflection::binding_types::storage_buffer:
+    entry.buffer = {.type{wgpu::BufferBindingType::Storage}, .minBindingSize{binding.min_binding_size}};
+    break;
+  case wgsl::reflection::binding_types::read_only_storage_buffer:
+    entry.buffer = {.type{wgpu::BufferBindingType::ReadOnlyStorage}, .minBindingSize{binding.min_binding_size}};
+    break;
+  case wgsl::reflection::binding_types::sampler:
+    entry.sampler = {.type{wgpu::SamplerBindingType::Filtering}};
+    break;
+  case wgsl::reflection::binding_types::comparison_sampler:
+    entry.sampler = {.type{wgpu::SamplerBindingType::Comparison}};
+    break;
+  case wgsl::reflection::binding_types::texture:
+  case wgsl::reflection::binding_types::depth_texture: {
+    auto sample_type{wgpu::TextureSampleType::Float};
+    switch(binding.sample_type) {
+    case wgsl::reflection::sample_types::none:
+    case wgsl::reflection::sample_types::floating:
+      break;
+    case wgsl::reflection::sample_types::signed_integer:
+      sample_type = wgpu::TextureSampleType::Sint;
+      break;
+    case wgsl::reflection::sample_types::unsigned_integer:
+      sample_type = wgpu::TextureSampleType::Uint;
+      break;
+    case wgsl::reflection::sample_types::depth:
+      sample_type = wgpu::TextureSampleType::Depth;
+      break;
+    }
+    if(binding.multisampled && sample_type == wgpu::TextureSampleType::Float) sample_type = wgpu::TextureSampleType::UnfilterableFloat; // multisampled textures can't be filtered
+    entry.texture = {
+      .sampleType{sample_type},
+      .viewDimension{to_view_dimension(binding.dimension)},
+      .multisampled{binding.multisampled},
+    };
+    break;
+  }
+  case wgsl::reflection::binding_types::storage_texture: {
+    auto const format{std::ranges::find(storage_texel_formats, binding.texel_format, &std::pair<std::string_view, wgpu::TextureFormat>::first)};
+    if(format == storage_texel_formats.end()) throw std::runtime_error{"Unsupported storage texel format " + std::string{binding.texel_format}};
+    entry.storageTexture = {
+      .access{binding.access == "read" ? wgpu::StorageTextureAccess::ReadOnly : binding.access == "read_write" ? wgpu::StorageTextureAccess::ReadWrite : wgpu::StorageTextureAccess::WriteOnly},
+      .format{format->second},
+      .viewDimension{to_view_dimension(binding.dimension)},
+    };
+    break;
+  }
+  }
+  return entry;
+}
+
+wgpu::BindGroupLayoutEntry make_uniforms_layout_entry() {
+  /// Describe the uniforms binding shared by every pipeline built from user shaders
+  /// Spelled out rather than reflected, as an edited shader may read the uniforms from stages the default doesn't;
+  /// the default shader's reflection only checks at compile time that it agrees
+  return {
+    .binding{0},
+    .visibility{wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment | wgpu::ShaderStage::Compute},
+    .buffer{                                                                    // BufferBindingLayout
+      .type{wgpu::BufferBindingType::Uniform},
+      .hasDynamicOffset{true},                                                  // each frame's uniforms are at a different offset in the uniform ring
+      .minBindingSize{sizeof(uniforms)},
+    },
+  };
+}
+
+}
+
+// the host structures bound to the default shader must match its interface, as reflected when it was compiled
+// A binding, structure or entry point missing from the shader fails these too, as dereferencing nullptr isn't constexpr
+namespace default_shader = shaders::default_wgsl_reflection;
+constexpr auto const *uniforms_binding{wgsl::reflection::find_binding(default_shader::bindings, 0, 0)};
+static_assert(uniforms_binding->type == wgsl::reflection::binding_types::uniform_buffer, "the default shader's uniforms must be a uniform buffer at group 0 binding 0");
+constexpr auto const *uniforms_layout{wgsl::reflection::find_struct(default_shader::structs, uniforms_binding->type_name)};
+static_assert(uniforms_layout->members.size() == 1, "render::uniforms has one member");
+static_assert(offsetof(uniforms, input) == uniforms_layout->members[0].offset && sizeof(uniforms::input) == uniforms_layout->members[0].size, "render::uniforms::input must match the shader's");
+static_assert(sizeof(uniforms) >= uniforms_binding->min_binding_size, "render::uniforms must be at least as large as the shader's uniform buffer");
+
+constexpr bool is_vec2f_input(wgsl::reflection::vertex_input const *input) {
+  return input && input->component_type == wgsl::reflection::component_types::f32 && input->components == 2;
+}
+constexpr auto const *vertex_entry_point{wgsl::reflection::find_entry_point(default_shader::entry_points, "vs_main")};
+static_assert(vertex_entry_point->inputs.size() == 6, "render::vertex and render::instance have six members between them");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 0)) && sizeof(vertex::position) == sizeof(float) * 2, "render::vertex::position must match the shader's vertex input at location 0");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 1)) && sizeof(vertex::uv) == sizeof(float) * 2, "render::vertex::uv must match the shader's vertex input at location 1");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 2)) && sizeof(instance::position_offset) == sizeof(float) * 2, "render::instance::position_offset must match the shader's vertex input at location 2");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 3)) && sizeof(instance::position_scale) == sizeof(float) * 2, "render::instance::position_scale must match the shader's vertex input at location 3");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 4)) && sizeof(instance::uv_offset) == sizeof(float) * 2, "render::instance::uv_offset must match the shader's vertex input at location 4");
+static_assert(is_vec2f_input(wgsl::reflection::find_vertex_input(vertex_entry_point->inputs, 5)) && sizeof(instance::uv_scale) == sizeof(float) * 2, "render::instance::uv_scale must match the shader's vertex input at location 5");
+static_assert(wgsl::reflection::find_entry_point(default_shader::entry_points, "vs_fullscreen")->inputs.empty(), "the default shader's fullscreen triangle must need no vertex buffers");
+
+template<typename T>
+constexpr bool declares_parameter(std::span<wgsl::reflection::override_constant const> overrides, shader_parameter<T> parameter) {
+  /// Whether a shader declares an override constant with the name and type of a parameter
+  auto const *override_constant{wgsl::reflection::find_override(overrides, parameter.name)};
+  if(!override_constant) return false;
+  switch(override_constant->type) {
+  case wgsl::reflection::override_types::boolean: return std::is_same_v<T, bool>;
+  case wgsl::reflection::override_types::f32:     return std::is_same_v<T, float>;
+  case wgsl::reflection::override_types::i32:     return std::is_same_v<T, int32_t>;
+  case wgsl::reflection::override_types::u32:     return std::is_same_v<T, uint32_t>;
+  }
+  return false;
+}
+static_assert(declares_parameter(default_shader::overrides, webgpu_renderer::shader_parameters::iterations), "the default shader must declare override iterations: u32");
+static_assert(declares_parameter(default_shader::overrides, webgpu_renderer::shader_parameters::bailout), "the default shader must declare override bailout: f32");
+static_assert(declares_parameter(default_shader::overrides, webgpu_renderer::shader_parameters::workgroup_width), "the default shader must declare override workgroup_width: u32");
+static_assert(declares_parameter(default_shader::overrides, webgpu_renderer::shader_parameters::workgroup_height), "the default shader must declare override workgroup_height: u32");
+
+// the compute path writes the offscreen texture through a storage texture at group 1 binding 0, with the uniforms as for render pipelines
+constexpr auto const *compute_entry_point{wgsl::reflection::find_entry_point(default_shader::entry_points, "cs_main")};
+static_assert(compute_entry_point->stage == wgsl::reflection::stages::compute);
+constexpr auto const *compute_target_binding{wgsl::reflection::find_binding(default_shader::bindings, 1, 0)};
+static_assert(compute_target_binding->type == wgsl::reflection::binding_types::storage_texture && compute_target_binding->dimension == wgsl::reflection::texture_dimensions::d2, "the default shader's compute path must write a 2d storage texture at group 1 binding 0");
+static_assert(uniforms_binding->visibility & wgsl::reflection::visible_in_compute, "the default shader's compute path reads the uniforms, as the shared layout expects");
+
+// the blit bind group is built with the scene sampler at binding 0 and the scene texture at binding 1
+namespace blit_shader = shaders::blit_wgsl_reflection;
+static_assert(wgsl::reflection::find_binding(blit_shader::bindings, 0, 0)->type == wgsl::reflection::binding_types::sampler);
+static_assert(wgsl::reflection::find_binding(blit_shader::bindings, 0, 1)->type == wgsl::reflection::binding_types::texture);
+
+size_t webgpu_renderer::pipeline_key::hasher::operator()(pipeline_key const &key) const {
+  /// Combine all fields of a pipeline cache key into a single hash
+  return static_cast<size_t>(fnv1a(static_cast<uint64_t>(key.geometry), fnv1a(key.constants_hash, fnv1a(key.vertex_layout_hash, fnv1a(static_cast<uint64_t>(key.colour_format), key.shader_hash)))));
+}
+
+size_t webgpu_renderer::texture_key::hasher::operator()(texture_key const &key) const {
+  /// Combine all fields of a texture pool key into a single hash
+  return static_cast<size_t>(fnv1a(static_cast<uint64_t>(key.format), fnv1a(key.size.y, fnv1a(key.size.x))));
 }
 
 webgpu_renderer::webgpu_renderer(logstorm::manager &this_logger)
@@ -48,27 +245,30 @@ webgpu_renderer::webgpu_renderer(logstorm::manager &this_logger)
   /// Construct a WebGPU renderer and populate those members that don't require delayed init
   if(!webgpu.instance) throw std::runtime_error{"Could not initialize WebGPU"};
 
-  shader_code = render::shaders::default_wgsl;
+  shader_code = std::string{render::shaders::default_wgsl_source, render::shaders::default_wgsl_source_size}; // unminified, as it's shown in the editor
+  shader_hash = render::shaders::default_wgsl_source_hash;                      // hashed when the resource was compiled
+  for(auto const &override_constant : default_shader::overrides) {
+    shader_overrides.emplace_back(override_constant.name);
+  }
 
-  // find out about the initial canvas size and the current window and doc sizes
-  window.viewport_size.assign(emscripten::val::global("window")["innerWidth"].as<unsigned int>(),
-                              emscripten::val::global("window")["innerHeight"].as<unsigned int>());
-  window.device_pixel_ratio = emscripten::val::global("window")["devicePixelRatio"].as<float>(); // query device pixel ratio using JS
-  logger << "WebGPU: Viewport size: " << window.viewport_size << " (device pixels: approx " << static_cast<vec2f>(window.viewport_size) * window.device_pixel_ratio << ")";
-  logger << "WebGPU: Device pixel ratio: " << window.device_pixel_ratio << " canvas pixels to 1 device pixel (" << static_cast<unsigned int>(std::round(100.0f * window.device_pixel_ratio)) << "% zoom)";
+  // find out about the initial canvas size and device pixel ratio
+  observe_canvas_size();
+  resizer.apply(resize_manager::clock::now());
+  window.viewport_size = resizer.get_surface_size();
+  logger << "WebGPU: Viewport size: " << window.viewport_size << " device pixels";
+  logger << "WebGPU: Device pixel ratio: " << resizer.get_device_pixel_ratio() << " device pixels to 1 CSS pixel (" << static_cast<unsigned int>(std::round(100.0f * resizer.get_device_pixel_ratio())) << "% zoom)";
 
-  // create a surface
-  {
-    wgpu::SurfaceDescriptorFromCanvasHTMLSelector surface_descriptor_from_canvas;
-    surface_descriptor_from_canvas.selector = "#canvas";
+  webgpu.surface = platform::create_surface(webgpu.instance);
+  if(!webgpu.surface) throw std::runtime_error{"Could not create WebGPU surface"};
 
-    wgpu::SurfaceDescriptor surface_descriptor{
-      .nextInChain{&surface_descriptor_from_canvas},
-      .label{"Canvas surface"},
-    };
-    webgpu.surface = webgpu.instance.CreateSurface(&surface_descriptor);
+  work_done_requests.reserve(frame_pacer::max_frames_in_flight_limit);          // callbacks hold pointers into this, so it must never reallocate
+  for(unsigned int slot{0}; slot != frame_pacer::max_frames_in_flight_limit; ++slot) {
+    work_done_requests.emplace_back(work_done_request{*this});
+  }
+  uniform_staging.map_requests.reserve(uniform_staging.slots);                  // as above, for the staging buffers' map callbacks
+  for(unsigned int slot{0}; slot != uniform_staging.slots; ++slot) {
+    uniform_staging.map_requests.emplace_back(uniform_staging_data::map_request{*this, slot});
   }
-  if(!webgpu.surface) throw std::runtime_error{"Could not create WebGPU surface"};
 }
 
 void webgpu_renderer::init(std::function<void(webgpu_data const&)> &&this_postinit_callback, std::function<void()> &&this_main_loop_callback) {
@@ -100,11 +300,13 @@ void webgpu_renderer::init(std::function<void(webgpu_data const&)> &&this_postin
         adapter = wgpu::Adapter::Acquire(adapter_ptr);
         if(!adapter) throw std::runtime_error{"WebGPU: Could not acquire adapter"};
 
-        // report surface and adapter capabilities
-        #ifndef NDEBUG
-          {
-            wgpu::SurfaceCapabilities surface_capabilities;
-            webgpu.surface.GetCapabilities(adapter, &surface_capabilities);
+        // find out, and report, surface and adapter capabilities
+        {
+          wgpu::SurfaceCapabilities surface_capabilities;
+          webgpu.surface.GetCapabilities(adapter, &surface_capabilities);
+          webgpu.present_modes.assign(surface_capabilities.presentModes, surface_capabilities.presentModes + surface_capabilities.presentModeCount);
+          if(std::ranges::find(webgpu.present_modes, wgpu::PresentMode::Fifo) == webgpu.present_modes.end()) webgpu.present_modes.emplace_back(wgpu::PresentMode::Fifo); // required of every surface, even if not reported
+          #ifndef NDEBUG
             for(size_t i{0}; i != surface_capabilities.formatCount; ++i) {
               logger << "DEBUG: WebGPU surface capabilities: texture formats: " << magic_enum::enum_name(surface_capabilities.formats[i]);
             }
@@ -114,8 +316,8 @@ void webgpu_renderer::init(std::function<void(webgpu_data const&)> &&this_postin
             for(size_t i{0}; i != surface_capabilities.alphaModeCount; ++i) {
               logger << "DEBUG: WebGPU surface capabilities: alpha modes: " << magic_enum::enum_name(surface_capabilities.alphaModes[i]);
             }
-          }
-        #endif // NDEBUG
+          #endif // NDEBUG
+        }
         webgpu.surface_preferred_format = webgpu.surface.GetPreferredFormat(adapter);
         logger << "WebGPU surface preferred format for this adapter: " << magic_enum::enum_name(webgpu.surface_preferred_format);
         if(webgpu.surface_preferred_format == wgpu::TextureFormat::Undefined) {
@@ -218,6 +420,9 @@ void webgpu_renderer::init(std::function<void(webgpu_data const&)> &&this_postin
         std::set<wgpu::FeatureName> desired_features{
           wgpu::FeatureName::ShaderF16,
           wgpu::FeatureName::Float32Filterable,
+          #ifdef NDEBUG
+            wgpu::FeatureName::TimestampQuery,                                  // used by the GPU profiler when available
+          #endif // NDEBUG
         };
 
         std::vector<wgpu::FeatureName> required_features_arr;
@@ -439,36 +644,86 @@ void webgpu_renderer::init(std::function<void(webgpu_data const&)> &&this_postin
     );
   }
 
-  emscripten_set_main_loop_arg([](void *data){
+  platform::run_main_loop([](void *data){
     /// Dispatch the loop waiting for WebGPU to become ready
     auto &renderer{*static_cast<webgpu_renderer*>(data)};
     renderer.wait_to_configure_loop();
-  }, this, 0, true);                                                            // loop function, user data, FPS (0 to use browser requestAnimationFrame mechanism), simulate infinite loop
-  std::unreachable();
+  }, this);
 }
 
-void webgpu_renderer::init_swapchain() {
-  /// Create or recreate the swapchain for the current viewport size
-  wgpu::SwapChainDescriptor swapchain_descriptor{
-    .label{"Swapchain 1"},
-    .usage{wgpu::TextureUsage::RenderAttachment},
+void webgpu_renderer::observe_canvas_size() {
+  /// Report the canvas's current CSS size and the device pixel ratio to the resize manager
+  /// Polled rather than event driven: only one resize callback can be registered per target, and ImGui's backend
+  /// owns the window's; polling also catches device pixel ratio changes from zooming or moving between monitors
+  resizer.observe(platform::get_canvas_css_size(), platform::get_device_pixel_ratio(), resize_manager::clock::now());
+}
+
+void webgpu_renderer::configure_surface() {
+  /// Configure the surface, and size the canvas's backing store to match, at the current viewport size in device pixels
+  wgpu::SurfaceConfiguration surface_configuration{
+    .device{webgpu.device},
     .format{webgpu.surface_preferred_format},
+    .usage{wgpu::TextureUsage::RenderAttachment},
+    .viewFormats{nullptr},
     .width{ window.viewport_size.x},
     .height{window.viewport_size.y},
-    .presentMode{wgpu::PresentMode::Fifo},
+    .presentMode{present_mode},
   };
-  webgpu.swapchain = webgpu.device.CreateSwapChain(webgpu.surface, &swapchain_descriptor);
+  webgpu.surface.Configure(&surface_configuration);
+  platform::set_canvas_size(window.viewport_size);
+}
+
+void webgpu_renderer::update_surface_size() {
+  /// Apply any resize observed since the last frame, reconfiguring the existing surface at most once per frame
+  observe_canvas_size();
+  if(!resizer.apply(resize_manager::clock::now())) return;
+  window.viewport_size = resizer.get_surface_size();
+
+  auto const configure_start{std::chrono::steady_clock::now()};
+  configure_surface();
+  std::chrono::duration<float, std::milli> const configure_time{std::chrono::steady_clock::now() - configure_start};
+  idle.request(idle_scheduler::reason::viewport);
+
+  auto const &stats{resizer.stats};
+  logger << "WebGPU: Surface reconfigured to " << window.viewport_size << " device pixels at pixel ratio " << resizer.get_effective_pixel_ratio()
+         << " in " << configure_time.count() << "ms, " << stats.last_latency_ms << "ms after the size changed (max " << stats.max_latency_ms << "ms), "
+         << stats.reconfigures << " reconfigures for " << stats.changes << " size changes";
+}
+
+bool webgpu_renderer::acquire_surface_texture() {
+  /// Get this frame's surface texture into the frame context, or reconfigure the surface and return false to skip the frame
+  /// Throws if the surface or device is lost, or out of memory
+  auto &surface_texture{frame_context.surface_texture};
+  webgpu.surface.GetCurrentTexture(&surface_texture);
+  auto const status_name{enum_wgpu_name<wgpu::SurfaceGetCurrentTextureStatus>(static_cast<WGPUSurfaceGetCurrentTextureStatus>(surface_texture.status))};
+  switch(surface_texture.status) {
+  case wgpu::SurfaceGetCurrentTextureStatus::Success:
+    if(!surface_texture.suboptimal) return true;
+    break;                                                                      // usable, but no longer matches the display well, so reconfigure rather than draw to it
+  case wgpu::SurfaceGetCurrentTextureStatus::Timeout:
+  case wgpu::SurfaceGetCurrentTextureStatus::Outdated:
+    break;
+  case wgpu::SurfaceGetCurrentTextureStatus::Lost:
+  case wgpu::SurfaceGetCurrentTextureStatus::OutOfMemory:
+  case wgpu::SurfaceGetCurrentTextureStatus::DeviceLost:
+    throw std::runtime_error{"Could not get current texture from surface, status " + status_name};
+  }
+  logger << "WebGPU: Surface texture " << (surface_texture.suboptimal ? "suboptimal" : status_name) << ", reconfiguring the surface and skipping the frame";
+  surface_texture.texture = {};
+  configure_surface();
+  idle.request(idle_scheduler::reason::viewport);                               // the frame wasn't drawn, so draw the next one
+  return false;
 }
 
 void webgpu_renderer::wait_to_configure_loop() {
   /// Check if initialisation has completed and the WebGPU system is ready for configuration
-  /// Since init occurs asynchronously, some emscripten ticks are needed before this becomes true
+  /// Since init occurs asynchronously, some main loop ticks are needed before this becomes true
   if(!webgpu.device) {
     logger << "WebGPU: Waiting for device to become available";
     // TODO: sensible timeout
     return;
   }
-  emscripten_cancel_main_loop();
+  platform::cancel_main_loop();
 
   configure();
 
@@ -478,63 +733,141 @@ void webgpu_renderer::wait_to_configure_loop() {
   }
 
   logger << "WebGPU: Launching main loop";
-  emscripten_set_main_loop_arg([](void *data){
+  platform::run_main_loop([](void *data){
     /// Main pseudo-loop waiting for initialisation to complete
     auto &renderer{*static_cast<webgpu_renderer*>(data)};
     renderer.main_loop_callback();
-  }, this, 0, true);                                                            // loop function, user data, FPS (0 to use browser requestAnimationFrame mechanism), simulate infinite loop
-  std::unreachable();
+  }, this);
 }
 
 void webgpu_renderer::configure() {
   /// When the device is ready, configure the WebGPU system
   logger << "WebGPU device ready, configuring surface";
   {
-    wgpu::SurfaceConfiguration surface_configuration{
-      .device{webgpu.device},
-      .format{webgpu.surface_preferred_format},
-      .viewFormats{nullptr},
-      .width{ window.viewport_size.x},
-      .height{window.viewport_size.y},
-    };
-    webgpu.surface.Configure(&surface_configuration);
+    wgpu::SupportedLimits device_limits;
+    if(!webgpu.device.GetLimits(&device_limits)) throw std::runtime_error{"WebGPU: Could not query device limits"};
+    webgpu.limits = device_limits.limits;
   }
-
-  logger << "WebGPU creating swapchain";
-  init_swapchain();
+  resizer.max_dimension = webgpu.limits.maxTextureDimension2D;
+  observe_canvas_size();                                                        // pick up any change since construction, and apply the device's size limit
+  resizer.apply(resize_manager::clock::now());
+  window.viewport_size = resizer.get_surface_size();
+  configure_surface();
 
   logger << "WebGPU acquiring queue";
   webgpu.queue = webgpu.device.GetQueue();
 
-  configure_pipeline();
+  uniform_blocks.init(webgpu.limits.minUniformBufferOffsetAlignment, uniform_buffer_size, 1); // a single region, reused every frame
+  logger << "WebGPU: Uniform buffer of " << uniform_blocks.get_buffer_size() << " bytes, alignment " << uniform_blocks.get_alignment();
 
-  emscripten_set_resize_callback(EMSCRIPTEN_EVENT_TARGET_WINDOW, this, false,   // target, userdata, use_capture, callback
-    ([](int /*event_type*/, EmscriptenUiEvent const *event, void *data) {       // event_type == EMSCRIPTEN_EVENT_RESIZE
-      auto &renderer{*static_cast<webgpu_renderer*>(data)};
-      renderer.window.viewport_size.x = static_cast<unsigned int>(event->windowInnerWidth);
-      renderer.window.viewport_size.y = static_cast<unsigned int>(event->windowInnerHeight);
+  {
+    std::vector<std::string> gpu_scope_names;
+    for(auto const name : magic_enum::enum_names<gpu_scope>()) {
+      gpu_scope_names.emplace_back(name);
+    }
+    profiler.init(webgpu.device, std::move(gpu_scope_names));
+  }
 
-      renderer.init_swapchain();
-      return true;                                                              // the event was consumed
-    })
-  );
+  configure_pipeline_layout();
+  configure_pipeline();
+  configure_blit_pipeline();
 
   build_scene();
+  configure_compute();
+  configure_feedback();
 }
 
-void webgpu_renderer::configure_pipeline() {
-  /// Configure or reconfigure the rendering pipeline
-  logger << "WebGPU assembling shaders";
+void webgpu_renderer::configure_pipeline_layout() {
+  /// Configure the bind group and pipeline layouts, which are shared by every pipeline built from user shaders
+  logger << "WebGPU configuring pipeline layout";
+  auto const binding_layout{make_uniforms_layout_entry()};
+  wgpu::BindGroupLayoutDescriptor bind_group_layout_descriptor{
+    .label{"Bind group layout 1"},
+    .entryCount{1},
+    .entries{&binding_layout},
+  };
+  webgpu.bind_group_layout = webgpu.device.CreateBindGroupLayout(&bind_group_layout_descriptor);
+
+  wgpu::PipelineLayoutDescriptor pipeline_layout_descriptor{
+    .label{"Pipeline layout 1"},
+    .bindGroupLayoutCount{1},
+    .bindGroupLayouts{&webgpu.bind_group_layout},
+  };
+  webgpu.pipeline_layout = webgpu.device.CreatePipelineLayout(&pipeline_layout_descriptor);
+}
+
+void webgpu_renderer::configure_blit_pipeline() {
+  /// Configure the pipeline that upscales the offscreen scene texture to the viewport when rendering at reduced scale
+  logger << "WebGPU configuring blit pipeline";
+  wgpu::SamplerDescriptor sampler_descriptor{
+    .label{"Offscreen sampler"},
+    .addressModeU{wgpu::AddressMode::ClampToEdge},
+    .addressModeV{wgpu::AddressMode::ClampToEdge},
+    .magFilter{wgpu::FilterMode::Linear},                                       // bilinear upscaling
+    .minFilter{wgpu::FilterMode::Linear},
+  };
+  offscreen.sampler = webgpu.device.CreateSampler(&sampler_descriptor);
+
+  std::array<wgpu::BindGroupLayoutEntry, blit_shader::bindings.size()> binding_layouts;
+  std::ranges::transform(blit_shader::bindings, binding_layouts.begin(), make_bind_group_layout_entry);
+  wgpu::BindGroupLayoutDescriptor bind_group_layout_descriptor{
+    .label{"Blit bind group layout"},
+    .entryCount{binding_layouts.size()},
+    .entries{binding_layouts.data()},
+  };
+  offscreen.bind_group_layout = webgpu.device.CreateBindGroupLayout(&bind_group_layout_descriptor);
+
+  wgpu::PipelineLayoutDescriptor pipeline_layout_descriptor{
+    .label{"Blit pipeline layout"},
+    .bindGroupLayoutCount{1},
+    .bindGroupLayouts{&offscreen.bind_group_layout},
+  };
+  wgpu::PipelineLayout pipeline_layout{webgpu.device.CreatePipelineLayout(&pipeline_layout_descriptor)};
+
   wgpu::ShaderModuleWGSLDescriptor shader_module_wgsl_decriptor;
-  shader_module_wgsl_decriptor.code = shader_code.c_str();
+  shader_module_wgsl_decriptor.code = render::shaders::blit_wgsl;
   wgpu::ShaderModuleDescriptor shader_module_descriptor{
     .nextInChain{&shader_module_wgsl_decriptor},
-    .label{"Shader module 1"},
+    .label{"Blit shader module"},
   };
   wgpu::ShaderModule shader_module{webgpu.device.CreateShaderModule(&shader_module_descriptor)};
 
-  logger << "WebGPU configuring pipeline";
+  wgpu::ColorTargetState colour_target_state{
+    .format{webgpu.surface_preferred_format},
+    .blend{nullptr},                                                            // the blit replaces everything under it
+  };
+  wgpu::FragmentState fragment_state{
+    .module{shader_module},
+    .entryPoint{"fs_main"},
+    .constantCount{0},
+    .constants{nullptr},
+    .targetCount{1},
+    .targets{&colour_target_state},
+  };
+  wgpu::RenderPipelineDescriptor render_pipeline_descriptor{
+    .label{"Blit render pipeline"},
+    .layout{pipeline_layout},
+    .vertex{                                                                    // VertexState
+      .module{shader_module},
+      .entryPoint{"vs_main"},
+      .constantCount{0},
+      .constants{nullptr},
+      .bufferCount{0},                                                          // the fullscreen triangle is generated from the vertex index
+      .buffers{nullptr},
+    },
+    .primitive{                                                                 // PrimitiveState
+      .cullMode{wgpu::CullMode::None},
+    },
+    .multisample{},
+    .fragment{&fragment_state},
+  };
+  offscreen.pipeline = webgpu.device.CreateRenderPipeline(&render_pipeline_descriptor);
+}
 
+void webgpu_renderer::configure_pipeline(pipeline_compile_mode mode) {
+  /// Configure or reconfigure the rendering pipeline, reusing a cached pipeline if one matches
+  scene_geometry const target_geometry{get_target_geometry()};
+  if(target_geometry == scene_geometry::quad) build_quad_buffers();             // the quad needs its buffers in place by the time its pipeline is
   std::array vertex_attributes{
     wgpu::VertexAttribute{
       .format{wgpu::VertexFormat::Float32x2},
@@ -547,13 +880,77 @@ void webgpu_renderer::configure_pipeline() {
       .shaderLocation{1},
     },
   };
-  std::vector<wgpu::VertexBufferLayout> vertex_buffer_layouts{
-    {
-      .arrayStride{sizeof(vertex)},
-      .attributeCount{vertex_attributes.size()},
-      .attributes{vertex_attributes.data()},
+  std::array instance_attributes{
+    wgpu::VertexAttribute{
+      .format{wgpu::VertexFormat::Float32x2},
+      .offset{offsetof(instance, position_offset)},
+      .shaderLocation{2},
     },
+    wgpu::VertexAttribute{
+      .format{wgpu::VertexFormat::Float32x2},
+      .offset{offsetof(instance, position_scale)},
+      .shaderLocation{3},
+    },
+    wgpu::VertexAttribute{
+      .format{wgpu::VertexFormat::Float32x2},
+      .offset{offsetof(instance, uv_offset)},
+      .shaderLocation{4},
+    },
+    wgpu::VertexAttribute{
+      .format{wgpu::VertexFormat::Float32x2},
+      .offset{offsetof(instance, uv_scale)},
+      .shaderLocation{5},
+    },
+  };
+  std::vector<wgpu::VertexBufferLayout> vertex_buffer_layouts;
+  char const *vertex_entry_point_name{"vs_fullscreen"};
+  switch(target_geometry) {
+  case scene_geometry::quad:
+    vertex_buffer_layouts = {
+      {
+        .arrayStride{sizeof(vertex)},
+        .attributeCount{vertex_attributes.size()},
+        .attributes{vertex_attributes.data()},
+      },
+      {
+        .arrayStride{sizeof(instance)},
+        .stepMode{wgpu::VertexStepMode::Instance},
+        .attributeCount{instance_attributes.size()},                            // shaders that don't read these still draw the instances, each over the whole viewport
+        .attributes{instance_attributes.data()},
+      },
+    };
+    vertex_entry_point_name = "vs_main";
+    break;
+  case scene_geometry::fullscreen_triangle:
+    break;                                                                      // no vertex buffers at all
+  }
+
+  uint64_t constants_hash{fnv1a_offset_basis};
+  auto const constants{make_pipeline_constants(constants_hash)};
+
+  pipeline_key const key{
+    .shader_hash{shader_hash},
+    .colour_format{webgpu.surface_preferred_format},
+    .vertex_layout_hash{hash_vertex_layouts(vertex_buffer_layouts)},
+    .constants_hash{constants_hash},
+    .geometry{target_geometry},
   };
+  if(auto const *cached_pipeline{pipeline_cache.find(key)}; cached_pipeline) {
+    log_pipeline_cache_stats("hit");
+    ++pipeline_generation;                                                      // supersede any compilation still in flight
+    if(mode == pipeline_compile_mode::async) {
+      on_pipeline_ready(wgpu::RenderPipeline{*cached_pipeline}, target_geometry);
+    } else {
+      webgpu.pipeline = *cached_pipeline;
+      pipeline_geometry = target_geometry;
+    }
+    return;
+  }
+  log_pipeline_cache_stats("miss");
+
+  wgpu::ShaderModule const shader_module{create_shader_module()};
+
+  logger << "WebGPU configuring pipeline";
 
   wgpu::BlendState blend_state{
     .color{                                                                     // BlendComponent
@@ -575,45 +972,20 @@ void webgpu_renderer::configure_pipeline() {
   wgpu::FragmentState fragment_state{
     .module{shader_module},
     .entryPoint{"fs_main"},
-    .constantCount{0},
-    .constants{nullptr},
+    .constantCount{constants.size()},                                           // constants are checked against the whole module, so both stages get them all
+    .constants{constants.data()},
     .targetCount{1},
     .targets{&colour_target_state},
   };
 
-  wgpu::BindGroupLayoutEntry binding_layout{
-    .binding{0},                                                                // binding index as used in the @binding attribute in the shader
-    .visibility{wgpu::ShaderStage::Vertex},
-    .buffer{                                                                    // BufferBindingLayout
-      .type{wgpu::BufferBindingType::Uniform},
-      .minBindingSize{sizeof(uniforms)},
-    },
-    .sampler{},                                                                 // SamplerBindingLayout
-    .texture{},                                                                 // TextureBindingLayout
-    .storageTexture{},                                                          // StorageTextureBindingLayout
-  };
-  wgpu::BindGroupLayoutDescriptor bind_group_layout_descriptor{
-    .label{"Bind group layout 1"},
-    .entryCount{1},
-    .entries{&binding_layout},
-  };
-  webgpu.bind_group_layout = webgpu.device.CreateBindGroupLayout(&bind_group_layout_descriptor);
-
-  wgpu::PipelineLayoutDescriptor pipeline_layout_descriptor{
-    .label{"Pipeline layout 1"},
-    .bindGroupLayoutCount{1},
-    .bindGroupLayouts{&webgpu.bind_group_layout},
-  };
-  wgpu::PipelineLayout pipeline_layout{webgpu.device.CreatePipelineLayout(&pipeline_layout_descriptor)};
-
   wgpu::RenderPipelineDescriptor render_pipeline_descriptor{
     .label{"Render pipeline 1"},
-    .layout{std::move(pipeline_layout)},
+    .layout{webgpu.pipeline_layout},
     .vertex{                                                                    // VertexState
       .module{shader_module},
-      .entryPoint{"vs_main"},
-      .constantCount{0},
-      .constants{nullptr},
+      .entryPoint{vertex_entry_point_name},
+      .constantCount{constants.size()},
+      .constants{constants.data()},
       .bufferCount{vertex_buffer_layouts.size()},
       .buffers{vertex_buffer_layouts.data()},
     },
@@ -623,7 +995,364 @@ void webgpu_renderer::configure_pipeline() {
     .multisample{},
     .fragment{&fragment_state},
   };
-  webgpu.pipeline = webgpu.device.CreateRenderPipeline(&render_pipeline_descriptor);
+
+  switch(mode) {
+  case pipeline_compile_mode::blocking:
+    webgpu.pipeline = webgpu.device.CreateRenderPipeline(&render_pipeline_descriptor);
+    pipeline_geometry = target_geometry;
+    pipeline_cache.insert(key, webgpu.pipeline);
+    break;
+  case pipeline_compile_mode::async:
+    webgpu.device.CreateRenderPipelineAsync(
+      &render_pipeline_descriptor,
+      [](WGPUCreatePipelineAsyncStatus status_c, WGPURenderPipeline pipeline_ptr, char const *message, void *data){
+        /// Pipeline compilation complete callback
+        std::unique_ptr<pipeline_request> request{static_cast<pipeline_request*>(data)}; // we take ownership of the request data here
+        auto &renderer{request->renderer};
+        auto &logger{renderer.logger};
+        wgpu::RenderPipeline new_pipeline{wgpu::RenderPipeline::Acquire(pipeline_ptr)}; // take ownership so it's released even if we discard it
+        std::chrono::duration<float, std::milli> const compile_time{std::chrono::steady_clock::now() - request->start_time};
+
+        if(auto status{static_cast<wgpu::CreatePipelineAsyncStatus>(status_c)}; status != wgpu::CreatePipelineAsyncStatus::Success) {
+          logger << "ERROR: WebGPU pipeline compilation " << request->generation << " failed after " << compile_time.count() << "ms, status " << enum_wgpu_name<wgpu::CreatePipelineAsyncStatus>(status_c) << (message ? ": " : "") << (message ? message : "") << ", keeping previous pipeline";
+          return;
+        }
+        renderer.pipeline_cache.insert(request->key, new_pipeline);             // cache it even if superseded, as it may be requested again
+        if(request->generation != renderer.pipeline_generation) {
+          logger << "WebGPU: Pipeline compilation " << request->generation << " completed in " << compile_time.count() << "ms but was superseded by " << renderer.pipeline_generation << ", discarding";
+          return;
+        }
+        logger << "WebGPU: Pipeline compilation " << request->generation << " completed in " << compile_time.count() << "ms";
+        renderer.on_pipeline_ready(std::move(new_pipeline), request->key.geometry);
+      },
+      new pipeline_request{                                                     // freed by the callback
+        .renderer{*this},
+        .key{key},
+        .generation{++pipeline_generation},
+        .start_time{std::chrono::steady_clock::now()},
+      }
+    );
+    break;
+  }
+}
+
+void webgpu_renderer::on_pipeline_ready(wgpu::RenderPipeline &&new_pipeline, scene_geometry new_geometry) {
+  /// Swap in a newly compiled pipeline and rebuild the render bundle that uses it
+  /// Both are replaced between frames, so a frame never sees a mismatched pipeline and bundle
+  webgpu.pipeline = std::move(new_pipeline);
+  pipeline_geometry = new_geometry;
+  configure_render_bundle();
+  progressive.tiles.restart();
+  idle.request(idle_scheduler::reason::shader);
+}
+
+wgpu::ShaderModule webgpu_renderer::create_shader_module() const {
+  /// Create a shader module from the current shader code, for render or compute pipelines
+  logger << "WebGPU assembling shaders";
+  wgpu::ShaderModuleWGSLDescriptor shader_module_wgsl_decriptor;
+  if(shader_hash == render::shaders::default_wgsl_source_hash) {
+    shader_module_wgsl_decriptor.code = render::shaders::default_wgsl;          // the unedited default shader compiles from its minified form
+  } else {
+    shader_module_wgsl_decriptor.code = shader_code.c_str();
+  }
+  wgpu::ShaderModuleDescriptor shader_module_descriptor{
+    .nextInChain{&shader_module_wgsl_decriptor},
+    .label{"Shader module 1"},
+  };
+  return webgpu.device.CreateShaderModule(&shader_module_descriptor);
+}
+
+std::vector<wgpu::ConstantEntry> webgpu_renderer::make_pipeline_constants(uint64_t &constants_hash) const {
+  /// The variant's values for the overrides this shader declares, combining them into the hash for pipeline keys
+  /// The entries refer to the variant's names, so are only valid until it next changes
+  std::vector<wgpu::ConstantEntry> constants;
+  for(auto const &constant : variant.get_constants()) {
+    if(std::ranges::find(shader_overrides, constant.name) == shader_overrides.end()) continue; // pipeline creation rejects constants the shader doesn't declare
+    constants.emplace_back(wgpu::ConstantEntry{
+      .key{constant.name.c_str()},
+      .value{constant.value},
+    });
+    constants_hash = fnv1a(std::bit_cast<uint64_t>(constant.value), fnv1a(constant.name, constants_hash));
+  }
+  return constants;
+}
+
+webgpu_renderer::scene_geometry webgpu_renderer::get_target_geometry() const {
+  /// The geometry pipelines should be built for: the one being measured while benchmarking, otherwise the one chosen
+  /// Shaders without a fullscreen triangle entry point can only draw the quad
+  if(!shader_has_fullscreen_entry_point) return scene_geometry::quad;
+  if(geometry_benchmark.is_running()) return static_cast<scene_geometry>(geometry_benchmark.get_configuration());
+  return geometry;
+}
+
+void webgpu_renderer::apply_benchmark_configuration() {
+  /// Switch to the target geometry and path before the next frame, stalling to compile their pipelines if needed
+  /// Used while benchmarking, where every frame must be drawn the way it's attributed to
+  configure_pipeline(pipeline_compile_mode::blocking);
+  configure_render_bundle();
+  configure_compute_pipeline(pipeline_compile_mode::blocking);
+  idle.request(idle_scheduler::reason::shader);
+}
+
+void webgpu_renderer::configure_compute() {
+  /// Configure the layouts and bind groups of the compute path, whose pipeline is only built once it's used
+  logger << "WebGPU configuring compute path";
+  auto const storage_binding_layout{make_bind_group_layout_entry(*compute_target_binding)};
+  compute.texture_format = storage_binding_layout.storageTexture.format;
+  wgpu::BindGroupLayoutDescriptor bind_group_layout_descriptor{
+    .label{"Compute storage bind group layout"},
+    .entryCount{1},
+    .entries{&storage_binding_layout},
+  };
+  compute.storage_bind_group_layout = webgpu.device.CreateBindGroupLayout(&bind_group_layout_descriptor);
+
+  std::array const bind_group_layouts{webgpu.bind_group_layout, compute.storage_bind_group_layout};
+  wgpu::PipelineLayoutDescriptor pipeline_layout_descriptor{
+    .label{"Compute pipeline layout"},
+    .bindGroupLayoutCount{bind_group_layouts.size()},
+    .bindGroupLayouts{bind_group_layouts.data()},
+  };
+  compute.pipeline_layout = webgpu.device.CreatePipelineLayout(&pipeline_layout_descriptor);
+
+  wgpu::BindGroupEntry bind_group_entry{
+    .binding{0},
+    .buffer{uniform_buffer},
+    .size{sizeof(uniforms)},                                                    // the size of one block; its offset is given dynamically
+  };
+  wgpu::BindGroupDescriptor bind_group_descriptor{
+    .label{"Compute uniform bind group"},
+    .layout{webgpu.bind_group_layout},
+    .entryCount{1},
+    .entries{&bind_group_entry},
+  };
+  compute.uniform_bind_group = webgpu.device.CreateBindGroup(&bind_group_descriptor);
+}
+
+void webgpu_renderer::configure_compute_pipeline(pipeline_compile_mode mode) {
+  /// Build the compute path's pipeline for the current shader, variant and workgroup size, if it's in use and they've changed
+  if(!is_compute_target()) return;
+  uint64_t constants_hash{fnv1a_offset_basis};
+  auto constants{make_pipeline_constants(constants_hash)};
+  for(auto const &[parameter, size] : {std::pair{shader_parameters::workgroup_width, compute.workgroup_size.x}, std::pair{shader_parameters::workgroup_height, compute.workgroup_size.y}}) {
+    if(std::ranges::find(shader_overrides, parameter.name) == shader_overrides.end()) continue; // shaders with fixed workgroup sizes just get dispatched for those
+    constants.emplace_back(wgpu::ConstantEntry{
+      .key{parameter.name.data()},                                              // the parameter names are literals, so null terminated
+      .value{static_cast<double>(size)},
+    });
+  }
+  uint64_t const hash{fnv1a(compute.workgroup_size.x, fnv1a(compute.workgroup_size.y, fnv1a(constants_hash, shader_hash)))};
+  if(hash == compute.pipeline_hash) return;                                     // already built, or being built
+  compute.pipeline_hash = hash;
+
+  wgpu::ComputePipelineDescriptor compute_pipeline_descriptor{
+    .label{"Compute pipeline"},
+    .layout{compute.pipeline_layout},
+    .compute{                                                                   // ProgrammableStageDescriptor
+      .module{create_shader_module()},
+      .entryPoint{"cs_main"},
+      .constantCount{constants.size()},
+      .constants{constants.data()},
+    },
+  };
+
+  switch(mode) {
+  case pipeline_compile_mode::blocking:
+    ++compute.generation;                                                       // supersede any compilation still in flight
+    compute.pipeline = webgpu.device.CreateComputePipeline(&compute_pipeline_descriptor);
+    compute.pipeline_workgroup_size = compute.workgroup_size;
+    break;
+  case pipeline_compile_mode::async:
+    webgpu.device.CreateComputePipelineAsync(
+      &compute_pipeline_descriptor,
+      [](WGPUCreatePipelineAsyncStatus status_c, WGPUComputePipeline pipeline_ptr, char const *message, void *data){
+        /// Compute pipeline compilation complete callback
+        std::unique_ptr<compute_pipeline_request> request{static_cast<compute_pipeline_request*>(data)}; // we take ownership of the request data here
+        auto &renderer{request->renderer};
+        auto &logger{renderer.logger};
+        wgpu::ComputePipeline new_pipeline{wgpu::ComputePipeline::Acquire(pipeline_ptr)}; // take ownership so it's released even if we discard it
+        std::chrono::duration<float, std::milli> const compile_time{std::chrono::steady_clock::now() - request->start_time};
+
+        if(auto status{static_cast<wgpu::CreatePipelineAsyncStatus>(status_c)}; status != wgpu::CreatePipelineAsyncStatus::Success) {
+          logger << "ERROR: WebGPU compute pipeline compilation " << request->generation << " failed after " << compile_time.count() << "ms, status " << enum_wgpu_name<wgpu::CreatePipelineAsyncStatus>(status_c) << (message ? ": " : "") << (message ? message : "") << ", keeping previous pipeline";
+          if(request->hash == renderer.compute.pipeline_hash) renderer.compute.pipeline_hash = 0; // so the same inputs can be retried
+          return;
+        }
+        if(request->generation != renderer.compute.generation) {
+          logger << "WebGPU: Compute pipeline compilation " << request->generation << " completed in " << compile_time.count() << "ms but was superseded by " << renderer.compute.generation << ", discarding";
+          return;
+        }
+        logger << "WebGPU: Compute pipeline compilation " << request->generation << " completed in " << compile_time.count() << "ms";
+        renderer.compute.pipeline = std::move(new_pipeline);
+        renderer.compute.pipeline_workgroup_size = request->workgroup_size;
+        renderer.idle.request(idle_scheduler::reason::shader);
+      },
+      new compute_pipeline_request{                                             // freed by the callback
+        .renderer{*this},
+        .hash{hash},
+        .workgroup_size{compute.workgroup_size.x, compute.workgroup_size.y},
+        .generation{++compute.generation},
+        .start_time{std::chrono::steady_clock::now()},
+      }
+    );
+    break;
+  }
+}
+
+bool webgpu_renderer::is_compute_target() const {
+  /// Whether the scene should be shaded by the compute path: the one being measured while benchmarking, otherwise the one chosen
+  if(!shader_has_compute_entry_point) return false;
+  if(compute_benchmark.is_running()) return compute_benchmark.get_configuration() == 1;
+  return compute.enabled;
+}
+
+bool webgpu_renderer::is_compute_active() const {
+  /// Whether this frame's scene is shaded by the compute path, which waits for its first pipeline to be ready
+  /// A shader's pass graph takes precedence, as it replaces the scene entirely
+  return is_compute_target() && compute.pipeline && !is_feedback_active();
+}
+
+void webgpu_renderer::configure_feedback() {
+  /// Build the pass graph of the initial shader, if it declares one
+  feedback.graph = pass_graph::parse(shader_code);
+  configure_feedback_pipelines();
+}
+
+void webgpu_renderer::configure_feedback_pipelines() {
+  /// Compile a pipeline for each pass of the pass graph in the background; the graph replaces the scene once they're all ready
+  /// Each pass draws the shader's vs_fullscreen triangle with its own fragment entry point, into a texture of the graph
+  ++feedback.generation;                                                        // supersede any compilations still in flight
+  feedback.passes.clear();
+  feedback.pipelines_pending = 0;
+  feedback.failed = false;
+  if(feedback.graph.empty()) return;
+  if(!shader_has_fullscreen_entry_point) {
+    logger << "ERROR: WebGPU: Shader passes are drawn with vs_fullscreen, which the shader doesn't declare, so drawing the scene without them";
+    feedback.failed = true;
+    return;
+  }
+
+  uint64_t constants_hash{fnv1a_offset_basis};
+  auto const constants{make_pipeline_constants(constants_hash)};
+  wgpu::ShaderModule const shader_module{create_shader_module()};
+  auto const &passes{feedback.graph.get_passes()};
+  auto const &order{feedback.graph.get_order()};
+  logger << "WebGPU configuring " << order.size() << " pass pipelines, " << passes.size() - order.size() << " passes culled";
+  feedback.passes.resize(passes.size());
+  feedback.pipelines_pending = static_cast<unsigned int>(order.size());
+  for(auto const index : order) {                                               // culled passes never run, so need no pipeline
+    auto const &this_pass{passes[index]};
+    auto &pass_data{feedback.passes[index]};
+
+    std::vector<wgpu::BindGroupLayoutEntry> binding_layouts{
+      make_uniforms_layout_entry(),                                             // as for the scene, including the fragment stage passes draw with
+      {
+        .binding{1},
+        .visibility{wgpu::ShaderStage::Fragment},
+        .sampler{                                                               // SamplerBindingLayout
+          .type{wgpu::SamplerBindingType::Filtering},
+        },
+      },
+    };
+    for(uint32_t input{0}; input != this_pass.inputs.size(); ++input) {
+      binding_layouts.emplace_back(wgpu::BindGroupLayoutEntry{
+        .binding{input + 2},
+        .visibility{wgpu::ShaderStage::Fragment},
+        .texture{                                                               // TextureBindingLayout
+          .sampleType{wgpu::TextureSampleType::Float},
+          .viewDimension{wgpu::TextureViewDimension::e2D},
+        },
+      });
+    }
+    wgpu::BindGroupLayoutDescriptor bind_group_layout_descriptor{
+      .label{"Pass bind group layout"},
+      .entryCount{binding_layouts.size()},
+      .entries{binding_layouts.data()},
+    };
+    pass_data.bind_group_layout = webgpu.device.CreateBindGroupLayout(&bind_group_layout_descriptor);
+    pass_data.bind_groups.resize(size_t{1} << this_pass.inputs.size());
+
+    wgpu::PipelineLayoutDescriptor pipeline_layout_descriptor{
+      .label{"Pass pipeline layout"},
+      .bindGroupLayoutCount{1},
+      .bindGroupLayouts{&pass_data.bind_group_layout},
+    };
+    wgpu::PipelineLayout const pipeline_layout{webgpu.device.CreatePipelineLayout(&pipeline_layout_descriptor)};
+
+    wgpu::ColorTargetState colour_target_state{
+      .format{feedback.texture_format},
+      .blend{nullptr},                                                          // each pass replaces its target's contents
+    };
+    wgpu::FragmentState fragment_state{
+      .module{shader_module},
+      .entryPoint{this_pass.entry_point.c_str()},
+      .constantCount{constants.size()},
+      .constants{constants.data()},
+      .targetCount{1},
+      .targets{&colour_target_state},
+    };
+    wgpu::RenderPipelineDescriptor render_pipeline_descriptor{
+      .label{"Pass render pipeline"},
+      .layout{pipeline_layout},
+      .vertex{                                                                  // VertexState
+        .module{shader_module},
+        .entryPoint{"vs_fullscreen"},
+        .constantCount{constants.size()},
+        .constants{constants.data()},
+        .bufferCount{0},                                                        // the fullscreen triangle is generated from the vertex index
+        .buffers{nullptr},
+      },
+      .primitive{                                                               // PrimitiveState
+        .cullMode{wgpu::CullMode::None},
+      },
+      .multisample{},
+      .fragment{&fragment_state},
+    };
+
+    webgpu.device.CreateRenderPipelineAsync(
+      &render_pipeline_descriptor,
+      [](WGPUCreatePipelineAsyncStatus status_c, WGPURenderPipeline pipeline_ptr, char const *message, void *data){
+        /// Pass pipeline compilation complete callback
+        std::unique_ptr<feedback_pipeline_request> request{static_cast<feedback_pipeline_request*>(data)}; // we take ownership of the request data here
+        auto &renderer{request->renderer};
+        auto &logger{renderer.logger};
+        wgpu::RenderPipeline new_pipeline{wgpu::RenderPipeline::Acquire(pipeline_ptr)}; // take ownership so it's released even if we discard it
+        std::chrono::duration<float, std::milli> const compile_time{std::chrono::steady_clock::now() - request->start_time};
+
+        if(request->generation != renderer.feedback.generation) return;         // superseded by a newer shader or variant, whose passes may differ
+        auto const &name{renderer.feedback.graph.get_passes()[request->pass].name};
+        if(auto status{static_cast<wgpu::CreatePipelineAsyncStatus>(status_c)}; status != wgpu::CreatePipelineAsyncStatus::Success) {
+          logger << "ERROR: WebGPU pass \"" << name << "\" pipeline compilation failed after " << compile_time.count() << "ms, status " << enum_wgpu_name<wgpu::CreatePipelineAsyncStatus>(status_c) << (message ? ": " : "") << (message ? message : "") << ", drawing the scene without its passes";
+          renderer.feedback.failed = true;
+          return;
+        }
+        renderer.feedback.passes[request->pass].pipeline = std::move(new_pipeline);
+        if(--renderer.feedback.pipelines_pending != 0) return;
+        logger << "WebGPU: Pass graph of " << renderer.feedback.graph.get_order().size() << " passes ready, the last compiled in " << compile_time.count() << "ms";
+        renderer.feedback.graph.invalidate();                                   // so every pass draws with its new pipeline
+        renderer.idle.request(idle_scheduler::reason::shader);
+      },
+      new feedback_pipeline_request{                                            // freed by the callback
+        .renderer{*this},
+        .pass{index},
+        .generation{feedback.generation},
+        .start_time{std::chrono::steady_clock::now()},
+      }
+    );
+  }
+}
+
+bool webgpu_renderer::is_feedback_active() const {
+  /// Whether this frame's scene is drawn by the shader's pass graph, which waits for all of its pipelines to be ready
+  return !feedback.graph.empty() && !feedback.failed && feedback.pipelines_pending == 0;
+}
+
+void webgpu_renderer::log_pipeline_cache_stats(std::string const &event) const {
+  /// Report pipeline cache usage after a lookup
+  logger << "WebGPU: Pipeline cache " << event << ", "
+         << pipeline_cache.stats.hits << " hits, "
+         << pipeline_cache.stats.misses << " misses, "
+         << pipeline_cache.stats.evictions << " evictions, "
+         << pipeline_cache.size() << "/" << pipeline_cache.get_capacity() << " entries";
 }
 
 void webgpu_renderer::build_scene() {
@@ -631,6 +1360,55 @@ void webgpu_renderer::build_scene() {
   // set up test buffers
 
   // create buffers
+  {
+    // uniform buffer
+    wgpu::BufferDescriptor uniform_buffer_desecriptor{
+      .label{"Uniform buffer 1"},
+      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform},
+      .size{uniform_blocks.get_buffer_size()},
+    };
+    uniform_buffer = webgpu.device.CreateBuffer(&uniform_buffer_desecriptor);
+
+    // uniform staging buffers, created mapped so the first frames can write straight into them
+    wgpu::BufferDescriptor staging_buffer_descriptor{
+      .label{"Uniform staging buffer"},
+      .usage{wgpu::BufferUsage::MapWrite | wgpu::BufferUsage::CopySrc},
+      .size{uniform_blocks.get_buffer_size()},
+      .mappedAtCreation{true},
+    };
+    for(unsigned int slot{0}; slot != uniform_staging.slots; ++slot) {
+      uniform_staging.buffers.emplace_back(webgpu.device.CreateBuffer(&staging_buffer_descriptor));
+    }
+  }
+  {
+    // instance buffer
+    wgpu::BufferDescriptor instance_buffer_descriptor{
+      .label{"Instance buffer 1"},
+      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Storage},
+      .size{max_instances * sizeof(instance)},
+    };
+    instance_buffer = webgpu.device.CreateBuffer(&instance_buffer_descriptor);
+  }
+  {
+    // indirect draw arguments buffer
+    wgpu::BufferDescriptor indirect_buffer_descriptor{
+      .label{"Indirect buffer 1"},
+      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Indirect | wgpu::BufferUsage::Storage},
+      .size{sizeof(indirect_indexed_command)},
+    };
+    indirect_buffer = webgpu.device.CreateBuffer(&indirect_buffer_descriptor);
+  }
+
+  configure_render_bundle();
+
+  // populate buffer contents
+  upload_instances();
+}
+
+void webgpu_renderer::build_quad_buffers() {
+  /// Create and fill the vertex and index buffers for quad geometry, if they don't already exist
+  /// The fullscreen triangle needs neither, so they're only built the first time a quad pipeline is
+  if(vertex_buffer) return;
   {
     // vertex buffer
     wgpu::BufferDescriptor vertex_buffer_descriptor{
@@ -649,19 +1427,7 @@ void webgpu_renderer::build_scene() {
     };
     index_buffer = webgpu.device.CreateBuffer(&index_buffer_descriptor);
   }
-  {
-    // uniform buffer
-    wgpu::BufferDescriptor uniform_buffer_desecriptor{
-      .label{"Uniform buffer 1"},
-      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform},
-      .size{sizeof(uniform_data)},
-    };
-    uniform_buffer = webgpu.device.CreateBuffer(&uniform_buffer_desecriptor);
-  }
-
-  configure_render_bundle();
 
-  // populate buffer contents
   webgpu.queue.WriteBuffer(
     vertex_buffer,                                                              // buffer
     0,                                                                          // offset
@@ -678,12 +1444,12 @@ void webgpu_renderer::build_scene() {
 }
 
 void webgpu_renderer::configure_render_bundle() {
-  /// Set up render bundle
+  /// Set up the render bundle drawing the scene with the current pipeline
   // uniform bind group
   wgpu::BindGroupEntry bind_group_entry{
     .binding{0},
     .buffer{uniform_buffer},
-    .size{sizeof(uniforms)},
+    .size{sizeof(uniforms)},                                                    // the size of one block; its offset is given dynamically
   };
   wgpu::BindGroupDescriptor bind_group_descriptor{
     .label{"Bind group 1"},
@@ -699,78 +1465,936 @@ void webgpu_renderer::configure_render_bundle() {
     .colorFormatCount{1},
     .colorFormats{&webgpu.surface_preferred_format},
   };
+  wgpu::RenderBundleDescriptor render_bundle_descriptor{
+    .label{"Render bundle 1"},
+  };
+
   wgpu::RenderBundleEncoder render_bundle_encoder{webgpu.device.CreateRenderBundleEncoder(&render_bundle_encoder_descriptor)};
+  render_bundle_encoder.SetPipeline(webgpu.pipeline);                           // select which render pipeline to use
+  render_bundle_encoder.SetBindGroup(0, bind_group, 1, &scene_uniform_offset);  // groupIndex, group, dynamicOffsetCount, dynamicOffsets
+  switch(pipeline_geometry) {
+  case scene_geometry::quad:
+    render_bundle_encoder.SetVertexBuffer(0, vertex_buffer, 0, vertex_buffer.GetSize()); // slot, buffer, offset, size
+    render_bundle_encoder.SetVertexBuffer(1, instance_buffer, 0, instance_buffer.GetSize());
+    render_bundle_encoder.SetIndexBuffer(index_buffer, wgpu::IndexFormat::Uint16, 0, index_buffer.GetSize()); // buffer, format, offset, size
+    render_bundle_encoder.DrawIndexedIndirect(indirect_buffer, 0);              // the instance count is read from the buffer, so changing it needs no new bundle
+    break;
+  case scene_geometry::fullscreen_triangle:
+    render_bundle_encoder.Draw(3);                                              // vertexCount; positions come from the vertex index, so nothing else is bound
+    break;
+  }
+  render_bundle = render_bundle_encoder.Finish(&render_bundle_descriptor);      // replacing the bundle from any previous pipeline
+}
 
-  render_bundle_encoder.SetPipeline(webgpu.pipeline);                         // select which render pipeline to use
-  render_bundle_encoder.SetVertexBuffer(0, vertex_buffer, 0, vertex_buffer.GetSize()); // slot, buffer, offset, size
-  render_bundle_encoder.SetIndexBuffer(index_buffer, wgpu::IndexFormat::Uint16, 0, index_buffer.GetSize()); // buffer, format, offset, size
-  render_bundle_encoder.SetBindGroup(0, bind_group);                          // groupIndex, group, dynamicOffsetCount = 0, dynamicOffsets = nullptr
+void webgpu_renderer::update_offscreen_target() {
+  /// Choose this frame's render scale, and create, resize or release the offscreen scene texture to match
+  if(offscreen.automatic && !progressive.enabled && profiler.get_frames_read() != scale_controller_frames_read) { // progressive frames only draw part of the scene, so aren't representative
+    scale_controller_frames_read = profiler.get_frames_read();
+    if(scale_controller.add_sample(get_latest_scene_time())) {
+      offscreen.scale = scale_controller.get_scale();
+      logger << "WebGPU: Automatic render scale changed to " << offscreen.scale;
+    }
+  }
 
-  render_bundle_encoder.DrawIndexed(index_data.size() * decltype(index_data)::value_type::size()); // indexCount, instanceCount = 1, firstIndex = 0, baseVertex = 0, firstInstance = 0
+  auto scale_dimension{[&](unsigned int viewport_dimension){
+    return std::max(1u, static_cast<unsigned int>(std::round(static_cast<float>(viewport_dimension) * offscreen.scale)));
+  }};
+  vec2ui const target_size{scale_dimension(window.viewport_size.x), scale_dimension(window.viewport_size.y)};
 
-  wgpu::RenderBundleDescriptor render_bundle_descriptor{
-    .label{"Render bundle 1"},
+  bool const feedback_active{is_feedback_active()};
+  if(feedback_active) {
+    update_feedback_textures(target_size);                                      // the pass graph draws into its own textures at the same scale
+  } else {
+    update_feedback_textures({});
+  }
+
+  bool const compute_active{is_compute_active()};                               // the compute path always writes the offscreen texture, then blits it
+  if((target_size == window.viewport_size && !progressive.enabled && !compute_active) || feedback_active) { // at full scale, render straight to the viewport without the blit
+    if(!offscreen.texture) return;
+    offscreen.texture.Destroy();
+    offscreen.texture = {};
+    offscreen.texture_view = {};
+    offscreen.bind_group = {};
+    offscreen.storage_bind_group = {};
+    offscreen.size = {};
+    idle.request(idle_scheduler::reason::viewport);
+    return;
+  }
+  wgpu::TextureFormat const format{compute_active ? compute.texture_format : webgpu.surface_preferred_format};
+  if(offscreen.texture && target_size == offscreen.size && format == offscreen.format && compute_active == static_cast<bool>(offscreen.storage_bind_group)) return; // formats may match but usages differ
+
+  if(offscreen.texture) offscreen.texture.Destroy();
+  wgpu::TextureDescriptor texture_descriptor{
+    .label{"Offscreen scene texture"},
+    .usage{compute_active ? wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding : wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding},
+    .dimension{wgpu::TextureDimension::e2D},
+    .size{                                                                      // Extent3D
+      .width{ target_size.x},
+      .height{target_size.y},
+      .depthOrArrayLayers{1},
+    },
+    .format{format},                                                            // matches the viewport, so the scene render bundles work with either target
+    .mipLevelCount{1},
+    .sampleCount{1},
+  };
+  offscreen.texture = webgpu.device.CreateTexture(&texture_descriptor);
+  offscreen.texture_view = offscreen.texture.CreateView();
+  offscreen.size = target_size;
+  offscreen.format = format;
+  progressive.contents_valid = false;
+  progressive.tiles.restart();                                                  // the new texture may be the same size, after switching to or from the compute path
+
+  std::array bind_group_entries{
+    wgpu::BindGroupEntry{
+      .binding{0},
+      .sampler{offscreen.sampler},
+    },
+    wgpu::BindGroupEntry{
+      .binding{1},
+      .textureView{offscreen.texture_view},
+    },
+  };
+  wgpu::BindGroupDescriptor bind_group_descriptor{
+    .label{"Blit bind group"},
+    .layout{offscreen.bind_group_layout},
+    .entryCount{bind_group_entries.size()},
+    .entries{bind_group_entries.data()},
+  };
+  offscreen.bind_group = webgpu.device.CreateBindGroup(&bind_group_descriptor);
+
+  offscreen.storage_bind_group = {};
+  if(compute_active) {
+    wgpu::BindGroupEntry storage_bind_group_entry{
+      .binding{0},
+      .textureView{offscreen.texture_view},
+    };
+    wgpu::BindGroupDescriptor storage_bind_group_descriptor{
+      .label{"Compute storage bind group"},
+      .layout{compute.storage_bind_group_layout},
+      .entryCount{1},
+      .entries{&storage_bind_group_entry},
+    };
+    offscreen.storage_bind_group = webgpu.device.CreateBindGroup(&storage_bind_group_descriptor);
+  }
+
+  logger << "WebGPU: Rendering scene at " << offscreen.size << " for viewport " << window.viewport_size << ", scale " << offscreen.scale;
+  idle.request(idle_scheduler::reason::viewport);
+}
+
+void webgpu_renderer::update_feedback_textures(vec2ui const &target_size) {
+  /// Give each allocation of the pass graph its render targets of the given size from the texture pool, or return them all
+  /// to the pool for a zero size; resizing returns the old ones, so going back to a recent size reuses them
+  size_t const allocation_count{target_size == vec2ui{} ? 0 : feedback.graph.get_allocation_count()};
+  if(target_size == feedback.size && feedback.allocations.size() == allocation_count) return;
+
+  texture_key const old_key{
+    .size{feedback.size.x, feedback.size.y},
+    .format{feedback.texture_format},
   };
-  render_bundles.emplace_back(render_bundle_encoder.Finish(&render_bundle_descriptor));
+  for(auto &allocation : feedback.allocations) {
+    for(unsigned int side{0}; side != allocation.sides; ++side) {
+      texture_pool.release(old_key, std::move(allocation.textures[side]));
+    }
+  }
+  feedback.allocations.clear();
+  feedback.size = {};
+  if(allocation_count == 0) return;
+
+  texture_key const key{
+    .size{target_size.x, target_size.y},
+    .format{feedback.texture_format},
+  };
+  auto const create_texture{[&](texture_key const &new_key){
+    wgpu::TextureDescriptor texture_descriptor{
+      .label{"Pass texture"},
+      .usage{wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding},
+      .dimension{wgpu::TextureDimension::e2D},
+      .size{                                                                    // Extent3D
+        .width{ new_key.size.x},
+        .height{new_key.size.y},
+        .depthOrArrayLayers{1},
+      },
+      .format{new_key.format},
+      .mipLevelCount{1},
+      .sampleCount{1},
+    };
+    return webgpu.device.CreateTexture(&texture_descriptor);
+  }};
+  unsigned int const created_before{texture_pool.stats.created};
+  unsigned int render_targets{0};
+  feedback.allocations.resize(allocation_count);
+  for(auto const &this_texture : feedback.graph.get_textures()) {
+    if(this_texture.allocation == render_graph::no_allocation) continue;        // only used by culled passes
+    auto &sides{feedback.allocations[this_texture.allocation].sides};
+    sides = std::max(sides, this_texture.transient ? 1u : 2u);
+  }
+  for(auto &allocation : feedback.allocations) {
+    for(unsigned int side{0}; side != allocation.sides; ++side) {
+      allocation.textures[side] = texture_pool.acquire(key, create_texture);
+      allocation.views[side] = allocation.textures[side].CreateView();
+      ++render_targets;
+
+      std::array bind_group_entries{
+        wgpu::BindGroupEntry{
+          .binding{0},
+          .sampler{offscreen.sampler},
+        },
+        wgpu::BindGroupEntry{
+          .binding{1},
+          .textureView{allocation.views[side]},
+        },
+      };
+      wgpu::BindGroupDescriptor bind_group_descriptor{
+        .label{"Pass texture blit bind group"},
+        .layout{offscreen.bind_group_layout},
+        .entryCount{bind_group_entries.size()},
+        .entries{bind_group_entries.data()},
+      };
+      allocation.blit_bind_groups[side] = webgpu.device.CreateBindGroup(&bind_group_descriptor);
+    }
+  }
+  for(auto &pass_data : feedback.passes) {
+    std::ranges::fill(pass_data.bind_groups, wgpu::BindGroup{});                // they bound the previous textures
+  }
+  feedback.size = {target_size.x, target_size.y};
+  feedback.needs_clear = true;
+  feedback.graph.invalidate();
+  idle.request(idle_scheduler::reason::viewport);
+  logger << "WebGPU: Pass graph textures at " << feedback.size << ", " << render_targets << " render targets, " << texture_pool.stats.created - created_before << " newly created";
+  log_feedback_memory();
+}
+
+void webgpu_renderer::log_feedback_memory() const {
+  /// Report how much memory the pass graph's render targets take, and how much sharing them between transient textures saves
+  auto const &report{feedback.graph.get_memory_report()};
+  uint64_t const render_target_bytes{uint64_t{feedback.size.x} * feedback.size.y * 8};  // RGBA16Float
+  constexpr float megabyte{1024.0f * 1024.0f};
+  logger << "WebGPU: Pass graph memory: " << report.textures << " textures in " << report.allocations << " allocations, "
+         << report.with_aliasing << " render targets instead of " << report.without_aliasing << ", "
+         << static_cast<float>(report.with_aliasing * render_target_bytes) / megabyte << "MB, "
+         << static_cast<float>((report.without_aliasing - report.with_aliasing) * render_target_bytes) / megabyte << "MB saved by aliasing";
+}
+
+float webgpu_renderer::get_latest_scene_time() const {
+  /// GPU time of the scene in the most recent frame read back, from whichever pass shaded it
+  gpu_scope scope{gpu_scope::scene};
+  if(is_feedback_active()) {
+    scope = gpu_scope::feedback;
+  } else if(is_compute_active()) {
+    scope = gpu_scope::compute;
+  }
+  return profiler.get_latest_scope_time(std::to_underlying(scope));
+}
+
+void webgpu_renderer::update_benchmarks() {
+  /// Feed whichever benchmark is running each new scene time, switching configuration when it moves to its next phase
+  auto *benchmark{geometry_benchmark.is_running() ? &geometry_benchmark : compute_benchmark.is_running() ? &compute_benchmark : nullptr};
+  if(!benchmark) return;
+  idle.request(idle_scheduler::reason::benchmark);                              // keep drawing, so there's something to measure
+  if(profiler.get_frames_read() == benchmark_frames_read) return;
+  benchmark_frames_read = profiler.get_frames_read();
+  if(!benchmark->add_sample(get_latest_scene_time())) return;
+  apply_benchmark_configuration();
+  if(benchmark->is_running()) return;
+
+  bool const geometry_finished{benchmark == &geometry_benchmark};
+  for(unsigned int configuration{0}; configuration != alternating_benchmark::configurations; ++configuration) {
+    std::string_view const name{geometry_finished ? magic_enum::enum_name(static_cast<scene_geometry>(configuration)) : configuration == 0 ? "fragment" : "compute"};
+    auto const summary{benchmark->get_summary(configuration)};
+    logger << "WebGPU: " << (geometry_finished ? "Geometry" : "Compute") << " benchmark " << name << ": scene GPU time min " << summary.min << "ms, avg " << summary.avg << "ms, p50 " << summary.p50 << "ms, p99 " << summary.p99 << "ms (" << summary.count << " samples)";
+  }
 }
 
 void webgpu_renderer::draw(vec2f const& input) {
-  /// Draw a frame
-  {
-    // set up uniform data
-    uniform_data.input = input;
-
-    webgpu.queue.WriteBuffer(
-      uniform_buffer,                                                           // buffer
-      0,                                                                        // offset
-      &uniform_data,                                                            // data
-      sizeof(uniform_data)                                                      // size
-    );
+  /// Draw a frame, unless nothing visible has changed since the last one, or the GPU is still busy with earlier frames
+  auto const input_time{frame_pacer::clock::now()};                             // the input was sampled just before drawing
+  uniform_data.modify([&](uniforms &data){
+    data.input = input;
+  });
+  if(uniform_data.is_dirty()) idle.request(idle_scheduler::reason::uniforms);
+  update_surface_size();
+  update_benchmarks();                                                          // first, as switching configuration may change the offscreen target
+  update_offscreen_target();
+  texture_pool.end_frame();
+  bool const feedback_active{is_feedback_active()};
+  bool const compute_active{is_compute_active()};
+  if(feedback_active && feedback.graph.has_feedback()) idle.request(idle_scheduler::reason::feedback);
+  if(progressive.enabled && !compute_active && !feedback_active) {              // the compute path and pass graph draw the whole scene at once
+    if(progressive.tiles_size != offscreen.size) {
+      progressive.tiles_size = offscreen.size;
+      progressive.tiles.configure(offscreen.size.x, offscreen.size.y, progressive.tile_size);
+    }
+    if(progressive.uniform_version != uniform_data.get_version()) {
+      progressive.uniform_version = uniform_data.get_version();
+      progressive.tiles.restart();
+    }
+    if(!progressive.tiles.is_complete()) idle.request(idle_scheduler::reason::progressive);
   }
+
+  if(++frame_count % stats_log_interval == 0) log_frame_stats();
+  if(!idle.is_idle() && !pacer.can_submit()) return;                            // drawing now would only queue behind earlier frames, adding latency, so keep the redraw pending
+  if(!idle.should_draw()) return;                                               // nothing visible has changed, so leave the last presented frame on screen
+
   {
-    wgpu::CommandEncoderDescriptor command_encoder_descriptor{
-      .label = "Command encoder 1"
-    };
-    wgpu::CommandEncoder command_encoder{webgpu.device.CreateCommandEncoder(&command_encoder_descriptor)};
+    // the descriptors are prebuilt in the frame context, so a frame only fills in what changes
+    auto &context{frame_context};
+    if(!acquire_surface_texture()) return;
+    context.surface_view = context.surface_texture.texture.CreateView();
+    wgpu::CommandEncoder command_encoder{webgpu.device.CreateCommandEncoder(&context.command_encoder_descriptor)};
+
+    profiler.begin_frame();
+
+    // upload uniform data, sub-allocated from the uniform buffer, ahead of every pass that reads it
+    if(uniform_data.is_dirty()) {
+      uniform_blocks.begin_frame();
+      [[maybe_unused]] auto const uniform_offset{uniform_blocks.push(uniform_data.get())};
+      assert(uniform_offset == scene_uniform_offset);                           // the render bundle expects the scene uniforms first
+      upload_uniforms(command_encoder);
+      uniform_data.mark_uploaded();
+    } else {
+      uniform_data.mark_skipped();                                              // unchanged, so keep drawing from the blocks uploaded last time
+    }
+
+    if(feedback_active) {
+      encode_feedback_passes(command_encoder);
+    } else if(compute_active) {
+      encode_compute_pass(command_encoder);
+    } else {
+      // scene render pass
+      command_encoder.PushDebugGroup("Scene render pass group");
+
+      bool const accumulate{progressive.enabled && progressive.contents_valid}; // progressive rendering draws over the tiles from previous frames
+      context.scene_colour_attachment.view = offscreen.texture ? offscreen.texture_view : context.surface_view; // render at reduced scale if we have an offscreen target
+      context.scene_colour_attachment.loadOp = accumulate ? wgpu::LoadOp::Load : wgpu::LoadOp::Clear;
+      context.scene_render_pass_descriptor.timestampWrites = profiler.get_timestamp_writes(std::to_underlying(gpu_scope::scene));
+
+      wgpu::RenderPassEncoder render_pass_encoder{command_encoder.BeginRenderPass(&context.scene_render_pass_descriptor)};
+
+      if(progressive.enabled) {
+        for(auto const &tile : progressive.tiles.next_batch()) {                // once the image is complete, this pass is left empty so the profiler's timestamps stay consistent
+          render_pass_encoder.SetScissorRect(tile.x, tile.y, tile.width, tile.height); // scissor is pass state, which bundles inherit
+          render_pass_encoder.ExecuteBundles(1, &render_bundle);
+        }
+        progressive.contents_valid = true;
+      } else {
+        render_pass_encoder.ExecuteBundles(1, &render_bundle);
+      }
 
+      render_pass_encoder.End();
+      command_encoder.PopDebugGroup();
+    }
+    if(gallery.enabled) encode_gallery_pass(command_encoder);
     {
-      // set up render pass
-      command_encoder.PushDebugGroup("Render pass group 1");
-      wgpu::TextureView texture_view{webgpu.swapchain.GetCurrentTextureView()};
-      if(!texture_view) throw std::runtime_error{"Could not get current texture view from swap chain"};
-
-      wgpu::RenderPassColorAttachment render_pass_colour_attachment{
-        .view{texture_view},
-        .loadOp{wgpu::LoadOp::Clear},
-        .storeOp{wgpu::StoreOp::Store},
-        .clearValue{wgpu::Color{0, 0.5, 0.5, 1.0}},
-      };
+      // composite render pass: upscale the scene if it was rendered offscreen, then draw the GUI over it at native resolution
+      command_encoder.PushDebugGroup("Composite render pass group");
+
+      wgpu::BindGroup const *blit_bind_group{nullptr};                          // the scene's texture to upscale, unless it was drawn straight to the viewport
+      if(feedback_active) {
+        auto const output{feedback.graph.get_output()};
+        auto const &output_texture{feedback.graph.get_textures()[output]};
+        blit_bind_group = &feedback.allocations[output_texture.allocation].blit_bind_groups[output_texture.current];
+      } else if(offscreen.texture) {
+        blit_bind_group = &offscreen.bind_group;
+      }
+
+      context.composite_colour_attachment.view = context.surface_view;
+      context.composite_colour_attachment.loadOp = blit_bind_group ? wgpu::LoadOp::Clear : wgpu::LoadOp::Load; // the blit covers everything, so there's nothing to load
+      context.composite_render_pass_descriptor.timestampWrites = profiler.get_timestamp_writes(std::to_underlying(gpu_scope::composite));
+
+      wgpu::RenderPassEncoder render_pass_encoder{command_encoder.BeginRenderPass(&context.composite_render_pass_descriptor)};
+
+      if(blit_bind_group) {
+        render_pass_encoder.SetPipeline(offscreen.pipeline);
+        render_pass_encoder.SetBindGroup(0, *blit_bind_group);
+        render_pass_encoder.Draw(3);                                            // a single triangle covering the viewport
+      }
+
+      auto &draw_data{*ImGui::GetDrawData()};
+      if(draw_data.DisplaySize.x > 0.0f && draw_data.DisplaySize.y > 0.0f) {    // match the surface we actually configured, which may be capped below the full device pixel ratio
+        draw_data.FramebufferScale = ImVec2(static_cast<float>(window.viewport_size.x) / draw_data.DisplaySize.x,
+                                            static_cast<float>(window.viewport_size.y) / draw_data.DisplaySize.y);
+      }
+      ImGui_ImplWGPU_RenderDrawData(&draw_data, render_pass_encoder.Get());     // render the outstanding GUI draw data
+
+      render_pass_encoder.End();
+      command_encoder.PopDebugGroup();
+    }
+    profiler.resolve(command_encoder);
+
+    wgpu::CommandBuffer command_buffer{command_encoder.Finish(&context.command_buffer_descriptor)};
+
+    webgpu.queue.Submit(1, &command_buffer);
+    profiler.end_frame();
+    if(auto const slot{std::exchange(uniform_staging.pending_slot, std::nullopt)}) {
+      uniform_staging.ring.submit(*slot);
+      uniform_staging.buffers[*slot].MapAsync(                                  // ready for writing again once the GPU has copied from it
+        wgpu::MapMode::Write,
+        0,                                                                      // offset
+        uniform_blocks.get_buffer_size(),                                       // size
+        [](WGPUBufferMapAsyncStatus status_c, void *data){
+          /// Uniform staging buffer mapped callback
+          auto const &request{*static_cast<uniform_staging_data::map_request*>(data)};
+          auto &renderer{request.renderer};
+          if(auto status{static_cast<wgpu::BufferMapAsyncStatus>(status_c)}; status != wgpu::BufferMapAsyncStatus::Success) {
+            renderer.logger << "ERROR: WebGPU: Uniform staging buffer " << request.slot << " couldn't be mapped, status " << magic_enum::enum_name(status) << ", leaving it out of the ring";
+            return;
+          }
+          renderer.uniform_staging.ring.release(request.slot);
+        },
+        &uniform_staging.map_requests[*slot]
+      );
+    }
+    context.scene_colour_attachment.view = {};                                  // don't keep this frame's surface texture alive once it's submitted
+    context.composite_colour_attachment.view = {};
+    context.surface_view = {};
+    context.surface_texture.texture = {};
+
+    uint64_t const frame{pacer.submit(input_time, frame_pacer::clock::now())};
+    auto &request{work_done_requests[frame % work_done_requests.size()]};       // free to reuse, as the frame that last used it has completed
+    request.frame = frame;
+    webgpu.queue.OnSubmittedWorkDone(
+      [](WGPUQueueWorkDoneStatus status_c, void *data){
+        /// Frame work done callback
+        auto const &done_request{*static_cast<work_done_request*>(data)};
+        auto &renderer{done_request.renderer};
+        if(auto status{static_cast<wgpu::QueueWorkDoneStatus>(status_c)}; status != wgpu::QueueWorkDoneStatus::Success) {
+          renderer.logger << "ERROR: WebGPU: Work for frame " << done_request.frame << " didn't complete, status " << magic_enum::enum_name(status);
+        }
+        renderer.pacer.complete(done_request.frame, frame_pacer::clock::now()); // even on failure, so later frames aren't deferred forever
+      },
+      &request
+    );
+  }
+}
+
+void webgpu_renderer::encode_compute_pass(wgpu::CommandEncoder const &command_encoder) {
+  /// Shade the scene into the offscreen texture with the compute pipeline, one invocation per pixel
+  command_encoder.PushDebugGroup("Compute pass group");
+
+  wgpu::ComputePassDescriptor compute_pass_descriptor{
+    .label{"Compute pass"},
+    .timestampWrites{profiler.get_compute_timestamp_writes(std::to_underlying(gpu_scope::compute))},
+  };
+  wgpu::ComputePassEncoder compute_pass_encoder{command_encoder.BeginComputePass(&compute_pass_descriptor)};
+
+  compute_pass_encoder.SetPipeline(compute.pipeline);
+  compute_pass_encoder.SetBindGroup(0, compute.uniform_bind_group, 1, &scene_uniform_offset); // groupIndex, group, dynamicOffsetCount, dynamicOffsets
+  compute_pass_encoder.SetBindGroup(1, offscreen.storage_bind_group);
+  vec2ui const workgroups{                                                      // enough to cover every pixel; the shader skips invocations beyond the edges
+    (offscreen.size.x + compute.pipeline_workgroup_size.x - 1) / compute.pipeline_workgroup_size.x,
+    (offscreen.size.y + compute.pipeline_workgroup_size.y - 1) / compute.pipeline_workgroup_size.y,
+  };
+  compute_pass_encoder.DispatchWorkgroups(workgroups.x, workgroups.y);          // workgroupCountX, workgroupCountY
+
+  compute_pass_encoder.End();
+  command_encoder.PopDebugGroup();
+  ++compute.stats.dispatches;
+  compute.stats.workgroups += uint64_t{workgroups.x} * workgroups.y;
+}
 
-      render_pass_descriptor = {
-        .label{"Render pass 1"},
-        .colorAttachmentCount{1},
-        .colorAttachments{&render_pass_colour_attachment},
+void webgpu_renderer::encode_feedback_passes(wgpu::CommandEncoder const &command_encoder) {
+  /// Draw the passes of the pass graph whose inputs have changed since they last ran, each into one side of its target's pair
+  command_encoder.PushDebugGroup("Pass graph group");
+  if(feedback.needs_clear) {                                                    // so passes reading a previous frame start from black, not leftovers
+    for(auto const &allocation : feedback.allocations) {
+      for(unsigned int side{0}; side != allocation.sides; ++side) {
+        wgpu::RenderPassColorAttachment clear_colour_attachment{
+          .view{allocation.views[side]},
+          .loadOp{wgpu::LoadOp::Clear},
+          .storeOp{wgpu::StoreOp::Store},
+          .clearValue{wgpu::Color{0, 0, 0, 0}},
+        };
+        wgpu::RenderPassDescriptor clear_render_pass_descriptor{
+          .label{"Pass texture clear"},
+          .colorAttachmentCount{1},
+          .colorAttachments{&clear_colour_attachment},
+        };
+        command_encoder.BeginRenderPass(&clear_render_pass_descriptor).End();
+      }
+    }
+    feedback.needs_clear = false;
+  }
+
+  auto const &passes{feedback.graph.get_passes()};
+  auto const &textures{feedback.graph.get_textures()};
+  auto const scheduled{feedback.graph.schedule(uniform_data.get_version())};
+  for(size_t index{0}; index != scheduled.size(); ++index) {
+    auto const &step{scheduled[index]};
+    auto const &this_pass{passes[step.pass]};
+    auto &pass_data{feedback.passes[step.pass]};
+    auto &bind_group{pass_data.bind_groups[step.input_sides]};
+    if(!bind_group) {
+      std::array<wgpu::BindGroupEntry, pass_graph::max_inputs + 2> bind_group_entries{ // on the stack, as these are created during the frame
+        wgpu::BindGroupEntry{
+          .binding{0},
+          .buffer{uniform_buffer},
+          .size{sizeof(uniforms)},                                              // the size of one block; its offset is given dynamically
+        },
+        wgpu::BindGroupEntry{
+          .binding{1},
+          .sampler{offscreen.sampler},
+        },
+      };
+      for(uint32_t input{0}; input != this_pass.inputs.size(); ++input) {
+        bind_group_entries[input + 2] = {
+          .binding{input + 2},
+          .textureView{feedback.allocations[textures[this_pass.inputs[input]].allocation].views[(step.input_sides >> input) & 1u]},
+        };
+      }
+      wgpu::BindGroupDescriptor bind_group_descriptor{
+        .label{"Pass bind group"},
+        .layout{pass_data.bind_group_layout},
+        .entryCount{this_pass.inputs.size() + 2},
+        .entries{bind_group_entries.data()},
       };
+      bind_group = webgpu.device.CreateBindGroup(&bind_group_descriptor);
+    }
 
-      wgpu::RenderPassEncoder render_pass_encoder{command_encoder.BeginRenderPass(&render_pass_descriptor)};
+    wgpu::RenderPassColorAttachment render_pass_colour_attachment{
+      .view{feedback.allocations[textures[this_pass.target].allocation].views[step.target_side]},
+      .loadOp{wgpu::LoadOp::Clear},
+      .storeOp{wgpu::StoreOp::Store},
+      .clearValue{wgpu::Color{0, 0, 0, 1.0}},
+    };
+    wgpu::RenderPassDescriptor pass_render_pass_descriptor{
+      .label{this_pass.name.c_str()},
+      .colorAttachmentCount{1},
+      .colorAttachments{&render_pass_colour_attachment},
+      .timestampWrites{profiler.get_timestamp_writes(std::to_underlying(gpu_scope::feedback), index == 0, index + 1 == scheduled.size())}, // one scope spanning every pass drawn
+    };
+    wgpu::RenderPassEncoder render_pass_encoder{command_encoder.BeginRenderPass(&pass_render_pass_descriptor)};
+    render_pass_encoder.SetPipeline(pass_data.pipeline);
+    render_pass_encoder.SetBindGroup(0, bind_group, 1, &scene_uniform_offset);  // groupIndex, group, dynamicOffsetCount, dynamicOffsets
+    render_pass_encoder.Draw(3);                                                // a single triangle covering the target
+    render_pass_encoder.End();
+  }
+  command_encoder.PopDebugGroup();
+}
 
-      render_pass_encoder.ExecuteBundles(render_bundles.size(), render_bundles.data());
+void webgpu_renderer::log_frame_stats() const {
+  /// Report how often frames were skipped as idle, and how often drawn frames skipped uniform uploads
+  auto const &idle_stats{idle.stats};
+  uint64_t const frames{idle_stats.drawn + idle_stats.skipped};
+  logger << "WebGPU: Frames drawn: " << idle_stats.drawn << ", idle " << idle_stats.skipped
+         << " (" << (frames == 0 ? 0u : idle_stats.skipped * 100u / frames) << "% of " << frames << " frames)";
+
+  auto const &uniform_stats{uniform_data.stats};
+  unsigned int const uniform_frames{uniform_stats.uploads + uniform_stats.skips};
+  logger << "WebGPU: Uniform uploads: " << uniform_stats.uploads << ", skipped " << uniform_stats.skips
+         << " (" << (uniform_frames == 0 ? 0u : uniform_stats.skips * 100u / uniform_frames) << "% of " << uniform_frames << " drawn frames); "
+         << uniform_staging.stats.mapped_uploads << " through mapped staging buffers, " << uniform_staging.stats.queue_uploads << " through the queue";
+
+  auto const &pacer_stats{pacer.stats};
+  auto const latency{pacer.get_latency_summary()};
+  logger << "WebGPU: Frame pacing: " << pacer_stats.completed << " frames completed, " << pacer_stats.deferred << " deferred with "
+         << pacer.get_max_frames_in_flight() << " in flight; input to completion latency p50 " << latency.p50 << "ms, p99 " << latency.p99
+         << "ms, max " << pacer_stats.max_latency_ms << "ms, present mode " << magic_enum::enum_name(present_mode);
+
+  if(feedback.graph.empty()) return;
+  auto const &graph_stats{feedback.graph.stats};
+  auto const &pool_stats{texture_pool.stats};
+  logger << "WebGPU: Pass graph: " << graph_stats.passes_run << " passes drawn, " << graph_stats.passes_skipped << " skipped as unchanged, "
+         << graph_stats.passes_rerun << " redrawn for transient textures; texture pool: "
+         << pool_stats.created << " created, " << pool_stats.reused << " reused, " << pool_stats.dropped << " dropped, " << texture_pool.size() << " held";
+  if(feedback.size != vec2ui{}) log_feedback_memory();
+}
 
-      ImGui_ImplWGPU_RenderDrawData(ImGui::GetDrawData(), render_pass_encoder.Get()); // render the outstanding GUI draw data
+gpu_profiler const &webgpu_renderer::get_gpu_profiler() const {
+  return profiler;
+}
 
-      // TODO: add timestamp query: https://eliemichel.github.io/LearnWebGPU/advanced-techniques/benchmarking/time.html / https://webgpu.github.io/webgpu-samples/?sample=timestampQuery
+float webgpu_renderer::get_render_scale() const {
+  return offscreen.scale;
+}
 
-      render_pass_encoder.End();
-      command_encoder.PopDebugGroup();
+void webgpu_renderer::set_render_scale(float new_scale) {
+  /// Set the fraction of the viewport size to render the scene at, unless it's being chosen automatically
+  if(offscreen.automatic) return;
+  offscreen.scale = std::clamp(new_scale, scale_controller.min_scale, scale_controller.max_scale);
+}
+
+void webgpu_renderer::set_render_scale_automatic(bool new_automatic, float target_ms) {
+  /// Enable or disable automatic choice of render scale to hold a target scene GPU time
+  /// Automatic mode relies on GPU timestamps, so is unavailable without them
+  scale_controller.target_ms = target_ms;
+  new_automatic = new_automatic && profiler.is_enabled();
+  if(new_automatic == offscreen.automatic) return;
+  offscreen.automatic = new_automatic;
+  if(offscreen.automatic) {
+    scale_controller.set_scale(offscreen.scale);                                // start from wherever the manual scale was
+    scale_controller_frames_read = profiler.get_frames_read();
+  }
+  logger << "WebGPU: Automatic render scale " << (offscreen.automatic ? "enabled" : "disabled");
+}
+
+webgpu_renderer::scene_geometry webgpu_renderer::get_scene_geometry() const {
+  return geometry;
+}
+
+void webgpu_renderer::set_scene_geometry(scene_geometry new_geometry) {
+  /// Choose how the scene covers the viewport; the new pipeline compiles in the background
+  /// Instances only apply to the quad, as the fullscreen triangle always covers the whole viewport
+  if(new_geometry == geometry) return;
+  geometry = new_geometry;
+  logger << "WebGPU: Scene geometry " << magic_enum::enum_name(geometry);
+  if(geometry_benchmark.is_running() || compute_benchmark.is_running()) return; // the chosen geometry is applied when the benchmark finishes
+  configure_pipeline(pipeline_compile_mode::async);
+}
+
+void webgpu_renderer::start_geometry_benchmark(unsigned int phases) {
+  /// Time the scene pass with each geometry in turn for the given number of phases, for comparing their costs
+  /// Needs GPU timestamps; results are logged when it finishes, and can be read from the benchmark
+  if(!profiler.is_enabled()) {
+    logger << "WebGPU: Geometry benchmark unavailable without timestamp queries";
+    return;
+  }
+  if(!shader_has_fullscreen_entry_point) {
+    logger << "WebGPU: Geometry benchmark needs a shader with a vs_fullscreen entry point";
+    return;
+  }
+  if(geometry_benchmark.is_running() || compute_benchmark.is_running()) return;
+  static_assert(magic_enum::enum_count<scene_geometry>() == alternating_benchmark::configurations);
+  logger << "WebGPU: Geometry benchmark starting, " << phases << " phases of " << geometry_benchmark.frames_per_phase << " frames";
+  geometry_benchmark.start(phases);
+  benchmark_frames_read = profiler.get_frames_read();
+  apply_benchmark_configuration();
+}
+
+alternating_benchmark const &webgpu_renderer::get_geometry_benchmark() const {
+  return geometry_benchmark;
+}
+
+void webgpu_renderer::set_compute(bool new_enabled, vec2ui const &new_workgroup_size) {
+  /// Choose whether to shade the scene with the compute path, and its workgroup size, which is clamped to the device's limits
+  /// The new pipeline compiles in the background, and the fragment path is used until the first one is ready
+  vec2ui workgroup_size{
+    std::clamp(new_workgroup_size.x, 1u, webgpu.limits.maxComputeWorkgroupSizeX),
+    std::clamp(new_workgroup_size.y, 1u, webgpu.limits.maxComputeWorkgroupSizeY),
+  };
+  workgroup_size.y = std::min(workgroup_size.y, std::max(1u, webgpu.limits.maxComputeInvocationsPerWorkgroup / workgroup_size.x)); // total invocations are limited too
+  if(new_enabled == compute.enabled && workgroup_size == compute.workgroup_size) return;
+  if(new_enabled && !shader_has_compute_entry_point) logger << "WebGPU: Shader has no cs_main entry point, shading the scene with fragments instead";
+  compute.enabled = new_enabled;
+  compute.workgroup_size = {workgroup_size.x, workgroup_size.y};
+  logger << "WebGPU: Compute path " << (compute.enabled ? "enabled" : "disabled") << ", workgroup size " << compute.workgroup_size;
+  if(geometry_benchmark.is_running() || compute_benchmark.is_running()) return; // the choice is applied when the benchmark finishes
+  configure_compute_pipeline(pipeline_compile_mode::async);
+  idle.request(idle_scheduler::reason::shader);
+}
+
+vec2ui const &webgpu_renderer::get_compute_workgroup_size() const {
+  return compute.workgroup_size;
+}
+
+void webgpu_renderer::start_compute_benchmark(unsigned int phases) {
+  /// Time the scene shaded by the fragment and compute paths in turn for the given number of phases, for comparing their costs
+  /// Needs GPU timestamps; results are logged when it finishes, and can be read from the benchmark
+  if(!profiler.is_enabled()) {
+    logger << "WebGPU: Compute benchmark unavailable without timestamp queries";
+    return;
+  }
+  if(!shader_has_compute_entry_point) {
+    logger << "WebGPU: Compute benchmark needs a shader with a cs_main entry point";
+    return;
+  }
+  if(geometry_benchmark.is_running() || compute_benchmark.is_running()) return;
+  logger << "WebGPU: Compute benchmark starting, " << phases << " phases of " << compute_benchmark.frames_per_phase << " frames, workgroup size " << compute.workgroup_size;
+  compute_benchmark.start(phases);
+  benchmark_frames_read = profiler.get_frames_read();
+  apply_benchmark_configuration();
+}
+
+alternating_benchmark const &webgpu_renderer::get_compute_benchmark() const {
+  return compute_benchmark;
+}
+
+void webgpu_renderer::upload_uniforms(wgpu::CommandEncoder const &command_encoder) {
+  /// Write this frame's uniform data into a mapped staging buffer and encode a copy from it into the uniform buffer,
+  /// or write it through the queue if every staging buffer is still waiting for the GPU
+  auto const frame_data{uniform_blocks.get_frame_data()};                       // everything allocated this frame is contiguous, so upload it in one copy
+  auto const frame_offset{uniform_blocks.get_frame_range().offset};
+  auto &staging{uniform_staging};
+  if(auto const slot{staging.ring.acquire()}) {
+    auto const &buffer{staging.buffers[*slot]};
+    if(void *mapped{buffer.GetMappedRange(0, frame_data.size())}) {
+      std::memcpy(mapped, frame_data.data(), frame_data.size());
+      buffer.Unmap();
+      command_encoder.CopyBufferToBuffer(buffer, 0, uniform_buffer, frame_offset, frame_data.size()); // source, sourceOffset, destination, destinationOffset, size
+      staging.pending_slot = slot;
+      ++staging.stats.mapped_uploads;
+      return;
+    }
+    staging.ring.release(*slot);                                                // not mapped, so it can't be written this frame
+  }
+  webgpu.queue.WriteBuffer(
+    uniform_buffer,                                                             // buffer
+    frame_offset,                                                               // offset
+    frame_data.data(),                                                          // data
+    frame_data.size()                                                           // size
+  );
+  ++staging.stats.queue_uploads;
+}
+
+void webgpu_renderer::upload_instances() {
+  /// Upload the instances, and the draw arguments that say how many to draw
+  webgpu.queue.WriteBuffer(
+    instance_buffer,                                                            // buffer
+    0,                                                                          // offset
+    instance_data.data(),                                                       // data
+    instance_data.size() * sizeof(instance_data[0])                             // size
+  );
+
+  indirect_indexed_command const command{
+    .index_count{static_cast<uint32_t>(index_data.size() * decltype(index_data)::value_type::size())},
+    .instance_count{static_cast<uint32_t>(instance_data.size())},
+  };
+  webgpu.queue.WriteBuffer(indirect_buffer, 0, &command, sizeof(command));      // buffer, offset, data, size
+}
+
+void webgpu_renderer::set_instances(std::span<instance const> new_instances) {
+  /// Draw the scene once for each of the given instances, all in a single indirect draw call
+  if(new_instances.empty()) throw std::runtime_error{"WebGPU: at least one instance is needed"};
+  if(new_instances.size() > max_instances) throw std::runtime_error{"WebGPU: " + std::to_string(new_instances.size()) + " instances requested, the maximum is " + std::to_string(max_instances)};
+  instance_data.assign(new_instances.begin(), new_instances.end());
+  upload_instances();
+  progressive.tiles.restart();
+  idle.request(idle_scheduler::reason::instances);
+}
+
+void webgpu_renderer::set_instance_grid(unsigned int columns, unsigned int rows, vec2f const &sweep_range) {
+  /// Tile the viewport with a grid of thumbnails of the scene, sweeping the shader's input across the given range
+  /// A 1x1 grid draws the scene once over the whole viewport
+  columns = std::max(columns, 1u);
+  rows = std::max(rows, 1u);
+
+  std::vector<instance> grid;
+  grid.reserve(columns * rows);
+  vec2f const cell_count{static_cast<float>(columns), static_cast<float>(rows)};
+  vec2f const cell_scale{vec2f{1.0f, 1.0f} / cell_count};
+  for(unsigned int row{0}; row != rows; ++row) {
+    for(unsigned int column{0}; column != columns; ++column) {
+      vec2f const cell{static_cast<float>(column), static_cast<float>(row)};
+      vec2f const sweep_position{                                               // from 0 to 1 across the grid
+        columns == 1 ? 0.5f : cell.x / (cell_count.x - 1.0f),
+        rows == 1 ? 0.5f : cell.y / (cell_count.y - 1.0f),
+      };
+      grid.emplace_back(instance{
+        .position_offset{(cell * 2.0f + 1.0f) * cell_scale - 1.0f},             // the centre of this cell, in clip space
+        .position_scale{cell_scale.x, cell_scale.y},
+        .uv_offset{(sweep_position - 0.5f) * sweep_range},
+      });
     }
+  }
+  set_instances(grid);
+  logger << "WebGPU: Drawing a " << columns << "x" << rows << " grid of " << grid.size() << " instances";
+}
 
-    wgpu::CommandBufferDescriptor command_buffer_descriptor {
-      .label = "Command buffer 1"
+void webgpu_renderer::configure_gallery() {
+  /// Create or resize the gallery's atlas and buffers for its current variants, and upload the variants
+  if(!gallery.uniform_buffer) {
+    gallery.stride = uniform_allocator::align_up(sizeof(uniforms), webgpu.limits.minUniformBufferOffsetAlignment);
+    wgpu::BufferDescriptor uniform_buffer_descriptor{
+      .label{"Gallery uniform buffer"},
+      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform | wgpu::BufferUsage::Storage}, // variants may also be generated by a compute pass
+      .size{gallery.max_variants * gallery.stride},
     };
-    wgpu::CommandBuffer command_buffer{command_encoder.Finish(&command_buffer_descriptor)};
+    gallery.uniform_buffer = webgpu.device.CreateBuffer(&uniform_buffer_descriptor);
 
-    webgpu.queue.Submit(1, &command_buffer);
+    wgpu::BindGroupEntry bind_group_entry{
+      .binding{0},
+      .buffer{gallery.uniform_buffer},
+      .size{sizeof(uniforms)},                                                  // the size of one variant; its offset is given dynamically
+    };
+    wgpu::BindGroupDescriptor bind_group_descriptor{
+      .label{"Gallery bind group"},
+      .layout{webgpu.bind_group_layout},                                        // the same layout as the scene, so the scene's pipeline can draw the gallery
+      .entryCount{1},
+      .entries{&bind_group_entry},
+    };
+    gallery.bind_group = webgpu.device.CreateBindGroup(&bind_group_descriptor);
+
+    wgpu::BufferDescriptor instance_buffer_descriptor{
+      .label{"Gallery instance buffer"},
+      .usage{wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex},
+      .size{sizeof(instance)},
+    };
+    gallery.instance_buffer = webgpu.device.CreateBuffer(&instance_buffer_descriptor);
+    instance const whole_tile{};
+    webgpu.queue.WriteBuffer(gallery.instance_buffer, 0, &whole_tile, sizeof(whole_tile)); // buffer, offset, data, size
+  }
+
+  std::vector<std::byte> staging(gallery.variants.size() * gallery.stride);     // every variant at its aligned offset, uploaded in one copy
+  for(size_t i{0}; i != gallery.variants.size(); ++i) {
+    std::memcpy(staging.data() + i * gallery.stride, &gallery.variants[i], sizeof(uniforms));
+  }
+  webgpu.queue.WriteBuffer(gallery.uniform_buffer, 0, staging.data(), staging.size()); // buffer, offset, data, size
+
+  auto const variant_count{static_cast<unsigned int>(gallery.variants.size())};
+  gallery.columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(variant_count))));
+  vec2ui const tiles{gallery.columns, (variant_count + gallery.columns - 1) / gallery.columns};
+  vec2ui const atlas_size{
+    std::min(gallery.tile_size.x * tiles.x, webgpu.limits.maxTextureDimension2D),
+    std::min(gallery.tile_size.y * tiles.y, webgpu.limits.maxTextureDimension2D),
+  };
+  gallery.tile_size = {atlas_size.x / tiles.x, atlas_size.y / tiles.y};         // shrink the tiles if the atlas would be too large
+  if(gallery.atlas && atlas_size == gallery.atlas_size) return;
+
+  if(gallery.atlas) gallery.atlas.Destroy();
+  wgpu::TextureDescriptor texture_descriptor{
+    .label{"Gallery atlas texture"},
+    .usage{wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding},
+    .dimension{wgpu::TextureDimension::e2D},
+    .size{                                                                      // Extent3D
+      .width{ atlas_size.x},
+      .height{atlas_size.y},
+      .depthOrArrayLayers{1},
+    },
+    .format{webgpu.surface_preferred_format},                                   // matches the viewport, so the scene's pipeline can draw to it
+    .mipLevelCount{1},
+    .sampleCount{1},
+  };
+  gallery.atlas = webgpu.device.CreateTexture(&texture_descriptor);
+  gallery.atlas_view = gallery.atlas.CreateView();
+  gallery.atlas_size = atlas_size;
+  logger << "WebGPU: Gallery atlas " << atlas_size.x << "x" << atlas_size.y << " for " << variant_count << " variants";
+}
+
+void webgpu_renderer::encode_gallery_pass(wgpu::CommandEncoder const &command_encoder) {
+  /// Render every variant into its own tile of the atlas, all in one pass
+  command_encoder.PushDebugGroup("Gallery render pass group");
+
+  wgpu::RenderPassColorAttachment render_pass_colour_attachment{
+    .view{gallery.atlas_view},
+    .loadOp{wgpu::LoadOp::Clear},
+    .storeOp{wgpu::StoreOp::Store},
+    .clearValue{wgpu::Color{0, 0, 0, 1.0}},
+  };
+  wgpu::RenderPassDescriptor gallery_render_pass_descriptor{
+    .label{"Gallery render pass"},
+    .colorAttachmentCount{1},
+    .colorAttachments{&render_pass_colour_attachment},
+    .timestampWrites{profiler.get_timestamp_writes(std::to_underlying(gpu_scope::gallery))},
+  };
+  wgpu::RenderPassEncoder render_pass_encoder{command_encoder.BeginRenderPass(&gallery_render_pass_descriptor)};
+
+  render_pass_encoder.SetPipeline(webgpu.pipeline);
+  if(pipeline_geometry == scene_geometry::quad) {
+    render_pass_encoder.SetVertexBuffer(0, vertex_buffer, 0, vertex_buffer.GetSize()); // slot, buffer, offset, size
+    render_pass_encoder.SetVertexBuffer(1, gallery.instance_buffer, 0, gallery.instance_buffer.GetSize());
+    render_pass_encoder.SetIndexBuffer(index_buffer, wgpu::IndexFormat::Uint16, 0, index_buffer.GetSize()); // buffer, format, offset, size
+  }
+  auto const index_count{static_cast<uint32_t>(index_data.size() * decltype(index_data)::value_type::size())};
+  for(unsigned int variant_index{0}; variant_index != gallery.variants.size(); ++variant_index) {
+    vec2ui const tile{variant_index % gallery.columns, variant_index / gallery.columns};
+    render_pass_encoder.SetViewport(                                            // viewports aren't bundle state, so each tile is encoded directly
+      static_cast<float>(tile.x * gallery.tile_size.x),
+      static_cast<float>(tile.y * gallery.tile_size.y),
+      static_cast<float>(gallery.tile_size.x),
+      static_cast<float>(gallery.tile_size.y),
+      0.0f,                                                                     // minDepth
+      1.0f                                                                      // maxDepth
+    );
+    uint32_t const uniform_offset{variant_index * gallery.stride};
+    render_pass_encoder.SetBindGroup(0, gallery.bind_group, 1, &uniform_offset); // groupIndex, group, dynamicOffsetCount, dynamicOffsets
+    switch(pipeline_geometry) {
+    case scene_geometry::quad:
+      render_pass_encoder.DrawIndexed(index_count);
+      break;
+    case scene_geometry::fullscreen_triangle:
+      render_pass_encoder.Draw(3);                                              // clipped to the tile by its viewport
+      break;
+    }
+  }
+
+  render_pass_encoder.End();
+  command_encoder.PopDebugGroup();
+  ++gallery.stats.passes;
+  gallery.stats.variants_rendered += gallery.variants.size();
+}
+
+void webgpu_renderer::set_gallery(std::span<uniforms const> variants, vec2ui const &tile_size) {
+  /// Render the scene with each of the given uniform sets every frame, into tiles of an atlas for display
+  if(variants.empty()) throw std::runtime_error{"WebGPU: the gallery needs at least one variant"};
+  if(variants.size() > gallery.max_variants) throw std::runtime_error{"WebGPU: " + std::to_string(variants.size()) + " gallery variants requested, the maximum is " + std::to_string(gallery.max_variants)};
+  gallery.variants.assign(variants.begin(), variants.end());
+  gallery.tile_size = {std::max(tile_size.x, 1u), std::max(tile_size.y, 1u)};
+  gallery.enabled = true;
+  configure_gallery();
+  idle.request(idle_scheduler::reason::uniforms);
+}
+
+void webgpu_renderer::disable_gallery() {
+  /// Stop rendering the gallery, releasing its atlas
+  if(!gallery.enabled) return;
+  gallery.enabled = false;
+  if(gallery.atlas) gallery.atlas.Destroy();
+  gallery.atlas = {};
+  gallery.atlas_view = {};
+  gallery.atlas_size = {};
+  logger << "WebGPU: Gallery disabled after " << gallery.stats.variants_rendered << " variants in " << gallery.stats.passes << " passes";
+}
+
+wgpu::TextureView const &webgpu_renderer::get_gallery_view() const {
+  return gallery.atlas_view;
+}
+
+vec2ui const &webgpu_renderer::get_gallery_size() const {
+  return gallery.atlas_size;
+}
+
+unsigned int webgpu_renderer::get_gallery_variant_count() const {
+  return gallery.enabled ? static_cast<unsigned int>(gallery.variants.size()) : 0;
+}
+
+void webgpu_renderer::set_progressive(bool new_enabled, unsigned int tiles_per_frame) {
+  /// Enable or disable progressive rendering of the scene in tiles, with the given budget of tiles per frame
+  progressive.tiles.tiles_per_frame = std::max(tiles_per_frame, 1u);
+  if(new_enabled == progressive.enabled) return;
+  progressive.enabled = new_enabled;
+  progressive.tiles_size = {};                                                  // configure the tiles afresh when next drawn
+  idle.request(idle_scheduler::reason::progressive);
+  logger << "WebGPU: Progressive rendering " << (progressive.enabled ? "enabled" : "disabled");
+}
+
+float webgpu_renderer::get_progressive_progress() const {
+  /// How much of the current progressive image has been drawn, from 0 to 1
+  if(!progressive.enabled) return 1.0f;
+  return progressive.tiles.get_progress();
+}
+
+void webgpu_renderer::set_max_device_pixel_ratio(float new_max_device_pixel_ratio) {
+  /// Cap the device pixel ratio the surface is sized for, or remove the cap with zero
+  resizer.max_device_pixel_ratio = new_max_device_pixel_ratio;                  // takes effect when the canvas size is next observed
+}
+
+frame_pacer const &webgpu_renderer::get_frame_pacer() const {
+  return pacer;
+}
+
+void webgpu_renderer::set_max_frames_in_flight(unsigned int new_max_frames_in_flight) {
+  /// Limit how many submitted frames the GPU may still be working on; fewer lowers latency, more tolerates uneven frame times
+  pacer.set_max_frames_in_flight(new_max_frames_in_flight);
+}
+
+std::vector<wgpu::PresentMode> const &webgpu_renderer::get_present_modes() const {
+  return webgpu.present_modes;
+}
+
+wgpu::PresentMode webgpu_renderer::get_present_mode() const {
+  return present_mode;
+}
+
+void webgpu_renderer::set_present_mode(wgpu::PresentMode new_present_mode) {
+  /// Choose how the surface presents frames, falling back to Fifo if the surface doesn't support the mode requested
+  if(std::ranges::find(webgpu.present_modes, new_present_mode) == webgpu.present_modes.end()) {
+    logger << "WebGPU: Present mode " << magic_enum::enum_name(new_present_mode) << " isn't supported by this surface, using Fifo";
+    new_present_mode = wgpu::PresentMode::Fifo;
   }
+  if(new_present_mode == present_mode) return;
+  present_mode = new_present_mode;
+  configure_surface();
+  idle.request(idle_scheduler::reason::viewport);                               // the reconfigured surface's contents are undefined
+  logger << "WebGPU: Present mode " << magic_enum::enum_name(present_mode);
 }
 
 std::string webgpu_renderer::get_shader() const {
@@ -778,9 +2402,55 @@ std::string webgpu_renderer::get_shader() const {
 }
 
 void webgpu_renderer::update_shader(std::string const &new_shader_code) {
+  /// Replace the shader code and compile a new pipeline in the background
+  /// Rendering continues with the current pipeline until the new one is ready
   shader_code = new_shader_code;
-  configure_pipeline();
-  configure_render_bundle();
+  shader_hash = fnv1a(shader_code);
+  shader_overrides.clear();
+  try {
+    auto const module{wgsl::reflection::reflect(shader_code)};
+    for(auto const &override_constant : module.overrides) {
+      shader_overrides.emplace_back(override_constant.name);
+    }
+    auto const has_entry_point{[&](std::string_view name, wgsl::reflection::stages stage){
+      auto const it{std::ranges::find(module.entry_points, name, &wgsl::reflection::reflected_entry_point::name)};
+      return it != module.entry_points.end() && it->stage == stage;
+    }};
+    shader_has_fullscreen_entry_point = has_entry_point("vs_fullscreen", wgsl::reflection::stages::vertex);
+    shader_has_compute_entry_point = has_entry_point("cs_main", wgsl::reflection::stages::compute);
+  } catch(std::runtime_error const &error) {
+    logger << "ERROR: WebGPU: " << error.what() << ", compiling the shader without overrides";
+    shader_has_fullscreen_entry_point = false;                                  // WebGPU reports the shader's own errors when it's compiled
+    shader_has_compute_entry_point = false;
+  }
+  try {
+    feedback.graph = pass_graph::parse(shader_code);
+  } catch(std::runtime_error const &error) {
+    logger << "ERROR: WebGPU: " << error.what() << ", drawing the scene without its passes";
+    feedback.graph = {};
+  }
+  update_feedback_textures({});                                                 // the new graph's textures come back from the pool once it's ready
+  if(geometry == scene_geometry::fullscreen_triangle && !shader_has_fullscreen_entry_point) {
+    logger << "WebGPU: Shader has no vs_fullscreen entry point, drawing the scene as a quad instead";
+  }
+  configure_pipeline(pipeline_compile_mode::async);
+  configure_compute_pipeline(pipeline_compile_mode::async);
+  configure_feedback_pipelines();
+}
+
+shader_variant const &webgpu_renderer::get_shader_variant() const {
+  return variant;
+}
+
+void webgpu_renderer::set_shader_variant(shader_variant const &new_variant) {
+  /// Specialise the shader with new override constant values, such as a different quality tier
+  /// The source is unchanged, so this only needs a pipeline: a cached one if this variant was used recently,
+  /// otherwise one compiled in the background while rendering continues with the current variant
+  if(new_variant == variant) return;
+  variant = new_variant;
+  configure_pipeline(pipeline_compile_mode::async);
+  configure_compute_pipeline(pipeline_compile_mode::async);
+  configure_feedback_pipelines();
 }
 
 }
@@ -1,13 +1,32 @@
 #pragma once
 
-#include <emscripten/em_types.h>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <vector>
 #include <webgpu/webgpu_cpp.h>
 #include "logstorm/logstorm_forward.h"
 #include "vectorstorm/vector/vector2.h"
 #include "vectorstorm/vector/vector3.h"
+#include "alternating_benchmark.h"
+#include "dirty_tracked.h"
+#include "frame_pacer.h"
+#include "gpu_profiler.h"
+#include "idle_scheduler.h"
 #include "indirect.h"
+#include "instance.h"
+#include "lru_cache.h"
+#include "pass_graph.h"
+#include "readback_ring.h"
+#include "render_scale_controller.h"
+#include "resource_pool.h"
+#include "resize_manager.h"
+#include "shader_variant.h"
+#include "tile_scheduler.h"
 #include "uniforms.h"
 #include "triangle_index.h"
+#include "uniform_allocator.h"
 #include "vertex.h"
 
 namespace render {
@@ -15,9 +34,26 @@ namespace render {
 class webgpu_renderer {
   logstorm::manager &logger;
 
-  std::string shader_code;
+  std::string shader_code;                                                      // as shown in the editor; the unedited default shader is compiled minified
+  uint64_t shader_hash{0};                                                      // of shader_code, for the pipeline cache key
+  std::vector<std::string> shader_overrides;                                    // names of the override constants shader_code declares
+  bool shader_has_fullscreen_entry_point{true};                                 // whether shader_code declares vs_fullscreen, needed for the fullscreen triangle
+  bool shader_has_compute_entry_point{true};                                    // whether shader_code declares cs_main, needed for the compute path
+  shader_variant variant;                                                       // override constant values pipelines are specialised with
 
 public:
+  struct shader_parameters {                                                    // override constants of the default shader, checked against it at compile time
+    static constexpr shader_parameter<uint32_t> iterations{"iterations"};       // escape iterations before a point is considered inside the set
+    static constexpr shader_parameter<float> bailout{"bailout"};                // squared distance beyond which a point has escaped
+    static constexpr shader_parameter<uint32_t> workgroup_width{"workgroup_width"}; // compute path workgroup size, set by the renderer rather than by variants
+    static constexpr shader_parameter<uint32_t> workgroup_height{"workgroup_height"};
+  };
+
+  enum class scene_geometry : unsigned int {                                    // how the scene covers the viewport
+    quad,                                                                       // two indexed triangles from the vertex and index buffers, drawn per instance
+    fullscreen_triangle,                                                        // one triangle generated from the vertex index by vs_fullscreen, with no buffers or instances
+  };
+
   struct webgpu_data {
     wgpu::Instance instance{wgpu::CreateInstance()};                            // the underlying WebGPU instance
     wgpu::Surface surface;                                                      // the canvas surface for rendering
@@ -25,11 +61,12 @@ public:
     wgpu::Device device;                                                        // WebGPU device once it has been acquired
     wgpu::Queue queue;                                                          // the queue for this device, once it has been acquired
     wgpu::BindGroupLayout bind_group_layout;                                    // layout for the uniform bind group
+    wgpu::PipelineLayout pipeline_layout;                                       // layout shared by every render pipeline built from user shaders
     wgpu::RenderPipeline pipeline;                                              // the render pipeline currently in use
 
-    wgpu::SwapChain swapchain;                                                  // the swapchain providing a texture view to render to
-
     wgpu::TextureFormat surface_preferred_format{wgpu::TextureFormat::Undefined}; // preferred texture format for this surface
+    std::vector<wgpu::PresentMode> present_modes;                               // supported by this surface on this adapter, always including Fifo
+    wgpu::Limits limits;                                                        // limits of the device we acquired
 
   private:
     webgpu_data() = default;
@@ -37,14 +74,83 @@ public:
   };
 
   // TODO, rearrange scene content meaningfully
-  std::vector<wgpu::RenderBundle> render_bundles;
-  wgpu::Buffer vertex_buffer;
+  wgpu::RenderBundle render_bundle;                                             // the scene's draw, bound to the scene uniforms
+  wgpu::Buffer vertex_buffer;                                                   // only created once quad geometry is needed
   wgpu::Buffer index_buffer;
-  wgpu::Buffer uniform_buffer;
+  wgpu::Buffer uniform_buffer;                                                  // this frame's uniform blocks, shared by every frame in flight as uploads are copies ordered on the queue
+  wgpu::Buffer instance_buffer;                                                 // per-instance placement of the scene quad, writable by the CPU or a compute pass
+  wgpu::Buffer indirect_buffer;                                                 // arguments of the scene's one indexed draw, writable by the CPU or a compute pass
+
+  static constexpr uint32_t uniform_buffer_size{4096};                          // minimum bytes of uniform data each frame may allocate
+  static constexpr uint32_t scene_uniform_offset{0};                            // the scene uniforms are always the first block allocated each frame
+  uniform_allocator uniform_blocks;                                             // per-frame sub-allocator of the uniform buffer
+
+  struct uniform_staging_data {                                                 // mapped buffers each frame's uniforms are written into, then copied to the uniform buffer on the GPU
+    static constexpr unsigned int slots{frame_pacer::max_frames_in_flight_limit}; // one for each frame that may still be copying from its buffer
+    std::vector<wgpu::Buffer> buffers;                                          // each one is mapped for writing while its slot is free
+    readback_ring ring{slots};                                                  // the same free, encoded, mapping cycle as readbacks, with the copy going the other way
+    std::optional<unsigned int> pending_slot;                                   // this frame's slot, to map again once its copy is submitted
+
+    struct map_request {                                                        // userdata for each slot's map callback
+      webgpu_renderer &renderer;
+      unsigned int slot{0};
+    };
+    std::vector<map_request> map_requests;
+
+    struct stats_data {
+      uint64_t mapped_uploads{0};                                               // uploads written into a staging buffer and copied
+      uint64_t queue_uploads{0};                                                // uploads written through the queue, as every staging buffer was busy
+    } stats;
+  } uniform_staging;
+
+  struct frame_context_data {                                                   // descriptors for encoding each frame, built once so a frame only fills in what changes
+    wgpu::CommandEncoderDescriptor command_encoder_descriptor{
+      .label{"Frame command encoder"},
+    };
+    wgpu::SurfaceTexture surface_texture;                                       // this frame's, released once it's submitted
+    wgpu::TextureView surface_view;
+
+    wgpu::RenderPassColorAttachment scene_colour_attachment{
+      .storeOp{wgpu::StoreOp::Store},
+      .clearValue{wgpu::Color{0, 0.5, 0.5, 1.0}},
+    };
+    wgpu::RenderPassDescriptor scene_render_pass_descriptor{
+      .label{"Scene render pass"},
+      .colorAttachmentCount{1},
+      .colorAttachments{&scene_colour_attachment},
+    };
+    wgpu::RenderPassColorAttachment composite_colour_attachment{
+      .storeOp{wgpu::StoreOp::Store},
+      .clearValue{wgpu::Color{0, 0, 0, 1.0}},
+    };
+    wgpu::RenderPassDescriptor composite_render_pass_descriptor{
+      .label{"Composite render pass"},
+      .colorAttachmentCount{1},
+      .colorAttachments{&composite_colour_attachment},
+    };
+    wgpu::CommandBufferDescriptor command_buffer_descriptor{
+      .label{"Frame command buffer"},
+    };
+
+    frame_context_data() = default;
+    frame_context_data(frame_context_data const&) = delete;                     // the descriptors point into the attachments, so it must stay put
+    frame_context_data &operator=(frame_context_data const&) = delete;
+  } frame_context;
+
+  enum class gpu_scope : unsigned int {                                         // render passes measured by the GPU profiler, in the order they're encoded
+    scene,
+    compute,                                                                    // the scene shaded by a compute shader, instead of the scene pass
+    feedback,                                                                   // the shader's pass graph, instead of the scene pass
+    gallery,                                                                    // uniform variants of the scene rendered into the gallery atlas
+    composite,                                                                  // upscaling the scene, if rendered at reduced scale, and the GUI
+  };
+  gpu_profiler profiler{logger};
 
-  wgpu::RenderPassDescriptor render_pass_descriptor;
+  dirty_tracked<uniforms> uniform_data;                                         // only uploaded on frames where it changed
+  idle_scheduler idle;                                                          // decides which frames need drawing at all
 
-  uniforms uniform_data;
+  static constexpr unsigned int stats_log_interval{600};                        // how many frames to wait between logging statistics
+  uint64_t frame_count{0};
 
   std::vector<vertex> vertex_data{
     {{-1.0f, -1.0f}, {0.0f, 0.0f}},
@@ -58,15 +164,172 @@ public:
     {2, 1, 3},
   };
 
+  static constexpr uint32_t max_instances{1024};                                // capacity of the instance buffer
+  std::vector<instance> instance_data{                                          // by default a single instance covering the viewport
+    {},
+  };
+
 private:
   webgpu_data webgpu;
 
   struct window_data {
     vec2ui viewport_size;                                                       // our idea of the size of the viewport we render to, in real pixels
-    float device_pixel_ratio{1.0f};
   } window;
+  resize_manager resizer;                                                       // decides when the surface needs reconfiguring, and at what size
+  wgpu::PresentMode present_mode{wgpu::PresentMode::Fifo};                      // the mode the surface is configured with, always one it supports
+
+  frame_pacer pacer;                                                            // limits how many submitted frames the GPU may still be working on
+  struct work_done_request {                                                    // userdata for each in-flight frame's work done callback
+    webgpu_renderer &renderer;
+    uint64_t frame{0};
+  };
+  std::vector<work_done_request> work_done_requests;                            // one for each frame that may be in flight, indexed by frame number
+
+  struct pipeline_key {                                                         // identifies a compiled pipeline by the inputs it was built from
+    uint64_t shader_hash{0};                                                    // hash of the WGSL source
+    wgpu::TextureFormat colour_format{wgpu::TextureFormat::Undefined};          // format of the colour target
+    uint64_t vertex_layout_hash{0};                                             // hash of the vertex buffer layouts
+    uint64_t constants_hash{0};                                                 // hash of the override constants it's specialised with
+    scene_geometry geometry{scene_geometry::quad};                              // which vertex entry point and buffers it draws with
+
+    bool operator==(pipeline_key const&) const = default;
+
+    struct hasher {
+      size_t operator()(pipeline_key const &key) const;
+    };
+  };
+  struct offscreen_data {                                                       // target for rendering the scene at a fraction of the viewport size
+    float scale{1.0f};                                                          // fraction of the viewport size to render the scene at
+    bool automatic{false};                                                      // whether the scale is chosen by the controller to hold a target frame time
+    vec2ui size;                                                                // size of the offscreen texture, zero if there isn't one
+    wgpu::Texture texture;                                                      // the scene is rendered here when scaled, then upscaled to the viewport
+    wgpu::TextureView texture_view;
+    wgpu::Sampler sampler;                                                      // bilinear sampler used to upscale
+    wgpu::BindGroupLayout bind_group_layout;
+    wgpu::TextureFormat format{wgpu::TextureFormat::Undefined};                 // the viewport's format, or the compute path's storage format
+    wgpu::BindGroup bind_group;                                                 // binds the current offscreen texture for the blit
+    wgpu::BindGroup storage_bind_group;                                         // binds it for the compute path to write, if it has the storage format
+    wgpu::RenderPipeline pipeline;                                              // blits the offscreen texture to the viewport
+  } offscreen;
+  render_scale_controller scale_controller;                                     // picks the scale in automatic mode
+  unsigned int scale_controller_frames_read{0};                                 // GPU profiler frames already fed to the controller
+
+  struct progressive_data {                                                     // tiled accumulation of the scene over several frames, for shaders too heavy to draw in one
+    static constexpr uint32_t tile_size{256};                                   // width and height of each tile in pixels
+    bool enabled{false};
+    tile_scheduler tiles;
+    vec2ui tiles_size;                                                          // target size the tiles were configured for
+    uint64_t uniform_version{0};                                                // uniform data version the current image is being drawn with
+    bool contents_valid{false};                                                 // whether the offscreen texture holds anything worth keeping yet
+  } progressive;
+
+  struct gallery_data {                                                         // many uniform variants of the scene rendered side by side into an atlas, for comparing them
+    static constexpr unsigned int max_variants{256};
+    bool enabled{false};
+    std::vector<uniforms> variants;                                             // one uniform set for each tile of the atlas
+    unsigned int columns{0};                                                    // tiles across the atlas
+    vec2ui tile_size;                                                           // pixels in each tile
+    uint32_t stride{0};                                                         // bytes between variants in the uniform buffer, a multiple of the uniform offset alignment
+    wgpu::Buffer uniform_buffer;                                                // every variant's uniforms, bound at a dynamic offset for each tile
+    wgpu::BindGroup bind_group;
+    wgpu::Buffer instance_buffer;                                               // a single instance, so each variant covers its whole tile
+    vec2ui atlas_size;                                                          // size of the atlas texture, zero if there isn't one
+    wgpu::Texture atlas;
+    wgpu::TextureView atlas_view;                                               // for displaying the atlas, e.g. with ImGui::Image
+
+    struct stats_data {
+      uint64_t passes{0};                                                       // gallery render passes encoded
+      uint64_t variants_rendered{0};
+    } stats;
+  } gallery;
+
+  struct compute_data {                                                         // shading the scene with a compute shader writing the offscreen texture, instead of the scene pass
+    bool enabled{false};
+    vec2ui workgroup_size{8, 8};                                                // invocations along each side of a workgroup, within the device's limits
+    vec2ui pipeline_workgroup_size;                                             // the workgroup size the current pipeline was compiled with, which lags while compiling
+    wgpu::TextureFormat texture_format{wgpu::TextureFormat::Undefined};         // storage format the shader writes, from its reflected binding
+    wgpu::BindGroupLayout storage_bind_group_layout;                            // group 1, the storage texture; group 0 is the uniforms, as for render pipelines
+    wgpu::PipelineLayout pipeline_layout;
+    wgpu::BindGroup uniform_bind_group;
+    wgpu::ComputePipeline pipeline;
+    uint64_t pipeline_hash{0};                                                  // of the inputs of the current or pending pipeline, so unchanged inputs don't recompile
+    unsigned int generation{0};                                                 // incremented each time a new compute pipeline compilation is requested
+
+    struct stats_data {
+      uint64_t dispatches{0};
+      uint64_t workgroups{0};
+    } stats;
+  } compute;
+
+  struct compute_pipeline_request {                                             // bookkeeping for a compute pipeline compilation in flight
+    webgpu_renderer &renderer;
+    uint64_t hash{0};
+    vec2ui workgroup_size;
+    unsigned int generation{0};
+    std::chrono::steady_clock::time_point start_time;
+  };
+
+  struct texture_key {                                                          // identifies interchangeable textures in the texture pool
+    vec2ui size;
+    wgpu::TextureFormat format{wgpu::TextureFormat::Undefined};
+
+    bool operator==(texture_key const&) const = default;
+
+    struct hasher {
+      size_t operator()(texture_key const &key) const;
+    };
+  };
+  resource_pool<texture_key, wgpu::Texture, texture_key::hasher> texture_pool;  // render targets released on resize or shader change, kept for reuse
+
+  struct feedback_data {                                                        // the scene drawn as a graph of fullscreen passes declared in the shader, with ping-pong textures
+    static constexpr wgpu::TextureFormat texture_format{wgpu::TextureFormat::RGBA16Float}; // enough precision to accumulate over many frames, and filterable
+    pass_graph graph;
+    bool failed{false};                                                         // whether the graph couldn't be built from the current shader
+
+    struct pass_data {
+      wgpu::BindGroupLayout bind_group_layout;                                  // the uniforms, a sampler, then the textures the pass reads, all in group 0
+      wgpu::RenderPipeline pipeline;
+      std::vector<wgpu::BindGroup> bind_groups;                                 // for each combination of input sides, created when first needed
+    };
+    std::vector<pass_data> passes;                                              // matching the graph's passes
+    unsigned int pipelines_pending{0};                                          // pass pipelines still compiling; the graph is only used once there are none
+    unsigned int generation{0};                                                 // incremented each time the pass pipelines are rebuilt
+
+    struct allocation_data {                                                    // a ping-pong pair for persistent textures, or only the first side for transient ones
+      unsigned int sides{0};
+      std::array<wgpu::Texture, 2> textures;
+      std::array<wgpu::TextureView, 2> views;
+      std::array<wgpu::BindGroup, 2> blit_bind_groups;                          // for displaying either side, if this holds the graph's output
+    };
+    std::vector<allocation_data> allocations;                                   // matching the graph's allocations, shared by transient textures that don't overlap
+    vec2ui size;                                                                // size of the textures, zero if they're not allocated
+    bool needs_clear{false};                                                    // whether the textures are new, or pooled from elsewhere, and need clearing before use
+  } feedback;
+
+  struct feedback_pipeline_request {                                            // bookkeeping for a pass pipeline compilation in flight
+    webgpu_renderer &renderer;
+    unsigned int pass{0};
+    unsigned int generation{0};
+    std::chrono::steady_clock::time_point start_time;
+  };
+
+  scene_geometry geometry{scene_geometry::quad};                                // the geometry chosen for the scene
+  scene_geometry pipeline_geometry{scene_geometry::quad};                       // the geometry the current pipeline draws, which lags the choice while compiling
+  alternating_benchmark geometry_benchmark;                                     // times the scene pass with each geometry in turn
+  alternating_benchmark compute_benchmark;                                      // times the scene with the fragment and compute paths in turn
+  unsigned int benchmark_frames_read{0};                                        // GPU profiler frames already fed to whichever benchmark is running
+
+  lru_cache<pipeline_key, wgpu::RenderPipeline, pipeline_key::hasher> pipeline_cache{8}; // recently compiled pipelines, so switching back to a previous shader needn't recompile
+
+  struct pipeline_request {                                                     // bookkeeping for a pipeline compilation in flight
+    webgpu_renderer &renderer;
+    pipeline_key key;                                                           // cache key the resulting pipeline will be stored under
+    unsigned int generation{0};                                                 // which request this was, so superseded results can be discarded
+    std::chrono::steady_clock::time_point start_time;                           // when compilation was requested, for reporting compile times
+  };
+  unsigned int pipeline_generation{0};                                          // incremented each time a new pipeline compilation is requested
 
-  std::function<void(webgpu_data const&)> postinit_callback;                    // the callback that is called once when init completes (it cannot return normally because of emscripten's loop mechanism)
+  std::function<void(webgpu_data const&)> postinit_callback;                    // the callback that is called once when init completes (it cannot return normally because of the platform's loop mechanism)
   std::function<void()> main_loop_callback;                                     // the callback that is called repeatedly for the main loop after init
 
 public:
@@ -75,23 +338,100 @@ public:
   void init(std::function<void(webgpu_data const&)> &&postinit_callback, std::function<void()> &&main_loop_callback);
 
 private:
-  void init_swapchain();
   void init_depth_texture();
 
+  void observe_canvas_size();
+  void configure_surface();
+  void update_surface_size();
+  bool acquire_surface_texture();
+
   void wait_to_configure_loop();
   void configure();
-  void configure_pipeline();
+  void configure_pipeline_layout();
+  void configure_blit_pipeline();
+
+  enum class pipeline_compile_mode {
+    blocking,                                                                   // create the pipeline immediately, stalling until it's ready
+    async,                                                                      // compile in the background, keep drawing with the old pipeline until the new one is ready
+  };
+  void configure_pipeline(pipeline_compile_mode mode = pipeline_compile_mode::blocking);
+  void on_pipeline_ready(wgpu::RenderPipeline &&new_pipeline, scene_geometry new_geometry);
+  wgpu::ShaderModule create_shader_module() const;
+  std::vector<wgpu::ConstantEntry> make_pipeline_constants(uint64_t &constants_hash) const;
+  scene_geometry get_target_geometry() const;
+  void apply_benchmark_configuration();
+  void configure_compute();
+  void configure_compute_pipeline(pipeline_compile_mode mode = pipeline_compile_mode::blocking);
+  bool is_compute_target() const;
+  bool is_compute_active() const;
+  void log_pipeline_cache_stats(std::string const &event) const;
   void update_imgui_size();
 
   void build_scene();
+  void build_quad_buffers();
 
   void configure_render_bundle();
+  void upload_uniforms(wgpu::CommandEncoder const &command_encoder);
+  void upload_instances();
+  void configure_gallery();
+  void encode_gallery_pass(wgpu::CommandEncoder const &command_encoder);
+  void update_offscreen_target();
+  float get_latest_scene_time() const;
+  void update_benchmarks();
+  void encode_compute_pass(wgpu::CommandEncoder const &command_encoder);
+  void configure_feedback();
+  void configure_feedback_pipelines();
+  bool is_feedback_active() const;
+  void update_feedback_textures(vec2ui const &target_size);
+  void log_feedback_memory() const;
+  void encode_feedback_passes(wgpu::CommandEncoder const &command_encoder);
+
+  void log_frame_stats() const;
 
 public:
   void draw(vec2f const& rotation);
 
+  gpu_profiler const &get_gpu_profiler() const;
+
+  float get_render_scale() const;
+  void set_render_scale(float new_scale);
+  void set_render_scale_automatic(bool new_automatic, float target_ms);
+
+  void set_max_device_pixel_ratio(float new_max_device_pixel_ratio);
+
+  frame_pacer const &get_frame_pacer() const;
+  void set_max_frames_in_flight(unsigned int new_max_frames_in_flight);
+  std::vector<wgpu::PresentMode> const &get_present_modes() const;
+  wgpu::PresentMode get_present_mode() const;
+  void set_present_mode(wgpu::PresentMode new_present_mode);
+
+  scene_geometry get_scene_geometry() const;
+  void set_scene_geometry(scene_geometry new_geometry);
+  void start_geometry_benchmark(unsigned int phases);
+  alternating_benchmark const &get_geometry_benchmark() const;
+
+  void set_compute(bool new_enabled, vec2ui const &new_workgroup_size);
+  vec2ui const &get_compute_workgroup_size() const;
+  void start_compute_benchmark(unsigned int phases);
+  alternating_benchmark const &get_compute_benchmark() const;
+
+  void set_instances(std::span<instance const> new_instances);
+  void set_instance_grid(unsigned int columns, unsigned int rows, vec2f const &sweep_range);
+
+  void set_gallery(std::span<uniforms const> variants, vec2ui const &tile_size);
+  void disable_gallery();
+  wgpu::TextureView const &get_gallery_view() const;
+  vec2ui const &get_gallery_size() const;
+  unsigned int get_gallery_variant_count() const;
+
+  void set_progressive(bool new_enabled, unsigned int tiles_per_frame);
+  float get_progressive_progress() const;
+
   std::string get_shader() const;
   void update_shader(std::string const &new_shader_code);
+
+  shader_variant const &get_shader_variant() const;
+  void set_shader_variant(shader_variant const &new_variant);
 };
 
 }
@@ -0,0 +1,129 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+
+namespace render {
+
+work_stealing_pool::work_stealing_pool(unsigned int thread_count)
+  : ranges(thread_count != 0 ? thread_count : get_default_thread_count()) {
+  /// Start the worker threads; a thread count of 0 uses every hardware thread available
+  threads.reserve(ranges.size() - 1);
+  for(unsigned int worker{1}; worker != ranges.size(); ++worker) {
+    threads.emplace_back(&work_stealing_pool::thread_main, this, worker);
+  }
+}
+
+work_stealing_pool::~work_stealing_pool() {
+  /// Stop and join the worker threads
+  {
+    std::lock_guard lock{mutex};
+    stopping = true;
+  }
+  start_condition.notify_all();
+  for(auto &thread : threads) {
+    thread.join();
+  }
+}
+
+unsigned int work_stealing_pool::get_default_thread_count() {
+  /// Every hardware thread, or only the calling thread where threads aren't available
+  #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    return 1;                                                                   // built without pthreads support
+  #else
+    return std::max(1u, std::thread::hardware_concurrency());
+  #endif // __EMSCRIPTEN__
+}
+
+unsigned int work_stealing_pool::get_thread_count() const {
+  return static_cast<unsigned int>(ranges.size());
+}
+
+void work_stealing_pool::run(size_t task_count, std::function<void(size_t)> const &task) {
+  /// Run task(0) to task(task_count - 1) across the pool, returning when all of them have finished
+  if(task_count == 0) return;
+  auto const worker_count{ranges.size()};
+  for(size_t worker{0}; worker != worker_count; ++worker) {
+    std::lock_guard lock{ranges[worker].mutex};
+    ranges[worker].begin = task_count * worker / worker_count;
+    ranges[worker].end   = task_count * (worker + 1) / worker_count;
+  }
+
+  {
+    std::lock_guard lock{mutex};
+    current_task = &task;
+    workers_busy = static_cast<unsigned int>(threads.size());
+    ++generation;
+  }
+  start_condition.notify_all();
+  work(0);
+
+  std::unique_lock lock{mutex};
+  done_condition.wait(lock, [&]{return workers_busy == 0;});
+  current_task = nullptr;
+  ++stats.batches;
+  stats.tasks += task_count;
+  stats.steals = steal_count;
+}
+
+bool work_stealing_pool::pop(unsigned int worker, size_t &task) {
+  /// Take the next task from the front of a worker's own range
+  auto &range{ranges[worker]};
+  std::lock_guard lock{range.mutex};
+  if(range.begin == range.end) return false;
+  task = range.begin++;
+  return true;
+}
+
+bool work_stealing_pool::steal(unsigned int worker, size_t &task) {
+  /// Take the back half of another worker's range, keeping the first task of it to run now
+  for(size_t offset{1}; offset != ranges.size(); ++offset) {
+    auto &victim{ranges[(worker + offset) % ranges.size()]};
+    size_t begin;
+    size_t end;
+    {
+      std::lock_guard lock{victim.mutex};
+      auto const remaining{victim.end - victim.begin};
+      if(remaining == 0) continue;
+      end = victim.end;
+      begin = end - (remaining + 1) / 2;
+      victim.end = begin;
+    }
+    ++steal_count;
+    task = begin;
+    auto &own{ranges[worker]};
+    std::lock_guard lock{own.mutex};
+    own.begin = begin + 1;
+    own.end = end;
+    return true;
+  }
+  return false;
+}
+
+void work_stealing_pool::work(unsigned int worker) {
+  /// Run tasks until there are none left anywhere
+  size_t task;
+  while(pop(worker, task) || steal(worker, task)) {
+    (*current_task)(task);
+  }
+}
+
+void work_stealing_pool::thread_main(unsigned int worker) {
+  /// Wait for each batch, and help with it
+  uint64_t seen_generation{0};
+  while(true) {
+    {
+      std::unique_lock lock{mutex};
+      start_condition.wait(lock, [&]{return stopping || generation != seen_generation;});
+      if(stopping) return;
+      seen_generation = generation;
+    }
+    work(worker);
+    bool last;
+    {
+      std::lock_guard lock{mutex};
+      last = --workers_busy == 0;
+    }
+    if(last) done_condition.notify_one();
+  }
+}
+
+}
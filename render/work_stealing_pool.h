@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace render {
+
+class work_stealing_pool {
+  /// Runs batches of independent, numbered tasks across a fixed set of threads, independent of the graphics API
+  /// Each batch is dealt out as contiguous ranges, one per worker; a worker whose range runs out steals the back
+  /// half of another's, so uneven tasks balance themselves without a shared queue every task contends on
+  /// The calling thread works as well, so a pool of one thread runs everything inline
+  struct task_range {
+    std::mutex mutex;
+    size_t begin{0};
+    size_t end{0};
+  };
+  std::vector<task_range> ranges;                                               // one per worker, worker 0 being the calling thread
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;                                                             // guards the batch state below
+  std::condition_variable start_condition;
+  std::condition_variable done_condition;
+  std::function<void(size_t)> const *current_task{nullptr};
+  uint64_t generation{0};                                                       // incremented for every batch
+  unsigned int workers_busy{0};                                                 // threads still working on the current batch
+  bool stopping{false};
+
+  std::atomic<uint64_t> steal_count{0};
+
+  bool pop(unsigned int worker, size_t &task);
+  bool steal(unsigned int worker, size_t &task);
+  void work(unsigned int worker);
+  void thread_main(unsigned int worker);
+
+public:
+  struct stats_data {
+    uint64_t batches{0};
+    uint64_t tasks{0};
+    uint64_t steals{0};                                                         // ranges taken from another worker
+  } stats;
+
+  explicit work_stealing_pool(unsigned int thread_count = 0);
+  ~work_stealing_pool();
+  work_stealing_pool(work_stealing_pool const&) = delete;
+  work_stealing_pool &operator=(work_stealing_pool const&) = delete;
+
+  static unsigned int get_default_thread_count();
+  unsigned int get_thread_count() const;
+
+  void run(size_t task_count, std::function<void(size_t)> const &task);
+};
+
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "fnv1a.h"
+#include "wgsl/minifier.h"
+#include "wgsl/reflection.h"
+
+// native build tool: embeds resource files in C++ headers, each next to its source as <file>.h, with the size and
+// hash of the contents available at compile time, and for WGSL shaders a reflection of their interface
+// Minified or stripped text is also embedded unchanged as <name>_source, for anything showing it to the user
+// All resources are compiled in one invocation, and a header is only rewritten when its contents change, so
+// nothing that includes it is rebuilt unnecessarily
+
+namespace {
+
+constexpr std::array text_suffixes{                                             // embedded as null-terminated string literals; anything else as bytes
+  "css",
+  "glsl",
+  "html",
+  "js",
+  "json",
+  "txt",
+  "wgsl",
+};
+
+std::string to_hex(uint64_t value, int digits) {
+  std::array<char, 17> buffer{};
+  std::snprintf(buffer.data(), buffer.size(), "%0*llx", digits, static_cast<unsigned long long>(value));
+  return buffer.data();
+}
+
+std::string read_file(std::filesystem::path const &filename) {
+  std::ifstream file{filename, std::ios::binary};
+  if(!file) throw std::runtime_error{"Unable to read " + filename.string()};
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+std::string strip_comments(std::string_view source) {
+  /// Strip C-style line comments and whitespace-only lines
+  std::string result;
+  while(!source.empty()) {
+    auto const line_end{source.find('\n')};
+    auto line{source.substr(0, line_end)};
+    source.remove_prefix(line_end == std::string_view::npos ? source.size() : line_end + 1);
+    if(auto const comment{line.find("//")}; comment != std::string_view::npos) line = line.substr(0, comment);
+    while(!line.empty() && line.back() == ' ') line.remove_suffix(1);
+    if(line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+    result += line;
+    result += '\n';
+  }
+  return result;
+}
+
+std::string prepare_contents(std::string const &source, std::string_view suffix) {
+  /// Minify or strip comments from the types of resource that allow it
+  if(suffix == "wgsl") return wgsl::minify(source);
+  if(suffix == "glsl") return strip_comments(source);
+  return source;
+}
+
+std::string quote(std::string_view text) {
+  return "\"" + std::string{text} + "\"";
+}
+
+std::string make_text_literal(std::filesystem::path const &filename, std::string const &name, std::string const &contents, uint64_t hash) {
+  /// Embed text as a raw string literal, with its size and hash
+  if(contents.find('\0') != std::string::npos) throw std::runtime_error{filename.string() + " contains a null character, so can't be embedded as text"};
+  auto const delimiter{to_hex(hash, 16)};                                       // raw string delimiters are limited to 16 characters
+  if(contents.find(")" + delimiter + "\"") != std::string::npos) throw std::runtime_error{filename.string() + " contains its own raw string delimiter"};
+  std::string result{"inline constexpr char const *" + name + "{R\"" + delimiter + "(" + contents + ")" + delimiter + "\"};\n"};
+  result += "inline constexpr size_t " + name + "_size{" + std::to_string(contents.size()) + "};\n";
+  result += "inline constexpr uint64_t " + name + "_hash{0x" + to_hex(hash, 16) + "ull};\n";
+  return result;
+}
+
+std::string make_visibility(uint32_t visibility) {
+  /// Spell out visibility bits with their names
+  std::string result;
+  for(auto const &[bit, bit_name] : std::array<std::pair<uint32_t, char const*>, 3>{{
+    {wgsl::reflection::visible_in_vertex, "visible_in_vertex"},
+    {wgsl::reflection::visible_in_fragment, "visible_in_fragment"},
+    {wgsl::reflection::visible_in_compute, "visible_in_compute"},
+  }}) {
+    if(!(visibility & bit)) continue;
+    if(!result.empty()) result += " | ";
+    result += "wgsl::reflection::";
+    result += bit_name;
+  }
+  return result.empty() ? "0" : result;
+}
+
+std::string generate_reflection(std::string const &source, std::string const &name) {
+  /// Write out a shader's interface as constexpr data, in a namespace of its own
+  using namespace std::string_literals;
+  auto const module{wgsl::reflection::reflect(source)};
+  std::string result{"\nnamespace " + name + "_reflection {\n\n"};
+
+  for(auto const &structure : module.structs) {
+    result += "inline constexpr std::array<wgsl::reflection::member, " + std::to_string(structure.members.size()) + "> " + std::string{structure.name} + "_members{{\n";
+    for(auto const &member : structure.members) {
+      result += "  {.name{" + quote(member.name) + "}, .offset{" + std::to_string(member.offset) + "}, .size{" + std::to_string(member.size) + "}, .alignment{" + std::to_string(member.alignment) + "}},\n";
+    }
+    result += "}};\n";
+  }
+  result += "inline constexpr std::array<wgsl::reflection::struct_layout, " + std::to_string(module.structs.size()) + "> structs{{\n";
+  for(auto const &structure : module.structs) {
+    result += "  {.name{" + quote(structure.name) + "}, .size{" + std::to_string(structure.size) + "}, .alignment{" + std::to_string(structure.alignment) + "}, .members{" + std::string{structure.name} + "_members}},\n";
+  }
+  result += "}};\n\n";
+
+  constexpr std::array binding_type_names{"uniform_buffer", "storage_buffer", "read_only_storage_buffer", "sampler", "comparison_sampler", "texture", "depth_texture", "storage_texture"};
+  constexpr std::array sample_type_names{"none", "floating", "signed_integer", "unsigned_integer", "depth"};
+  constexpr std::array dimension_names{"none", "d1", "d2", "d2_array", "cube", "cube_array", "d3"};
+  result += "inline constexpr std::array<wgsl::reflection::resource_binding, " + std::to_string(module.bindings.size()) + "> bindings{{\n";
+  for(auto const &binding : module.bindings) {
+    result += "  {\n";
+    result += "    .group{" + std::to_string(binding.group) + "},\n";
+    result += "    .binding{" + std::to_string(binding.binding) + "},\n";
+    result += "    .name{" + quote(binding.name) + "},\n";
+    result += "    .type{wgsl::reflection::binding_types::"s + binding_type_names[static_cast<size_t>(binding.type)] + "},\n";
+    result += "    .visibility{" + make_visibility(binding.visibility) + "},\n";
+    result += "    .min_binding_size{" + std::to_string(binding.min_binding_size) + "},\n";
+    result += "    .type_name{" + quote(binding.type_name) + "},\n";
+    result += "    .sample_type{wgsl::reflection::sample_types::"s + sample_type_names[static_cast<size_t>(binding.sample_type)] + "},\n";
+    result += "    .dimension{wgsl::reflection::texture_dimensions::"s + dimension_names[static_cast<size_t>(binding.dimension)] + "},\n";
+    result += "    .multisampled{"s + (binding.multisampled ? "true" : "false") + "},\n";
+    result += "    .texel_format{" + quote(binding.texel_format) + "},\n";
+    result += "    .access{" + quote(binding.access) + "},\n";
+    result += "  },\n";
+  }
+  result += "}};\n\n";
+
+  constexpr std::array override_type_names{"boolean", "f32", "i32", "u32"};
+  result += "inline constexpr std::array<wgsl::reflection::override_constant, " + std::to_string(module.overrides.size()) + "> overrides{{\n";
+  for(auto const &override_constant : module.overrides) {
+    result += "  {.name{" + quote(override_constant.name) + "}, .type{wgsl::reflection::override_types::" + override_type_names[static_cast<size_t>(override_constant.type)] + "}, .visibility{" + make_visibility(override_constant.visibility) + "}, .has_default{" + (override_constant.has_default ? "true" : "false") + "}},\n";
+  }
+  result += "}};\n\n";
+
+  constexpr std::array component_type_names{"f32", "i32", "u32"};
+  constexpr std::array stage_names{"vertex", "fragment", "compute"};
+  for(auto const &entry_point : module.entry_points) {
+    result += "inline constexpr std::array<wgsl::reflection::vertex_input, " + std::to_string(entry_point.inputs.size()) + "> " + std::string{entry_point.name} + "_inputs{{\n";
+    for(auto const &input : entry_point.inputs) {
+      result += "  {.location{" + std::to_string(input.location) + "}, .name{" + quote(input.name) + "}, .component_type{wgsl::reflection::component_types::" + component_type_names[static_cast<size_t>(input.component_type)] + "}, .components{" + std::to_string(input.components) + "}},\n";
+    }
+    result += "}};\n";
+  }
+  result += "inline constexpr std::array<wgsl::reflection::entry_point, " + std::to_string(module.entry_points.size()) + "> entry_points{{\n";
+  for(auto const &entry_point : module.entry_points) {
+    result += "  {.name{" + quote(entry_point.name) + "}, .stage{wgsl::reflection::stages::" + stage_names[static_cast<size_t>(entry_point.stage)] + "}, .inputs{" + std::string{entry_point.name} + "_inputs}},\n";
+  }
+  result += "}};\n\n} // namespace " + name + "_reflection\n";
+  return result;
+}
+
+std::string generate_header(std::filesystem::path const &filename, std::string const &name_space) {
+  /// Generate the C++ header embedding one resource
+  auto suffix{filename.extension().string()};
+  if(!suffix.empty()) suffix.erase(0, 1);
+  std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c){return static_cast<char>(std::tolower(c));});
+  auto name{filename.filename().string()};
+  std::replace(name.begin(), name.end(), '.', '_');
+
+  auto const source{read_file(filename)};
+  std::string contents;
+  std::string reflection;
+  try {
+    contents = prepare_contents(source, suffix);
+    if(suffix == "wgsl") reflection = generate_reflection(source, name);
+  } catch(std::exception const &e) {
+    throw std::runtime_error{filename.string() + ": " + e.what()};
+  }
+  auto const hash{fnv1a(contents)};
+  bool const text{std::find(text_suffixes.begin(), text_suffixes.end(), suffix) != text_suffixes.end()};
+
+  std::string header{"#pragma once\n\n"};
+  header += "// This file is automatically generated from " + filename.generic_string() + " by resource_compiler\n\n";
+  if(!text || !reflection.empty()) header += "#include <array>\n";
+  header += "#include <cstddef>\n#include <cstdint>\n";
+  if(!reflection.empty()) header += "#include \"wgsl/reflection.h\"\n";
+  header += "\n";
+  if(!name_space.empty()) header += "namespace " + name_space + " {\n\n";
+
+  if(text) {
+    header += make_text_literal(filename, name, contents, hash);
+    if(contents != source) header += make_text_literal(filename, name + "_source", source, fnv1a(source)); // unminified, for showing to the user
+  } else {
+    header += "inline constexpr std::array<uint8_t, " + std::to_string(contents.size()) + "> " + name + "{";
+    for(size_t i{0}; i != contents.size(); ++i) {
+      header += (i % 16 == 0 ? "\n  0x" : " 0x") + to_hex(static_cast<uint8_t>(contents[i]), 2) + ",";
+    }
+    header += "\n};\n";
+    header += "inline constexpr size_t " + name + "_size{" + std::to_string(contents.size()) + "};\n";
+    header += "inline constexpr uint64_t " + name + "_hash{0x" + to_hex(hash, 16) + "ull};\n";
+  }
+  header += reflection;
+
+  if(!name_space.empty()) header += "\n} // namespace " + name_space + "\n";
+  return header;
+}
+
+bool write_if_changed(std::filesystem::path const &filename, std::string const &contents) {
+  /// Write a file only if its contents would change, leaving its timestamp alone otherwise
+  if(std::filesystem::exists(filename) && read_file(filename) == contents) return false;
+  std::ofstream file{filename, std::ios::binary};
+  if(!file) throw std::runtime_error{"Unable to write " + filename.string()};
+  file << contents;
+  if(!file) throw std::runtime_error{"Error writing " + filename.string()};
+  return true;
+}
+
+std::string namespace_for(std::filesystem::path const &filename) {
+  /// A namespace matching the directory the resource is in, such as render::shaders for render/shaders
+  std::string result;
+  for(auto const &part : filename.parent_path().relative_path()) {
+    auto const text{part.string()};
+    if(text.empty() || text == ".") continue;
+    if(!result.empty()) result += "::";
+    result += text;
+  }
+  return result;
+}
+
+}
+
+auto main(int argc, char *argv[])->int {
+  std::string name_space;
+  bool explicit_namespace{false};
+  std::vector<std::filesystem::path> filenames;
+  std::span const args{argv + 1, static_cast<size_t>(argc - 1)};
+  for(size_t i{0}; i != args.size(); ++i) {
+    std::string const arg{args[i]};
+    if(arg == "--namespace" && i + 1 != args.size()) {
+      name_space = args[++i];
+      explicit_namespace = true;
+    } else {
+      filenames.emplace_back(arg);
+    }
+  }
+  if(filenames.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [--namespace name] <file>..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    unsigned int updated{0};
+    for(auto const &filename : filenames) {
+      auto const header_filename{filename.string() + ".h"};
+      if(write_if_changed(header_filename, generate_header(filename, explicit_namespace ? name_space : namespace_for(filename)))) {
+        std::cout << "Resource compiler: " << filename.generic_string() << " compiled to " << header_filename << '\n';
+        ++updated;
+      }
+    }
+    std::cout << "Compiled resources: " << updated << " updated, " << filenames.size() - updated << " up to date (" << filenames.size() << " total)" << std::endl;
+    return EXIT_SUCCESS;
+
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
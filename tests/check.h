@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+namespace tests {
+
+// minimal support for the native unit tests: failed checks are reported with their location and counted,
+// and each test's main returns get_exit_code() so ctest sees any failure
+
+inline unsigned int failures{0};
+
+inline void check(bool condition, std::string_view description, std::source_location location = std::source_location::current()) {
+  /// Report and count a failed expectation, carrying on so one run shows every failure
+  if(condition) return;
+  ++failures;
+  std::cerr << location.file_name() << ':' << location.line() << ": check failed: " << description << '\n';
+}
+
+inline int get_exit_code() {
+  /// Report the outcome of the checks made so far
+  if(failures == 0) return EXIT_SUCCESS;
+  std::cerr << failures << " checks failed\n";
+  return EXIT_FAILURE;
+}
+
+}
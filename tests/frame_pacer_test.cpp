@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "render/frame_pacer.h"
+#include "tests/check.h"
+
+// checks the frame pacer against a fake clock: the in-flight limit and deferral, completion in submission order,
+// and the latency measured from sampling input to completing each frame
+
+namespace {
+
+render::frame_pacer::clock::time_point at(int milliseconds) {
+  /// A time on the fake clock, as a whole number of milliseconds after it started
+  return render::frame_pacer::clock::time_point{} + std::chrono::milliseconds{milliseconds};
+}
+
+bool near(float lhs, float rhs) {
+  return std::abs(lhs - rhs) < 1e-3f;
+}
+
+}
+
+auto main()->int {
+  using tests::check;
+  using render::frame_pacer;
+
+  frame_pacer pacer;
+  check(pacer.get_max_frames_in_flight() == 2, "two frames may be in flight by default");
+  pacer.set_max_frames_in_flight(0);
+  check(pacer.get_max_frames_in_flight() == 1, "at least one frame may be in flight");
+  pacer.set_max_frames_in_flight(10);
+  check(pacer.get_max_frames_in_flight() == frame_pacer::max_frames_in_flight_limit, "the limit is clamped to the most that's tracked");
+  pacer.set_max_frames_in_flight(2);
+
+  check(pacer.can_submit(), "a frame may be submitted with none in flight");
+  auto const first{pacer.submit(at(0), at(2))};
+  check(pacer.can_submit(), "a second frame may be submitted");
+  auto const second{pacer.submit(at(16), at(18))};
+  check(second == first + 1, "frames are numbered in submission order");
+  check(pacer.get_frames_in_flight() == 2, "submitted frames are in flight");
+  check(!pacer.can_submit() && !pacer.can_submit(), "frames beyond the limit are deferred");
+  check(pacer.stats.deferred == 2, "each deferred frame is counted");
+
+  pacer.complete(first, at(30));
+  check(pacer.get_frames_in_flight() == 1 && pacer.can_submit(), "a completed frame makes room for another");
+  check(near(pacer.stats.last_latency_ms, 30.0f) && near(pacer.stats.last_gpu_ms, 28.0f), "latency is measured from input, and GPU time from submission");
+  pacer.complete(first, at(31));
+  check(pacer.stats.completed == 1, "completing a frame again changes nothing");
+
+  auto const third{pacer.submit(at(32), at(33))};
+  pacer.complete(third, at(52));
+  check(pacer.get_frames_in_flight() == 0 && pacer.stats.completed == 3, "completing a frame completes every one submitted before it");
+  check(near(pacer.stats.last_latency_ms, 20.0f) && near(pacer.stats.max_latency_ms, 36.0f), "the latest and largest latencies are kept");
+
+  auto const summary{pacer.get_latency_summary()};
+  check(summary.count == 3 && near(summary.min, 20.0f) && near(summary.max, 36.0f), "the summary covers every completed frame");
+  check(near(summary.p50, 30.0f), "the summary has the median latency");
+
+  pacer.set_max_frames_in_flight(4);
+  for(int frame{0}; frame != 4; ++frame) {
+    check(pacer.can_submit(), "frames may be submitted up to a raised limit");
+    pacer.submit(at(100 + frame), at(100 + frame));
+  }
+  pacer.set_max_frames_in_flight(1);
+  check(!pacer.can_submit(), "lowering the limit defers frames until those in flight drain");
+  pacer.complete(third + 3, at(120));
+  check(pacer.get_frames_in_flight() == 1 && !pacer.can_submit(), "frames stay deferred until in flight are within the limit");
+  pacer.complete(third + 4, at(121));
+  check(pacer.can_submit(), "frames may be submitted again once drained");
+  check(pacer.stats.submitted == 7 && pacer.stats.completed == 7, "every frame is counted");
+
+  return tests::get_exit_code();
+}
@@ -0,0 +1,47 @@
+#include "render/idle_scheduler.h"
+#include "tests/check.h"
+
+// checks the idle scheduler draws a frame for each change, keeps drawing through GUI input's cooldown, and
+// otherwise skips frames until something changes
+
+auto main()->int {
+  using tests::check;
+  using reason = render::idle_scheduler::reason;
+
+  render::idle_scheduler idle;
+  check(!idle.is_idle(), "the first frame is always drawn");
+  check(idle.should_draw(), "the first frame is drawn");
+  check(idle.is_idle(), "with nothing requested the scheduler goes idle");
+  check(!idle.should_draw() && !idle.should_draw(), "idle frames are skipped");
+
+  idle.request(reason::uniforms);
+  idle.request(reason::shader);
+  check(idle.should_draw(), "a change is drawn");
+  check(!idle.should_draw(), "several changes in one frame are drawn once");
+
+  idle.request(reason::input);
+  for(unsigned int frame{0}; frame != idle.input_cooldown_frames; ++frame) {
+    check(idle.should_draw(), "frames are drawn while input settles");
+  }
+  check(!idle.should_draw(), "the scheduler goes idle once input has settled");
+
+  idle.request(reason::input);
+  idle.should_draw();
+  idle.request(reason::uniforms);
+  check(idle.should_draw(), "a change during the cooldown doesn't cut it short");
+  check(idle.should_draw(), "a change during the cooldown doesn't cut it short");
+  check(!idle.should_draw(), "the cooldown isn't extended by other changes");
+
+  idle.set_animate(true);
+  check(idle.get_animate() && !idle.is_idle(), "animating is never idle");
+  check(idle.should_draw() && idle.should_draw(), "every frame is drawn while animating");
+  idle.set_animate(false);
+  check(idle.is_idle(), "the scheduler is idle again once animation stops");
+
+  render::idle_scheduler const delayed{3};
+  check(!delayed.is_idle(), "initial frames are drawn before going idle");
+
+  check(idle.stats.drawn == 10 && idle.stats.skipped == 5, "drawn and skipped frames are counted");
+
+  return tests::get_exit_code();
+}
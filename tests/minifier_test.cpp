@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include "render/shaders/default.wgsl.h"
+#include "tests/check.h"
+#include "wgsl/minifier.h"
+#include "wgsl/reflection.h"
+
+// checks the WGSL minifier round trip: the embedded default shader is the minified form of its source, and
+// minifying keeps the interface the host relies on, its entry points, bindings and override constants
+
+auto main()->int {
+  using tests::check;
+  using render::shaders::default_wgsl;
+  using render::shaders::default_wgsl_source;
+
+  std::string_view const source{default_wgsl_source, render::shaders::default_wgsl_source_size};
+  wgsl::minify_stats stats;
+  auto const minified{wgsl::minify(source, &stats)};
+  check(minified == std::string_view{default_wgsl, render::shaders::default_wgsl_size}, "the embedded shader is the minified source");
+  check(stats.source_bytes == source.size() && stats.minified_bytes == minified.size(), "the sizes before and after are counted");
+  check(minified.size() < source.size(), "minifying makes the shader smaller");
+  check(wgsl::minify(minified) == minified, "minifying again changes nothing");
+
+  auto const original{wgsl::reflection::reflect(source)};
+  auto const result{wgsl::reflection::reflect(minified)};
+  check(result.entry_points.size() == original.entry_points.size(), "every entry point is kept");
+  for(auto const &entry_point : original.entry_points) {
+    auto const it{std::ranges::find(result.entry_points, entry_point.name, &wgsl::reflection::reflected_entry_point::name)};
+    check(it != result.entry_points.end() && it->stage == entry_point.stage, "entry points keep their names and stages");
+    check(it != result.entry_points.end() && it->inputs.size() == entry_point.inputs.size(), "vertex entry points keep their inputs");
+  }
+  check(result.bindings.size() == original.bindings.size(), "every binding is kept");
+  for(auto const &binding : original.bindings) {
+    auto const *found{wgsl::reflection::find_binding(result.bindings, binding.group, binding.binding)};
+    check(found && found->type == binding.type && found->visibility == binding.visibility, "bindings keep their type and visibility");
+    check(found && found->min_binding_size == binding.min_binding_size, "bindings keep their size");
+  }
+  check(result.overrides.size() == original.overrides.size(), "every override constant is kept");
+  for(auto const &override_constant : original.overrides) {
+    auto const *found{wgsl::reflection::find_override(result.overrides, override_constant.name)};
+    check(found && found->type == override_constant.type && found->has_default == override_constant.has_default, "override constants keep their names, types and defaults");
+  }
+
+  return tests::get_exit_code();
+}
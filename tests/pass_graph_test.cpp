@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "render/pass_graph.h"
+#include "tests/check.h"
+#include "wgsl/reflection.h"
+
+// checks the pass graph parsed from shader comments: the shipped example's passes and its interface, ordering
+// and culling, which textures are transient, ping-pong sides, and skipping passes whose inputs haven't changed
+
+namespace {
+
+std::string read_file(std::string const &filename) {
+  std::ifstream file{filename, std::ios::binary};
+  if(!file) throw std::runtime_error{"Unable to read " + filename};
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+bool parse_fails(std::string_view source) {
+  /// Whether parsing a source throws
+  try {
+    render::pass_graph::parse(source);
+  } catch(std::runtime_error const&) {
+    return true;
+  }
+  return false;
+}
+
+}
+
+auto main()->int {
+  using tests::check;
+  using render::pass_graph;
+
+  check(pass_graph::parse("fn fs_main() {}\n// pass a fs_a writes x\n").empty(), "a source without directives gives an empty graph");
+  check(parse_fails("//! pass a fs_a reads x\n"), "a pass must write a texture");
+  check(parse_fails("//! pass a fs_a writes x reads y\n"), "a pass can't read a texture no pass writes");
+  check(parse_fails("//! pass a fs_a writes x\n//! pass a fs_b writes y reads x\n"), "a pass can't be declared twice");
+  check(parse_fails("//! pass a fs_a writes x reads\n"), "reads needs at least one texture");
+
+  // the example shipped for the editor: a feedback pass and a pass displaying its result
+  auto const example_source{read_file("render/shaders/examples/trails.wgsl")};
+  auto example{pass_graph::parse(example_source)};
+  check(example.get_passes().size() == 2 && example.get_order().size() == 2, "the example's passes all run");
+  check(example.has_feedback(), "the example's trails pass reads its previous frame");
+  check(!example.get_textures()[0].transient && !example.get_textures()[1].transient, "the example's textures are read next frame or displayed, so kept as pairs");
+  check(example.get_output() == 1, "the last pass's texture is displayed");
+  auto const module{wgsl::reflection::reflect(example_source)};
+  for(auto const &this_pass : example.get_passes()) {
+    auto const it{std::ranges::find(module.entry_points, this_pass.entry_point, &wgsl::reflection::reflected_entry_point::name)};
+    check(it != module.entry_points.end() && it->stage == wgsl::reflection::stages::fragment, "each pass names a fragment entry point of the example");
+  }
+  auto const *uniforms{wgsl::reflection::find_binding(module.bindings, 0, 0)};
+  check(uniforms && (uniforms->visibility & wgsl::reflection::visible_in_fragment), "the example's passes read the uniforms from the fragment stage");
+  check(wgsl::reflection::find_binding(module.bindings, 0, 1) && wgsl::reflection::find_binding(module.bindings, 0, 2), "the example binds the sampler and its input after the uniforms");
+
+  auto const first{example.schedule(0)};
+  check(first.size() == 2 && first[0].target_side == 1 && first[0].input_sides == 0, "a pass reads one side of a pair and writes the other");
+  auto const second{example.schedule(0)};
+  check(second.size() == 2, "passes reading a previous frame run every frame");
+  check(second[0].target_side == 0 && second[0].input_sides == 1, "the sides swap each frame");
+
+  // a chain of passes, with one contributing nothing to the output
+  auto chain{pass_graph::parse(
+    "//! pass a fs_a writes x\n"
+    "  //! pass unused fs_unused writes spare reads x\n"
+    "//! pass b fs_b writes y reads x\n"
+    "//! pass c fs_c writes z reads y\n"
+  )};
+  check(!chain.has_feedback(), "a chain reading only this frame's results has no feedback");
+  check(chain.is_culled(1) && chain.get_order().size() == 3, "a pass contributing nothing to the output is culled");
+  check(std::ranges::equal(chain.get_order(), std::array{0u, 2u, 3u}), "passes run in the order declared");
+  check(chain.get_textures()[0].transient && chain.get_textures()[2].transient, "textures only read within the frame are transient");
+  check(!chain.get_textures()[3].transient, "the displayed texture is kept");
+  check(chain.get_textures()[1].allocation == render::render_graph::no_allocation, "a culled pass's texture isn't allocated");
+  check(chain.schedule(0).size() == 3, "every pass runs the first time");
+  check(chain.schedule(0).empty(), "passes are skipped while nothing they depend on changes");
+  check(chain.schedule(1).size() == 3, "a uniform change runs every pass again");
+  chain.invalidate();
+  check(chain.schedule(1).size() == 3, "invalidating runs every pass again");
+  check(chain.stats.passes_run == 9 && chain.stats.passes_skipped == 3, "run and skipped passes are counted");
+
+  // a transient texture feeding a pass that runs every frame must be drawn again, as it isn't kept
+  auto rerun{pass_graph::parse(
+    "//! pass a fs_a writes x\n"
+    "//! pass b fs_b writes state reads x state\n"
+  )};
+  check(rerun.get_textures()[0].transient, "the first pass's texture is transient");
+  check(rerun.schedule(0).size() == 2, "every pass runs the first time");
+  check(rerun.schedule(0).size() == 2 && rerun.stats.passes_rerun == 1, "an unchanged pass runs again to rewrite a transient texture a running pass reads");
+
+  return tests::get_exit_code();
+}
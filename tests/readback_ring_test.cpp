@@ -0,0 +1,41 @@
+#include "render/readback_ring.h"
+#include "tests/check.h"
+
+// checks the readback ring's slot lifecycle: slots are handed out round-robin, and frames that find every slot
+// busy are skipped until one is released
+
+auto main()->int {
+  using tests::check;
+  using slot_state = render::readback_ring::slot_state;
+
+  render::readback_ring ring{3};
+  check(ring.size() == 3, "the ring has the requested number of slots");
+  for(unsigned int slot{0}; slot != ring.size(); ++slot) {
+    check(ring.get_state(slot) == slot_state::free, "slots start free");
+  }
+
+  auto const first{ring.acquire()};
+  check(first == 0u, "the first slot is acquired first");
+  check(ring.get_state(0) == slot_state::encoded, "an acquired slot is encoded");
+  ring.submit(0);
+  check(ring.get_state(0) == slot_state::mapping, "a submitted slot is mapping");
+
+  check(ring.acquire() == 1u, "slots are acquired round-robin");
+  ring.submit(1);
+  check(ring.acquire() == 2u, "slots are acquired round-robin");
+  ring.submit(2);
+  check(!ring.acquire(), "no slot is acquired while all are mapping");
+  check(ring.stats.acquired == 3 && ring.stats.skipped == 1, "the skipped frame is counted");
+
+  ring.release(1);
+  check(ring.get_state(1) == slot_state::free, "a released slot is free");
+  check(ring.acquire() == 1u, "a released slot is reused");
+  ring.release(1);                                                              // abandoned while only encoded
+  check(ring.get_state(1) == slot_state::free, "an encoded slot can be released without submitting it");
+
+  ring.release(0);
+  check(ring.acquire() == 0u, "the search carries on from after the last slot acquired");
+  check(ring.stats.acquired == 5 && ring.stats.skipped == 1, "every acquisition is counted");
+
+  return tests::get_exit_code();
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "render/render_graph.h"
+#include "tests/check.h"
+
+// checks the render graph orders passes by their dependencies whatever order they're added in, culls those that
+// contribute nothing, aliases transient textures whose lifetimes don't overlap, and rejects invalid graphs
+
+namespace {
+
+bool compile_fails(render::render_graph &graph) {
+  /// Whether compiling a graph throws
+  try {
+    graph.compile();
+  } catch(std::runtime_error const&) {
+    return true;
+  }
+  return false;
+}
+
+}
+
+auto main()->int {
+  using tests::check;
+  using render::render_graph;
+
+  // a post-processing chain, added out of order, with a pass whose result nothing uses
+  render_graph graph;
+  auto const scene{graph.add_texture({.name{"scene"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const blurred_x{graph.add_texture({.name{"blurred_x"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const blurred_y{graph.add_texture({.name{"blurred_y"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const toned{graph.add_texture({.name{"toned"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const screen{graph.add_texture({.name{"screen"}, .size{2}, .compatibility{0}, .persistent{true}})};
+  auto const spare{graph.add_texture({.name{"spare"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const show{graph.add_pass({.name{"show"}, .reads{toned}, .writes{screen}})};
+  auto const blur_y{graph.add_pass({.name{"blur_y"}, .reads{blurred_x}, .writes{blurred_y}})};
+  auto const unused{graph.add_pass({.name{"unused"}, .reads{blurred_y}, .writes{spare}})};
+  auto const blur_x{graph.add_pass({.name{"blur_x"}, .reads{scene}, .writes{blurred_x}})};
+  auto const tone{graph.add_pass({.name{"tone"}, .reads{blurred_y}, .writes{toned}})};
+  auto const draw{graph.add_pass({.name{"draw"}, .reads{}, .writes{scene}})};
+  graph.compile();
+
+  check(std::ranges::equal(graph.get_order(), std::array{draw, blur_x, blur_y, tone, show}), "each texture is written before it's read");
+  check(graph.is_culled(unused) && !graph.is_culled(tone), "a pass contributing to no persistent texture is culled");
+  check(graph.get_allocation(spare) == render_graph::no_allocation, "a texture only a culled pass uses isn't allocated");
+  check(graph.get_allocation(scene) == graph.get_allocation(blurred_y), "transient textures whose lifetimes don't overlap share an allocation");
+  check(graph.get_allocation(blurred_x) == graph.get_allocation(toned), "transient textures whose lifetimes don't overlap share an allocation");
+  check(graph.get_allocation(scene) != graph.get_allocation(blurred_x), "a texture read by a pass doesn't share with the one it writes");
+  check(graph.get_allocation(screen) != graph.get_allocation(scene) && graph.get_allocation(screen) != graph.get_allocation(blurred_x), "a persistent texture has an allocation of its own");
+  auto const &report{graph.get_memory_report()};
+  check(report.textures == 5 && report.allocations == 3 && graph.get_allocation_count() == 3, "the report counts the textures used and their allocations");
+  check(report.without_aliasing == 6 && report.with_aliasing == 4, "the report shows the memory aliasing saves");
+
+  // transient textures only alias ones they're compatible with
+  render_graph formats;
+  auto const colour{formats.add_texture({.name{"colour"}, .size{1}, .compatibility{1}, .persistent{false}})};
+  auto const depth{formats.add_texture({.name{"depth"}, .size{1}, .compatibility{2}, .persistent{false}})};
+  auto const output{formats.add_texture({.name{"output"}, .size{1}, .compatibility{1}, .persistent{true}})};
+  formats.add_pass({.name{"first"}, .reads{}, .writes{colour}});
+  formats.add_pass({.name{"second"}, .reads{colour}, .writes{depth}});
+  formats.add_pass({.name{"third"}, .reads{depth}, .writes{output}});
+  formats.compile();
+  check(formats.get_allocation(colour) != formats.get_allocation(depth), "textures of different formats don't alias");
+
+  // a persistent texture read before it's written sees the previous frame's, so isn't a dependency
+  render_graph feedback;
+  auto const history{feedback.add_texture({.name{"history"}, .size{2}, .compatibility{0}, .persistent{true}})};
+  feedback.add_pass({.name{"accumulate"}, .reads{history}, .writes{history}});
+  check(!compile_fails(feedback) && feedback.get_order().size() == 1, "a pass may read the persistent texture it writes");
+
+  // a pass reading a persistent texture must run before a pass added after it overwrites it
+  render_graph overwrite;
+  auto const transient{overwrite.add_texture({.name{"transient"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const previous{overwrite.add_texture({.name{"previous"}, .size{1}, .compatibility{0}, .persistent{true}})};
+  auto const combined{overwrite.add_texture({.name{"combined"}, .size{1}, .compatibility{0}, .persistent{true}})};
+  auto const combine{overwrite.add_pass({.name{"combine"}, .reads{transient, previous}, .writes{combined}})};
+  auto const store{overwrite.add_pass({.name{"store"}, .reads{}, .writes{previous}})};
+  auto const produce{overwrite.add_pass({.name{"produce"}, .reads{}, .writes{transient}})};
+  overwrite.compile();
+  check(std::ranges::equal(overwrite.get_order(), std::array{produce, combine, store}), "a persistent texture is read before a later pass overwrites it");
+
+  render_graph cycle;
+  auto const a{cycle.add_texture({.name{"a"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const b{cycle.add_texture({.name{"b"}, .size{1}, .compatibility{0}, .persistent{true}})};
+  cycle.add_pass({.name{"first"}, .reads{a}, .writes{b}});
+  cycle.add_pass({.name{"second"}, .reads{b}, .writes{a}});
+  check(compile_fails(cycle), "passes depending on each other in a cycle are rejected");
+
+  render_graph writers;
+  auto const shared{writers.add_texture({.name{"shared"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const result{writers.add_texture({.name{"result"}, .size{1}, .compatibility{0}, .persistent{true}})};
+  writers.add_pass({.name{"first"}, .reads{}, .writes{shared}});
+  writers.add_pass({.name{"second"}, .reads{}, .writes{shared}});
+  writers.add_pass({.name{"third"}, .reads{shared}, .writes{result}});
+  check(compile_fails(writers), "a transient texture written by more than one pass is rejected");
+
+  render_graph unwritten;
+  auto const missing{unwritten.add_texture({.name{"missing"}, .size{1}, .compatibility{0}, .persistent{false}})};
+  auto const shown{unwritten.add_texture({.name{"shown"}, .size{1}, .compatibility{0}, .persistent{true}})};
+  unwritten.add_pass({.name{"only"}, .reads{missing}, .writes{shown}});
+  check(compile_fails(unwritten), "reading a transient texture no pass writes is rejected");
+
+  return tests::get_exit_code();
+}
@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <imgui/imgui_impl_wgpu.h>
+#include "logstorm/logstorm.h"
+#include "platform/platform.h"
+#include "platform/platform_headless.h"
+#include "platform/recording_webgpu.h"
+#include "render/webgpu_renderer.h"
+#include "tests/check.h"
+
+// checks that updating the shader compiles its pipeline in the background against the recording WebGPU backend,
+// drawing with the old pipeline until the compilation completes, then swapping to the new one in a single frame
+
+namespace {
+
+uint64_t get_count(std::string_view function) {
+  /// Calls made to an API function since the counts were last reset
+  auto const &counts{platform::recording_webgpu::get_counts()};
+  auto const it{counts.find(function)};
+  return it == counts.end() ? 0 : it->second;
+}
+
+class shader_reload_test {
+  logstorm::manager logger{logstorm::manager::build_with_sink<logstorm::sink::console>()}; // logging system
+  render::webgpu_renderer renderer{logger};                                     // WebGPU rendering system
+
+  static constexpr unsigned int warmup_frames{5};                               // frames to draw before updating, while the initial pipeline settles
+  unsigned int frame{0};
+
+  void loop_main();
+  void draw();
+
+public:
+  shader_reload_test();
+};
+
+shader_reload_test::shader_reload_test() {
+  /// Run the renderer headless, through the reload
+  renderer.init(
+    [&](render::webgpu_renderer::webgpu_data const& webgpu){
+      ImGui::CreateContext();
+      ImGui::GetIO().IniFilename = nullptr;
+      ImGui_ImplWGPU_InitInfo imgui_wgpu_info;
+      imgui_wgpu_info.Device = webgpu.device.Get();
+      imgui_wgpu_info.RenderTargetFormat = static_cast<WGPUTextureFormat>(webgpu.surface_preferred_format);
+      ImGui_ImplWGPU_Init(&imgui_wgpu_info);
+
+      renderer.idle.set_animate(true);                                          // draw every frame, so each one has a scene pass to check
+    },
+    [&]{
+      loop_main();
+    }
+  );
+}
+
+void shader_reload_test::draw() {
+  /// Draw one frame with an empty GUI
+  auto &io{ImGui::GetIO()};
+  auto const &canvas_size{platform::headless::get_settings().canvas_css_size};
+  io.DisplaySize = ImVec2{canvas_size.x, canvas_size.y};
+  io.DeltaTime = 1.0f / 60.0f;
+  ImGui_ImplWGPU_NewFrame();
+  ImGui::NewFrame();
+  ImGui::Render();
+  renderer.draw({});
+}
+
+void shader_reload_test::loop_main() {
+  /// Main pseudo-loop, stepping through the reload one frame at a time
+  using platform::recording_webgpu::process_events;
+  using platform::recording_webgpu::reset_counts;
+
+  if(frame < warmup_frames) {
+    process_events();
+    draw();
+  } else if(frame == warmup_frames) {
+    process_events();
+    reset_counts();
+    std::string const edited_shader{renderer.get_shader() + "\n// edited\n"};   // a different source, so no cached pipeline matches
+    renderer.update_shader(edited_shader);
+    tests::check(get_count("wgpuDeviceCreateRenderPipelineAsync") == 1, "updating the shader compiles its pipeline asynchronously");
+    tests::check(get_count("wgpuDeviceCreateRenderPipeline") == 0, "updating the shader doesn't block on a pipeline");
+    tests::check(renderer.get_shader() == edited_shader, "the edited shader is current");
+
+    reset_counts();
+    draw();                                                                     // before the compilation completes
+    tests::check(get_count("wgpuRenderPassEncoderExecuteBundles") == 1, "the scene is still drawn while compiling");
+    tests::check(get_count("wgpuRenderBundleEncoderFinish") == 0, "the old render bundle is kept while compiling");
+  } else if(frame == warmup_frames + 1) {
+    reset_counts();
+    process_events();                                                           // delivers the compiled pipeline
+    draw();
+    tests::check(get_count("wgpuRenderBundleEncoderFinish") == 1, "the render bundle is rebuilt once with the new pipeline");
+    tests::check(get_count("wgpuRenderPassEncoderExecuteBundles") == 1, "the scene is drawn with the new pipeline");
+  } else {
+    reset_counts();
+    process_events();
+    draw();
+    tests::check(get_count("wgpuDeviceCreateRenderPipelineAsync") == 0, "nothing is recompiled once the swap is done");
+    tests::check(get_count("wgpuRenderBundleEncoderFinish") == 0, "the new render bundle is reused");
+    std::exit(tests::get_exit_code());
+  }
+  ++frame;
+}
+
+}
+
+auto main()->int {
+  try {
+    shader_reload_test test;
+    std::unreachable();
+
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
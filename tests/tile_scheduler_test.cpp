@@ -0,0 +1,46 @@
+#include <cmath>
+#include <cstdint>
+#include "render/tile_scheduler.h"
+#include "tests/check.h"
+
+// checks the tile scheduler covers the target exactly once, clipping edge tiles, issues a budget of tiles
+// per frame, and starts from the centre when asked
+
+auto main()->int {
+  using tests::check;
+  using tile_order = render::tile_scheduler::tile_order;
+
+  render::tile_scheduler scheduler;
+  scheduler.tiles_per_frame = 4;
+  scheduler.configure(600, 300, 256, tile_order::rows);
+  check(scheduler.get_tile_count() == 6, "a partly covered row or column still gets a tile");
+
+  uint64_t area{0};
+  unsigned int frames{0};
+  for(auto batch{scheduler.next_batch()}; !batch.empty(); batch = scheduler.next_batch(), ++frames) {
+    check(batch.size() <= scheduler.tiles_per_frame, "no more tiles are issued in a frame than the budget");
+    for(auto const &tile : batch) {
+      check(tile.x + tile.width <= 600 && tile.y + tile.height <= 300, "edge tiles are clipped to the target");
+      area += uint64_t{tile.width} * tile.height;
+    }
+  }
+  check(area == 600 * 300, "the tiles cover the target exactly once");
+  check(frames == 2, "the tiles are issued over as few frames as the budget allows");
+  check(scheduler.is_complete() && std::abs(scheduler.get_progress() - 1.0f) < 1e-6f, "the image is complete once every tile is issued");
+  check(scheduler.next_batch().empty(), "no more tiles are issued once complete");
+  check(scheduler.stats.completions == 1, "the completion is counted once");
+
+  scheduler.restart();
+  check(!scheduler.is_complete() && scheduler.get_progress() < 1e-6f, "restarting invalidates the image");
+  check(scheduler.next_batch().front().x == 0, "rows start at the top left");
+
+  scheduler.configure(768, 768, 256, tile_order::centre_out);
+  auto const first{scheduler.next_batch().front()};
+  check(first.x == 256 && first.y == 256, "centre out order starts with the centre tile");
+  check(scheduler.stats.restarts == 3, "every restart is counted, including configuring");
+
+  scheduler.configure(0, 0, 256);
+  check(scheduler.get_tile_count() == 0 && scheduler.is_complete(), "an empty target is immediately complete");
+
+  return tests::get_exit_code();
+}
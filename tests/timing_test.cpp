@@ -0,0 +1,61 @@
+#include <array>
+#include <cmath>
+#include <span>
+#include "tests/check.h"
+#include "timing/sample_ring.h"
+#include "timing/statistics.h"
+
+// checks the frame timing statistics: nearest-rank percentiles, summaries, histograms, and the sample ring
+// keeping only the most recent samples
+
+namespace {
+
+bool near(float lhs, float rhs) {
+  return std::abs(lhs - rhs) < 1e-5f;
+}
+
+}
+
+auto main()->int {
+  using tests::check;
+
+  std::array<float, 5> const sorted{1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  check(near(timing::percentile(sorted, 0.5f), 3.0f), "the median of an odd count is the middle sample");
+  check(near(timing::percentile(sorted, 0.0f), 1.0f), "the 0th percentile is the minimum");
+  check(near(timing::percentile(sorted, 1.0f), 5.0f), "the 100th percentile is the maximum");
+  check(near(timing::percentile(sorted, 0.99f), 5.0f), "percentiles round up to the next rank");
+  check(near(timing::percentile({}, 0.5f), 0.0f), "the percentile of no samples is zero");
+
+  std::array<float, 4> const unsorted{4.0f, 1.0f, 3.0f, 2.0f};
+  auto const summary{timing::summarise(unsorted)};
+  check(summary.count == 4, "every sample is summarised");
+  check(near(summary.min, 1.0f) && near(summary.max, 4.0f), "the summary has the extremes");
+  check(near(summary.avg, 2.5f), "the summary has the mean");
+  check(near(summary.p50, 2.0f), "the median uses the nearest rank, not interpolation");
+  check(timing::summarise({}).count == 0, "summarising no samples gives an empty summary");
+
+  std::array<float, 6> const samples{-1.0f, 0.5f, 1.5f, 1.6f, 3.5f, 10.0f};
+  std::array<float, 4> buckets;
+  timing::histogram(samples, 0.0f, 4.0f, buckets);
+  check(near(buckets[0], 2.0f), "samples below the range go in the first bucket");
+  check(near(buckets[1], 2.0f), "samples are counted in their bucket");
+  check(near(buckets[2], 0.0f), "empty buckets are zero");
+  check(near(buckets[3], 2.0f), "samples above the range go in the last bucket");
+  timing::histogram(samples, 1.0f, 1.0f, buckets);
+  check(near(buckets[0], 0.0f) && near(buckets[3], 0.0f), "an empty range counts nothing");
+
+  timing::sample_ring<4> ring;
+  check(ring.size() == 0 && ring.summarise().count == 0, "the ring starts empty");
+  for(unsigned int i{1}; i != 7; ++i) {
+    ring.push(static_cast<float>(i));
+  }
+  check(ring.size() == 4, "the ring holds at most its capacity");
+  std::array<float, 4> snapshot;
+  check(ring.snapshot(snapshot) == 4, "the snapshot has every sample held");
+  check(near(snapshot[0], 3.0f) && near(snapshot[3], 6.0f), "the oldest samples are overwritten, and the snapshot is oldest first");
+  check(near(ring.summarise().avg, 4.5f), "the summary covers only the samples held");
+  ring.clear();
+  check(ring.size() == 0, "clearing empties the ring");
+
+  return tests::get_exit_code();
+}
@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <stdexcept>
+#include "render/uniform_allocator.h"
+#include "tests/check.h"
+
+// checks the uniform allocator's aligned sub-allocation within each frame's region, and its rotation through the ring
+
+auto main()->int {
+  using tests::check;
+  using render::uniform_allocator;
+
+  check(uniform_allocator::align_up(0, 256) == 0, "zero is aligned");
+  check(uniform_allocator::align_up(1, 256) == 256, "values round up to the alignment");
+  check(uniform_allocator::align_up(256, 256) == 256, "aligned values are unchanged");
+
+  uniform_allocator allocator;
+  bool threw{false};
+  try {
+    allocator.init(100, 1024, 1);
+  } catch(std::runtime_error const&) {
+    threw = true;
+  }
+  check(threw, "an alignment that isn't a power of two is rejected");
+  threw = false;
+  try {
+    allocator.init(256, 1024, 0);
+  } catch(std::runtime_error const&) {
+    threw = true;
+  }
+  check(threw, "a ring without regions is rejected");
+
+  allocator.init(256, 1000, 3);
+  check(allocator.get_buffer_size() == 3 * 1024, "regions are rounded up to the alignment");
+  check(allocator.get_region_offset(2) == 2 * 1024, "regions are laid out one after another");
+
+  allocator.begin_frame();
+  check(allocator.get_current_region() == 0, "the first frame uses the first region");
+  struct value {
+    uint32_t a{0};
+    uint32_t b{0};
+  };
+  check(allocator.push(value{1, 2}) == 0u, "the first allocation is at the start of the region");
+  check(allocator.allocate(4) == 256u, "each allocation starts at the next aligned offset");
+  check(allocator.get_frame_range().offset == 0 && allocator.get_frame_range().size == 260, "the frame range covers everything allocated this frame");
+  auto const frame_data{allocator.get_frame_data()};
+  check(frame_data.size() == 260 && frame_data[0] == std::byte{1} && frame_data[4] == std::byte{2}, "pushed values are copied into the frame data");
+  check(allocator.allocate(1024 - 512 + 1) == std::nullopt, "an allocation beyond the end of the region fails");
+  check(allocator.allocate(0) == std::nullopt, "an empty allocation fails");
+  check(allocator.allocate(512) == 512u, "an allocation exactly filling the region succeeds");
+  check(allocator.allocate(1) == std::nullopt, "a full region can't allocate any more");
+
+  allocator.begin_frame();
+  check(allocator.get_current_region() == 1, "each frame moves on to the next region");
+  check(allocator.allocate(4) == 1024u, "allocations are offset by their region");
+  allocator.begin_frame();
+  allocator.begin_frame();
+  check(allocator.get_current_region() == 0, "the regions wrap around");
+  check(allocator.get_frame_range().size == 0, "a new frame starts with nothing allocated");
+  check(allocator.stats.frames == 4 && allocator.stats.allocations == 4 && allocator.stats.failed_allocations == 3, "allocations and failures are counted");
+
+  return tests::get_exit_code();
+}
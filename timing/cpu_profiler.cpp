@@ -0,0 +1,27 @@
+#include "cpu_profiler.h"
+
+namespace timing {
+
+cpu_profiler::cpu_profiler(std::vector<std::string_view> const &section_names)
+  : sections(section_names.size()) {
+  /// Construct a profiler with the given named sections
+  for(size_t i{0}; i != section_names.size(); ++i) {
+    sections[i].name = section_names[i];
+  }
+}
+
+scoped_timer<cpu_profiler::history_length> cpu_profiler::time(unsigned int section_index) {
+  /// Time the remainder of the caller's scope into the given section
+  return scoped_timer{sections.at(section_index).samples};
+}
+
+void cpu_profiler::record(unsigned int section_index, float milliseconds) {
+  /// Record a duration measured by other means into the given section
+  sections.at(section_index).samples.push(milliseconds);
+}
+
+std::vector<cpu_profiler::section> const &cpu_profiler::get_sections() const {
+  return sections;
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <magic_enum/magic_enum.hpp>
+#include "sample_ring.h"
+#include "scoped_timer.h"
+
+namespace timing {
+
+class cpu_profiler {
+  /// Rolling CPU timings for a fixed set of named sections of the frame
+public:
+  static constexpr size_t history_length{256};                                  // how many samples each section's statistics cover
+
+  struct section {
+    std::string name;
+    sample_ring<history_length> samples;                                        // durations in milliseconds
+  };
+
+private:
+  std::vector<section> sections;                                                // never resized after construction, as sample rings can't be moved
+
+public:
+  explicit cpu_profiler(std::vector<std::string_view> const &section_names);
+
+  template<typename Tenum>
+  static cpu_profiler from_enum();
+
+  scoped_timer<history_length> time(unsigned int section_index);
+  void record(unsigned int section_index, float milliseconds);
+
+  template<typename Tenum>
+  scoped_timer<history_length> time(Tenum section_enum);
+  template<typename Tenum>
+  void record(Tenum section_enum, float milliseconds);
+
+  std::vector<section> const &get_sections() const;
+};
+
+template<typename Tenum>
+cpu_profiler cpu_profiler::from_enum() {
+  /// Construct a profiler with a section for each value of the given enum, named after it
+  auto const names{magic_enum::enum_names<Tenum>()};
+  return cpu_profiler{std::vector<std::string_view>(names.begin(), names.end())};
+}
+
+template<typename Tenum>
+scoped_timer<cpu_profiler::history_length> cpu_profiler::time(Tenum section_enum) {
+  return time(static_cast<unsigned int>(std::to_underlying(section_enum)));
+}
+
+template<typename Tenum>
+void cpu_profiler::record(Tenum section_enum, float milliseconds) {
+  record(static_cast<unsigned int>(std::to_underlying(section_enum)), milliseconds);
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <span>
+#include "statistics.h"
+
+namespace timing {
+
+template<size_t Capacity>
+class sample_ring {
+  /// Fixed-size lock-free ring of the most recent samples, overwriting the oldest when full
+  /// Safe for a single producer to push while other threads take snapshots; a snapshot
+  /// taken during a push may include a mix of old and new samples, which is fine for statistics
+  std::array<std::atomic<float>, Capacity> samples{};
+  std::atomic<size_t> written{0};                                               // total samples ever pushed
+
+public:
+  static constexpr size_t capacity{Capacity};
+
+  void push(float sample);
+  void clear();
+
+  size_t snapshot(std::span<float, Capacity> out) const;
+  summary summarise() const;
+  size_t size() const;
+};
+
+template<size_t Capacity>
+void sample_ring<Capacity>::push(float sample) {
+  /// Record a sample, replacing the oldest if the ring is full
+  size_t const index{written.load(std::memory_order_relaxed)};
+  samples[index % Capacity].store(sample, std::memory_order_relaxed);
+  written.store(index + 1, std::memory_order_release);                          // publish the sample to readers
+}
+
+template<size_t Capacity>
+void sample_ring<Capacity>::clear() {
+  written.store(0, std::memory_order_release);
+}
+
+template<size_t Capacity>
+size_t sample_ring<Capacity>::snapshot(std::span<float, Capacity> out) const {
+  /// Copy the valid samples, oldest first, into the output and return how many there are
+  size_t const total{written.load(std::memory_order_acquire)};
+  size_t const count{std::min(total, Capacity)};
+  size_t const first{total - count};
+  for(size_t i{0}; i != count; ++i) {
+    out[i] = samples[(first + i) % Capacity].load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+template<size_t Capacity>
+summary sample_ring<Capacity>::summarise() const {
+  /// Summarise the current contents of the ring
+  std::array<float, Capacity> values;
+  return timing::summarise(std::span{values.data(), snapshot(values)});
+}
+
+template<size_t Capacity>
+size_t sample_ring<Capacity>::size() const {
+  return std::min(written.load(std::memory_order_acquire), Capacity);
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include "sample_ring.h"
+
+namespace timing {
+
+template<size_t Capacity>
+class scoped_timer {
+  /// Records the time between construction and destruction into a sample ring, in milliseconds
+  sample_ring<Capacity> &target;
+  std::chrono::steady_clock::time_point const start{std::chrono::steady_clock::now()};
+
+public:
+  explicit scoped_timer(sample_ring<Capacity> &target);
+  ~scoped_timer();
+
+  scoped_timer(scoped_timer const&) = delete;
+  scoped_timer &operator=(scoped_timer const&) = delete;
+};
+
+template<size_t Capacity>
+scoped_timer<Capacity>::scoped_timer(sample_ring<Capacity> &this_target)
+  : target{this_target} {
+  /// Start timing
+}
+
+template<size_t Capacity>
+scoped_timer<Capacity>::~scoped_timer() {
+  /// Stop timing and record the result
+  target.push(std::chrono::duration<float, std::milli>{std::chrono::steady_clock::now() - start}.count());
+}
+
+}
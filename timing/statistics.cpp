@@ -0,0 +1,42 @@
+#include "statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace timing {
+
+float percentile(std::span<float const> sorted_samples, float fraction) {
+  /// Return the given percentile (0.0 to 1.0) of a sorted set of samples, using the nearest-rank method
+  if(sorted_samples.empty()) return 0.0f;
+  auto const rank{static_cast<size_t>(std::ceil(std::clamp(fraction, 0.0f, 1.0f) * static_cast<float>(sorted_samples.size())))};
+  return sorted_samples[std::clamp<size_t>(rank, 1, sorted_samples.size()) - 1];
+}
+
+summary summarise(std::span<float const> samples) {
+  /// Summarise an unsorted set of samples
+  if(samples.empty()) return {};
+  std::vector<float> sorted(samples.begin(), samples.end());
+  std::sort(sorted.begin(), sorted.end());
+  return {
+    .min{sorted.front()},
+    .avg{std::accumulate(sorted.begin(), sorted.end(), 0.0f) / static_cast<float>(sorted.size())},
+    .p50{percentile(sorted, 0.5f)},
+    .p99{percentile(sorted, 0.99f)},
+    .max{sorted.back()},
+    .count{static_cast<unsigned int>(sorted.size())},
+  };
+}
+
+void histogram(std::span<float const> samples, float min, float max, std::span<float> bucket_counts) {
+  /// Count samples into evenly sized buckets spanning min to max; samples outside the range go in the end buckets
+  std::fill(bucket_counts.begin(), bucket_counts.end(), 0.0f);
+  if(bucket_counts.empty() || !(max > min)) return;
+  auto const bucket_count{static_cast<float>(bucket_counts.size())};
+  for(float const sample : samples) {
+    auto const bucket{static_cast<size_t>(std::clamp((sample - min) / (max - min) * bucket_count, 0.0f, bucket_count - 1.0f))};
+    bucket_counts[bucket] += 1.0f;
+  }
+}
+
+}
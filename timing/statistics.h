@@ -0,0 +1,20 @@
+#pragma once
+
+#include <span>
+
+namespace timing {
+
+struct summary {
+  float min{0.0f};
+  float avg{0.0f};
+  float p50{0.0f};
+  float p99{0.0f};
+  float max{0.0f};
+  unsigned int count{0};                                                        // number of samples summarised
+};
+
+float percentile(std::span<float const> sorted_samples, float fraction);
+summary summarise(std::span<float const> samples);
+void histogram(std::span<float const> samples, float min, float max, std::span<float> bucket_counts);
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "tokenizer.h"
+
+namespace wgsl::ast {
+
+// the syntax tree produced by the parser: names and operators are left as views into the source,
+// and nothing is resolved or type checked until the program is compiled
+
+struct location {
+  unsigned int line{0};
+  unsigned int column{0};
+};
+
+struct attribute {
+  std::string_view name;                                                        // e.g. "location" for @location(0)
+  std::vector<std::string_view> arguments;                                      // the first token of each argument
+};
+
+struct type_name {
+  std::string_view name;                                                        // a builtin type, struct or alias name, e.g. "vec3", "vec3f", "my_struct"
+  std::vector<type_name> template_arguments;                                    // e.g. f32 in vec3<f32>
+  ast::location location;
+};
+
+struct expression {
+  enum class kinds {
+    literal,                                                                    // text is the literal, literal_type says which kind
+    identifier,                                                                 // text is the name
+    call,                                                                       // callee names the function or type constructed, operands are the arguments
+    member,                                                                     // text is the member or swizzle, operands[0] is the object
+    index,                                                                      // operands are the object and the index
+    unary,                                                                      // text is the operator, operands[0] is the operand
+    binary,                                                                     // text is the operator, operands are the left and right hand sides
+  };
+
+  kinds kind{kinds::literal};
+  std::string_view text;
+  token::types literal_type{token::types::integer_literal};
+  type_name callee;
+  std::vector<expression> operands;
+  ast::location location;
+};
+
+struct statement {
+  enum class kinds {
+    empty,
+    block,                                                                      // children are the statements in the block
+    variable,                                                                   // var, let or const: declaration, name, optional type, optional initialiser as expressions[0]
+    assignment,                                                                 // text is the operator ("=", "+=" etc), expressions are the left and right hand sides
+    increment,                                                                  // expressions[0] is the target
+    decrement,
+    call,                                                                       // expressions[0] is a call evaluated for its side effects
+    if_else,                                                                    // expressions[0] is the condition, children are the then block and optionally the else statement
+    for_loop,                                                                   // children are the initialiser, the update and the body; expressions[0] is the condition if present
+    while_loop,                                                                 // expressions[0] is the condition, children[0] is the body
+    loop,                                                                       // children are the body, and optionally the continuing block
+    break_statement,
+    break_if,                                                                   // expressions[0] is the condition; only valid at the end of a continuing block
+    continue_statement,
+    return_statement,                                                           // expressions[0] is the returned value if present
+    discard,
+  };
+
+  kinds kind{kinds::empty};
+  std::string_view text;
+  std::string_view declaration;                                                 // "var", "let" or "const"
+  std::string_view name;
+  std::optional<type_name> type;
+  std::vector<expression> expressions;
+  std::vector<statement> children;
+  ast::location location;
+};
+
+struct alias_declaration {
+  std::string_view name;
+  type_name type;
+  ast::location location;
+};
+
+struct struct_member {
+  std::vector<attribute> attributes;
+  std::string_view name;
+  type_name type;
+};
+
+struct struct_declaration {
+  std::string_view name;
+  std::vector<struct_member> members;
+  ast::location location;
+};
+
+struct variable_declaration {                                                   // module scope var, const or override
+  std::vector<attribute> attributes;
+  std::string_view declaration;                                                 // "var", "const" or "override"
+  std::string_view address_space;                                               // e.g. "uniform" for var<uniform>, empty for the default
+  std::string_view access_mode;                                                 // e.g. "read_write" for var<storage, read_write>, empty for the default
+  std::string_view name;
+  std::optional<type_name> type;
+  std::optional<expression> initialiser;
+  ast::location location;
+};
+
+struct parameter {
+  std::vector<attribute> attributes;
+  std::string_view name;
+  type_name type;
+};
+
+struct function_declaration {
+  std::vector<attribute> attributes;                                            // e.g. @vertex
+  std::string_view name;
+  std::vector<parameter> parameters;
+  std::optional<type_name> return_type;
+  std::vector<attribute> return_attributes;                                     // e.g. @location(0)
+  statement body;
+  ast::location location;
+};
+
+struct module {
+  std::vector<alias_declaration> aliases;
+  std::vector<struct_declaration> structs;
+  std::vector<variable_declaration> variables;
+  std::vector<function_declaration> functions;
+};
+
+attribute const *find_attribute(std::span<attribute const> attributes, std::string_view name);
+
+}
@@ -0,0 +1,676 @@
+#include "invocation.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace wgsl {
+
+namespace {
+
+// lanes are processed by fixed-length loops over plain arrays, which the compiler vectorises
+
+uint32_t to_bits(float value)    {return std::bit_cast<uint32_t>(value);}
+uint32_t to_bits(int32_t value)  {return std::bit_cast<uint32_t>(value);}
+uint32_t to_bits(uint32_t value) {return value;}
+uint32_t to_bits(bool value)     {return value ? 1u : 0u;}
+
+template<typename T>
+T from_bits(uint32_t bits) {
+  return std::bit_cast<T>(bits);
+}
+
+bool any(lane_bits const &mask) {
+  uint32_t result{0};
+  for(auto const lane : mask) {
+    result |= lane;
+  }
+  return result != 0;
+}
+
+lane_bits operator&(lane_bits const &lhs, lane_bits const &rhs) {
+  lane_bits result;
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    result[lane] = lhs[lane] & rhs[lane];
+  }
+  return result;
+}
+
+lane_bits operator|(lane_bits const &lhs, lane_bits const &rhs) {
+  lane_bits result;
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    result[lane] = lhs[lane] | rhs[lane];
+  }
+  return result;
+}
+
+lane_bits operator~(lane_bits const &value) {
+  lane_bits result;
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    result[lane] = ~value[lane];
+  }
+  return result;
+}
+
+lane_bits to_mask(lane_bits const &condition) {
+  /// Turn booleans stored as 0 or 1 into masks of all zeroes or all ones
+  lane_bits result;
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    result[lane] = 0u - condition[lane];
+  }
+  return result;
+}
+
+void blend(lane_bits &target, lane_bits const &value, lane_bits const &mask) {
+  /// Write value to the lanes of target selected by mask
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    target[lane] = (value[lane] & mask[lane]) | (target[lane] & ~mask[lane]);
+  }
+}
+
+uint32_t clamp_index(uint32_t bits, scalar_type index_scalar, uint32_t count) {
+  /// Out of bounds indices read and write the nearest element, as a GPU may
+  if(index_scalar == scalar_type::i32 && std::bit_cast<int32_t>(bits) < 0) return 0;
+  return std::min(bits, count - 1);
+}
+
+template<typename T, typename F>
+void map_components(std::vector<lane_bits> &registers, node const &value, F &&function) {
+  /// Apply a function to each component and lane of the operands, repeating broadcast operands
+  auto const component_count{value.result_type->get_component_count()};
+  auto const operand_register{[&](size_t operand, uint32_t component) -> lane_bits const& {
+    bool const broadcast{operand < value.broadcast.size() && value.broadcast[operand]};
+    return registers[value.operands[operand]->slot + (broadcast ? 0 : component)];
+  }};
+  for(uint32_t component{0}; component != component_count; ++component) {
+    auto &result{registers[value.slot + component]};
+    if constexpr(std::is_invocable_v<F, T>) {
+      auto const &a{operand_register(0, component)};
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        result[lane] = to_bits(function(from_bits<T>(a[lane])));
+      }
+    } else if constexpr(std::is_invocable_v<F, T, T>) {
+      auto const &a{operand_register(0, component)};
+      auto const &b{operand_register(1, component)};
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        result[lane] = to_bits(function(from_bits<T>(a[lane]), from_bits<T>(b[lane])));
+      }
+    } else {
+      auto const &a{operand_register(0, component)};
+      auto const &b{operand_register(1, component)};
+      auto const &c{operand_register(2, component)};
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        result[lane] = to_bits(function(from_bits<T>(a[lane]), from_bits<T>(b[lane]), from_bits<T>(c[lane])));
+      }
+    }
+  }
+}
+
+template<typename T>
+void evaluate_binary(std::vector<lane_bits> &registers, node const &value) {
+  /// Component-wise arithmetic and comparison on one scalar type
+  /// Integer arithmetic wraps, and division by zero gives the results WGSL defines rather than trapping
+  using unsigned_type = uint32_t;
+  constexpr bool is_float{std::is_same_v<T, float>};
+  constexpr bool is_signed{std::is_same_v<T, int32_t>};
+  switch(value.binary) {
+  case binary_operator::add:
+    if constexpr(is_float) map_components<T>(registers, value, [](T a, T b){return a + b;});
+    else                   map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a + b;});
+    return;
+  case binary_operator::subtract:
+    if constexpr(is_float) map_components<T>(registers, value, [](T a, T b){return a - b;});
+    else                   map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a - b;});
+    return;
+  case binary_operator::multiply:
+    if constexpr(is_float) map_components<T>(registers, value, [](T a, T b){return a * b;});
+    else                   map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a * b;});
+    return;
+  case binary_operator::divide:
+    map_components<T>(registers, value, [](T a, T b){
+      if constexpr(is_float) {
+        return a / b;
+      } else {
+        if(b == 0) return a;
+        if constexpr(is_signed) {
+          if(a == std::numeric_limits<T>::min() && b == -1) return a;
+        }
+        return static_cast<T>(a / b);
+      }
+    });
+    return;
+  case binary_operator::modulo:
+    map_components<T>(registers, value, [](T a, T b){
+      if constexpr(is_float) {
+        return std::fmod(a, b);
+      } else {
+        if(b == 0) return T{0};
+        if constexpr(is_signed) {
+          if(a == std::numeric_limits<T>::min() && b == -1) return T{0};
+        }
+        return static_cast<T>(a % b);
+      }
+    });
+    return;
+  case binary_operator::bitwise_and:
+    map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a & b;});
+    return;
+  case binary_operator::bitwise_or:
+    map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a | b;});
+    return;
+  case binary_operator::bitwise_xor:
+    map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a ^ b;});
+    return;
+  case binary_operator::shift_left:
+    map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a << (b & 31);});
+    return;
+  case binary_operator::shift_right:
+    if constexpr(is_signed) map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return std::bit_cast<unsigned_type>(std::bit_cast<int32_t>(a) >> (b & 31));});
+    else                    map_components<unsigned_type>(registers, value, [](unsigned_type a, unsigned_type b){return a >> (b & 31);});
+    return;
+  case binary_operator::less:
+    map_components<T>(registers, value, [](T a, T b){return a < b;});
+    return;
+  case binary_operator::less_equal:
+    map_components<T>(registers, value, [](T a, T b){return a <= b;});
+    return;
+  case binary_operator::greater:
+    map_components<T>(registers, value, [](T a, T b){return a > b;});
+    return;
+  case binary_operator::greater_equal:
+    map_components<T>(registers, value, [](T a, T b){return a >= b;});
+    return;
+  case binary_operator::equal:
+    map_components<T>(registers, value, [](T a, T b){return !(a < b) && !(b < a);});
+    return;
+  case binary_operator::not_equal:
+    map_components<T>(registers, value, [](T a, T b){return a < b || b < a;});
+    return;
+  }
+}
+
+template<typename T>
+void evaluate_numeric_builtin(std::vector<lane_bits> &registers, node const &value) {
+  /// Builtins defined for integers as well as floats; the float-only builtins are handled by the caller
+  constexpr bool is_float{std::is_same_v<T, float>};
+  if(value.builtin == builtin_function::abs) {
+    if constexpr(is_float) map_components<T>(registers, value, [](T a){return std::abs(a);});
+    else if constexpr(std::is_same_v<T, int32_t>) map_components<uint32_t>(registers, value, [](uint32_t a){return std::bit_cast<int32_t>(a) < 0 ? 0u - a : a;});
+    else map_components<T>(registers, value, [](T a){return a;});
+  } else if(value.builtin == builtin_function::clamp) {
+    map_components<T>(registers, value, [](T e, T low, T high){return std::min(std::max(e, low), high);});
+  } else if(value.builtin == builtin_function::max) {
+    map_components<T>(registers, value, [](T a, T b){return std::max(a, b);});
+  } else if(value.builtin == builtin_function::min) {
+    map_components<T>(registers, value, [](T a, T b){return std::min(a, b);});
+  } else if(value.builtin == builtin_function::sign) {
+    map_components<T>(registers, value, [](T a){return a > T{0} ? T{1} : a < T{0} ? static_cast<T>(-1) : T{0};});
+  } else if(value.builtin == builtin_function::dot) {
+    auto &result{registers[value.slot]};
+    result.fill(to_bits(T{0}));
+    for(uint32_t component{0}; component != value.shape[0]; ++component) {
+      auto const &a{registers[value.operands[0]->slot + component]};
+      auto const &b{registers[value.operands[1]->slot + component]};
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        if constexpr(is_float) result[lane] = to_bits(from_bits<float>(result[lane]) + from_bits<float>(a[lane]) * from_bits<float>(b[lane]));
+        else                   result[lane] += a[lane] * b[lane];               // wraps, as two's complement
+      }
+    }
+  }
+}
+
+}
+
+invocation::invocation(program const &this_source_program)
+  : source_program{this_source_program} {
+  /// Set up registers for a program, which must outlive the invocation
+  reset();
+}
+
+void invocation::reset() {
+  /// Reload every register from the program, picking up changes to uniforms and overrides
+  auto const initial{source_program.get_initial_registers()};
+  registers.resize(initial.size());
+  for(size_t i{0}; i != initial.size(); ++i) {
+    registers[i].fill(initial[i]);
+  }
+  discarded = {};
+}
+
+lane_bits &invocation::get_register(uint32_t slot) {
+  return registers[slot];
+}
+
+lane_bits const &invocation::get_register(uint32_t slot) const {
+  return registers[slot];
+}
+
+void invocation::run(entry_point const &entry, lane_bits const &active) {
+  /// Execute an entry point for the active lanes, whose inputs have already been written to their registers
+  discarded = {};
+  frame_masks frame;
+  for(auto const &initialiser : source_program.get_global_initialisers()) {
+    execute(initialiser, active, frame);
+  }
+  execute(entry.body->body, active, frame);
+}
+
+lane_bits const &invocation::get_discarded() const {
+  return discarded;
+}
+
+void invocation::evaluate(node const &value, lane_bits const &mask) {
+  /// Compute a node's result in every lane; only calls, which may have side effects, depend on the mask
+  switch(value.opcode) {
+  case node::opcodes::none:
+    return;
+
+  case node::opcodes::view:
+    evaluate(*value.operands.front(), mask);
+    return;
+
+  case node::opcodes::gather:
+    for(auto const *operand : value.operands) {
+      evaluate(*operand, mask);
+    }
+    for(size_t i{0}; i != value.sources.size(); ++i) {
+      registers[value.slot + i] = registers[value.sources[i]];
+    }
+    return;
+
+  case node::opcodes::dynamic_index: {
+    auto const &object{*value.operands[0]};
+    auto const &index{*value.operands[1]};
+    evaluate(object, mask);
+    evaluate(index, mask);
+    auto const element_components{value.shape[0]};
+    auto const element_count{value.shape[1]};
+    for(unsigned int lane{0}; lane != lane_count; ++lane) {
+      auto const element{clamp_index(registers[index.slot][lane], value.operand_scalar, element_count)};
+      for(uint32_t component{0}; component != element_components; ++component) {
+        registers[value.slot + component][lane] = registers[object.slot + element * element_components + component][lane];
+      }
+    }
+    return;
+  }
+
+  case node::opcodes::convert: {
+    evaluate(*value.operands.front(), mask);
+    auto const from{value.operand_scalar};
+    switch(value.result_type->scalar) {
+    case scalar_type::f32:
+      if(from == scalar_type::i32)          map_components<int32_t>(registers, value, [](int32_t a){return static_cast<float>(a);});
+      else if(from == scalar_type::u32)     map_components<uint32_t>(registers, value, [](uint32_t a){return static_cast<float>(a);});
+      else if(from == scalar_type::boolean) map_components<uint32_t>(registers, value, [](uint32_t a){return static_cast<float>(a);});
+      return;
+    case scalar_type::i32:                                                      // conversions from float saturate, as in WGSL
+      if(from == scalar_type::f32)          map_components<float>(registers, value, [](float a){return std::isnan(a) ? 0 : static_cast<int32_t>(std::clamp(a, -2147483648.0f, 2147483520.0f));});
+      else                                  map_components<uint32_t>(registers, value, [](uint32_t a){return a;});
+      return;
+    case scalar_type::u32:
+      if(from == scalar_type::f32)          map_components<float>(registers, value, [](float a){return std::isnan(a) ? 0u : static_cast<uint32_t>(std::clamp(a, 0.0f, 4294967040.0f));});
+      else                                  map_components<uint32_t>(registers, value, [](uint32_t a){return a;});
+      return;
+    case scalar_type::boolean:
+      if(from == scalar_type::f32)          map_components<float>(registers, value, [](float a){return a < 0.0f || a > 0.0f;});
+      else                                  map_components<uint32_t>(registers, value, [](uint32_t a){return a != 0;});
+      return;
+    case scalar_type::abstract_int:
+    case scalar_type::abstract_float:
+      return;
+    }
+    return;
+  }
+
+  case node::opcodes::bitcast:
+    evaluate(*value.operands.front(), mask);
+    map_components<uint32_t>(registers, value, [](uint32_t a){return a;});
+    return;
+
+  case node::opcodes::unary:
+    evaluate(*value.operands.front(), mask);
+    switch(value.unary) {
+    case unary_operator::negate:
+      if(value.operand_scalar == scalar_type::f32) map_components<float>(registers, value, [](float a){return -a;});
+      else                                         map_components<uint32_t>(registers, value, [](uint32_t a){return 0u - a;});
+      return;
+    case unary_operator::logical_not:
+      map_components<uint32_t>(registers, value, [](uint32_t a){return a ^ 1u;});
+      return;
+    case unary_operator::bitwise_not:
+      map_components<uint32_t>(registers, value, [](uint32_t a){return ~a;});
+      return;
+    }
+    return;
+
+  case node::opcodes::binary:
+    evaluate(*value.operands[0], mask);
+    evaluate(*value.operands[1], mask);
+    switch(value.operand_scalar) {
+    case scalar_type::f32:
+      evaluate_binary<float>(registers, value);
+      return;
+    case scalar_type::i32:
+      evaluate_binary<int32_t>(registers, value);
+      return;
+    case scalar_type::u32:
+    case scalar_type::boolean:
+      evaluate_binary<uint32_t>(registers, value);
+      return;
+    case scalar_type::abstract_int:
+    case scalar_type::abstract_float:
+      return;
+    }
+    return;
+
+  case node::opcodes::matrix_multiply: {
+    evaluate(*value.operands[0], mask);
+    evaluate(*value.operands[1], mask);
+    auto const [rows, inner, columns]{value.shape};
+    auto const lhs{value.operands[0]->slot};
+    auto const rhs{value.operands[1]->slot};
+    for(uint32_t column{0}; column != columns; ++column) {
+      for(uint32_t row{0}; row != rows; ++row) {
+        std::array<float, lane_count> sum{};
+        for(uint32_t k{0}; k != inner; ++k) {
+          auto const &a{registers[lhs + k * rows + row]};
+          auto const &b{registers[rhs + column * inner + k]};
+          for(unsigned int lane{0}; lane != lane_count; ++lane) {
+            sum[lane] += from_bits<float>(a[lane]) * from_bits<float>(b[lane]);
+          }
+        }
+        auto &result{registers[value.slot + column * rows + row]};
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          result[lane] = to_bits(sum[lane]);
+        }
+      }
+    }
+    return;
+  }
+
+  case node::opcodes::builtin:
+    for(auto const *operand : value.operands) {
+      evaluate(*operand, mask);
+    }
+    evaluate_builtin(value);
+    return;
+
+  case node::opcodes::call:
+    call(value, mask);
+    return;
+  }
+}
+
+void invocation::evaluate_builtin(node const &value) {
+  /// Compute a builtin function whose operands have been evaluated
+  switch(value.operand_scalar) {
+  case scalar_type::i32:
+    evaluate_numeric_builtin<int32_t>(registers, value);
+    return;
+  case scalar_type::u32:
+    evaluate_numeric_builtin<uint32_t>(registers, value);
+    return;
+  case scalar_type::boolean:
+    break;
+  case scalar_type::f32:
+    evaluate_numeric_builtin<float>(registers, value);
+    break;
+  case scalar_type::abstract_int:
+  case scalar_type::abstract_float:
+    return;
+  }
+
+  auto const width{value.shape[0]};
+  switch(value.builtin) {
+  case builtin_function::abs:
+  case builtin_function::clamp:
+  case builtin_function::max:
+  case builtin_function::min:
+  case builtin_function::sign:
+  case builtin_function::dot:
+    return;                                                                     // already done above
+
+  case builtin_function::acos:         map_components<float>(registers, value, [](float a){return std::acos(a);});                    return;
+  case builtin_function::acosh:        map_components<float>(registers, value, [](float a){return std::acosh(a);});                   return;
+  case builtin_function::asin:         map_components<float>(registers, value, [](float a){return std::asin(a);});                    return;
+  case builtin_function::asinh:        map_components<float>(registers, value, [](float a){return std::asinh(a);});                   return;
+  case builtin_function::atan:         map_components<float>(registers, value, [](float a){return std::atan(a);});                    return;
+  case builtin_function::atan2:        map_components<float>(registers, value, [](float y, float x){return std::atan2(y, x);});       return;
+  case builtin_function::atanh:        map_components<float>(registers, value, [](float a){return std::atanh(a);});                   return;
+  case builtin_function::ceil:         map_components<float>(registers, value, [](float a){return std::ceil(a);});                    return;
+  case builtin_function::cos:          map_components<float>(registers, value, [](float a){return std::cos(a);});                     return;
+  case builtin_function::cosh:         map_components<float>(registers, value, [](float a){return std::cosh(a);});                    return;
+  case builtin_function::degrees:      map_components<float>(registers, value, [](float a){return a * (180.0f / std::numbers::pi_v<float>);}); return;
+  case builtin_function::exp:          map_components<float>(registers, value, [](float a){return std::exp(a);});                     return;
+  case builtin_function::exp2:         map_components<float>(registers, value, [](float a){return std::exp2(a);});                    return;
+  case builtin_function::floor:        map_components<float>(registers, value, [](float a){return std::floor(a);});                   return;
+  case builtin_function::fma:          map_components<float>(registers, value, [](float a, float b, float c){return std::fma(a, b, c);}); return;
+  case builtin_function::fract:        map_components<float>(registers, value, [](float a){return a - std::floor(a);});               return;
+  case builtin_function::inverse_sqrt: map_components<float>(registers, value, [](float a){return 1.0f / std::sqrt(a);});             return;
+  case builtin_function::log:          map_components<float>(registers, value, [](float a){return std::log(a);});                     return;
+  case builtin_function::log2:         map_components<float>(registers, value, [](float a){return std::log2(a);});                    return;
+  case builtin_function::mix:          map_components<float>(registers, value, [](float a, float b, float t){return a * (1.0f - t) + b * t;}); return;
+  case builtin_function::pow:          map_components<float>(registers, value, [](float a, float b){return std::pow(a, b);});         return;
+  case builtin_function::radians:      map_components<float>(registers, value, [](float a){return a * (std::numbers::pi_v<float> / 180.0f);}); return;
+  case builtin_function::round:        map_components<float>(registers, value, [](float a){return std::nearbyint(a);});               return; // ties to even
+  case builtin_function::saturate:     map_components<float>(registers, value, [](float a){return std::clamp(a, 0.0f, 1.0f);});       return;
+  case builtin_function::sin:          map_components<float>(registers, value, [](float a){return std::sin(a);});                     return;
+  case builtin_function::sinh:         map_components<float>(registers, value, [](float a){return std::sinh(a);});                    return;
+  case builtin_function::sqrt:         map_components<float>(registers, value, [](float a){return std::sqrt(a);});                    return;
+  case builtin_function::step:         map_components<float>(registers, value, [](float edge, float a){return a >= edge ? 1.0f : 0.0f;}); return;
+  case builtin_function::tan:          map_components<float>(registers, value, [](float a){return std::tan(a);});                     return;
+  case builtin_function::tanh:         map_components<float>(registers, value, [](float a){return std::tanh(a);});                    return;
+  case builtin_function::trunc:        map_components<float>(registers, value, [](float a){return std::trunc(a);});                   return;
+  case builtin_function::smoothstep:
+    map_components<float>(registers, value, [](float low, float high, float a){
+      auto const t{std::clamp((a - low) / (high - low), 0.0f, 1.0f)};
+      return t * t * (3.0f - 2.0f * t);
+    });
+    return;
+
+  case builtin_function::select:
+    map_components<uint32_t>(registers, value, [](uint32_t if_false, uint32_t if_true, uint32_t condition){return condition != 0 ? if_true : if_false;});
+    return;
+
+  case builtin_function::all:
+  case builtin_function::any: {
+    bool const is_all{value.builtin == builtin_function::all};
+    auto &result{registers[value.slot]};
+    result.fill(is_all ? 1u : 0u);
+    for(uint32_t component{0}; component != width; ++component) {
+      auto const &a{registers[value.operands[0]->slot + component]};
+      for(unsigned int lane{0}; lane != lane_count; ++lane) {
+        result[lane] = is_all ? result[lane] & a[lane] : result[lane] | a[lane];
+      }
+    }
+    return;
+  }
+
+  case builtin_function::length:
+  case builtin_function::distance:
+  case builtin_function::normalize: {
+    auto const slot{value.operands[0]->slot};
+    std::array<lane_bits, 4> difference_storage;
+    if(value.builtin == builtin_function::distance) {                           // length of the difference
+      for(uint32_t component{0}; component != width; ++component) {
+        bool const broadcast_a{value.broadcast[0]};
+        bool const broadcast_b{value.broadcast[1]};
+        auto const &a{registers[value.operands[0]->slot + (broadcast_a ? 0 : component)]};
+        auto const &b{registers[value.operands[1]->slot + (broadcast_b ? 0 : component)]};
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          difference_storage[component][lane] = to_bits(from_bits<float>(a[lane]) - from_bits<float>(b[lane]));
+        }
+      }
+    }
+    for(unsigned int lane{0}; lane != lane_count; ++lane) {
+      float sum{0.0f};
+      for(uint32_t component{0}; component != width; ++component) {
+        auto const x{from_bits<float>(value.builtin == builtin_function::distance ? difference_storage[component][lane] : registers[slot + component][lane])};
+        sum += x * x;
+      }
+      auto const length{std::sqrt(sum)};
+      if(value.builtin != builtin_function::normalize) {
+        registers[value.slot][lane] = to_bits(length);
+        continue;
+      }
+      for(uint32_t component{0}; component != width; ++component) {
+        registers[value.slot + component][lane] = to_bits(from_bits<float>(registers[slot + component][lane]) / length);
+      }
+    }
+    return;
+  }
+
+  case builtin_function::reflect: {                                             // e1 - 2 * dot(e2, e1) * e2
+    auto const incident{value.operands[0]->slot};
+    auto const normal{value.operands[1]->slot};
+    for(unsigned int lane{0}; lane != lane_count; ++lane) {
+      float dot{0.0f};
+      for(uint32_t component{0}; component != width; ++component) {
+        dot += from_bits<float>(registers[incident + component][lane]) * from_bits<float>(registers[normal + component][lane]);
+      }
+      for(uint32_t component{0}; component != width; ++component) {
+        registers[value.slot + component][lane] = to_bits(from_bits<float>(registers[incident + component][lane]) - 2.0f * dot * from_bits<float>(registers[normal + component][lane]));
+      }
+    }
+    return;
+  }
+
+  case builtin_function::cross: {
+    auto const a{value.operands[0]->slot};
+    auto const b{value.operands[1]->slot};
+    for(unsigned int lane{0}; lane != lane_count; ++lane) {
+      auto const get{[&](uint32_t slot, uint32_t component){return from_bits<float>(registers[slot + component][lane]);}};
+      for(uint32_t component{0}; component != 3; ++component) {
+        auto const next{(component + 1) % 3};
+        auto const after{(component + 2) % 3};
+        registers[value.slot + component][lane] = to_bits(get(a, next) * get(b, after) - get(a, after) * get(b, next));
+      }
+    }
+    return;
+  }
+
+  case builtin_function::transpose: {
+    auto const &matrix_type{*value.operands[0]->result_type};
+    for(uint32_t column{0}; column != matrix_type.columns; ++column) {
+      for(uint32_t row{0}; row != matrix_type.rows; ++row) {
+        registers[value.slot + row * matrix_type.columns + column] = registers[value.operands[0]->slot + column * matrix_type.rows + row];
+      }
+    }
+    return;
+  }
+  }
+}
+
+void invocation::call(node const &value, lane_bits const &mask) {
+  /// Call a user function for the lanes in the mask
+  auto const &callee{*value.callee};
+  for(auto const *operand : value.operands) {
+    evaluate(*operand, mask);
+  }
+  for(size_t i{0}; i != value.operands.size(); ++i) {
+    auto const components{callee.parameter_types[i]->get_component_count()};
+    std::copy_n(&registers[value.operands[i]->slot], components, &registers[callee.parameter_slots[i]]);
+  }
+  frame_masks frame;
+  execute(callee.body, mask, frame);
+  auto const components{callee.return_type->get_component_count()};
+  if(components != 0) std::copy_n(&registers[callee.return_slot], components, &registers[value.slot]);
+}
+
+void invocation::store(destination const &target, node const &value, lane_bits const &mask) {
+  /// Write a value to the lanes of a destination selected by the mask
+  if(!target.index) {
+    for(size_t i{0}; i != target.components.size(); ++i) {
+      blend(registers[target.slot + target.components[i]], registers[value.slot + i], mask);
+    }
+    return;
+  }
+  auto const &index{registers[target.index->slot]};
+  auto const index_scalar{target.index->result_type->scalar};
+  for(unsigned int lane{0}; lane != lane_count; ++lane) {
+    if(mask[lane] == 0) continue;
+    auto const element{clamp_index(index[lane], index_scalar, target.element_count)};
+    for(size_t i{0}; i != target.components.size(); ++i) {
+      registers[target.slot + element * target.element_components + target.components[i]][lane] = registers[value.slot + i][lane];
+    }
+  }
+}
+
+void invocation::execute(statement const &source, lane_bits const &mask, frame_masks &frame) {
+  /// Execute a statement for the lanes in the mask
+  switch(source.kind) {
+  case statement::kinds::block:
+    for(auto const &child : source.children) {
+      auto const active{mask & ~(frame.returned | frame.broken | frame.continued | discarded)};
+      if(!any(active)) return;                                                  // every lane has left the block
+      execute(child, active, frame);
+    }
+    return;
+
+  case statement::kinds::evaluate:
+    evaluate(*source.value, mask);
+    return;
+
+  case statement::kinds::store:
+    evaluate(*source.value, mask);
+    if(source.target.index) evaluate(*source.target.index, mask);
+    store(source.target, *source.value, mask);
+    return;
+
+  case statement::kinds::if_else: {
+    evaluate(*source.value, mask);
+    auto const condition{to_mask(registers[source.value->slot])};
+    if(auto const then_mask{mask & condition}; any(then_mask)) execute(source.children[0], then_mask, frame);
+    if(source.children.size() < 2) return;
+    if(auto const else_mask{mask & ~condition & ~discarded}; any(else_mask)) execute(source.children[1], else_mask, frame);
+    return;
+  }
+
+  case statement::kinds::loop: {
+    auto const outer_broken{frame.broken};
+    auto const outer_continued{frame.continued};
+    frame.broken = {};
+    frame.continued = {};
+    auto active{mask};
+    while(any(active)) {                                                        // until every lane has broken out or returned
+      execute(source.children[0], active, frame);
+      frame.continued = {};
+      active = active & ~(frame.broken | frame.returned | discarded);
+      if(!any(active)) break;
+      execute(source.children[1], active, frame);
+      active = active & ~(frame.broken | discarded);
+    }
+    frame.broken = outer_broken;
+    frame.continued = outer_continued;
+    return;
+  }
+
+  case statement::kinds::break_statement:
+    frame.broken = frame.broken | mask;
+    return;
+
+  case statement::kinds::break_if:
+    evaluate(*source.value, mask);
+    frame.broken = frame.broken | (mask & to_mask(registers[source.value->slot]));
+    return;
+
+  case statement::kinds::continue_statement:
+    frame.continued = frame.continued | mask;
+    return;
+
+  case statement::kinds::return_statement:
+    if(source.value) {
+      evaluate(*source.value, mask);
+      store(source.target, *source.value, mask);
+    }
+    frame.returned = frame.returned | mask;
+    return;
+
+  case statement::kinds::discard:
+    discarded = discarded | mask;
+    return;
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "program.h"
+
+namespace wgsl {
+
+class invocation {
+  /// Executes entry points of a program for lane_count invocations at once, independent of the graphics API
+  /// Control flow is handled by masking lanes rather than branching, so every operation runs across all lanes together
+  /// Each invocation owns its registers, so separate invocations of one program can run on separate threads
+  program const &source_program;
+  std::vector<lane_bits> registers;
+  lane_bits discarded{};                                                        // lanes that have executed discard
+
+  struct frame_masks {                                                          // lanes that have left the current function or loop body early
+    lane_bits returned{};
+    lane_bits broken{};
+    lane_bits continued{};
+  };
+
+  void evaluate(node const &value, lane_bits const &mask);
+  void evaluate_builtin(node const &value);
+  void call(node const &value, lane_bits const &mask);
+  void store(destination const &target, node const &value, lane_bits const &mask);
+  void execute(statement const &source, lane_bits const &mask, frame_masks &frame);
+
+public:
+  explicit invocation(program const &this_source_program);
+
+  void reset();
+
+  lane_bits &get_register(uint32_t slot);
+  lane_bits const &get_register(uint32_t slot) const;
+
+  void run(entry_point const &entry, lane_bits const &active);
+  lane_bits const &get_discarded() const;
+};
+
+}
@@ -0,0 +1,388 @@
+#include "minifier.h"
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "tokenizer.h"
+
+namespace wgsl {
+
+namespace {
+
+constexpr std::array short_reserved_words{                                      // keywords, reserved words and predeclared types short enough to be generated as names
+  "as", "do", "fn", "if", "in", "of",
+  "asm", "f16", "f32", "for", "get", "i32", "let", "mod", "mut", "new", "nil", "ptr", "pub", "ref", "set", "std", "try",
+  "u32", "use", "var",
+};
+
+constexpr std::array context_names{                                             // names only meaningful in a particular context, which must keep their spelling
+  // address spaces and access modes
+  "function", "private", "workgroup", "uniform", "storage", "handle", "read", "write", "read_write",
+  // builtin values
+  "vertex_index", "instance_index", "position", "front_facing", "frag_depth", "sample_index", "sample_mask",
+  "local_invocation_id", "local_invocation_index", "global_invocation_id", "workgroup_id", "num_workgroups",
+  "clip_distances", "primitive_index", "subgroup_invocation_id", "subgroup_size",
+  // interpolation
+  "perspective", "linear", "flat", "center", "centroid", "sample", "first", "either",
+  // texel formats
+  "rgba8unorm", "rgba8snorm", "rgba8uint", "rgba8sint", "rgba16uint", "rgba16sint", "rgba16float", "r32uint",
+  "r32sint", "r32float", "rg32uint", "rg32sint", "rg32float", "rgba32uint", "rgba32sint", "rgba32float",
+  "bgra8unorm",
+  // members of structures returned by builtin functions
+  "fract", "exp", "whole", "old_value", "exchanged",
+  // diagnostic severities
+  "error", "warning", "info", "off",
+};
+
+constexpr std::array entry_point_attributes{"vertex", "fragment", "compute"};
+
+bool contains(auto const &names, std::string_view name) {
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+bool is_swizzle(std::string_view name) {
+  /// Whether a member name could be a vector swizzle, such as .xy or .rgba
+  if(name.empty() || name.size() > 4) return false;
+  return name.find_first_not_of("xyzw") == std::string_view::npos || name.find_first_not_of("rgba") == std::string_view::npos;
+}
+
+std::string shorten_float(std::string_view text) {
+  /// Drop redundant zeros from a plain decimal float literal, so 0.50 becomes .5 and 2.0 becomes 2.
+  /// Literals with an exponent or suffix are left alone, as "1.e5" and "1.f" would read as member accesses
+  if(text.find_first_not_of("0123456789.") != std::string_view::npos) return std::string{text};
+  auto const point{text.find('.')};
+  if(point == std::string_view::npos) return std::string{text};
+  auto whole{text.substr(0, point)};
+  auto fraction{text.substr(point + 1)};
+  while(!fraction.empty() && fraction.back() == '0') fraction.remove_suffix(1);
+  while(whole.size() > 1 && whole.front() == '0') whole.remove_prefix(1);
+  if(whole == "0" && !fraction.empty()) whole = {};
+  return std::string{whole} + "." + std::string{fraction};
+}
+
+std::string generate_name(unsigned int index) {
+  /// The index'th short identifier: a to Z, then aa to Z9, and so on
+  constexpr std::string_view first_characters{"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+  constexpr std::string_view other_characters{"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"};
+  std::string name{first_characters[index % first_characters.size()]};
+  index /= static_cast<unsigned int>(first_characters.size());
+  while(index != 0) {
+    --index;
+    name += other_characters[index % other_characters.size()];
+    index /= static_cast<unsigned int>(other_characters.size());
+  }
+  return name;
+}
+
+bool needs_space(std::string_view left, std::string_view right) {
+  /// Whether two tokens written together would read back as something other than the same two tokens
+  std::string const joined{std::string{left} + std::string{right}};             // outlives the tokens viewing it
+  try {
+    auto const tokens{tokenize(joined)};
+    return tokens.size() != 3 || tokens[0].text != left || tokens[1].text != right;
+  } catch(std::runtime_error const&) {
+    return true;
+  }
+}
+
+class minifier {
+  /// Collapses whitespace, drops comments and optional punctuation, inlines aliases where that's shorter, and
+  /// renames every declared identifier by how often it's used, most used shortest
+  /// Entry points, override constants and anything spelled out by context (builtin values, address spaces,
+  /// texel formats and swizzles) keep their names, as the host and the WGSL grammar refer to them by name;
+  /// bindings and locations are numbers, so they're unaffected
+  /// Naming is by spelling rather than by scope: every declaration of a name gets the same new name, so
+  /// shadowing still resolves the same way
+  struct alias_declaration {
+    std::string_view name;
+    size_t begin{0};                                                            // the alias keyword
+    size_t type_begin{0};
+    size_t end{0};                                                              // one past the semicolon
+    bool inlined{false};
+  };
+
+  std::vector<token> tokens;
+  std::unordered_set<std::string_view> declared_names;                          // functions, structures, variables, constants and parameters
+  std::unordered_set<std::string_view> member_names;
+  std::unordered_set<size_t> member_declarations;                               // indices of the names in structure declarations
+  std::unordered_set<std::string_view> kept_names;                              // declared, but referred to from outside the shader
+  std::vector<alias_declaration> aliases;
+  std::unordered_map<std::string_view, std::string> new_names;
+  std::unordered_map<std::string_view, std::string> new_member_names;
+
+  std::vector<std::string_view> output;
+  std::vector<bool> line_break_after;                                           // one per output token
+  std::deque<std::string> output_storage;                                       // text for output tokens that aren't views into the source
+
+  minify_stats &stats;
+
+  bool is_identifier(size_t index, std::string_view text = {}) const {
+    return index < tokens.size() && tokens[index].type == token::types::identifier && (text.empty() || tokens[index].text == text);
+  }
+
+  bool is_member(size_t index) const {
+    /// Whether an identifier names a structure member, in an access or in the structure's declaration
+    return (index != 0 && tokens[index - 1].type == token::types::symbol && tokens[index - 1].text == ".") || member_declarations.contains(index);
+  }
+
+  size_t find_closing(size_t open) const {
+    /// Index of the bracket closing the one at open
+    auto const open_text{tokens[open].text};
+    auto const close_text{open_text == "(" ? ")" : open_text == "{" ? "}" : open_text == "[" ? "]" : ">"};
+    unsigned int depth{0};
+    for(size_t i{open}; i != tokens.size(); ++i) {
+      if(tokens[i].type != token::types::symbol) continue;
+      if(tokens[i].text == open_text) {
+        ++depth;
+      } else if(tokens[i].text == close_text && --depth == 0) {
+        return i;
+      }
+    }
+    throw std::runtime_error{"WGSL minifier: " + std::to_string(tokens[open].line) + ":" + std::to_string(tokens[open].column) + ": unmatched '" + std::string{open_text} + "'"};
+  }
+
+  bool is_entry_point(size_t fn_index) const {
+    /// Whether the function declared at fn_index has a shader stage attribute
+    size_t i{fn_index};
+    while(i >= 2) {
+      if(tokens[i - 1].type == token::types::symbol && tokens[i - 1].text == ")") {
+        unsigned int depth{0};
+        do {
+          --i;
+          if(tokens[i].text == ")") ++depth;
+          if(tokens[i].text == "(") --depth;
+        } while(depth != 0 && i != 0);
+      }
+      if(i < 2 || !is_identifier(i - 1) || tokens[i - 2].type != token::types::attribute) return false;
+      if(contains(entry_point_attributes, tokens[i - 1].text)) return true;
+      i -= 2;
+    }
+    return false;
+  }
+
+  std::vector<size_t> find_typed_names(size_t open) const {
+    /// Every "name:" within a bracketed list, such as structure members or function parameters
+    std::vector<size_t> result;
+    auto const close{find_closing(open)};
+    for(size_t i{open + 1}; i < close; ++i) {
+      if(is_identifier(i) && tokens[i + 1].type == token::types::symbol && tokens[i + 1].text == ":") result.emplace_back(i);
+    }
+    return result;
+  }
+
+  void find_declarations() {
+    /// Collect the names the shader declares
+    for(size_t i{0}; i + 1 < tokens.size(); ++i) {
+      if(!is_identifier(i) || is_member(i)) continue;
+      auto const keyword{tokens[i].text};
+      if(keyword == "struct" && is_identifier(i + 1)) {
+        declared_names.emplace(tokens[i + 1].text);
+        if(i + 2 < tokens.size() && tokens[i + 2].text == "{") {
+          for(auto const member : find_typed_names(i + 2)) {
+            member_names.emplace(tokens[member].text);
+            member_declarations.emplace(member);
+          }
+        }
+      } else if(keyword == "fn" && is_identifier(i + 1)) {
+        (is_entry_point(i) ? kept_names : declared_names).emplace(tokens[i + 1].text);
+        if(i + 2 < tokens.size() && tokens[i + 2].text == "(") {
+          for(auto const parameter : find_typed_names(i + 2)) declared_names.emplace(tokens[parameter].text);
+        }
+      } else if(keyword == "var") {
+        auto name{i + 1};
+        if(name < tokens.size() && tokens[name].text == "<") name = find_closing(name) + 1;
+        if(is_identifier(name)) declared_names.emplace(tokens[name].text);
+      } else if(keyword == "let" || keyword == "const") {
+        if(is_identifier(i + 1)) declared_names.emplace(tokens[i + 1].text);
+      } else if(keyword == "override") {
+        if(is_identifier(i + 1)) kept_names.emplace(tokens[i + 1].text);
+      } else if(keyword == "alias" && is_identifier(i + 1) && i + 2 < tokens.size() && tokens[i + 2].text == "=") {
+        auto end{i + 3};
+        while(end != tokens.size() && tokens[end].text != ";") ++end;
+        if(end == tokens.size()) throw std::runtime_error{"WGSL minifier: unterminated alias " + std::string{tokens[i + 1].text}};
+        aliases.emplace_back(alias_declaration{
+          .name{tokens[i + 1].text},
+          .begin{i},
+          .type_begin{i + 3},
+          .end{end + 1},
+        });
+      }
+    }
+
+    std::erase_if(declared_names, [&](std::string_view name){return kept_names.contains(name) || contains(context_names, name);});
+    std::erase_if(member_names, [&](std::string_view name){return is_swizzle(name) || contains(context_names, name);});
+  }
+
+  alias_declaration const *find_alias(std::string_view name) const {
+    auto const it{std::find_if(aliases.begin(), aliases.end(), [&](alias_declaration const &alias){return alias.name == name;})};
+    return it == aliases.end() ? nullptr : &*it;
+  }
+
+  size_t expanded_length(size_t begin, size_t end, unsigned int depth = 0) const {
+    /// Length of a range of tokens once every alias within it is expanded, ignoring spacing
+    if(depth > aliases.size()) throw std::runtime_error{"WGSL minifier: recursive alias"};
+    size_t length{0};
+    for(size_t i{begin}; i != end; ++i) {
+      auto const *alias{is_identifier(i) && !is_member(i) ? find_alias(tokens[i].text) : nullptr};
+      length += alias ? expanded_length(alias->type_begin, alias->end - 1, depth + 1) : tokens[i].text.size();
+    }
+    return length;
+  }
+
+  void choose_aliases_to_inline() {
+    /// Inline an alias wherever spelling out its type is no longer than keeping a declaration for a short name
+    for(auto &alias : aliases) {
+      if(declared_names.contains(alias.name)) continue;                         // the name is reused for something else too, so keep the alias
+      size_t uses{0};
+      for(size_t i{0}; i != tokens.size(); ++i) {
+        if(i != alias.begin + 1 && is_identifier(i, alias.name) && !is_member(i)) ++uses;
+      }
+      auto const type_length{expanded_length(alias.type_begin, alias.end - 1)};
+      auto const declaration_length{std::string_view{"alias a=;\n"}.size() + type_length};
+      alias.inlined = uses * type_length <= uses + declaration_length;
+      if(alias.inlined) {
+        ++stats.inlined_aliases;
+      } else {
+        declared_names.emplace(alias.name);
+      }
+    }
+  }
+
+  bool is_inlined_alias(std::string_view name) const {
+    auto const *alias{find_alias(name)};
+    return alias && alias->inlined;
+  }
+
+  void choose_names() {
+    /// Give each renamed identifier a new name, shortest to the most used, avoiding every name left as it was
+    std::unordered_set<std::string_view> unchanged_names;
+    std::unordered_map<std::string_view, unsigned int> uses;
+    std::vector<std::string_view> renamed;                                      // in order of first appearance
+    for(size_t i{0}; i != tokens.size(); ++i) {
+      if(!is_identifier(i)) continue;
+      auto const name{tokens[i].text};
+      bool const member{is_member(i)};
+      if((member && !member_names.contains(name)) || (!member && !declared_names.contains(name) && !is_inlined_alias(name))) {
+        unchanged_names.emplace(name);
+      } else if(!is_inlined_alias(name) || member) {
+        if(uses[name]++ == 0) renamed.emplace_back(name);
+      }
+    }
+    for(auto const &alias : aliases) {                                          // every declaration counts, even if unused
+      if(!alias.inlined && !uses.contains(alias.name)) renamed.emplace_back(alias.name);
+    }
+    std::stable_sort(renamed.begin(), renamed.end(), [&](std::string_view lhs, std::string_view rhs){return uses[lhs] > uses[rhs];});
+
+    unsigned int index{0};
+    for(auto const name : renamed) {
+      std::string new_name;
+      do {
+        new_name = generate_name(index++);
+      } while(contains(short_reserved_words, new_name) || unchanged_names.contains(new_name) || is_swizzle(new_name));
+      if(declared_names.contains(name)) new_names.emplace(name, new_name);
+      if(member_names.contains(name)) new_member_names.emplace(name, new_name);
+      ++stats.renamed_identifiers;
+    }
+  }
+
+  void emit(std::string_view text) {
+    output.emplace_back(text);
+    line_break_after.emplace_back(false);
+  }
+
+  void emit_range(size_t begin, size_t end, unsigned int depth = 0) {
+    /// Emit a range of tokens, renamed, with aliases expanded
+    for(size_t i{begin}; i != end; ++i) {
+      auto const &current{tokens[i]};
+      if(current.type == token::types::float_literal) {
+        emit(output_storage.emplace_back(shorten_float(current.text)));
+      } else if(current.type != token::types::identifier) {
+        emit(current.text);
+      } else if(is_member(i)) {
+        auto const it{new_member_names.find(current.text)};
+        emit(it == new_member_names.end() ? current.text : it->second);
+      } else if(auto const *alias{find_alias(current.text)}; alias && alias->inlined) {
+        if(depth > aliases.size()) throw std::runtime_error{"WGSL minifier: recursive alias"};
+        emit_range(alias->type_begin, alias->end - 1, depth + 1);
+      } else {
+        auto const it{new_names.find(current.text)};
+        emit(it == new_names.end() ? current.text : it->second);
+      }
+    }
+  }
+
+  void emit_module() {
+    /// Emit the whole module, one module-scope declaration per line
+    unsigned int brace_depth{0};
+    for(size_t i{0}; i != tokens.size(); ++i) {
+      auto const &current{tokens[i]};
+      if(brace_depth == 0 && is_identifier(i, "alias")) {
+        auto const alias{std::find_if(aliases.begin(), aliases.end(), [&](alias_declaration const &declaration){return declaration.begin == i;})};
+        if(alias != aliases.end() && alias->inlined) {
+          i = alias->end - 1;
+          continue;
+        }
+      }
+      if(current.type == token::types::symbol) {
+        // trailing commas are optional, as are empty declarations such as the semicolon after a structure
+        if(current.text == "," && i + 1 != tokens.size() && (tokens[i + 1].text == ")" || tokens[i + 1].text == "}")) continue;
+        if(current.text == ";" && brace_depth == 0 && (output.empty() || output.back() == "}" || output.back() == ";")) continue;
+        if(current.text == "{") ++brace_depth;
+        if(current.text == "}") --brace_depth;
+      }
+      emit_range(i, i + 1);
+      if(brace_depth == 0 && current.type == token::types::symbol && (current.text == "}" || current.text == ";")) {
+        line_break_after.back() = true;
+      }
+    }
+  }
+
+public:
+  minifier(std::string_view source, minify_stats &this_stats)
+    : tokens{tokenize(source)},
+      stats{this_stats} {
+    tokens.pop_back();                                                          // the end token
+    stats.source_bytes = source.size();
+  }
+
+  std::string run() {
+    /// Minify the module, and check the result reads back as the intended tokens
+    find_declarations();
+    choose_aliases_to_inline();
+    choose_names();
+    emit_module();
+
+    std::string result;
+    for(size_t i{0}; i != output.size(); ++i) {
+      if(i != 0) {
+        if(line_break_after[i - 1]) {
+          result += '\n';
+        } else if(needs_space(output[i - 1], output[i])) {
+          result += ' ';
+        }
+      }
+      result += output[i];
+    }
+    if(!output.empty()) result += '\n';
+
+    auto const check{tokenize(result)};
+    if(check.size() != output.size() + 1 || !std::equal(output.begin(), output.end(), check.begin(), [](std::string_view text, token const &read){return text == read.text;})) {
+      throw std::runtime_error{"WGSL minifier: minified source does not read back as the intended tokens"};
+    }
+    stats.minified_bytes = result.size();
+    return result;
+  }
+};
+
+}
+
+std::string minify(std::string_view source, minify_stats *stats) {
+  /// Shrink WGSL source without changing its meaning or interface
+  minify_stats local_stats;
+  return minifier{source, stats ? *stats : local_stats}.run();
+}
+
+}
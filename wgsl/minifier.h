@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace wgsl {
+
+struct minify_stats {
+  size_t source_bytes{0};
+  size_t minified_bytes{0};
+  unsigned int renamed_identifiers{0};
+  unsigned int inlined_aliases{0};                                              // including unused aliases, which are removed
+};
+
+std::string minify(std::string_view source, minify_stats *stats = nullptr);
+
+}
@@ -0,0 +1,580 @@
+#include "parser.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace wgsl {
+
+namespace ast {
+
+attribute const *find_attribute(std::span<attribute const> attributes, std::string_view name) {
+  /// Find an attribute by name, or return nullptr if it's not present
+  auto const it{std::ranges::find(attributes, name, &attribute::name)};
+  return it == attributes.end() ? nullptr : &*it;
+}
+
+}
+
+namespace {
+
+constexpr std::array templated_type_names{                                      // identifiers that take a template argument list in expressions
+  "vec2", "vec3", "vec4",
+  "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3", "mat3x4", "mat4x2", "mat4x3", "mat4x4",
+  "array", "bitcast",
+};
+
+constexpr std::array<std::array<std::string_view, 4>, 10> binary_operators{{    // lowest precedence first
+  {"||"},
+  {"&&"},
+  {"|"},
+  {"^"},
+  {"&"},
+  {"==", "!="},
+  {"<", ">", "<=", ">="},
+  {"<<", ">>"},
+  {"+", "-"},
+  {"*", "/", "%"},
+}};
+
+class parser {
+  std::vector<token> tokens;
+  size_t position{0};
+
+  token const &peek(size_t offset = 0) const {
+    return tokens[std::min(position + offset, tokens.size() - 1)];
+  }
+
+  bool is_symbol(std::string_view text, size_t offset = 0) const {
+    auto const &current{peek(offset)};
+    return current.type == token::types::symbol && current.text == text;
+  }
+
+  bool is_keyword(std::string_view text) const {
+    return peek().type == token::types::identifier && peek().text == text;
+  }
+
+  ast::location here() const {
+    return {.line{peek().line}, .column{peek().column}};
+  }
+
+  [[noreturn]] void fail(std::string const &message) const {
+    auto const &current{peek()};
+    throw std::runtime_error{"WGSL: " + std::to_string(current.line) + ":" + std::to_string(current.column) + ": " + message + (current.type == token::types::end ? " at end of source" : " near \"" + std::string{current.text} + "\"")};
+  }
+
+  token const &next() {
+    auto const &current{peek()};
+    if(position != tokens.size() - 1) ++position;
+    return current;
+  }
+
+  bool accept(std::string_view symbol) {
+    /// Consume the given symbol if it's next
+    if(!is_symbol(symbol)) return false;
+    next();
+    return true;
+  }
+
+  void expect(std::string_view symbol) {
+    if(!accept(symbol)) fail("expected \"" + std::string{symbol} + "\"");
+  }
+
+  void expect_template_close() {
+    /// Consume a ">" closing a template argument list, splitting ">>", ">=" and ">>=" as needed
+    auto &current{tokens[position]};
+    if(current.type == token::types::symbol && current.text.size() > 1 && current.text.front() == '>') {
+      current.text.remove_prefix(1);
+      ++current.column;
+      return;
+    }
+    expect(">");
+  }
+
+  std::string_view expect_identifier() {
+    if(peek().type != token::types::identifier) fail("expected an identifier");
+    return next().text;
+  }
+
+  std::vector<ast::attribute> parse_attributes() {
+    /// Parse any number of attributes, e.g. @location(0) @interpolate(flat)
+    std::vector<ast::attribute> attributes;
+    while(peek().type == token::types::attribute) {
+      next();
+      auto &current{attributes.emplace_back(ast::attribute{.name{expect_identifier()}, .arguments{}})};
+      if(!accept("(")) continue;
+      while(!accept(")")) {
+        current.arguments.emplace_back(next().text);
+        unsigned int depth{0};
+        while(depth != 0 || (!is_symbol(",") && !is_symbol(")"))) {             // skip the rest of a complex argument
+          if(peek().type == token::types::end) fail("unterminated attribute");
+          if(is_symbol("(")) ++depth;
+          if(is_symbol(")")) --depth;
+          next();
+        }
+        accept(",");
+      }
+    }
+    return attributes;
+  }
+
+  ast::type_name parse_type() {
+    /// Parse a type, with any template arguments
+    ast::type_name type{.name{}, .template_arguments{}, .location{here()}};
+    type.name = expect_identifier();
+    if(accept("<")) {
+      do {
+        if(peek().type == token::types::integer_literal) {                      // array element counts
+          type.template_arguments.emplace_back(ast::type_name{.name{next().text}, .template_arguments{}, .location{here()}});
+        } else {
+          type.template_arguments.emplace_back(parse_type());
+        }
+      } while(accept(","));
+      expect_template_close();
+    }
+    return type;
+  }
+
+  std::vector<ast::expression> parse_arguments() {
+    /// Parse a parenthesised, comma separated argument list
+    std::vector<ast::expression> arguments;
+    expect("(");
+    while(!accept(")")) {
+      arguments.emplace_back(parse_expression());
+      if(!is_symbol(")")) expect(",");
+    }
+    return arguments;
+  }
+
+  ast::expression parse_primary() {
+    /// Parse a literal, identifier, call or parenthesised expression
+    ast::expression result{.text{}, .callee{}, .operands{}, .location{here()}};
+    switch(peek().type) {
+    case token::types::integer_literal:
+    case token::types::float_literal:
+      result.kind = ast::expression::kinds::literal;
+      result.literal_type = peek().type;
+      result.text = next().text;
+      return result;
+
+    case token::types::identifier:
+      if(peek().text == "true" || peek().text == "false") {
+        result.kind = ast::expression::kinds::literal;
+        result.literal_type = token::types::identifier;
+        result.text = next().text;
+        return result;
+      }
+      if(is_symbol("(", 1)
+      || (is_symbol("<", 1) && std::ranges::find(templated_type_names, peek().text) != templated_type_names.end())) {
+        result.kind = ast::expression::kinds::call;
+        result.callee = parse_type();
+        result.operands = parse_arguments();
+        return result;
+      }
+      result.kind = ast::expression::kinds::identifier;
+      result.text = next().text;
+      return result;
+
+    case token::types::symbol:
+      if(accept("(")) {
+        result = parse_expression();
+        expect(")");
+        return result;
+      }
+      break;
+
+    case token::types::attribute:
+    case token::types::end:
+      break;
+    }
+    fail("expected an expression");
+  }
+
+  ast::expression parse_postfix() {
+    /// Parse member access and indexing following a primary expression
+    auto result{parse_primary()};
+    while(true) {
+      auto const location{here()};
+      if(accept(".")) {
+        ast::expression member{
+          .kind{ast::expression::kinds::member},
+          .text{expect_identifier()},
+          .callee{},
+          .operands{},
+          .location{location},
+        };
+        member.operands.emplace_back(std::move(result));
+        result = std::move(member);
+      } else if(accept("[")) {
+        ast::expression index{
+          .kind{ast::expression::kinds::index},
+          .text{},
+          .callee{},
+          .operands{},
+          .location{location},
+        };
+        index.operands.emplace_back(std::move(result));
+        index.operands.emplace_back(parse_expression());
+        expect("]");
+        result = std::move(index);
+      } else {
+        return result;
+      }
+    }
+  }
+
+  ast::expression parse_unary() {
+    /// Parse prefix operators
+    if(is_symbol("-") || is_symbol("!") || is_symbol("~")) {
+      ast::expression result{
+        .kind{ast::expression::kinds::unary},
+        .text{},
+        .callee{},
+        .operands{},
+        .location{here()},
+      };
+      result.text = next().text;
+      result.operands.emplace_back(parse_unary());
+      return result;
+    }
+    return parse_postfix();
+  }
+
+  ast::expression parse_binary(unsigned int level) {
+    /// Parse left-associative binary operators at the given precedence level and above
+    if(level == binary_operators.size()) return parse_unary();
+    auto lhs{parse_binary(level + 1)};
+    while(std::ranges::any_of(binary_operators[level], [&](std::string_view op){return !op.empty() && is_symbol(op);})) {
+      ast::expression result{
+        .kind{ast::expression::kinds::binary},
+        .text{},
+        .callee{},
+        .operands{},
+        .location{here()},
+      };
+      result.text = next().text;
+      result.operands.emplace_back(std::move(lhs));
+      result.operands.emplace_back(parse_binary(level + 1));
+      lhs = std::move(result);
+    }
+    return lhs;
+  }
+
+  ast::expression parse_expression() {
+    return parse_binary(0);
+  }
+
+  ast::statement parse_block() {
+    /// Parse a brace-enclosed sequence of statements
+    ast::statement block{
+      .kind{ast::statement::kinds::block},
+      .text{},
+      .declaration{},
+      .name{},
+      .type{},
+      .expressions{},
+      .children{},
+      .location{here()},
+    };
+    expect("{");
+    while(!accept("}")) {
+      if(peek().type == token::types::end) fail("unterminated block");
+      block.children.emplace_back(parse_statement());
+    }
+    return block;
+  }
+
+  ast::statement parse_variable_statement() {
+    /// Parse a var, let or const declaration, without the trailing semicolon
+    ast::statement result{
+      .kind{ast::statement::kinds::variable},
+      .text{},
+      .declaration{},
+      .name{},
+      .type{},
+      .expressions{},
+      .children{},
+      .location{here()},
+    };
+    result.declaration = next().text;
+    if(result.declaration == "var" && accept("<")) {                            // function address space is the only one allowed here
+      expect_identifier();
+      expect_template_close();
+    }
+    result.name = expect_identifier();
+    if(accept(":")) result.type = parse_type();
+    if(accept("=")) result.expressions.emplace_back(parse_expression());
+    return result;
+  }
+
+  ast::statement parse_simple_statement() {
+    /// Parse a declaration, assignment, increment, decrement or call, without the trailing semicolon
+    if(is_keyword("var") || is_keyword("let") || is_keyword("const")) return parse_variable_statement();
+
+    ast::statement result{.text{}, .declaration{}, .name{}, .type{}, .expressions{}, .children{}, .location{here()}};
+    auto target{parse_expression()};
+    if(accept("++")) {
+      result.kind = ast::statement::kinds::increment;
+    } else if(accept("--")) {
+      result.kind = ast::statement::kinds::decrement;
+    } else if(peek().type == token::types::symbol && peek().text.ends_with("=") && peek().text != "==" && peek().text != "!=" && peek().text != "<=" && peek().text != ">=") {
+      result.kind = ast::statement::kinds::assignment;
+      result.text = next().text;
+      result.expressions.emplace_back(std::move(target));
+      result.expressions.emplace_back(parse_expression());
+      return result;
+    } else {
+      if(target.kind != ast::expression::kinds::call) fail("expected a statement");
+      result.kind = ast::statement::kinds::call;
+    }
+    result.expressions.emplace_back(std::move(target));
+    return result;
+  }
+
+  ast::statement parse_if() {
+    /// Parse an if statement, with any else if and else clauses
+    ast::statement result{
+      .kind{ast::statement::kinds::if_else},
+      .text{},
+      .declaration{},
+      .name{},
+      .type{},
+      .expressions{},
+      .children{},
+      .location{here()},
+    };
+    next();
+    result.expressions.emplace_back(parse_expression());
+    result.children.emplace_back(parse_block());
+    if(is_keyword("else")) {
+      next();
+      result.children.emplace_back(is_keyword("if") ? parse_if() : parse_block());
+    }
+    return result;
+  }
+
+  ast::statement parse_statement() {
+    /// Parse any statement
+    ast::statement result{.text{}, .declaration{}, .name{}, .type{}, .expressions{}, .children{}, .location{here()}};
+    parse_attributes();                                                         // statement attributes don't affect behaviour
+    if(accept(";")) return result;
+    if(is_symbol("{")) return parse_block();
+
+    if(is_keyword("if")) return parse_if();
+
+    if(is_keyword("for")) {
+      next();
+      result.kind = ast::statement::kinds::for_loop;
+      expect("(");
+      result.children.emplace_back(is_symbol(";") ? ast::statement{} : parse_simple_statement());
+      expect(";");
+      if(!is_symbol(";")) result.expressions.emplace_back(parse_expression());
+      expect(";");
+      result.children.emplace_back(is_symbol(")") ? ast::statement{} : parse_simple_statement());
+      expect(")");
+      result.children.emplace_back(parse_block());
+      return result;
+    }
+
+    if(is_keyword("while")) {
+      next();
+      result.kind = ast::statement::kinds::while_loop;
+      result.expressions.emplace_back(parse_expression());
+      result.children.emplace_back(parse_block());
+      return result;
+    }
+
+    if(is_keyword("loop")) {
+      next();
+      result.kind = ast::statement::kinds::loop;
+      expect("{");
+      ast::statement body{
+        .kind{ast::statement::kinds::block},
+        .text{},
+        .declaration{},
+        .name{},
+        .type{},
+        .expressions{},
+        .children{},
+        .location{here()},
+      };
+      while(!accept("}")) {
+        if(is_keyword("continuing")) {
+          next();
+          auto continuing{parse_block()};
+          expect("}");                                                          // continuing must be the last thing in the loop
+          result.children.emplace_back(std::move(body));
+          result.children.emplace_back(std::move(continuing));
+          return result;
+        }
+        if(peek().type == token::types::end) fail("unterminated loop");
+        body.children.emplace_back(parse_statement());
+      }
+      result.children.emplace_back(std::move(body));
+      return result;
+    }
+
+    if(is_keyword("break")) {
+      next();
+      if(is_keyword("if")) {
+        next();
+        result.kind = ast::statement::kinds::break_if;
+        result.expressions.emplace_back(parse_expression());
+      } else {
+        result.kind = ast::statement::kinds::break_statement;
+      }
+      expect(";");
+      return result;
+    }
+
+    if(is_keyword("continue")) {
+      next();
+      result.kind = ast::statement::kinds::continue_statement;
+      expect(";");
+      return result;
+    }
+
+    if(is_keyword("return")) {
+      next();
+      result.kind = ast::statement::kinds::return_statement;
+      if(!is_symbol(";")) result.expressions.emplace_back(parse_expression());
+      expect(";");
+      return result;
+    }
+
+    if(is_keyword("discard")) {
+      next();
+      result.kind = ast::statement::kinds::discard;
+      expect(";");
+      return result;
+    }
+
+    if(is_keyword("switch")) fail("switch statements are not supported");
+
+    result = parse_simple_statement();
+    expect(";");
+    return result;
+  }
+
+  void skip_directive() {
+    /// Skip a global directive or assertion that doesn't affect execution, up to and including its semicolon
+    while(!accept(";")) {
+      if(peek().type == token::types::end) fail("unterminated directive");
+      next();
+    }
+  }
+
+  void parse_global(ast::module &result) {
+    /// Parse one module scope declaration
+    auto const location{here()};
+    auto attributes{parse_attributes()};
+
+    if(accept(";")) return;
+    if(is_keyword("enable") || is_keyword("requires") || is_keyword("diagnostic") || is_keyword("const_assert")) {
+      skip_directive();
+      return;
+    }
+
+    if(is_keyword("alias")) {
+      next();
+      auto &alias{result.aliases.emplace_back(ast::alias_declaration{.name{expect_identifier()}, .type{}, .location{location}})};
+      expect("=");
+      alias.type = parse_type();
+      expect(";");
+      return;
+    }
+
+    if(is_keyword("struct")) {
+      next();
+      auto &declaration{result.structs.emplace_back(ast::struct_declaration{.name{expect_identifier()}, .members{}, .location{location}})};
+      expect("{");
+      while(!accept("}")) {
+        auto &member{declaration.members.emplace_back(ast::struct_member{.attributes{parse_attributes()}, .name{}, .type{}})};
+        member.name = expect_identifier();
+        expect(":");
+        member.type = parse_type();
+        if(!is_symbol("}")) expect(",");
+      }
+      accept(";");
+      return;
+    }
+
+    if(is_keyword("var") || is_keyword("const") || is_keyword("override") || is_keyword("let")) {
+      ast::variable_declaration declaration{
+        .attributes{std::move(attributes)},
+        .declaration{next().text},
+        .address_space{},
+        .access_mode{},
+        .name{},
+        .type{},
+        .initialiser{},
+        .location{location},
+      };
+      if(declaration.declaration == "let") declaration.declaration = "const";   // module scope let is an old spelling of const
+      if(declaration.declaration == "var" && accept("<")) {
+        declaration.address_space = expect_identifier();
+        if(accept(",")) declaration.access_mode = expect_identifier();
+        expect_template_close();
+      }
+      declaration.name = expect_identifier();
+      if(accept(":")) declaration.type = parse_type();
+      if(accept("=")) declaration.initialiser = parse_expression();
+      expect(";");
+      result.variables.emplace_back(std::move(declaration));
+      return;
+    }
+
+    if(is_keyword("fn")) {
+      next();
+      ast::function_declaration function{
+        .attributes{std::move(attributes)},
+        .name{expect_identifier()},
+        .parameters{},
+        .return_type{},
+        .return_attributes{},
+        .body{},
+        .location{location},
+      };
+      expect("(");
+      while(!accept(")")) {
+        auto &parameter{function.parameters.emplace_back(ast::parameter{.attributes{parse_attributes()}, .name{}, .type{}})};
+        parameter.name = expect_identifier();
+        expect(":");
+        parameter.type = parse_type();
+        if(!is_symbol(")")) expect(",");
+      }
+      if(accept("->")) {
+        function.return_attributes = parse_attributes();
+        function.return_type = parse_type();
+      }
+      function.body = parse_block();
+      result.functions.emplace_back(std::move(function));
+      return;
+    }
+
+    fail("expected a declaration");
+  }
+
+public:
+  explicit parser(std::vector<token> &&this_tokens)
+    : tokens{std::move(this_tokens)} {
+  }
+
+  ast::module run() {
+    /// Parse the whole module
+    ast::module result;
+    while(peek().type != token::types::end) {
+      parse_global(result);
+    }
+    return result;
+  }
+};
+
+}
+
+ast::module parse(std::string_view source) {
+  /// Parse WGSL source into a syntax tree, which refers to the source so must not outlive it
+  return parser{tokenize(source)}.run();
+}
+
+}
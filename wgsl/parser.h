@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string_view>
+#include "ast.h"
+
+namespace wgsl {
+
+ast::module parse(std::string_view source);
+
+}
@@ -0,0 +1,1591 @@
+#include "program.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "parser.h"
+
+namespace wgsl {
+
+namespace {
+
+enum class builtin_category {
+  float_component_wise,                                                         // f32 scalars or vectors in, the same shape out
+  numeric_component_wise,                                                       // any numeric scalars or vectors in, the same shape out
+  float_reduce,                                                                 // f32 vectors in, an f32 scalar out
+  numeric_reduce,                                                               // numeric vectors in, a scalar out
+  float_vector,                                                                 // f32 vectors in, a vector out, not component-wise
+  boolean_reduce,                                                               // a boolean vector in, a boolean scalar out
+  select,
+  transpose,
+};
+
+struct builtin_info {
+  std::string_view name;
+  builtin_function function;
+  unsigned int arguments;
+  builtin_category category;
+};
+
+constexpr std::array builtins{
+  builtin_info{"abs",         builtin_function::abs,          1, builtin_category::numeric_component_wise},
+  builtin_info{"acos",        builtin_function::acos,         1, builtin_category::float_component_wise},
+  builtin_info{"acosh",       builtin_function::acosh,        1, builtin_category::float_component_wise},
+  builtin_info{"all",         builtin_function::all,          1, builtin_category::boolean_reduce},
+  builtin_info{"any",         builtin_function::any,          1, builtin_category::boolean_reduce},
+  builtin_info{"asin",        builtin_function::asin,         1, builtin_category::float_component_wise},
+  builtin_info{"asinh",       builtin_function::asinh,        1, builtin_category::float_component_wise},
+  builtin_info{"atan",        builtin_function::atan,         1, builtin_category::float_component_wise},
+  builtin_info{"atan2",       builtin_function::atan2,        2, builtin_category::float_component_wise},
+  builtin_info{"atanh",       builtin_function::atanh,        1, builtin_category::float_component_wise},
+  builtin_info{"ceil",        builtin_function::ceil,         1, builtin_category::float_component_wise},
+  builtin_info{"clamp",       builtin_function::clamp,        3, builtin_category::numeric_component_wise},
+  builtin_info{"cos",         builtin_function::cos,          1, builtin_category::float_component_wise},
+  builtin_info{"cosh",        builtin_function::cosh,         1, builtin_category::float_component_wise},
+  builtin_info{"cross",       builtin_function::cross,        2, builtin_category::float_vector},
+  builtin_info{"degrees",     builtin_function::degrees,      1, builtin_category::float_component_wise},
+  builtin_info{"distance",    builtin_function::distance,     2, builtin_category::float_reduce},
+  builtin_info{"dot",         builtin_function::dot,          2, builtin_category::numeric_reduce},
+  builtin_info{"exp",         builtin_function::exp,          1, builtin_category::float_component_wise},
+  builtin_info{"exp2",        builtin_function::exp2,         1, builtin_category::float_component_wise},
+  builtin_info{"floor",       builtin_function::floor,        1, builtin_category::float_component_wise},
+  builtin_info{"fma",         builtin_function::fma,          3, builtin_category::float_component_wise},
+  builtin_info{"fract",       builtin_function::fract,        1, builtin_category::float_component_wise},
+  builtin_info{"inverseSqrt", builtin_function::inverse_sqrt, 1, builtin_category::float_component_wise},
+  builtin_info{"length",      builtin_function::length,       1, builtin_category::float_reduce},
+  builtin_info{"log",         builtin_function::log,          1, builtin_category::float_component_wise},
+  builtin_info{"log2",        builtin_function::log2,         1, builtin_category::float_component_wise},
+  builtin_info{"max",         builtin_function::max,          2, builtin_category::numeric_component_wise},
+  builtin_info{"min",         builtin_function::min,          2, builtin_category::numeric_component_wise},
+  builtin_info{"mix",         builtin_function::mix,          3, builtin_category::float_component_wise},
+  builtin_info{"normalize",   builtin_function::normalize,    1, builtin_category::float_vector},
+  builtin_info{"pow",         builtin_function::pow,          2, builtin_category::float_component_wise},
+  builtin_info{"radians",     builtin_function::radians,      1, builtin_category::float_component_wise},
+  builtin_info{"reflect",     builtin_function::reflect,      2, builtin_category::float_vector},
+  builtin_info{"round",       builtin_function::round,        1, builtin_category::float_component_wise},
+  builtin_info{"saturate",    builtin_function::saturate,     1, builtin_category::float_component_wise},
+  builtin_info{"select",      builtin_function::select,       3, builtin_category::select},
+  builtin_info{"sign",        builtin_function::sign,         1, builtin_category::numeric_component_wise},
+  builtin_info{"sin",         builtin_function::sin,          1, builtin_category::float_component_wise},
+  builtin_info{"sinh",        builtin_function::sinh,         1, builtin_category::float_component_wise},
+  builtin_info{"smoothstep",  builtin_function::smoothstep,   3, builtin_category::float_component_wise},
+  builtin_info{"sqrt",        builtin_function::sqrt,         1, builtin_category::float_component_wise},
+  builtin_info{"step",        builtin_function::step,         2, builtin_category::float_component_wise},
+  builtin_info{"tan",         builtin_function::tan,          1, builtin_category::float_component_wise},
+  builtin_info{"tanh",        builtin_function::tanh,         1, builtin_category::float_component_wise},
+  builtin_info{"transpose",   builtin_function::transpose,    1, builtin_category::transpose},
+  builtin_info{"trunc",       builtin_function::trunc,        1, builtin_category::float_component_wise},
+};
+
+struct binary_operator_info {
+  std::string_view symbol;
+  binary_operator op;
+};
+
+constexpr std::array binary_operators{
+  binary_operator_info{"+",  binary_operator::add},
+  binary_operator_info{"-",  binary_operator::subtract},
+  binary_operator_info{"*",  binary_operator::multiply},
+  binary_operator_info{"/",  binary_operator::divide},
+  binary_operator_info{"%",  binary_operator::modulo},
+  binary_operator_info{"&",  binary_operator::bitwise_and},
+  binary_operator_info{"&&", binary_operator::bitwise_and},
+  binary_operator_info{"|",  binary_operator::bitwise_or},
+  binary_operator_info{"||", binary_operator::bitwise_or},
+  binary_operator_info{"^",  binary_operator::bitwise_xor},
+  binary_operator_info{"<<", binary_operator::shift_left},
+  binary_operator_info{">>", binary_operator::shift_right},
+  binary_operator_info{"<",  binary_operator::less},
+  binary_operator_info{"<=", binary_operator::less_equal},
+  binary_operator_info{">",  binary_operator::greater},
+  binary_operator_info{">=", binary_operator::greater_equal},
+  binary_operator_info{"==", binary_operator::equal},
+  binary_operator_info{"!=", binary_operator::not_equal},
+};
+
+bool is_integer(scalar_type scalar) {
+  return scalar == scalar_type::i32 || scalar == scalar_type::u32 || scalar == scalar_type::abstract_int;
+}
+
+bool is_comparison(binary_operator op) {
+  switch(op) {
+  case binary_operator::less:
+  case binary_operator::less_equal:
+  case binary_operator::greater:
+  case binary_operator::greater_equal:
+  case binary_operator::equal:
+  case binary_operator::not_equal:
+    return true;
+  case binary_operator::add:
+  case binary_operator::subtract:
+  case binary_operator::multiply:
+  case binary_operator::divide:
+  case binary_operator::modulo:
+  case binary_operator::bitwise_and:
+  case binary_operator::bitwise_or:
+  case binary_operator::bitwise_xor:
+  case binary_operator::shift_left:
+  case binary_operator::shift_right:
+    break;
+  }
+  return false;
+}
+
+bool is_bitwise(binary_operator op) {
+  return op == binary_operator::bitwise_and || op == binary_operator::bitwise_or || op == binary_operator::bitwise_xor;
+}
+
+bool is_shift(binary_operator op) {
+  return op == binary_operator::shift_left || op == binary_operator::shift_right;
+}
+
+uint32_t scalar_bits(scalar_type scalar, double value) {
+  /// The register contents representing a value of the given scalar type
+  switch(scalar) {
+  case scalar_type::f32:
+  case scalar_type::abstract_float:
+    return std::bit_cast<uint32_t>(static_cast<float>(value));
+  case scalar_type::i32:
+  case scalar_type::u32:
+  case scalar_type::abstract_int:
+    return static_cast<uint32_t>(static_cast<int64_t>(std::clamp(value, -9.0e18, 9.0e18))); // wraps, as two's complement
+  case scalar_type::boolean:
+    return value < 0.0 || value > 0.0 ? 1u : 0u;
+  }
+  return 0;
+}
+
+double scalar_value(scalar_type scalar, uint32_t bits) {
+  /// The value represented by the given register contents
+  switch(scalar) {
+  case scalar_type::f32:
+  case scalar_type::abstract_float:
+    return static_cast<double>(std::bit_cast<float>(bits));
+  case scalar_type::i32:
+  case scalar_type::abstract_int:
+    return static_cast<double>(std::bit_cast<int32_t>(bits));
+  case scalar_type::u32:
+  case scalar_type::boolean:
+    return static_cast<double>(bits);
+  }
+  return 0.0;
+}
+
+}
+
+class compiler {
+  /// Resolves and type checks a syntax tree, and lays out its values in registers
+  program &target;
+  ast::module const &syntax;
+
+  std::unordered_map<std::string_view, ast::alias_declaration const*> alias_declarations;
+  std::unordered_map<std::string_view, ast::struct_declaration const*> struct_declarations;
+  std::unordered_map<std::string_view, ast::variable_declaration const*> variable_declarations;
+  std::unordered_map<std::string_view, ast::function_declaration const*> function_declarations;
+
+  std::unordered_map<std::string_view, type const*> named_types;                // resolved aliases and structures
+  std::unordered_map<std::string_view, function const*> compiled_functions;
+  std::unordered_set<std::string_view> declarations_in_progress;                // to report cyclic declarations rather than overflow the stack
+
+  struct symbol {
+    node const *value{nullptr};                                                 // referring to the symbol evaluates to this
+    bool is_mutable{false};                                                     // whether it can be assigned to
+  };
+  std::unordered_map<std::string_view, symbol> globals;
+  std::vector<std::unordered_map<std::string_view, symbol>> scopes;             // function scopes, innermost last
+  function *current_function{nullptr};
+
+  struct reference {                                                            // something that can be assigned to
+    destination target;
+    type const *reference_type{nullptr};
+  };
+
+  [[noreturn]] void fail(ast::location const &location, std::string const &message) const {
+    throw std::runtime_error{"WGSL: " + std::to_string(location.line) + ":" + std::to_string(location.column) + ": " + message};
+  }
+
+  uint32_t allocate(unsigned int count) {
+    /// Reserve registers, which start out zeroed
+    auto const slot{static_cast<uint32_t>(target.initial_registers.size())};
+    target.initial_registers.resize(target.initial_registers.size() + count, 0);
+    return slot;
+  }
+
+  node *add_node(node::opcodes opcode, type const *result_type) {
+    /// Create a node with its own registers for the result
+    auto &result{target.nodes.emplace_back(node{
+      .opcode{opcode},
+      .result_type{result_type},
+      .operands{},
+      .sources{},
+      .broadcast{},
+      .abstract_value{},
+    })};
+    result.slot = allocate(result_type->get_component_count());
+    return &result;
+  }
+
+  node const *make_alias(type const *result_type, uint32_t slot, bool constant) {
+    /// A node referring to existing registers
+    return &target.nodes.emplace_back(node{
+      .result_type{result_type},
+      .slot{slot},
+      .operands{},
+      .sources{},
+      .broadcast{},
+      .constant{constant},
+      .abstract_value{},
+    });
+  }
+
+  node const *make_constant(scalar_type scalar, double value) {
+    auto *result{add_node(node::opcodes::none, target.types.get_scalar(scalar))};
+    result->constant = true;
+    target.initial_registers[result->slot] = scalar_bits(scalar, value);
+    return result;
+  }
+
+  node const *make_zero(type const *result_type) {
+    auto *result{add_node(node::opcodes::none, result_type)};
+    result->constant = true;
+    return result;
+  }
+
+  node const *make_abstract(scalar_type scalar, double value) {
+    /// An abstract value has no registers; it gets them when it's given a concrete type
+    return &target.nodes.emplace_back(node{
+      .result_type{target.types.get_scalar(scalar)},
+      .operands{},
+      .sources{},
+      .broadcast{},
+      .constant{true},
+      .abstract_value{value},
+    });
+  }
+
+  node const *make_view(node const *object, uint32_t offset, type const *result_type) {
+    /// Part of another node's result
+    if(object->opcode == node::opcodes::none) return make_alias(result_type, object->slot + offset, object->constant);
+    auto &result{target.nodes.emplace_back(node{
+      .opcode{node::opcodes::view},
+      .result_type{result_type},
+      .slot{object->slot + offset},
+      .operands{},
+      .sources{},
+      .broadcast{},
+      .abstract_value{},
+    })};
+    result.operands.emplace_back(object);
+    return &result;
+  }
+
+  node const *make_gather(type const *result_type, std::vector<node const*> &&operands, std::vector<uint32_t> &&sources) {
+    /// Assemble a result from registers of other nodes
+    bool const all_constant{std::ranges::all_of(operands, &node::constant)};
+    auto *result{add_node(node::opcodes::gather, result_type)};
+    result->operands = std::move(operands);
+    result->sources = std::move(sources);
+    if(all_constant) {                                                          // fold it now
+      for(size_t i{0}; i != result->sources.size(); ++i) {
+        target.initial_registers[result->slot + i] = target.initial_registers[result->sources[i]];
+      }
+      result->opcode = node::opcodes::none;
+      result->constant = true;
+      result->operands.clear();
+      result->sources.clear();
+    }
+    return result;
+  }
+
+  static bool is_abstract(node const *value) {
+    return value->abstract_value.has_value();
+  }
+
+  static scalar_type default_scalar(scalar_type scalar) {
+    /// The concrete type an abstract value takes when nothing else decides it
+    switch(scalar) {
+    case scalar_type::abstract_int:   return scalar_type::i32;
+    case scalar_type::abstract_float: return scalar_type::f32;
+    case scalar_type::f32:
+    case scalar_type::i32:
+    case scalar_type::u32:
+    case scalar_type::boolean:
+      break;
+    }
+    return scalar;
+  }
+
+  node const *concretise(node const *value, scalar_type scalar, ast::location const &location) {
+    /// Give an abstract value a concrete type; concrete values are returned unchanged
+    if(!is_abstract(value)) return value;
+    if(value->result_type->scalar == scalar_type::abstract_float && is_integer(scalar)) {
+      fail(location, "cannot convert a float literal to " + target.types.get_scalar(scalar)->get_name());
+    }
+    if(scalar == scalar_type::boolean) fail(location, "cannot convert a numeric literal to bool");
+    return make_constant(scalar, *value->abstract_value);
+  }
+
+  node const *concretise(node const *value, ast::location const &location) {
+    return concretise(value, default_scalar(value->result_type->scalar), location);
+  }
+
+  node const *convert_scalar(node const *value, scalar_type scalar, ast::location const &location) {
+    /// Explicitly convert the components of a value to another scalar type, as in a constructor
+    if(is_abstract(value)) return make_constant(scalar, *value->abstract_value);
+    auto const *value_type{value->result_type};
+    if(value_type->scalar == scalar) return value;
+    if(value_type->kind != type::kinds::scalar && value_type->kind != type::kinds::vector && value_type->kind != type::kinds::matrix) {
+      fail(location, "cannot convert " + value_type->get_name() + " to " + target.types.get_scalar(scalar)->get_name());
+    }
+    if(value->constant) {                                                       // fold it now
+      auto *result{add_node(node::opcodes::none, target.types.with_scalar(value_type, scalar))};
+      result->constant = true;
+      for(unsigned int i{0}; i != value_type->get_component_count(); ++i) {
+        auto const component{scalar_value(value_type->scalar, target.initial_registers[value->slot + i])};
+        target.initial_registers[result->slot + i] = scalar_bits(scalar, scalar == scalar_type::f32 ? component : std::trunc(component));
+      }
+      return result;
+    }
+    auto *result{add_node(node::opcodes::convert, target.types.with_scalar(value_type, scalar))};
+    result->operands.emplace_back(value);
+    result->operand_scalar = value_type->scalar;
+    return result;
+  }
+
+  node const *coerce(node const *value, type const *required_type, ast::location const &location) {
+    /// Implicitly convert a value to the required type, which only abstract values allow
+    if(is_abstract(value) && required_type->kind == type::kinds::scalar) return concretise(value, required_type->scalar, location);
+    if(value->result_type != required_type) {
+      fail(location, "cannot use " + value->result_type->get_name() + " as " + required_type->get_name());
+    }
+    return value;
+  }
+
+  // types
+
+  static std::optional<scalar_type> parse_scalar_name(std::string_view name) {
+    if(name == "f32")  return scalar_type::f32;
+    if(name == "i32")  return scalar_type::i32;
+    if(name == "u32")  return scalar_type::u32;
+    if(name == "bool") return scalar_type::boolean;
+    return std::nullopt;
+  }
+
+  static std::optional<scalar_type> parse_scalar_suffix(char suffix) {
+    switch(suffix) {
+    case 'f': return scalar_type::f32;
+    case 'i': return scalar_type::i32;
+    case 'u': return scalar_type::u32;
+    default:  return std::nullopt;
+    }
+  }
+
+  std::optional<scalar_type> get_template_scalar(ast::type_name const &name) {
+    /// The component type given as a template argument, e.g. f32 in vec3<f32>, if there is one
+    if(name.template_arguments.empty()) return std::nullopt;
+    auto const *argument_type{resolve_type(name.template_arguments.front())};
+    if(argument_type->kind != type::kinds::scalar) fail(name.location, "expected a scalar type argument");
+    return argument_type->scalar;
+  }
+
+  type const *resolve_type(ast::type_name const &name) {
+    /// Find the type a name refers to
+    if(name.name == "f16" || ((name.name.starts_with("vec") || name.name.starts_with("mat")) && name.name.ends_with("h"))) {
+      fail(name.location, "f16 is not supported");
+    }
+    if(auto const scalar{parse_scalar_name(name.name)}) return target.types.get_scalar(*scalar);
+
+    if(name.name.size() >= 4 && name.name.starts_with("vec") && name.name[3] >= '2' && name.name[3] <= '4') {
+      auto const size{static_cast<unsigned int>(name.name[3] - '0')};
+      if(name.name.size() == 5) {                                               // vec3f etc
+        if(auto const scalar{parse_scalar_suffix(name.name[4])}) return target.types.get_vector(*scalar, size);
+      } else if(name.name.size() == 4) {
+        auto const scalar{get_template_scalar(name)};
+        if(!scalar) fail(name.location, "vector type needs a component type");
+        return target.types.get_vector(*scalar, size);
+      }
+    }
+
+    if(name.name.size() >= 6 && name.name.starts_with("mat") && name.name[4] == 'x'
+    && name.name[3] >= '2' && name.name[3] <= '4' && name.name[5] >= '2' && name.name[5] <= '4') {
+      auto const columns{static_cast<unsigned int>(name.name[3] - '0')};
+      auto const rows{static_cast<unsigned int>(name.name[5] - '0')};
+      if(name.name.size() == 7 && name.name[6] == 'f') return target.types.get_matrix(scalar_type::f32, columns, rows);
+      if(name.name.size() == 6) {
+        auto const scalar{get_template_scalar(name).value_or(scalar_type::f32)};
+        if(scalar != scalar_type::f32) fail(name.location, "matrices must have f32 components");
+        return target.types.get_matrix(scalar, columns, rows);
+      }
+    }
+
+    if(name.name == "array") {
+      if(name.template_arguments.size() != 2) fail(name.location, "arrays need an element type and a fixed size");
+      auto const *element{resolve_type(name.template_arguments[0])};
+      auto const &count_name{name.template_arguments[1].name};
+      unsigned int count{0};
+      for(auto const c : count_name) {
+        if(c < '0' || c > '9') break;
+        count = count * 10 + static_cast<unsigned int>(c - '0');
+      }
+      if(count == 0) fail(name.location, "array size must be a positive integer literal");
+      return target.types.get_array(element, count);
+    }
+
+    return resolve_named_type(name.name, name.location);
+  }
+
+  type const *resolve_named_type(std::string_view name, ast::location const &location) {
+    /// Resolve an alias or structure by name
+    if(auto const it{named_types.find(name)}; it != named_types.end()) return it->second;
+    if(declarations_in_progress.contains(name)) fail(location, "type \"" + std::string{name} + "\" refers to itself");
+    declarations_in_progress.emplace(name);
+
+    type const *result{nullptr};
+    if(auto const alias_it{alias_declarations.find(name)}; alias_it != alias_declarations.end()) {
+      result = resolve_type(alias_it->second->type);
+    } else if(auto const struct_it{struct_declarations.find(name)}; struct_it != struct_declarations.end()) {
+      structure new_structure{.name{std::string{name}}, .members{}};
+      for(auto const &member : struct_it->second->members) {
+        auto &new_member{new_structure.members.emplace_back(structure::member{
+          .name{std::string{member.name}},
+          .member_type{resolve_type(member.type)},
+          .location{},
+          .builtin{},
+        })};
+        if(auto const *location_attribute{ast::find_attribute(member.attributes, "location")}; location_attribute && !location_attribute->arguments.empty()) {
+          new_member.location = static_cast<unsigned int>(std::stoul(std::string{location_attribute->arguments.front()}));
+        }
+        if(auto const *builtin_attribute{ast::find_attribute(member.attributes, "builtin")}; builtin_attribute && !builtin_attribute->arguments.empty()) {
+          new_member.builtin = builtin_attribute->arguments.front();
+        }
+      }
+      result = target.types.get_structure(std::move(new_structure));
+    } else {
+      fail(location, "unknown type \"" + std::string{name} + "\"");
+    }
+
+    declarations_in_progress.erase(name);
+    named_types.emplace(name, result);
+    return result;
+  }
+
+  bool is_type_name(std::string_view name) const {
+    /// Whether a call to this name constructs a type rather than calling a function
+    return parse_scalar_name(name) || name.starts_with("vec") || name.starts_with("mat") || name == "array"
+        || alias_declarations.contains(name) || struct_declarations.contains(name);
+  }
+
+  // expressions
+
+  node const *compile_literal(ast::expression const &expression) {
+    /// Literals without a suffix are abstract, and take their type from how they're used
+    auto text{expression.text};
+    if(expression.literal_type == token::types::identifier) return make_constant(scalar_type::boolean, text == "true" ? 1.0 : 0.0);
+
+    std::optional<scalar_type> scalar;
+    bool const hexadecimal{text.starts_with("0x") || text.starts_with("0X")};
+    if(auto const suffix{parse_scalar_suffix(text.back())}; suffix && !(hexadecimal && text.back() == 'f')) { // f is a digit in hexadecimal
+      scalar = suffix;
+      text.remove_suffix(1);
+    }
+    if(text.ends_with('h')) fail(expression.location, "f16 is not supported");
+
+    double value{0.0};
+    try {
+      if(expression.literal_type == token::types::integer_literal) {
+        value = static_cast<double>(std::stoll(std::string{text}, nullptr, 0));
+      } else {
+        value = std::stod(std::string{text});
+      }
+    } catch(std::exception const&) {
+      fail(expression.location, "malformed literal \"" + std::string{expression.text} + "\"");
+    }
+    if(scalar) return make_constant(*scalar, value);
+    return make_abstract(expression.literal_type == token::types::integer_literal ? scalar_type::abstract_int : scalar_type::abstract_float, value);
+  }
+
+  symbol const &lookup(std::string_view name, ast::location const &location) {
+    /// Find a symbol in the innermost scope declaring it, compiling module scope declarations on first use
+    for(auto scope{scopes.rbegin()}; scope != scopes.rend(); ++scope) {
+      if(auto const it{scope->find(name)}; it != scope->end()) return it->second;
+    }
+    return get_global(name, location);
+  }
+
+  node const *compile_member(ast::expression const &expression) {
+    /// Access a structure member, or swizzle a vector
+    auto const *object{compile_expression(expression.operands.front())};
+    if(is_abstract(object)) object = concretise(object, expression.location);
+    auto const *object_type{object->result_type};
+    auto const name{expression.text};
+
+    if(object_type->kind == type::kinds::structure) {
+      auto const *member{object_type->members->find_member(name)};
+      if(!member) fail(expression.location, "no member \"" + std::string{name} + "\" in " + object_type->get_name());
+      return make_view(object, member->component_offset, member->member_type);
+    }
+
+    if(object_type->kind == type::kinds::vector) {
+      auto const components{get_swizzle(name, object_type->rows, expression.location)};
+      auto const *result_type{components.size() == 1 ? target.types.get_scalar(object_type->scalar) : target.types.get_vector(object_type->scalar, static_cast<unsigned int>(components.size()))};
+      bool contiguous{true};
+      for(size_t i{1}; i != components.size(); ++i) {
+        contiguous = contiguous && components[i] == components[i - 1] + 1;
+      }
+      if(contiguous) return make_view(object, components.front(), result_type);
+      std::vector<uint32_t> sources;
+      for(auto const component : components) {
+        sources.emplace_back(object->slot + component);
+      }
+      return make_gather(result_type, {object}, std::move(sources));
+    }
+
+    fail(expression.location, "cannot access member \"" + std::string{name} + "\" of " + object_type->get_name());
+  }
+
+  std::vector<uint32_t> get_swizzle(std::string_view name, unsigned int size, ast::location const &location) const {
+    /// The components selected by a swizzle, e.g. 1 and 0 for .yx
+    static constexpr std::string_view xyzw{"xyzw"};
+    static constexpr std::string_view rgba{"rgba"};
+    if(name.empty() || name.size() > 4) fail(location, "invalid swizzle \"" + std::string{name} + "\"");
+    auto const &letters{xyzw.find(name.front()) != std::string_view::npos ? xyzw : rgba};
+    std::vector<uint32_t> components;
+    for(auto const letter : name) {
+      auto const component{letters.find(letter)};
+      if(component == std::string_view::npos || component >= size) fail(location, "invalid swizzle \"" + std::string{name} + "\"");
+      components.emplace_back(static_cast<uint32_t>(component));
+    }
+    return components;
+  }
+
+  std::optional<int64_t> get_constant_index(node const *index) const {
+    /// The value of an index known at compile time
+    if(is_abstract(index)) return static_cast<int64_t>(*index->abstract_value);
+    if(index->constant && index->opcode == node::opcodes::none && index->result_type->kind == type::kinds::scalar) {
+      return static_cast<int64_t>(scalar_value(index->result_type->scalar, target.initial_registers[index->slot]));
+    }
+    return std::nullopt;
+  }
+
+  std::pair<type const*, unsigned int> get_element_type(type const *object_type, ast::location const &location) {
+    /// The type and count of the elements an index selects between
+    switch(object_type->kind) {
+    case type::kinds::vector:
+      return {target.types.get_scalar(object_type->scalar), object_type->rows};
+    case type::kinds::matrix:
+      return {target.types.get_vector(object_type->scalar, object_type->rows), object_type->columns};
+    case type::kinds::array:
+      return {object_type->element, object_type->columns};
+    case type::kinds::none:
+    case type::kinds::scalar:
+    case type::kinds::structure:
+      break;
+    }
+    fail(location, "cannot index " + object_type->get_name());
+  }
+
+  node const *compile_index(ast::expression const &expression) {
+    /// Index a vector, matrix or array
+    auto const *object{compile_expression(expression.operands[0])};
+    if(is_abstract(object)) object = concretise(object, expression.location);
+    auto const [element_type, element_count]{get_element_type(object->result_type, expression.location)};
+    auto const element_components{element_type->get_component_count()};
+    auto const *index{compile_expression(expression.operands[1])};
+
+    if(auto const constant_index{get_constant_index(index)}) {
+      if(*constant_index < 0 || *constant_index >= element_count) fail(expression.location, "index out of bounds");
+      return make_view(object, static_cast<uint32_t>(*constant_index) * element_components, element_type);
+    }
+    if(!is_integer(index->result_type->scalar) || index->result_type->kind != type::kinds::scalar) fail(expression.location, "index must be an integer scalar");
+
+    auto *result{add_node(node::opcodes::dynamic_index, element_type)};
+    result->operands = {object, index};
+    result->operand_scalar = index->result_type->scalar;
+    result->shape = {element_components, element_count, 0};
+    return result;
+  }
+
+  node const *fold_unary(unary_operator op, node const *operand, ast::location const &location) {
+    /// Evaluate an operator on an abstract value at compile time
+    auto const scalar{operand->result_type->scalar};
+    auto const value{*operand->abstract_value};
+    switch(op) {
+    case unary_operator::negate:
+      return make_abstract(scalar, -value);
+    case unary_operator::bitwise_not:
+      if(scalar != scalar_type::abstract_int) fail(location, "~ needs an integer");
+      return make_abstract(scalar, static_cast<double>(~static_cast<int64_t>(value)));
+    case unary_operator::logical_not:
+      break;
+    }
+    fail(location, "! needs a bool");
+  }
+
+  node const *compile_unary(unary_operator op, node const *operand, ast::location const &location) {
+    if(is_abstract(operand)) return fold_unary(op, operand, location);
+    auto const *operand_type{operand->result_type};
+    switch(op) {
+    case unary_operator::negate:
+      if(operand_type->scalar == scalar_type::boolean || operand_type->kind == type::kinds::structure || operand_type->kind == type::kinds::array) fail(location, "cannot negate " + operand_type->get_name());
+      break;
+    case unary_operator::logical_not:
+      if(operand_type->scalar != scalar_type::boolean || !(operand_type->kind == type::kinds::scalar || operand_type->kind == type::kinds::vector)) fail(location, "! needs a bool");
+      break;
+    case unary_operator::bitwise_not:
+      if(!is_integer(operand_type->scalar) || !operand_type->is_numeric_scalar_or_vector()) fail(location, "~ needs an integer");
+      break;
+    }
+    auto *result{add_node(node::opcodes::unary, operand_type)};
+    result->operands.emplace_back(operand);
+    result->operand_scalar = operand_type->scalar;
+    result->unary = op;
+    return result;
+  }
+
+  node const *fold_binary(binary_operator op, node const *lhs, node const *rhs, ast::location const &location) {
+    /// Evaluate an operator on two abstract values at compile time
+    bool const integer{lhs->result_type->scalar == scalar_type::abstract_int && rhs->result_type->scalar == scalar_type::abstract_int};
+    auto const scalar{integer ? scalar_type::abstract_int : scalar_type::abstract_float};
+    auto const a{*lhs->abstract_value};
+    auto const b{*rhs->abstract_value};
+    auto const ia{static_cast<int64_t>(a)};
+    auto const ib{static_cast<int64_t>(b)};
+    switch(op) {
+    case binary_operator::add:      return make_abstract(scalar, a + b);
+    case binary_operator::subtract: return make_abstract(scalar, a - b);
+    case binary_operator::multiply: return make_abstract(scalar, a * b);
+    case binary_operator::divide:
+      if(!integer) return make_abstract(scalar, a / b);
+      if(ib == 0) fail(location, "integer division by zero");
+      return make_abstract(scalar, static_cast<double>(ia / ib));
+    case binary_operator::modulo:
+      if(!integer) return make_abstract(scalar, std::fmod(a, b));
+      if(ib == 0) fail(location, "integer division by zero");
+      return make_abstract(scalar, static_cast<double>(ia % ib));
+    case binary_operator::bitwise_and:
+    case binary_operator::bitwise_or:
+    case binary_operator::bitwise_xor:
+    case binary_operator::shift_left:
+    case binary_operator::shift_right:
+      if(!integer) fail(location, "bitwise operators need integers");
+      switch(op) {
+      case binary_operator::bitwise_and: return make_abstract(scalar, static_cast<double>(ia & ib));
+      case binary_operator::bitwise_or:  return make_abstract(scalar, static_cast<double>(ia | ib));
+      case binary_operator::bitwise_xor: return make_abstract(scalar, static_cast<double>(ia ^ ib));
+      case binary_operator::shift_left:  return make_abstract(scalar, static_cast<double>(ia << (ib & 63)));
+      case binary_operator::shift_right: return make_abstract(scalar, static_cast<double>(ia >> (ib & 63)));
+      case binary_operator::add:
+      case binary_operator::subtract:
+      case binary_operator::multiply:
+      case binary_operator::divide:
+      case binary_operator::modulo:
+      case binary_operator::less:
+      case binary_operator::less_equal:
+      case binary_operator::greater:
+      case binary_operator::greater_equal:
+      case binary_operator::equal:
+      case binary_operator::not_equal:
+        break;
+      }
+      break;
+    case binary_operator::less:
+    case binary_operator::less_equal:
+    case binary_operator::greater:
+    case binary_operator::greater_equal:
+    case binary_operator::equal:
+    case binary_operator::not_equal:
+      break;
+    }
+    return nullptr;                                                             // comparisons are left to run time
+  }
+
+  node const *compile_binary(binary_operator op, node const *lhs, node const *rhs, ast::location const &location) {
+    /// Type check a binary operator, giving abstract operands the type of the other side
+    if(is_abstract(lhs) && is_abstract(rhs)) {
+      if(auto const *folded{fold_binary(op, lhs, rhs, location)}) return folded;
+    }
+    if(is_shift(op)) {
+      rhs = concretise(rhs, scalar_type::u32, location);
+      lhs = concretise(lhs, location);
+    } else if(is_abstract(lhs) && !is_abstract(rhs)) {
+      lhs = concretise(lhs, rhs->result_type->scalar, location);
+    } else if(is_abstract(rhs) && !is_abstract(lhs)) {
+      rhs = concretise(rhs, lhs->result_type->scalar, location);
+    } else if(is_abstract(lhs)) {
+      bool const integer{lhs->result_type->scalar == scalar_type::abstract_int && rhs->result_type->scalar == scalar_type::abstract_int};
+      lhs = concretise(lhs, integer ? scalar_type::i32 : scalar_type::f32, location);
+      rhs = concretise(rhs, integer ? scalar_type::i32 : scalar_type::f32, location);
+    }
+
+    auto const *lhs_type{lhs->result_type};
+    auto const *rhs_type{rhs->result_type};
+    auto const describe{[&]{return lhs_type->get_name() + " and " + rhs_type->get_name();}};
+    for(auto const *operand_type : {lhs_type, rhs_type}) {
+      if(operand_type->kind == type::kinds::structure || operand_type->kind == type::kinds::array || operand_type->kind == type::kinds::none) {
+        fail(location, "invalid operands " + describe());
+      }
+    }
+
+    if(op == binary_operator::multiply
+    && ((lhs_type->kind == type::kinds::matrix && rhs_type->kind != type::kinds::scalar)
+     || (rhs_type->kind == type::kinds::matrix && lhs_type->kind != type::kinds::scalar))) {
+      return compile_matrix_multiply(lhs, rhs, location);
+    }
+
+    if(!is_shift(op) && lhs_type->scalar != rhs_type->scalar) fail(location, "mismatched operands " + describe());
+    if(is_shift(op) && (!is_integer(lhs_type->scalar) || rhs_type->scalar != scalar_type::u32)) fail(location, "invalid shift operands " + describe());
+    if(is_bitwise(op) && lhs_type->scalar == scalar_type::f32) fail(location, "bitwise operators need integers or bools");
+    if(!is_bitwise(op) && op != binary_operator::equal && op != binary_operator::not_equal && lhs_type->scalar == scalar_type::boolean) {
+      fail(location, "invalid operands " + describe());
+    }
+
+    type const *shape_type{nullptr};
+    auto const lhs_components{lhs_type->get_component_count()};
+    auto const rhs_components{rhs_type->get_component_count()};
+    if(lhs_type->kind == rhs_type->kind && lhs_type->columns == rhs_type->columns && lhs_type->rows == rhs_type->rows) {
+      shape_type = lhs_type;
+    } else if(rhs_components == 1 && lhs_type->kind != type::kinds::matrix) {
+      shape_type = lhs_type;
+    } else if(lhs_components == 1 && rhs_type->kind != type::kinds::matrix) {
+      shape_type = rhs_type;
+    } else if((op == binary_operator::multiply || op == binary_operator::divide) && (lhs_components == 1 || rhs_components == 1)) {
+      shape_type = lhs_components == 1 ? rhs_type : lhs_type;                   // matrix scaled by a scalar
+    } else {
+      fail(location, "mismatched operand shapes " + describe());
+    }
+    if(shape_type->kind == type::kinds::matrix && !(op == binary_operator::add || op == binary_operator::subtract || op == binary_operator::multiply || op == binary_operator::divide)) {
+      fail(location, "invalid matrix operation on " + describe());
+    }
+
+    auto const *result_type{is_comparison(op) ? target.types.with_scalar(shape_type, scalar_type::boolean) : target.types.with_scalar(shape_type, lhs_type->scalar)};
+    auto *result{add_node(node::opcodes::binary, result_type)};
+    auto const result_components{result_type->get_component_count()};
+    result->operands = {lhs, rhs};
+    result->broadcast = {lhs_components == 1 && result_components != 1, rhs_components == 1 && result_components != 1};
+    result->operand_scalar = lhs_type->scalar;
+    result->binary = op;
+    return result;
+  }
+
+  node const *compile_matrix_multiply(node const *lhs, node const *rhs, ast::location const &location) {
+    /// Multiply a matrix by a vector or matrix, or a vector by a matrix
+    auto const *lhs_type{lhs->result_type};
+    auto const *rhs_type{rhs->result_type};
+    if(lhs_type->scalar != scalar_type::f32 || rhs_type->scalar != scalar_type::f32) fail(location, "matrix multiplication needs f32 operands");
+    // treat vectors on the left as single row matrices and vectors on the right as single column matrices
+    unsigned int const lhs_rows{lhs_type->kind == type::kinds::vector ? 1 : lhs_type->rows};
+    unsigned int const lhs_columns{lhs_type->kind == type::kinds::vector ? lhs_type->rows : lhs_type->columns};
+    unsigned int const rhs_rows{rhs_type->rows};
+    unsigned int const rhs_columns{rhs_type->kind == type::kinds::vector ? 1 : rhs_type->columns};
+    if(lhs_columns != rhs_rows) fail(location, "mismatched matrix dimensions " + lhs_type->get_name() + " and " + rhs_type->get_name());
+
+    type const *result_type{nullptr};
+    if(lhs_type->kind == type::kinds::vector) {
+      result_type = target.types.get_vector(scalar_type::f32, rhs_columns);
+    } else if(rhs_type->kind == type::kinds::vector) {
+      result_type = target.types.get_vector(scalar_type::f32, lhs_rows);
+    } else {
+      result_type = target.types.get_matrix(scalar_type::f32, rhs_columns, lhs_rows);
+    }
+    auto *result{add_node(node::opcodes::matrix_multiply, result_type)};
+    result->operands = {lhs, rhs};
+    result->shape = {lhs_rows, lhs_columns, rhs_columns};
+    return result;
+  }
+
+  node const *compile_builtin(builtin_info const &info, std::vector<node const*> &&arguments, ast::location const &location) {
+    /// Type check a call to a builtin function
+    if(arguments.size() != info.arguments) fail(location, std::string{info.name} + " takes " + std::to_string(info.arguments) + " arguments");
+
+    // values being chosen between by select take their type from each other
+    size_t const numeric_arguments{info.category == builtin_category::select ? 2 : arguments.size()};
+    if(info.category != builtin_category::boolean_reduce) {
+      std::optional<scalar_type> concrete;
+      bool any_float{false};
+      for(size_t i{0}; i != numeric_arguments; ++i) {
+        auto const scalar{arguments[i]->result_type->scalar};
+        if(!is_abstract(arguments[i])) concrete = concrete.value_or(scalar);
+        any_float = any_float || scalar == scalar_type::abstract_float;
+      }
+      bool const float_only{info.category != builtin_category::numeric_component_wise && info.category != builtin_category::numeric_reduce && info.category != builtin_category::select};
+      auto const scalar{concrete.value_or(float_only || any_float ? scalar_type::f32 : scalar_type::i32)};
+      for(size_t i{0}; i != numeric_arguments; ++i) {
+        arguments[i] = concretise(arguments[i], scalar, location);
+        if(arguments[i]->result_type->scalar != scalar) fail(location, "mismatched argument types to " + std::string{info.name});
+      }
+      if(float_only && scalar != scalar_type::f32) fail(location, std::string{info.name} + " needs f32 arguments");
+      if(info.category != builtin_category::select && scalar == scalar_type::boolean) fail(location, std::string{info.name} + " needs numeric arguments");
+    }
+
+    unsigned int width{1};
+    for(auto const *argument : arguments) {
+      auto const *argument_type{argument->result_type};
+      if(info.category == builtin_category::transpose) {
+        if(argument_type->kind != type::kinds::matrix) fail(location, "transpose needs a matrix");
+      } else if(argument_type->kind != type::kinds::scalar && argument_type->kind != type::kinds::vector) {
+        fail(location, std::string{info.name} + " needs scalar or vector arguments");
+      }
+      width = std::max(width, argument_type->get_component_count());
+    }
+    for(auto const *argument : arguments) {
+      auto const components{argument->result_type->get_component_count()};
+      if(components != 1 && components != width) fail(location, "mismatched argument sizes to " + std::string{info.name});
+    }
+
+    auto const scalar{arguments.front()->result_type->scalar};
+    type const *result_type{nullptr};
+    switch(info.category) {
+    case builtin_category::float_component_wise:
+    case builtin_category::numeric_component_wise:
+    case builtin_category::select:
+      result_type = width == 1 ? target.types.get_scalar(scalar) : target.types.get_vector(scalar, width);
+      if(info.function == builtin_function::sign && scalar == scalar_type::u32) fail(location, "sign needs a signed argument");
+      if(info.category == builtin_category::select && arguments[2]->result_type->scalar != scalar_type::boolean) fail(location, "select needs a bool condition");
+      break;
+    case builtin_category::float_reduce:
+    case builtin_category::numeric_reduce:
+      result_type = target.types.get_scalar(scalar);
+      break;
+    case builtin_category::float_vector:
+      if(info.function == builtin_function::cross && width != 3) fail(location, "cross needs vec3 arguments");
+      result_type = target.types.get_vector(scalar, width);
+      break;
+    case builtin_category::boolean_reduce:
+      if(scalar != scalar_type::boolean) fail(location, std::string{info.name} + " needs a bool argument");
+      result_type = target.types.get_scalar(scalar_type::boolean);
+      break;
+    case builtin_category::transpose: {
+      auto const *matrix_type{arguments.front()->result_type};
+      result_type = target.types.get_matrix(scalar, matrix_type->rows, matrix_type->columns);
+      break;
+    }
+    }
+
+    auto *result{add_node(node::opcodes::builtin, result_type)};
+    for(auto const *argument : arguments) {
+      result->broadcast.push_back(argument->result_type->get_component_count() == 1 && width != 1);
+    }
+    result->operands = std::move(arguments);
+    result->operand_scalar = scalar;
+    result->builtin = info.function;
+    result->shape = {width, 0, 0};
+    return result;
+  }
+
+  node const *compile_constructor(ast::type_name const &callee, std::vector<node const*> &&arguments, ast::location const &location) {
+    /// Construct a value of a type from its components, or convert a value to another type
+    type const *result_type{nullptr};
+    if(callee.template_arguments.empty() && (callee.name == "vec2" || callee.name == "vec3" || callee.name == "vec4" || callee.name == "array")) {
+      if(arguments.empty()) fail(location, "cannot infer the type of " + std::string{callee.name} + "()");
+      std::optional<scalar_type> concrete;
+      bool any_float{false};
+      for(auto const *argument : arguments) {                                   // infer the component type from the arguments
+        if(!is_abstract(argument)) concrete = concrete.value_or(argument->result_type->scalar);
+        any_float = any_float || argument->result_type->scalar == scalar_type::abstract_float;
+      }
+      auto const scalar{concrete.value_or(any_float ? scalar_type::f32 : scalar_type::i32)};
+      if(callee.name == "array") {
+        auto const *first{concretise(arguments.front(), scalar, location)};
+        result_type = target.types.get_array(first->result_type, static_cast<unsigned int>(arguments.size()));
+      } else {
+        result_type = target.types.get_vector(scalar, static_cast<unsigned int>(callee.name[3] - '0'));
+      }
+    } else {
+      result_type = resolve_type(callee);
+    }
+
+    if(arguments.empty()) return make_zero(result_type);
+
+    switch(result_type->kind) {
+    case type::kinds::none:
+      break;
+
+    case type::kinds::scalar:
+      if(arguments.size() != 1 || arguments.front()->result_type->kind != type::kinds::scalar) fail(location, result_type->get_name() + " takes one scalar argument");
+      return convert_scalar(arguments.front(), result_type->scalar, location);
+
+    case type::kinds::vector:
+    case type::kinds::matrix: {
+      auto const components{result_type->get_component_count()};
+      if(arguments.size() == 1) {
+        auto const *argument_type{arguments.front()->result_type};
+        if(argument_type->kind == result_type->kind && argument_type->get_component_count() == components) { // conversion
+          return convert_scalar(arguments.front(), result_type->scalar, location);
+        }
+        if(argument_type->kind == type::kinds::scalar && result_type->kind == type::kinds::vector) { // splat
+          auto const *converted{convert_scalar(arguments.front(), result_type->scalar, location)};
+          return make_gather(result_type, {converted}, std::vector<uint32_t>(components, converted->slot));
+        }
+      }
+      std::vector<node const*> operands;
+      std::vector<uint32_t> sources;
+      for(auto const *argument : arguments) {
+        auto const *argument_type{argument->result_type};
+        if(argument_type->kind != type::kinds::scalar && argument_type->kind != type::kinds::vector) fail(location, "cannot construct " + result_type->get_name() + " from " + argument_type->get_name());
+        auto const *converted{convert_scalar(argument, result_type->scalar, location)};
+        for(unsigned int i{0}; i != converted->result_type->get_component_count(); ++i) {
+          sources.emplace_back(converted->slot + i);
+        }
+        operands.emplace_back(converted);
+      }
+      if(sources.size() != components) fail(location, "wrong number of components to construct " + result_type->get_name());
+      return make_gather(result_type, std::move(operands), std::move(sources));
+    }
+
+    case type::kinds::array:
+    case type::kinds::structure: {
+      std::vector<type const*> element_types;
+      if(result_type->kind == type::kinds::array) {
+        element_types.assign(result_type->columns, result_type->element);
+      } else {
+        for(auto const &member : result_type->members->members) {
+          element_types.emplace_back(member.member_type);
+        }
+      }
+      if(arguments.size() != element_types.size()) fail(location, "wrong number of arguments to construct " + result_type->get_name());
+      std::vector<node const*> operands;
+      std::vector<uint32_t> sources;
+      for(size_t i{0}; i != arguments.size(); ++i) {
+        auto const *converted{coerce(arguments[i], element_types[i], location)};
+        for(unsigned int component{0}; component != element_types[i]->get_component_count(); ++component) {
+          sources.emplace_back(converted->slot + component);
+        }
+        operands.emplace_back(converted);
+      }
+      return make_gather(result_type, std::move(operands), std::move(sources));
+    }
+    }
+    fail(location, "cannot construct " + result_type->get_name());
+  }
+
+  node const *compile_call(ast::expression const &expression) {
+    /// Call a user function or builtin, or construct a type
+    std::vector<node const*> arguments;
+    for(auto const &operand : expression.operands) {
+      arguments.emplace_back(compile_expression(operand));
+    }
+    auto const name{expression.callee.name};
+
+    if(name == "bitcast") {
+      if(expression.callee.template_arguments.size() != 1 || arguments.size() != 1) fail(expression.location, "bitcast takes one type and one argument");
+      auto const *result_type{resolve_type(expression.callee.template_arguments.front())};
+      auto const *argument{concretise(arguments.front(), expression.location)};
+      if(result_type->get_component_count() != argument->result_type->get_component_count()) fail(expression.location, "bitcast between types of different sizes");
+      auto *result{add_node(node::opcodes::bitcast, result_type)};
+      result->operands.emplace_back(argument);
+      return result;
+    }
+
+    if(function_declarations.contains(name)) {
+      auto const *callee{get_function(name, expression.location)};
+      if(arguments.size() != callee->parameter_types.size()) fail(expression.location, "wrong number of arguments to " + std::string{name});
+      for(size_t i{0}; i != arguments.size(); ++i) {
+        arguments[i] = coerce(arguments[i], callee->parameter_types[i], expression.location);
+      }
+      auto *result{add_node(node::opcodes::call, callee->return_type)};
+      result->operands = std::move(arguments);
+      result->callee = callee;
+      return result;
+    }
+
+    if(auto const builtin{std::ranges::find(builtins, name, &builtin_info::name)}; builtin != builtins.end()) {
+      return compile_builtin(*builtin, std::move(arguments), expression.location);
+    }
+
+    if(is_type_name(name)) return compile_constructor(expression.callee, std::move(arguments), expression.location);
+    fail(expression.location, "unknown function \"" + std::string{name} + "\"");
+  }
+
+  node const *compile_expression(ast::expression const &expression) {
+    switch(expression.kind) {
+    case ast::expression::kinds::literal:
+      return compile_literal(expression);
+    case ast::expression::kinds::identifier:
+      return lookup(expression.text, expression.location).value;
+    case ast::expression::kinds::call:
+      return compile_call(expression);
+    case ast::expression::kinds::member:
+      return compile_member(expression);
+    case ast::expression::kinds::index:
+      return compile_index(expression);
+    case ast::expression::kinds::unary: {
+      auto const *operand{compile_expression(expression.operands.front())};
+      auto const op{expression.text == "-" ? unary_operator::negate : expression.text == "!" ? unary_operator::logical_not : unary_operator::bitwise_not};
+      return compile_unary(op, operand, expression.location);
+    }
+    case ast::expression::kinds::binary: {
+      auto const *lhs{compile_expression(expression.operands[0])};
+      auto const *rhs{compile_expression(expression.operands[1])};
+      auto const op{std::ranges::find(binary_operators, expression.text, &binary_operator_info::symbol)};
+      if(op == binary_operators.end()) fail(expression.location, "unknown operator \"" + std::string{expression.text} + "\"");
+      if((expression.text == "&&" || expression.text == "||")
+      && (lhs->result_type->scalar != scalar_type::boolean || rhs->result_type->scalar != scalar_type::boolean || lhs->result_type->kind != type::kinds::scalar)) {
+        fail(expression.location, expression.text == "&&" ? "&& needs bool operands" : "|| needs bool operands");
+      }
+      return compile_binary(op->op, lhs, rhs, expression.location);
+    }
+    }
+    fail(expression.location, "invalid expression");
+  }
+
+  reference compile_reference(ast::expression const &expression) {
+    /// Find the registers an assignment writes to
+    switch(expression.kind) {
+    case ast::expression::kinds::identifier: {
+      auto const &found{lookup(expression.text, expression.location)};
+      if(!found.is_mutable) fail(expression.location, "cannot assign to \"" + std::string{expression.text} + "\"");
+      reference result{
+        .target{.slot{found.value->slot}, .components{}},
+        .reference_type{found.value->result_type},
+      };
+      for(uint32_t i{0}; i != result.reference_type->get_component_count(); ++i) {
+        result.target.components.emplace_back(i);
+      }
+      return result;
+    }
+
+    case ast::expression::kinds::member: {
+      auto result{compile_reference(expression.operands.front())};
+      auto const *object_type{result.reference_type};
+      std::vector<uint32_t> selected;
+      if(object_type->kind == type::kinds::structure) {
+        auto const *member{object_type->members->find_member(expression.text)};
+        if(!member) fail(expression.location, "no member \"" + std::string{expression.text} + "\" in " + object_type->get_name());
+        for(uint32_t i{0}; i != member->member_type->get_component_count(); ++i) {
+          selected.emplace_back(member->component_offset + i);
+        }
+        result.reference_type = member->member_type;
+      } else if(object_type->kind == type::kinds::vector) {
+        selected = get_swizzle(expression.text, object_type->rows, expression.location);
+        result.reference_type = selected.size() == 1 ? target.types.get_scalar(object_type->scalar) : target.types.get_vector(object_type->scalar, static_cast<unsigned int>(selected.size()));
+      } else {
+        fail(expression.location, "cannot access member \"" + std::string{expression.text} + "\" of " + object_type->get_name());
+      }
+      std::vector<uint32_t> components;
+      for(auto const component : selected) {
+        components.emplace_back(result.target.components[component]);
+      }
+      result.target.components = std::move(components);
+      return result;
+    }
+
+    case ast::expression::kinds::index: {
+      auto result{compile_reference(expression.operands[0])};
+      auto const [element_type, element_count]{get_element_type(result.reference_type, expression.location)};
+      auto const element_components{element_type->get_component_count()};
+      auto const *index{compile_expression(expression.operands[1])};
+      result.reference_type = element_type;
+
+      if(auto const constant_index{get_constant_index(index)}) {
+        if(*constant_index < 0 || *constant_index >= element_count) fail(expression.location, "index out of bounds");
+        auto const first{result.target.components.begin() + static_cast<ptrdiff_t>(*constant_index * element_components)};
+        result.target.components = std::vector<uint32_t>(first, first + element_components);
+        return result;
+      }
+
+      if(result.target.index) fail(expression.location, "only one dynamic index is supported in an assignment");
+      if(!is_integer(index->result_type->scalar) || index->result_type->kind != type::kinds::scalar) fail(expression.location, "index must be an integer scalar");
+      for(size_t i{1}; i != result.target.components.size(); ++i) {
+        if(result.target.components[i] != result.target.components[0] + i) fail(expression.location, "dynamic index into a swizzle is not supported");
+      }
+      result.target.slot += result.target.components.front();
+      result.target.index = index;
+      result.target.element_components = element_components;
+      result.target.element_count = element_count;
+      result.target.components.clear();
+      for(uint32_t i{0}; i != element_components; ++i) {
+        result.target.components.emplace_back(i);
+      }
+      return result;
+    }
+
+    case ast::expression::kinds::literal:
+    case ast::expression::kinds::call:
+    case ast::expression::kinds::unary:
+    case ast::expression::kinds::binary:
+      break;
+    }
+    fail(expression.location, "cannot assign to this expression");
+  }
+
+  node const *compile_condition(ast::expression const &expression) {
+    auto const *condition{compile_expression(expression)};
+    if(condition->result_type != target.types.get_scalar(scalar_type::boolean)) fail(expression.location, "condition must be a bool");
+    return condition;
+  }
+
+  // statements
+
+  statement make_store(destination const &target_destination, node const *value) {
+    return statement{
+      .kind{statement::kinds::store},
+      .value{value},
+      .target{target_destination},
+      .children{},
+    };
+  }
+
+  static destination whole(uint32_t slot, unsigned int components) {
+    /// A destination covering every component of a value
+    destination result{.slot{slot}, .components{}};
+    for(uint32_t i{0}; i != components; ++i) {
+      result.components.emplace_back(i);
+    }
+    return result;
+  }
+
+  statement make_break_unless(node const *condition) {
+    /// if(!condition) { break; }
+    statement result{
+      .kind{statement::kinds::if_else},
+      .value{condition},
+      .target{},
+      .children{},
+    };
+    result.children.emplace_back(statement{.kind{statement::kinds::block}, .target{}, .children{}});
+    result.children.emplace_back(statement{.kind{statement::kinds::break_statement}, .target{}, .children{}});
+    return result;
+  }
+
+  void declare(std::string_view name, symbol &&new_symbol, ast::location const &location) {
+    if(!scopes.back().emplace(name, new_symbol).second) fail(location, "\"" + std::string{name} + "\" is already declared in this scope");
+  }
+
+  statement compile_variable(ast::statement const &source) {
+    /// Declare a function scope var, let or const
+    type const *declared_type{source.type ? resolve_type(*source.type) : nullptr};
+    node const *value{nullptr};
+    if(!source.expressions.empty()) {
+      value = compile_expression(source.expressions.front());
+      if(declared_type) value = coerce(value, declared_type, source.location);
+    }
+
+    if(source.declaration == "var") {
+      if(!value && !declared_type) fail(source.location, "var needs a type or an initialiser");
+      if(value && is_abstract(value)) value = concretise(value, source.location);
+      auto const *variable_type{declared_type ? declared_type : value->result_type};
+      auto const slot{allocate(variable_type->get_component_count())};
+      declare(source.name, {.value{make_alias(variable_type, slot, false)}, .is_mutable{true}}, source.location);
+      return make_store(whole(slot, variable_type->get_component_count()), value ? value : make_zero(variable_type)); // variables without initialisers start at zero
+    }
+
+    if(!value) fail(source.location, std::string{source.declaration} + " needs an initialiser");
+    if(is_abstract(value) && source.declaration == "const") {                   // abstract constants stay abstract
+      declare(source.name, {.value{value}}, source.location);
+      return {.kind{statement::kinds::block}, .target{}, .children{}};
+    }
+    value = concretise(value, source.location);
+    if(value->constant) {
+      declare(source.name, {.value{value}}, source.location);
+      return {.kind{statement::kinds::block}, .target{}, .children{}};
+    }
+    if(value->opcode == node::opcodes::none || value->opcode == node::opcodes::view) { // a copy, so later changes to what it refers to don't show through
+      auto const slot{allocate(value->result_type->get_component_count())};
+      declare(source.name, {.value{make_alias(value->result_type, slot, false)}}, source.location);
+      return make_store(whole(slot, value->result_type->get_component_count()), value);
+    }
+    declare(source.name, {.value{make_alias(value->result_type, value->slot, false)}}, source.location); // refer to the registers the value is computed into
+    return {
+      .kind{statement::kinds::evaluate},
+      .value{value},
+      .target{},
+      .children{},
+    };
+  }
+
+  statement compile_assignment(ast::statement const &source) {
+    auto const &lhs{source.expressions[0]};
+    auto const &rhs{source.expressions[1]};
+    if(source.text == "=" && lhs.kind == ast::expression::kinds::identifier && lhs.text == "_") { // phony assignment
+      return {
+        .kind{statement::kinds::evaluate},
+        .value{concretise(compile_expression(rhs), source.location)},
+        .target{},
+        .children{},
+      };
+    }
+    auto const destination_reference{compile_reference(lhs)};
+    auto const *value{compile_expression(rhs)};
+    if(source.text != "=") {
+      auto const op_text{source.text.substr(0, source.text.size() - 1)};
+      auto const op{std::ranges::find(binary_operators, op_text, &binary_operator_info::symbol)};
+      if(op == binary_operators.end()) fail(source.location, "unknown operator \"" + std::string{source.text} + "\"");
+      value = compile_binary(op->op, compile_expression(lhs), value, source.location);
+    }
+    return make_store(destination_reference.target, coerce(value, destination_reference.reference_type, source.location));
+  }
+
+  statement compile_increment(ast::statement const &source) {
+    auto const destination_reference{compile_reference(source.expressions.front())};
+    auto const *target_type{destination_reference.reference_type};
+    if(target_type->kind != type::kinds::scalar || !is_integer(target_type->scalar)) fail(source.location, "can only increment or decrement integer scalars");
+    auto const op{source.kind == ast::statement::kinds::increment ? binary_operator::add : binary_operator::subtract};
+    auto const *value{compile_binary(op, compile_expression(source.expressions.front()), make_constant(target_type->scalar, 1.0), source.location)};
+    return make_store(destination_reference.target, value);
+  }
+
+  statement compile_loop(ast::statement const &body, ast::statement const *continuing, node const *condition) {
+    /// Build a loop, which breaks at the top of the body if a condition is given and false
+    /// The continuing statement is in the scope of the body, so it can refer to its declarations
+    statement result{.kind{statement::kinds::loop}, .target{}, .children{}};
+    scopes.emplace_back();
+    statement compiled_body{.kind{statement::kinds::block}, .target{}, .children{}};
+    if(condition) compiled_body.children.emplace_back(make_break_unless(condition));
+    for(auto const &child : body.children) {
+      compiled_body.children.emplace_back(compile_statement(child));
+    }
+    result.children.emplace_back(std::move(compiled_body));
+    result.children.emplace_back(continuing ? compile_statement(*continuing) : statement{.kind{statement::kinds::block}, .target{}, .children{}});
+    scopes.pop_back();
+    return result;
+  }
+
+  statement compile_block(ast::statement const &source) {
+    statement result{.kind{statement::kinds::block}, .target{}, .children{}};
+    scopes.emplace_back();
+    for(auto const &child : source.children) {
+      result.children.emplace_back(compile_statement(child));
+    }
+    scopes.pop_back();
+    return result;
+  }
+
+  statement compile_statement(ast::statement const &source) {
+    switch(source.kind) {
+    case ast::statement::kinds::empty:
+      return {.kind{statement::kinds::block}, .target{}, .children{}};
+
+    case ast::statement::kinds::block:
+      return compile_block(source);
+
+    case ast::statement::kinds::variable:
+      return compile_variable(source);
+
+    case ast::statement::kinds::assignment:
+      return compile_assignment(source);
+
+    case ast::statement::kinds::increment:
+    case ast::statement::kinds::decrement:
+      return compile_increment(source);
+
+    case ast::statement::kinds::call:
+      return {
+        .kind{statement::kinds::evaluate},
+        .value{compile_expression(source.expressions.front())},
+        .target{},
+        .children{},
+      };
+
+    case ast::statement::kinds::if_else: {
+      statement result{
+        .kind{statement::kinds::if_else},
+        .value{compile_condition(source.expressions.front())},
+        .target{},
+        .children{},
+      };
+      for(auto const &child : source.children) {
+        result.children.emplace_back(compile_statement(child));
+      }
+      return result;
+    }
+
+    case ast::statement::kinds::for_loop: {
+      statement result{.kind{statement::kinds::block}, .target{}, .children{}};
+      scopes.emplace_back();                                                    // for the initialiser's declaration
+      result.children.emplace_back(compile_statement(source.children[0]));
+      auto const *condition{source.expressions.empty() ? nullptr : compile_condition(source.expressions.front())};
+      result.children.emplace_back(compile_loop(source.children[2], &source.children[1], condition));
+      scopes.pop_back();
+      return result;
+    }
+
+    case ast::statement::kinds::while_loop:
+      return compile_loop(source.children.front(), nullptr, compile_condition(source.expressions.front()));
+
+    case ast::statement::kinds::loop:
+      return compile_loop(source.children[0], source.children.size() > 1 ? &source.children[1] : nullptr, nullptr);
+
+    case ast::statement::kinds::break_statement:
+      return {.kind{statement::kinds::break_statement}, .target{}, .children{}};
+
+    case ast::statement::kinds::break_if:
+      return {
+        .kind{statement::kinds::break_if},
+        .value{compile_condition(source.expressions.front())},
+        .target{},
+        .children{},
+      };
+
+    case ast::statement::kinds::continue_statement:
+      return {.kind{statement::kinds::continue_statement}, .target{}, .children{}};
+
+    case ast::statement::kinds::return_statement: {
+      if(!current_function) fail(source.location, "return outside a function");
+      statement result{.kind{statement::kinds::return_statement}, .target{}, .children{}};
+      auto const *return_type{current_function->return_type};
+      if(source.expressions.empty() != (return_type->kind == type::kinds::none)) fail(source.location, "wrong return value for " + current_function->name);
+      if(!source.expressions.empty()) {
+        result.value = coerce(compile_expression(source.expressions.front()), return_type, source.location);
+        result.target = whole(current_function->return_slot, return_type->get_component_count());
+      }
+      return result;
+    }
+
+    case ast::statement::kinds::discard:
+      return {.kind{statement::kinds::discard}, .target{}, .children{}};
+    }
+    fail(source.location, "invalid statement");
+  }
+
+  // module scope declarations
+
+  symbol const &get_global(std::string_view name, ast::location const &location) {
+    /// Compile a module scope variable, constant or override on first use
+    if(auto const it{globals.find(name)}; it != globals.end()) return it->second;
+    auto const declaration_it{variable_declarations.find(name)};
+    if(declaration_it == variable_declarations.end()) fail(location, "unknown identifier \"" + std::string{name} + "\"");
+    auto const &declaration{*declaration_it->second};
+    if(declarations_in_progress.contains(name)) fail(location, "\"" + std::string{name} + "\" refers to itself");
+    declarations_in_progress.emplace(name);
+
+    auto saved_scopes{std::exchange(scopes, {})};                               // module scope declarations can't see function scopes
+    auto *saved_function{std::exchange(current_function, nullptr)};
+
+    type const *declared_type{declaration.type ? resolve_type(*declaration.type) : nullptr};
+    node const *value{declaration.initialiser ? compile_expression(*declaration.initialiser) : nullptr};
+    if(value && declared_type) value = coerce(value, declared_type, declaration.location);
+    symbol result;
+
+    if(declaration.declaration == "const") {
+      if(!value) fail(declaration.location, "const needs an initialiser");
+      if(is_abstract(value) || value->constant) {
+        result.value = value;
+      } else {                                                                  // computed before each entry point runs
+        target.global_initialisers.emplace_back(statement{
+          .kind{statement::kinds::evaluate},
+          .value{value},
+          .target{},
+          .children{},
+        });
+        result.value = make_alias(value->result_type, value->slot, false);
+      }
+
+    } else if(declaration.declaration == "override") {
+      if(value) value = concretise(value, declaration.location);
+      if(value && !value->constant) fail(declaration.location, "override initialisers must be constant");
+      auto const *override_type{declared_type ? declared_type : value ? value->result_type : nullptr};
+      if(!override_type || override_type->kind != type::kinds::scalar) fail(declaration.location, "override needs a scalar type");
+      auto const slot{allocate(1)};
+      if(value) target.initial_registers[slot] = target.initial_registers[value->slot];
+      target.overrides.emplace_back(program::override_constant{
+        .name{std::string{name}},
+        .constant_type{override_type},
+        .slot{slot},
+      });
+      result.value = make_alias(override_type, slot, false);
+
+    } else if(declaration.address_space == "uniform") {
+      if(!declared_type) fail(declaration.location, "uniform variables need a type");
+      auto const *group{ast::find_attribute(declaration.attributes, "group")};
+      auto const *binding{ast::find_attribute(declaration.attributes, "binding")};
+      if(!group || !binding || group->arguments.empty() || binding->arguments.empty()) fail(declaration.location, "uniform variables need @group and @binding");
+      auto const slot{allocate(declared_type->get_component_count())};
+      target.uniforms.emplace_back(program::uniform_binding{
+        .group{static_cast<unsigned int>(std::stoul(std::string{group->arguments.front()}))},
+        .binding{static_cast<unsigned int>(std::stoul(std::string{binding->arguments.front()}))},
+        .binding_type{declared_type},
+        .slot{slot},
+      });
+      result.value = make_alias(declared_type, slot, false);
+
+    } else if(declaration.address_space.empty() || declaration.address_space == "private") {
+      if(value && is_abstract(value)) value = concretise(value, declaration.location);
+      auto const *variable_type{declared_type ? declared_type : value ? value->result_type : nullptr};
+      if(!variable_type) fail(declaration.location, "var needs a type or an initialiser");
+      auto const slot{allocate(variable_type->get_component_count())};
+      target.global_initialisers.emplace_back(make_store(whole(slot, variable_type->get_component_count()), value ? value : make_zero(variable_type))); // reset before each entry point runs
+      result = {.value{make_alias(variable_type, slot, false)}, .is_mutable{true}};
+
+    } else {
+      fail(declaration.location, "address space \"" + std::string{declaration.address_space} + "\" is not supported");
+    }
+
+    scopes = std::move(saved_scopes);
+    current_function = saved_function;
+    declarations_in_progress.erase(name);
+    return globals.emplace(name, result).first->second;
+  }
+
+  function const *get_function(std::string_view name, ast::location const &location) {
+    /// Compile a function on first use
+    if(auto const it{compiled_functions.find(name)}; it != compiled_functions.end()) return it->second;
+    auto const declaration_it{function_declarations.find(name)};
+    if(declaration_it == function_declarations.end()) fail(location, "unknown function \"" + std::string{name} + "\"");
+    auto const &declaration{*declaration_it->second};
+    if(declarations_in_progress.contains(name)) fail(location, "recursion is not allowed: \"" + std::string{name} + "\"");
+    declarations_in_progress.emplace(name);
+
+    auto saved_scopes{std::exchange(scopes, {})};
+    auto *saved_function{current_function};
+
+    auto &compiled{target.functions.emplace_back(function{.name{std::string{name}}, .parameter_slots{}, .parameter_types{}, .body{}})};
+    compiled.return_type = declaration.return_type ? resolve_type(*declaration.return_type) : target.types.get_none();
+    compiled.return_slot = allocate(compiled.return_type->get_component_count());
+    scopes.emplace_back();
+    for(auto const &parameter : declaration.parameters) {
+      auto const *parameter_type{resolve_type(parameter.type)};
+      auto const slot{allocate(parameter_type->get_component_count())};
+      compiled.parameter_slots.emplace_back(slot);
+      compiled.parameter_types.emplace_back(parameter_type);
+      declare(parameter.name, {.value{make_alias(parameter_type, slot, false)}}, declaration.location);
+    }
+    current_function = &compiled;
+    compiled.body = compile_block(declaration.body);
+
+    scopes = std::move(saved_scopes);
+    current_function = saved_function;
+    declarations_in_progress.erase(name);
+    compiled_functions.emplace(name, &compiled);
+    return &compiled;
+  }
+
+  void add_interface(std::vector<interface_variable> &interface, std::span<ast::attribute const> attributes, type const *variable_type, uint32_t slot, ast::location const &location) {
+    /// Add an entry point input or output, or the members of a structure of them
+    if(variable_type->kind == type::kinds::structure) {
+      for(auto const &member : variable_type->members->members) {
+        if(!member.location && member.builtin.empty()) fail(location, "entry point structure member \"" + member.name + "\" needs @location or @builtin");
+        interface.emplace_back(interface_variable{
+          .builtin{member.builtin},
+          .location{member.location},
+          .variable_type{member.member_type},
+          .slot{slot + member.component_offset},
+        });
+      }
+      return;
+    }
+    interface_variable variable{
+      .builtin{},
+      .location{},
+      .variable_type{variable_type},
+      .slot{slot},
+    };
+    if(auto const *location_attribute{ast::find_attribute(attributes, "location")}; location_attribute && !location_attribute->arguments.empty()) {
+      variable.location = static_cast<unsigned int>(std::stoul(std::string{location_attribute->arguments.front()}));
+    } else if(auto const *builtin_attribute{ast::find_attribute(attributes, "builtin")}; builtin_attribute && !builtin_attribute->arguments.empty()) {
+      variable.builtin = builtin_attribute->arguments.front();
+    } else {
+      fail(location, "entry point inputs and outputs need @location or @builtin");
+    }
+    interface.emplace_back(std::move(variable));
+  }
+
+public:
+  compiler(program &this_target, ast::module const &this_syntax)
+    : target{this_target},
+      syntax{this_syntax} {
+  }
+
+  void run() {
+    /// Compile every function, and describe the interfaces of the entry points
+    for(auto const &declaration : syntax.aliases) {
+      alias_declarations.emplace(declaration.name, &declaration);
+    }
+    for(auto const &declaration : syntax.structs) {
+      struct_declarations.emplace(declaration.name, &declaration);
+    }
+    for(auto const &declaration : syntax.variables) {
+      variable_declarations.emplace(declaration.name, &declaration);
+    }
+    for(auto const &declaration : syntax.functions) {
+      function_declarations.emplace(declaration.name, &declaration);
+    }
+
+    for(auto const &declaration : syntax.functions) {
+      if(ast::find_attribute(declaration.attributes, "compute")) continue;      // only rasterisation is interpreted, so compute entry points and the storage textures they write are left uncompiled
+      auto const *compiled{get_function(declaration.name, declaration.location)};
+      std::optional<entry_point::stages> stage;
+      if(ast::find_attribute(declaration.attributes, "vertex"))   stage = entry_point::stages::vertex;
+      if(ast::find_attribute(declaration.attributes, "fragment")) stage = entry_point::stages::fragment;
+      if(!stage) continue;
+
+      entry_point entry{
+        .name{std::string{declaration.name}},
+        .stage{*stage},
+        .body{compiled},
+        .inputs{},
+        .outputs{},
+      };
+      for(size_t i{0}; i != declaration.parameters.size(); ++i) {
+        add_interface(entry.inputs, declaration.parameters[i].attributes, compiled->parameter_types[i], compiled->parameter_slots[i], declaration.location);
+      }
+      if(compiled->return_type->kind != type::kinds::none) {
+        add_interface(entry.outputs, declaration.return_attributes, compiled->return_type, compiled->return_slot, declaration.location);
+      }
+      target.entry_points.emplace_back(std::move(entry));
+    }
+  }
+};
+
+interface_variable const *entry_point::find_input_builtin(std::string_view builtin) const {
+  auto const it{std::ranges::find(inputs, builtin, &interface_variable::builtin)};
+  return it == inputs.end() ? nullptr : &*it;
+}
+
+interface_variable const *entry_point::find_output_builtin(std::string_view builtin) const {
+  auto const it{std::ranges::find(outputs, builtin, &interface_variable::builtin)};
+  return it == outputs.end() ? nullptr : &*it;
+}
+
+interface_variable const *entry_point::find_output_location(unsigned int location) const {
+  auto const it{std::ranges::find(outputs, std::optional{location}, &interface_variable::location)};
+  return it == outputs.end() ? nullptr : &*it;
+}
+
+program::program(std::string_view this_source)
+  : source{this_source} {
+  /// Parse and compile WGSL source, throwing std::runtime_error describing the first problem found
+  auto const syntax{parse(source)};
+  compiler{*this, syntax}.run();
+}
+
+std::span<entry_point const> program::get_entry_points() const {
+  return entry_points;
+}
+
+entry_point const &program::get_entry_point(std::string_view name) const {
+  auto const it{std::ranges::find(entry_points, name, &entry_point::name)};
+  if(it == entry_points.end()) throw std::runtime_error{"WGSL: no entry point \"" + std::string{name} + "\""};
+  return *it;
+}
+
+void program::set_uniform(unsigned int group, unsigned int binding, std::span<std::byte const> data) {
+  /// Provide the contents of a uniform buffer, laid out as it would be for the GPU
+  auto const it{std::ranges::find_if(uniforms, [&](uniform_binding const &uniform){return uniform.group == group && uniform.binding == binding;})};
+  if(it == uniforms.end()) return;                                              // not used by this program
+  decode_host_shareable(*it->binding_type, data, std::span{initial_registers}.subspan(it->slot, it->binding_type->get_component_count()));
+}
+
+void program::set_override(std::string_view name, double value) {
+  /// Set the value of an override constant, as a pipeline would
+  auto const it{std::ranges::find(overrides, name, &override_constant::name)};
+  if(it == overrides.end()) throw std::runtime_error{"WGSL: no override \"" + std::string{name} + "\""};
+  initial_registers[it->slot] = scalar_bits(it->constant_type->scalar, value);
+}
+
+std::span<statement const> program::get_global_initialisers() const {
+  return global_initialisers;
+}
+
+std::span<uint32_t const> program::get_initial_registers() const {
+  return initial_registers;
+}
+
+size_t program::get_register_count() const {
+  return initial_registers.size();
+}
+
+}
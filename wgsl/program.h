@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "types.h"
+
+namespace wgsl {
+
+inline constexpr unsigned int lane_count{8};                                    // invocations executed together, one per SIMD lane
+using lane_bits = std::array<uint32_t, lane_count>;                             // one 32-bit component for every lane
+
+enum class unary_operator {
+  negate,
+  logical_not,
+  bitwise_not,
+};
+
+enum class binary_operator {
+  add,
+  subtract,
+  multiply,
+  divide,
+  modulo,
+  bitwise_and,                                                                  // also logical and on booleans
+  bitwise_or,                                                                   // also logical or on booleans
+  bitwise_xor,
+  shift_left,
+  shift_right,
+  less,
+  less_equal,
+  greater,
+  greater_equal,
+  equal,
+  not_equal,
+};
+
+enum class builtin_function {
+  abs, acos, acosh, asin, asinh, atan, atan2, atanh, ceil, clamp, cos, cosh, cross, degrees, distance, dot, exp, exp2,
+  floor, fma, fract, inverse_sqrt, length, log, log2, max, min, mix, normalize, pow, radians, reflect, round, saturate,
+  select, sign, sin, sinh, smoothstep, sqrt, step, tan, tanh, transpose, trunc, all, any,
+};
+
+struct function;
+
+struct node {                                                                   // one operation in an expression, whose result occupies a fixed range of registers
+  enum class opcodes {
+    none,                                                                       // nothing to do: constants, uniforms and variables are already in place
+    view,                                                                       // evaluate operands[0]; the result is a contiguous part of its registers
+    gather,                                                                     // evaluate the operands, then copy the registers listed in sources
+    dynamic_index,                                                              // select element operands[1] of operands[0] separately for each lane
+    convert,                                                                    // convert each component of operands[0] from operand_scalar to the result's scalar type
+    bitcast,                                                                    // reinterpret the bits of operands[0]
+    unary,
+    binary,                                                                     // component-wise, repeating broadcast operands for each component
+    matrix_multiply,                                                            // shape is the rows of the left operand, the inner dimension and the columns of the right
+    builtin,
+    call,
+  };
+
+  opcodes opcode{opcodes::none};
+  type const *result_type{nullptr};
+  uint32_t slot{0};                                                             // first register of the result
+  std::vector<node const*> operands;
+  std::vector<uint32_t> sources;                                                // registers copied by a gather
+  std::vector<bool> broadcast;                                                  // for each operand, whether its single component applies to every component of the result
+  scalar_type operand_scalar{scalar_type::f32};                                 // component type the operation works on
+  unary_operator unary{unary_operator::negate};
+  binary_operator binary{binary_operator::add};
+  builtin_function builtin{builtin_function::abs};
+  std::array<uint32_t, 3> shape{};                                              // matrix multiply dimensions, or element size and count for a dynamic index
+  function const *callee{nullptr};
+
+  bool constant{false};                                                         // the result never changes
+  std::optional<double> abstract_value;                                         // the value of an abstract literal expression, which has no registers until it gets a concrete type
+};
+
+struct destination {                                                            // the registers written by a store
+  uint32_t slot{0};
+  std::vector<uint32_t> components;                                             // registers relative to slot, or to the indexed element
+  node const *index{nullptr};                                                   // element index chosen separately for each lane, if any
+  uint32_t element_components{0};
+  uint32_t element_count{0};
+};
+
+struct statement {
+  enum class kinds {
+    block,                                                                      // children are executed in order
+    evaluate,                                                                   // evaluate value for its side effects, or so a let can refer to its registers
+    store,                                                                      // evaluate value and write it to target in active lanes
+    if_else,                                                                    // value is the condition, children are the then and optional else statements
+    loop,                                                                       // children are the body and the continuing statement
+    break_statement,
+    break_if,                                                                   // value is the condition
+    continue_statement,
+    return_statement,                                                           // value, if any, is stored to target
+    discard,
+  };
+
+  kinds kind{kinds::block};
+  node const *value{nullptr};
+  destination target;
+  std::vector<statement> children;
+};
+
+struct function {
+  std::string name;
+  type const *return_type{nullptr};
+  uint32_t return_slot{0};
+  std::vector<uint32_t> parameter_slots;
+  std::vector<type const*> parameter_types;
+  statement body;
+};
+
+struct interface_variable {                                                     // an entry point input or output
+  std::string builtin;                                                          // e.g. "position", empty for user-defined locations
+  std::optional<unsigned int> location;
+  type const *variable_type{nullptr};
+  uint32_t slot{0};
+};
+
+struct entry_point {
+  enum class stages {
+    vertex,
+    fragment,
+    compute,
+  };
+
+  std::string name;
+  stages stage{stages::fragment};
+  function const *body{nullptr};
+  std::vector<interface_variable> inputs;
+  std::vector<interface_variable> outputs;
+
+  interface_variable const *find_input_builtin(std::string_view builtin) const;
+  interface_variable const *find_output_builtin(std::string_view builtin) const;
+  interface_variable const *find_output_location(unsigned int location) const;
+};
+
+class program {
+  /// A WGSL module compiled for execution on the CPU, lane_count invocations at a time, independent of the graphics API
+  /// Every value in the program lives at a fixed range of registers, so execution needs no allocation
+  std::string source;                                                           // kept for the lifetime of the program, as the syntax tree refers to it
+  type_table types;
+  std::deque<node> nodes;
+  std::deque<function> functions;
+  std::vector<entry_point> entry_points;
+  std::vector<statement> global_initialisers;                                   // run before each entry point to set up module scope variables
+  std::vector<uint32_t> initial_registers;                                      // every register's value before execution, holding constants, uniforms and overrides
+
+  struct uniform_binding {
+    unsigned int group{0};
+    unsigned int binding{0};
+    type const *binding_type{nullptr};
+    uint32_t slot{0};
+  };
+  std::vector<uniform_binding> uniforms;
+
+  struct override_constant {
+    std::string name;
+    type const *constant_type{nullptr};
+    uint32_t slot{0};
+  };
+  std::vector<override_constant> overrides;
+
+  friend class compiler;
+
+public:
+  explicit program(std::string_view this_source);
+  program(program const&) = delete;
+  program &operator=(program const&) = delete;
+
+  std::span<entry_point const> get_entry_points() const;
+  entry_point const &get_entry_point(std::string_view name) const;
+
+  void set_uniform(unsigned int group, unsigned int binding, std::span<std::byte const> data);
+  void set_override(std::string_view name, double value);
+
+  std::span<statement const> get_global_initialisers() const;
+  std::span<uint32_t const> get_initial_registers() const;
+  size_t get_register_count() const;
+};
+
+}
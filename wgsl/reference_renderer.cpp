@@ -0,0 +1,354 @@
+#include "reference_renderer.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include "invocation.h"
+
+namespace wgsl {
+
+namespace {
+
+struct screen_vertex {
+  float x{0.0f};                                                                // pixels from the left
+  float y{0.0f};                                                                // pixels from the top
+  float z{0.0f};
+  float inverse_w{0.0f};
+  uint32_t index{0};                                                            // which vertex's outputs to interpolate
+};
+
+struct triangle {
+  std::array<screen_vertex, 3> vertices;
+  float inverse_area{0.0f};
+  bool front_facing{true};
+  int min_x{0};
+  int min_y{0};
+  int max_x{0};                                                                 // inclusive
+  int max_y{0};
+};
+
+struct fragment_input {                                                         // where a fragment shader input gets its value from
+  enum class sources {
+    position,
+    front_facing,
+    vertex_output,
+    zero,
+  };
+
+  sources source{sources::zero};
+  uint32_t slot{0};
+  uint32_t components{0};
+  uint32_t vertex_offset{0};                                                    // of the matching vertex output, within a vertex's outputs
+  bool interpolated{false};                                                     // perspective correct, or flat from the first vertex for integers
+};
+
+float edge(screen_vertex const &a, screen_vertex const &b, float x, float y) {
+  /// Twice the signed area of the triangle a, b, p: positive when p is inside a triangle of positive area
+  return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+bool is_top_left(screen_vertex const &a, screen_vertex const &b) {
+  /// Whether pixels exactly on an edge belong to this triangle, so that triangles sharing an edge don't both cover them
+  auto const dx{b.x - a.x};
+  auto const dy{b.y - a.y};
+  return dy < 0.0f || (dy <= 0.0f && dx > 0.0f);
+}
+
+}
+
+reference_renderer::reference_renderer(program const &this_shader_program, unsigned int this_thread_count)
+  : shader_program{this_shader_program},
+    thread_count{this_thread_count != 0 ? this_thread_count : std::max(1u, std::thread::hardware_concurrency())} {
+  /// Set up a renderer for a program, which must outlive it; a thread count of 0 uses every hardware thread
+}
+
+reference_renderer::image reference_renderer::render(draw_call const &draw, unsigned int width, unsigned int height) {
+  /// Render a draw call to a new image cleared to transparent black
+  auto const &vertex_entry{shader_program.get_entry_point(draw.vertex_entry_point)};
+  auto const &fragment_entry{shader_program.get_entry_point(draw.fragment_entry_point)};
+  auto const *position_output{vertex_entry.find_output_builtin("position")};
+  if(!position_output) throw std::runtime_error{"WGSL: vertex entry point " + vertex_entry.name + " has no @builtin(position) output"};
+  auto const *colour_output{fragment_entry.find_output_location(0)};
+  if(!colour_output) throw std::runtime_error{"WGSL: fragment entry point " + fragment_entry.name + " has no @location(0) output"};
+
+  // vertex stage: shade every vertex referenced, lane_count at a time, keeping all of their outputs
+  std::vector<uint32_t> output_offsets;
+  uint32_t output_stride{0};
+  for(auto const &output : vertex_entry.outputs) {
+    output_offsets.emplace_back(output_stride);
+    output_stride += output.variable_type->get_component_count();
+  }
+  auto const position_offset{output_offsets[static_cast<size_t>(position_output - vertex_entry.outputs.data())]};
+
+  uint32_t vertex_count{0};
+  for(auto const index : draw.indices) {
+    vertex_count = std::max(vertex_count, index + 1);
+  }
+  std::vector<uint32_t> vertex_outputs(static_cast<size_t>(vertex_count) * output_stride);
+
+  invocation vertex_invocation{shader_program};
+  for(uint32_t first{0}; first < vertex_count; first += lane_count) {
+    lane_bits active{};
+    for(unsigned int lane{0}; lane != lane_count; ++lane) {
+      active[lane] = first + lane < vertex_count ? ~0u : 0u;
+    }
+    for(auto const &input : vertex_entry.inputs) {
+      auto const components{input.variable_type->get_component_count()};
+      if(input.builtin == "vertex_index" || input.builtin == "instance_index") {
+        auto &target{vertex_invocation.get_register(input.slot)};
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          target[lane] = input.builtin == "vertex_index" ? first + lane : 0u;
+        }
+        continue;
+      }
+      if(!input.location) continue;
+      if(input.variable_type->scalar != scalar_type::f32) throw std::runtime_error{"WGSL: only float vertex attributes are supported"};
+      auto const attribute{std::ranges::find(draw.attributes, *input.location, &vertex_attribute::location)};
+      if(attribute == draw.attributes.end()) throw std::runtime_error{"WGSL: no vertex attribute for @location(" + std::to_string(*input.location) + ")"};
+      for(uint32_t component{0}; component != components; ++component) {
+        auto &target{vertex_invocation.get_register(input.slot + component)};
+        for(unsigned int lane{0}; lane != lane_count; ++lane) {
+          size_t const value_index{static_cast<size_t>(first + lane) * attribute->components + component};
+          float value{component == 3 ? 1.0f : 0.0f};                            // missing components default as they would on the GPU
+          if(component < attribute->components && value_index < attribute->values.size()) value = attribute->values[value_index];
+          target[lane] = std::bit_cast<uint32_t>(value);
+        }
+      }
+    }
+    vertex_invocation.run(vertex_entry, active);
+    for(size_t output{0}; output != vertex_entry.outputs.size(); ++output) {
+      auto const &variable{vertex_entry.outputs[output]};
+      for(uint32_t component{0}; component != variable.variable_type->get_component_count(); ++component) {
+        auto const &source{vertex_invocation.get_register(variable.slot + component)};
+        for(unsigned int lane{0}; lane != lane_count && first + lane < vertex_count; ++lane) {
+          vertex_outputs[(first + lane) * output_stride + output_offsets[output] + component] = source[lane];
+        }
+      }
+    }
+  }
+  stats.vertex_invocations += vertex_count;
+
+  // triangle setup: project to the screen, and orient every triangle the same way so one inside test works for all
+  std::vector<triangle> triangles;
+  for(size_t i{0}; i + 2 < draw.indices.size(); i += 3) {
+    triangle setup;
+    bool visible{true};
+    for(unsigned int corner{0}; corner != 3; ++corner) {
+      auto const index{draw.indices[i + corner]};
+      auto const position{[&](uint32_t component){
+        return std::bit_cast<float>(vertex_outputs[index * output_stride + position_offset + component]);
+      }};
+      auto const w{position(3)};
+      if(!(w > 0.0f)) {                                                         // no clipping: triangles crossing the eye plane are dropped
+        visible = false;
+        break;
+      }
+      setup.vertices[corner] = {
+        .x{(position(0) / w * 0.5f + 0.5f) * static_cast<float>(width)},
+        .y{(0.5f - position(1) / w * 0.5f) * static_cast<float>(height)},       // clip space y is up, the image's is down
+        .z{position(2) / w},
+        .inverse_w{1.0f / w},
+        .index{index},
+      };
+    }
+    auto area{visible ? edge(setup.vertices[0], setup.vertices[1], setup.vertices[2].x, setup.vertices[2].y) : 0.0f};
+    if(!(std::abs(area) > 0.0f)) {
+      ++stats.culled_triangles;
+      continue;
+    }
+    setup.front_facing = area < 0.0f;                                           // counter-clockwise in clip space, as the default front face
+    if(area < 0.0f) {
+      std::swap(setup.vertices[1], setup.vertices[2]);
+      area = -area;
+    }
+    setup.inverse_area = 1.0f / area;
+    auto const [min_x, max_x]{std::ranges::minmax({setup.vertices[0].x, setup.vertices[1].x, setup.vertices[2].x})};
+    auto const [min_y, max_y]{std::ranges::minmax({setup.vertices[0].y, setup.vertices[1].y, setup.vertices[2].y})};
+    setup.min_x = std::max(0, static_cast<int>(std::floor(min_x)));
+    setup.min_y = std::max(0, static_cast<int>(std::floor(min_y)));
+    setup.max_x = std::min(static_cast<int>(width) - 1, static_cast<int>(std::ceil(max_x)));
+    setup.max_y = std::min(static_cast<int>(height) - 1, static_cast<int>(std::ceil(max_y)));
+    if(setup.min_x > setup.max_x || setup.min_y > setup.max_y) continue;
+    triangles.emplace_back(setup);
+  }
+
+  // match fragment shader inputs to vertex outputs by location
+  std::vector<fragment_input> fragment_inputs;
+  for(auto const &input : fragment_entry.inputs) {
+    fragment_input matched{
+      .slot{input.slot},
+      .components{input.variable_type->get_component_count()},
+    };
+    if(input.builtin == "position") {
+      matched.source = fragment_input::sources::position;
+    } else if(input.builtin == "front_facing") {
+      matched.source = fragment_input::sources::front_facing;
+    } else if(input.location) {
+      for(size_t output{0}; output != vertex_entry.outputs.size(); ++output) {
+        if(vertex_entry.outputs[output].location != input.location) continue;
+        matched.source = fragment_input::sources::vertex_output;
+        matched.vertex_offset = output_offsets[output];
+        matched.interpolated = input.variable_type->scalar == scalar_type::f32;
+      }
+    }
+    fragment_inputs.emplace_back(matched);
+  }
+
+  // fragment stage: threads take tiles in turn, shading the pixels each triangle covers lane_count at a time
+  image result{
+    .width{width},
+    .height{height},
+    .pixels{std::vector<float>(static_cast<size_t>(width) * height * 4, 0.0f)},
+  };
+  uint32_t const tiles_x{(width + tile_size - 1) / tile_size};
+  uint32_t const tiles_y{(height + tile_size - 1) / tile_size};
+  std::atomic<uint32_t> next_tile{0};
+  std::atomic<uint64_t> fragment_invocations{0};
+  std::atomic<uint64_t> discarded_fragments{0};
+  std::atomic<uint64_t> fragment_batches{0};
+
+  auto const worker{[&]{
+    invocation fragment_invocation{shader_program};
+    uint64_t local_invocations{0};
+    uint64_t local_discarded{0};
+    uint64_t local_batches{0};
+
+    struct pending_fragment {
+      int x{0};
+      int y{0};
+      std::array<float, 3> weights{};                                           // barycentric, perspective correct
+      float z{0.0f};
+      float inverse_w{0.0f};
+    };
+    std::array<pending_fragment, lane_count> batch;
+    unsigned int batch_size{0};
+
+    auto const flush{[&](triangle const &setup){
+      /// Shade the pending fragments of a triangle and write those not discarded
+      if(batch_size == 0) return;
+      lane_bits active{};
+      for(unsigned int lane{0}; lane != batch_size; ++lane) {
+        active[lane] = ~0u;
+      }
+      for(auto const &input : fragment_inputs) {
+        for(uint32_t component{0}; component != input.components; ++component) {
+          auto &target{fragment_invocation.get_register(input.slot + component)};
+          for(unsigned int lane{0}; lane != batch_size; ++lane) {
+            auto const &fragment{batch[lane]};
+            switch(input.source) {
+            case fragment_input::sources::position: {
+              std::array const position{static_cast<float>(fragment.x) + 0.5f, static_cast<float>(fragment.y) + 0.5f, fragment.z, fragment.inverse_w};
+              target[lane] = std::bit_cast<uint32_t>(position[std::min(component, 3u)]);
+              break;
+            }
+            case fragment_input::sources::front_facing:
+              target[lane] = setup.front_facing ? 1u : 0u;
+              break;
+            case fragment_input::sources::vertex_output: {
+              auto const value_of{[&](unsigned int corner){
+                return vertex_outputs[setup.vertices[corner].index * output_stride + input.vertex_offset + component];
+              }};
+              if(!input.interpolated) {
+                target[lane] = value_of(0);
+                break;
+              }
+              float value{0.0f};
+              for(unsigned int corner{0}; corner != 3; ++corner) {
+                value += fragment.weights[corner] * std::bit_cast<float>(value_of(corner));
+              }
+              target[lane] = std::bit_cast<uint32_t>(value);
+              break;
+            }
+            case fragment_input::sources::zero:
+              target[lane] = 0;
+              break;
+            }
+          }
+        }
+      }
+      fragment_invocation.run(fragment_entry, active);
+
+      auto const &discarded{fragment_invocation.get_discarded()};
+      auto const colour_components{colour_output->variable_type->get_component_count()};
+      for(unsigned int lane{0}; lane != batch_size; ++lane) {
+        if(discarded[lane] != 0) {
+          ++local_discarded;
+          continue;
+        }
+        auto *pixel{&result.pixels[(static_cast<size_t>(batch[lane].y) * width + static_cast<size_t>(batch[lane].x)) * 4]};
+        for(uint32_t component{0}; component != 4; ++component) {
+          pixel[component] = component < colour_components ? std::bit_cast<float>(fragment_invocation.get_register(colour_output->slot + component)[lane]) : (component == 3 ? 1.0f : 0.0f);
+        }
+      }
+      local_invocations += batch_size;
+      ++local_batches;
+      batch_size = 0;
+    }};
+
+    for(uint32_t tile{next_tile++}; tile < tiles_x * tiles_y; tile = next_tile++) {
+      int const tile_min_x{static_cast<int>((tile % tiles_x) * tile_size)};
+      int const tile_min_y{static_cast<int>((tile / tiles_x) * tile_size)};
+      int const tile_max_x{std::min(tile_min_x + static_cast<int>(tile_size), static_cast<int>(width)) - 1};
+      int const tile_max_y{std::min(tile_min_y + static_cast<int>(tile_size), static_cast<int>(height)) - 1};
+      for(auto const &setup : triangles) {                                      // in submission order, so later triangles overwrite earlier ones
+        auto const &[v0, v1, v2]{setup.vertices};
+        bool const top_left_0{is_top_left(v1, v2)};
+        bool const top_left_1{is_top_left(v2, v0)};
+        bool const top_left_2{is_top_left(v0, v1)};
+        for(int y{std::max(tile_min_y, setup.min_y)}; y <= std::min(tile_max_y, setup.max_y); ++y) {
+          for(int x{std::max(tile_min_x, setup.min_x)}; x <= std::min(tile_max_x, setup.max_x); ++x) {
+            float const centre_x{static_cast<float>(x) + 0.5f};
+            float const centre_y{static_cast<float>(y) + 0.5f};
+            auto const w0{edge(v1, v2, centre_x, centre_y)};
+            auto const w1{edge(v2, v0, centre_x, centre_y)};
+            auto const w2{edge(v0, v1, centre_x, centre_y)};
+            if(!(w0 > 0.0f || (w0 >= 0.0f && top_left_0))) continue;
+            if(!(w1 > 0.0f || (w1 >= 0.0f && top_left_1))) continue;
+            if(!(w2 > 0.0f || (w2 >= 0.0f && top_left_2))) continue;
+
+            std::array const linear{w0 * setup.inverse_area, w1 * setup.inverse_area, w2 * setup.inverse_area};
+            std::array const perspective{linear[0] * v0.inverse_w, linear[1] * v1.inverse_w, linear[2] * v2.inverse_w};
+            auto const inverse_w{perspective[0] + perspective[1] + perspective[2]};
+            auto &fragment{batch[batch_size++]};
+            fragment = {
+              .x{x},
+              .y{y},
+              .weights{perspective[0] / inverse_w, perspective[1] / inverse_w, perspective[2] / inverse_w},
+              .z{linear[0] * v0.z + linear[1] * v1.z + linear[2] * v2.z},
+              .inverse_w{inverse_w},
+            };
+            if(batch_size == lane_count) flush(setup);
+          }
+        }
+        flush(setup);
+      }
+    }
+
+    fragment_invocations += local_invocations;
+    discarded_fragments += local_discarded;
+    fragment_batches += local_batches;
+  }};
+
+  auto const threads_to_use{std::min(thread_count, tiles_x * tiles_y)};
+  if(threads_to_use <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(threads_to_use);
+    for(unsigned int i{0}; i != threads_to_use; ++i) {
+      threads.emplace_back(worker);
+    }
+    for(auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  stats.fragment_invocations += fragment_invocations;
+  stats.discarded_fragments += discarded_fragments;
+  stats.fragment_batches += fragment_batches;
+  return result;
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "program.h"
+
+namespace wgsl {
+
+class reference_renderer {
+  /// Rasterises indexed triangle lists on the CPU, running a program's vertex and fragment shaders through the
+  /// interpreter, independent of the graphics API, to produce reference images to compare GPU output against
+  /// Fragments are shaded lane_count at a time, and tiles of the image are shaded on separate threads
+public:
+  struct vertex_attribute {
+    unsigned int location{0};                                                   // @location of the vertex shader input it feeds
+    unsigned int components{0};                                                 // floats per vertex
+    std::vector<float> values;
+  };
+
+  struct draw_call {
+    std::string vertex_entry_point{"vs_main"};
+    std::string fragment_entry_point{"fs_main"};
+    std::vector<vertex_attribute> attributes;
+    std::vector<uint32_t> indices;                                              // triangle list
+  };
+
+  struct image {
+    unsigned int width{0};
+    unsigned int height{0};
+    std::vector<float> pixels;                                                  // rgba from @location(0), row by row from the top
+  };
+
+private:
+  program const &shader_program;
+  unsigned int thread_count;
+
+public:
+  unsigned int tile_size{32};                                                   // pixels along each side of the tiles handed to threads
+
+  struct stats_data {
+    uint64_t vertex_invocations{0};
+    uint64_t fragment_invocations{0};                                           // fragments shaded, including those discarded
+    uint64_t discarded_fragments{0};
+    uint64_t fragment_batches{0};                                               // fragment shader runs of up to lane_count fragments each
+    uint64_t culled_triangles{0};                                               // degenerate, or crossing the w = 0 plane
+  } stats;
+
+  explicit reference_renderer(program const &this_shader_program, unsigned int this_thread_count = 0);
+
+  image render(draw_call const &draw, unsigned int width, unsigned int height);
+};
+
+}
@@ -0,0 +1,453 @@
+#include "reflection.h"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "parser.h"
+#include "types.h"
+
+namespace wgsl::reflection {
+
+namespace {
+
+constexpr std::array<std::pair<std::string_view, texture_dimensions>, 16> texture_type_dimensions{{
+  {"texture_1d",                    texture_dimensions::d1},
+  {"texture_2d",                    texture_dimensions::d2},
+  {"texture_2d_array",              texture_dimensions::d2_array},
+  {"texture_3d",                    texture_dimensions::d3},
+  {"texture_cube",                  texture_dimensions::cube},
+  {"texture_cube_array",            texture_dimensions::cube_array},
+  {"texture_multisampled_2d",       texture_dimensions::d2},
+  {"texture_depth_2d",              texture_dimensions::d2},
+  {"texture_depth_2d_array",        texture_dimensions::d2_array},
+  {"texture_depth_cube",            texture_dimensions::cube},
+  {"texture_depth_cube_array",      texture_dimensions::cube_array},
+  {"texture_depth_multisampled_2d", texture_dimensions::d2},
+  {"texture_storage_1d",            texture_dimensions::d1},
+  {"texture_storage_2d",            texture_dimensions::d2},
+  {"texture_storage_2d_array",      texture_dimensions::d2_array},
+  {"texture_storage_3d",            texture_dimensions::d3},
+}};
+
+[[noreturn]] void fail(ast::location const &location, std::string const &message) {
+  throw std::runtime_error{"WGSL: " + std::to_string(location.line) + ":" + std::to_string(location.column) + ": " + message};
+}
+
+uint32_t round_up(uint32_t value, uint32_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+class reflector {
+  /// Works out a module's interface from its syntax tree, checking the parts of it the host depends on
+  /// This is not a full validator: function bodies are only scanned for the names they use
+  ast::module const &syntax;
+  type_table types;
+  std::unordered_map<std::string_view, type const*> resolved_structs;           // nullptr for structures without a host-shareable layout
+  std::unordered_set<std::string_view> resolving_structs;                       // to catch recursive structures
+  std::unordered_map<std::string_view, std::unordered_set<std::string_view>> function_references; // names used by each function, directly or through the functions it calls
+
+  ast::struct_declaration const *find_struct_declaration(ast::type_name const &name) const {
+    /// The structure a type name refers to, through any aliases, or nullptr if it's not a structure
+    for(auto const &alias : syntax.aliases) {
+      if(alias.name == name.name) return find_struct_declaration(alias.type);
+    }
+    auto const it{std::ranges::find(syntax.structs, name.name, &ast::struct_declaration::name)};
+    return it == syntax.structs.end() ? nullptr : &*it;
+  }
+
+  uint32_t parse_integer(std::string_view text, ast::location const &location) const {
+    /// Value of an integer literal, as used for array sizes, groups, bindings and locations
+    auto const digits{text.substr(0, text.find_first_not_of("0123456789"))};
+    if(digits.empty() || (digits.size() != text.size() && text.substr(digits.size()) != "u" && text.substr(digits.size()) != "i")) {
+      fail(location, "expected an integer literal rather than " + std::string{text});
+    }
+    return static_cast<uint32_t>(std::stoul(std::string{digits}));
+  }
+
+  type const *resolve_scalar(std::string_view name) {
+    if(name == "f32" || name == "f") return types.get_scalar(scalar_type::f32);
+    if(name == "i32" || name == "i") return types.get_scalar(scalar_type::i32);
+    if(name == "u32" || name == "u") return types.get_scalar(scalar_type::u32);
+    return nullptr;                                                             // bool and f16 have no layout the host can share here
+  }
+
+  type const *resolve_component(ast::type_name const &name, std::string_view suffix) {
+    /// The component type of a vector or matrix, from its template argument or a suffix such as the f of vec2f
+    if(suffix.empty()) {
+      if(name.template_arguments.size() != 1) fail(name.location, std::string{name.name} + " needs a component type");
+      return resolve(name.template_arguments.front());
+    }
+    return resolve_scalar(suffix);
+  }
+
+  type const *resolve_struct(ast::struct_declaration const &declaration) {
+    if(auto const it{resolved_structs.find(declaration.name)}; it != resolved_structs.end()) return it->second;
+    if(!resolving_structs.emplace(declaration.name).second) fail(declaration.location, "structure " + std::string{declaration.name} + " contains itself");
+    structure result{.name{std::string{declaration.name}}, .members{}};
+    bool host_shareable{true};
+    for(auto const &member : declaration.members) {
+      if(ast::find_attribute(member.attributes, "align") || ast::find_attribute(member.attributes, "size")) {
+        fail(member.type.location, "@align and @size are not supported by reflection");
+      }
+      auto const *member_type{resolve(member.type)};
+      if(!member_type) host_shareable = false;
+      result.members.emplace_back(structure::member{.name{std::string{member.name}}, .member_type{member_type}, .location{}, .builtin{}});
+    }
+    resolving_structs.erase(declaration.name);
+    auto const *resolved{host_shareable ? types.get_structure(std::move(result)) : nullptr};
+    resolved_structs.emplace(declaration.name, resolved);
+    return resolved;
+  }
+
+  type const *resolve(ast::type_name const &name) {
+    /// The type a type name refers to, or nullptr for types without a host-shareable layout, such as bool, textures and samplers
+    std::string_view const text{name.name};
+    for(auto const &alias : syntax.aliases) {
+      if(alias.name == text) return resolve(alias.type);
+    }
+    if(auto const *declaration{find_struct_declaration(name)}) return resolve_struct(*declaration);
+    if(text == "f32" || text == "i32" || text == "u32") return resolve_scalar(text);
+    if(text == "bool" || text == "f16" || text.starts_with("texture_") || text.starts_with("sampler")) return nullptr;
+    if(text == "atomic") {
+      if(name.template_arguments.size() != 1) fail(name.location, "atomic needs a component type");
+      return resolve(name.template_arguments.front());
+    }
+    if(text.size() >= 4 && text.starts_with("vec") && text[3] >= '2' && text[3] <= '4') {
+      auto const *component{resolve_component(name, text.substr(4))};
+      if(!component) return nullptr;
+      if(component->kind != type::kinds::scalar) fail(name.location, "vector components must be scalars");
+      return types.get_vector(component->scalar, static_cast<unsigned int>(text[3] - '0'));
+    }
+    if(text.size() >= 6 && text.starts_with("mat") && text[4] == 'x') {
+      auto const *component{resolve_component(name, text.substr(6))};
+      if(!component) return nullptr;
+      return types.get_matrix(component->scalar, static_cast<unsigned int>(text[3] - '0'), static_cast<unsigned int>(text[5] - '0'));
+    }
+    if(text == "array") {
+      if(name.template_arguments.empty()) fail(name.location, "array needs an element type");
+      auto const *element{resolve(name.template_arguments.front())};
+      if(!element) return nullptr;
+      uint32_t count{0};                                                        // runtime sized unless given
+      if(name.template_arguments.size() > 1) count = parse_integer(name.template_arguments[1].name, name.template_arguments[1].location);
+      return types.get_array(element, count);
+    }
+    fail(name.location, "unknown type " + std::string{text});
+  }
+
+  void check_uniform_layout(type const &checked_type, ast::location const &location) const {
+    /// Check the extra layout constraints of the uniform address space, which the host's structures have to meet too
+    if(checked_type.kind == type::kinds::array) {
+      if(checked_type.columns == 0) fail(location, "uniform buffers can't contain runtime sized arrays");
+      auto const stride{get_host_shareable_layout(checked_type).size / checked_type.columns};
+      if(stride % 16 != 0) fail(location, "array element stride of " + std::to_string(stride) + " bytes in a uniform buffer must be a multiple of 16");
+      check_uniform_layout(*checked_type.element, location);
+    } else if(checked_type.kind == type::kinds::structure) {
+      uint32_t offset{0};
+      for(auto const &member : checked_type.members->members) {
+        auto const member_layout{get_host_shareable_layout(*member.member_type)};
+        offset = round_up(offset, member_layout.alignment);
+        if(member.member_type->kind == type::kinds::structure && offset % 16 != 0) {
+          fail(location, "structure member " + member.name + " in a uniform buffer must be at an offset that's a multiple of 16");
+        }
+        check_uniform_layout(*member.member_type, location);
+        offset += member_layout.size;
+      }
+    }
+  }
+
+  static uint32_t get_min_binding_size(type const &buffer_type) {
+    /// The smallest buffer that can be bound, where a runtime sized array needs at least one element
+    auto const get_stride{[](type const &array_type){
+      auto const element_layout{get_host_shareable_layout(*array_type.element)};
+      return round_up(element_layout.size, element_layout.alignment);
+    }};
+    auto const layout{get_host_shareable_layout(buffer_type)};
+    if(buffer_type.kind == type::kinds::array && buffer_type.columns == 0) return get_stride(buffer_type);
+    if(buffer_type.kind == type::kinds::structure && !buffer_type.members->members.empty()) {
+      auto const &last{*buffer_type.members->members.back().member_type};
+      if(last.kind == type::kinds::array && last.columns == 0) return round_up(layout.size + get_stride(last), layout.alignment);
+    }
+    return layout.size;
+  }
+
+  void collect_references(ast::expression const &expression, std::unordered_set<std::string_view> &references) const {
+    if(expression.kind == ast::expression::kinds::identifier) references.emplace(expression.text);
+    if(expression.kind == ast::expression::kinds::call) references.emplace(expression.callee.name);
+    for(auto const &operand : expression.operands) collect_references(operand, references);
+  }
+
+  void collect_references(ast::statement const &statement, std::unordered_set<std::string_view> &references) const {
+    for(auto const &expression : statement.expressions) collect_references(expression, references);
+    for(auto const &child : statement.children) collect_references(child, references);
+  }
+
+  std::unordered_set<std::string_view> const &get_references(ast::function_declaration const &function) {
+    /// Every name a function uses, including those used by the functions it calls
+    if(auto const it{function_references.find(function.name)}; it != function_references.end()) return it->second;
+    auto &references{function_references[function.name]};                       // empty while being collected, which ends recursion
+    std::unordered_set<std::string_view> direct;
+    collect_references(function.body, direct);
+    if(auto const *workgroup_size{ast::find_attribute(function.attributes, "workgroup_size")}; workgroup_size) {
+      direct.insert(workgroup_size->arguments.begin(), workgroup_size->arguments.end()); // overrides can size a compute entry point's workgroups
+    }
+    for(auto const name : direct) {
+      references.emplace(name);
+      auto const callee{std::ranges::find(syntax.functions, name, &ast::function_declaration::name)};
+      if(callee == syntax.functions.end() || callee->name == function.name) continue;
+      auto const &indirect{get_references(*callee)};
+      references.insert(indirect.begin(), indirect.end());
+    }
+    return references;
+  }
+
+  vertex_input make_vertex_input(uint32_t location, std::string_view name, ast::type_name const &input_type) {
+    auto const *resolved{resolve(input_type)};
+    if(!resolved || (resolved->kind != type::kinds::scalar && resolved->kind != type::kinds::vector)) {
+      fail(input_type.location, "vertex input " + std::string{name} + " must be a 32-bit scalar or vector");
+    }
+    vertex_input result{
+      .location{location},
+      .name{name},
+      .components{resolved->rows},
+    };
+    switch(resolved->scalar) {
+    case scalar_type::f32:
+      result.component_type = component_types::f32;
+      break;
+    case scalar_type::i32:
+      result.component_type = component_types::i32;
+      break;
+    case scalar_type::u32:
+      result.component_type = component_types::u32;
+      break;
+    case scalar_type::boolean:
+    case scalar_type::abstract_int:
+    case scalar_type::abstract_float:
+      fail(input_type.location, "vertex input " + std::string{name} + " must be a 32-bit scalar or vector");
+    }
+    return result;
+  }
+
+  std::vector<vertex_input> reflect_vertex_inputs(ast::function_declaration const &function) {
+    /// The located inputs of a vertex entry point, whether parameters or members of structure parameters
+    std::vector<vertex_input> inputs;
+    auto const add_input{[&](std::span<ast::attribute const> attributes, std::string_view name, ast::type_name const &input_type) {
+      if(ast::find_attribute(attributes, "builtin")) return false;
+      auto const *location{ast::find_attribute(attributes, "location")};
+      if(!location) return false;
+      auto const input{make_vertex_input(parse_integer(location->arguments.at(0), input_type.location), name, input_type)};
+      if(std::ranges::find(inputs, input.location, &vertex_input::location) != inputs.end()) {
+        fail(input_type.location, "vertex input location " + std::to_string(input.location) + " is used twice");
+      }
+      inputs.emplace_back(input);
+      return true;
+    }};
+    for(auto const &parameter : function.parameters) {
+      if(add_input(parameter.attributes, parameter.name, parameter.type) || ast::find_attribute(parameter.attributes, "builtin")) continue;
+      auto const *declaration{find_struct_declaration(parameter.type)};
+      if(!declaration) fail(parameter.type.location, "vertex input " + std::string{parameter.name} + " needs a @location or @builtin attribute");
+      for(auto const &member : declaration->members) {
+        if(!add_input(member.attributes, member.name, member.type) && !ast::find_attribute(member.attributes, "builtin")) {
+          fail(member.type.location, "vertex input " + std::string{member.name} + " needs a @location or @builtin attribute");
+        }
+      }
+    }
+    return inputs;
+  }
+
+  uint32_t get_visibility(std::string_view name, std::span<reflected_entry_point const> entry_points) {
+    /// Which stages use a module scope name, from the entry points that refer to it directly or through their calls
+    uint32_t visibility{0};
+    for(auto const &entry_point : entry_points) {
+      auto const function{std::ranges::find(syntax.functions, entry_point.name, &ast::function_declaration::name)};
+      if(!get_references(*function).contains(name)) continue;
+      switch(entry_point.stage) {
+      case stages::vertex:
+        visibility |= visible_in_vertex;
+        break;
+      case stages::fragment:
+        visibility |= visible_in_fragment;
+        break;
+      case stages::compute:
+        visibility |= visible_in_compute;
+        break;
+      }
+    }
+    return visibility;
+  }
+
+  override_types get_override_type(ast::variable_declaration const &variable) const {
+    /// The type of an override constant, as declared or as its literal initialiser concretises to
+    std::string_view name;
+    if(variable.type) {
+      name = variable.type->name;
+      for(auto alias{std::ranges::find(syntax.aliases, name, &ast::alias_declaration::name)}; alias != syntax.aliases.end(); alias = std::ranges::find(syntax.aliases, name, &ast::alias_declaration::name)) {
+        name = alias->type.name;                                                // through any aliases
+      }
+    } else if(variable.initialiser && variable.initialiser->kind == ast::expression::kinds::literal) {
+      auto const &literal{*variable.initialiser};
+      switch(literal.literal_type) {
+      case token::types::identifier:                                            // true or false
+        name = "bool";
+        break;
+      case token::types::integer_literal:
+        name = literal.text.ends_with('u') ? "u32" : "i32";
+        break;
+      case token::types::float_literal:
+        name = literal.text.ends_with('h') ? "f16" : "f32";
+        break;
+      case token::types::symbol:
+      case token::types::attribute:
+      case token::types::end:
+        break;
+      }
+    }
+    if(name == "bool")               return override_types::boolean;
+    if(name == "f32" || name == "f") return override_types::f32;
+    if(name == "i32" || name == "i") return override_types::i32;
+    if(name == "u32" || name == "u") return override_types::u32;
+    if(name.empty()) fail(variable.location, "override " + std::string{variable.name} + " needs a type or a literal initialiser");
+    fail(variable.location, "override " + std::string{variable.name} + " has unsupported type " + std::string{name});
+  }
+
+  resource_binding reflect_binding(ast::variable_declaration const &variable, uint32_t group, uint32_t binding) {
+    /// Describe one resource variable
+    if(!variable.type) fail(variable.location, "resource variable " + std::string{variable.name} + " needs a type");
+    auto const &type_name{*variable.type};
+    resource_binding result{
+      .group{group},
+      .binding{binding},
+      .name{variable.name},
+      .type_name{type_name.name},
+      .texel_format{},
+      .access{},
+    };
+
+    if(variable.address_space == "uniform" || variable.address_space == "storage") {
+      auto const *buffer_type{resolve(type_name)};
+      if(!buffer_type) fail(variable.location, "buffer " + std::string{variable.name} + " has a type with no host-shareable layout");
+      if(variable.address_space == "uniform") {
+        check_uniform_layout(*buffer_type, variable.location);
+        result.type = binding_types::uniform_buffer;
+      } else {
+        result.type = variable.access_mode == "read_write" ? binding_types::storage_buffer : binding_types::read_only_storage_buffer;
+        result.access = variable.access_mode.empty() ? std::string_view{"read"} : variable.access_mode;
+      }
+      result.min_binding_size = get_min_binding_size(*buffer_type);
+      return result;
+    }
+    if(!variable.address_space.empty()) fail(variable.location, "resource variables can't be in the " + std::string{variable.address_space} + " address space");
+
+    if(type_name.name == "sampler") {
+      result.type = binding_types::sampler;
+      return result;
+    }
+    if(type_name.name == "sampler_comparison") {
+      result.type = binding_types::comparison_sampler;
+      return result;
+    }
+    auto const texture{std::ranges::find(texture_type_dimensions, type_name.name, &std::pair<std::string_view, texture_dimensions>::first)};
+    if(texture == texture_type_dimensions.end()) fail(type_name.location, "unsupported resource type " + std::string{type_name.name});
+    result.dimension = texture->second;
+    result.multisampled = type_name.name.find("multisampled") != std::string_view::npos;
+    if(type_name.name.starts_with("texture_depth")) {
+      result.type = binding_types::depth_texture;
+      result.sample_type = sample_types::depth;
+    } else if(type_name.name.starts_with("texture_storage")) {
+      if(type_name.template_arguments.size() != 2) fail(type_name.location, "storage textures need a texel format and an access mode");
+      result.type = binding_types::storage_texture;
+      result.texel_format = type_name.template_arguments[0].name;
+      result.access = type_name.template_arguments[1].name;
+    } else {
+      if(type_name.template_arguments.size() != 1) fail(type_name.location, "sampled textures need a sample type");
+      auto const sample{type_name.template_arguments[0].name};
+      result.type = binding_types::texture;
+      result.sample_type = sample == "f32" ? sample_types::floating : sample == "i32" ? sample_types::signed_integer : sample == "u32" ? sample_types::unsigned_integer : sample_types::none;
+      if(result.sample_type == sample_types::none) fail(type_name.location, "unsupported texture sample type " + std::string{sample});
+    }
+    return result;
+  }
+
+public:
+  explicit reflector(ast::module const &this_syntax)
+    : syntax{this_syntax} {
+  }
+
+  reflected_module run() {
+    /// Reflect the whole module
+    reflected_module result;
+
+    for(auto const &declaration : syntax.structs) {
+      auto const *resolved{resolve_struct(declaration)};
+      if(!resolved) continue;
+      auto const layout{get_host_shareable_layout(*resolved)};
+      auto &reflected{result.structs.emplace_back(reflected_struct{.name{declaration.name}, .size{layout.size}, .alignment{layout.alignment}, .members{}})};
+      uint32_t offset{0};
+      for(size_t i{0}; i != declaration.members.size(); ++i) {
+        auto const member_layout{get_host_shareable_layout(*resolved->members->members[i].member_type)};
+        offset = round_up(offset, member_layout.alignment);
+        reflected.members.emplace_back(member{
+          .name{declaration.members[i].name},
+          .offset{offset},
+          .size{member_layout.size},
+          .alignment{member_layout.alignment},
+        });
+        offset += member_layout.size;
+      }
+    }
+
+    for(auto const &function : syntax.functions) {
+      std::optional<stages> stage;
+      if(ast::find_attribute(function.attributes, "vertex"))   stage = stages::vertex;
+      if(ast::find_attribute(function.attributes, "fragment")) stage = stages::fragment;
+      if(ast::find_attribute(function.attributes, "compute"))  stage = stages::compute;
+      if(!stage) continue;
+      result.entry_points.emplace_back(reflected_entry_point{
+        .name{function.name},
+        .stage{*stage},
+        .inputs{*stage == stages::vertex ? reflect_vertex_inputs(function) : std::vector<vertex_input>{}},
+      });
+    }
+
+    for(auto const &variable : syntax.variables) {
+      if(variable.declaration == "override") {
+        result.overrides.emplace_back(override_constant{
+          .name{variable.name},
+          .type{get_override_type(variable)},
+          .visibility{get_visibility(variable.name, result.entry_points)},
+          .has_default{variable.initialiser.has_value()},
+        });
+        continue;
+      }
+      auto const *group{ast::find_attribute(variable.attributes, "group")};
+      auto const *binding{ast::find_attribute(variable.attributes, "binding")};
+      if(!group && !binding) continue;
+      if(!group || !binding || group->arguments.empty() || binding->arguments.empty()) {
+        fail(variable.location, "resource variable " + std::string{variable.name} + " needs both @group and @binding");
+      }
+      auto reflected{reflect_binding(variable, parse_integer(group->arguments[0], variable.location), parse_integer(binding->arguments[0], variable.location))};
+      for(auto const &existing : result.bindings) {
+        if(existing.group == reflected.group && existing.binding == reflected.binding) {
+          fail(variable.location, std::string{variable.name} + " uses the same group and binding as " + std::string{existing.name});
+        }
+      }
+      reflected.visibility = get_visibility(variable.name, result.entry_points);
+      result.bindings.emplace_back(reflected);
+    }
+    return result;
+  }
+};
+
+}
+
+reflected_module reflect(std::string_view source) {
+  /// Parse a shader and describe its interface with the host, throwing if that interface is invalid
+  auto const syntax{parse(source)};
+  return reflector{syntax}.run();
+}
+
+}
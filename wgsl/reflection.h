@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace wgsl::reflection {
+
+// a shader's interface with the host: its bindings, override constants, the memory layout of its structures, and
+// its vertex inputs
+// The resource compiler writes these out as constexpr data alongside each embedded shader, so the renderer can
+// build layouts from them and check its own structures against the shader when it's compiled
+
+inline constexpr uint32_t visible_in_vertex{1};                                 // visibility bits, the same as wgpu::ShaderStage's
+inline constexpr uint32_t visible_in_fragment{2};
+inline constexpr uint32_t visible_in_compute{4};
+
+enum class stages {
+  vertex,
+  fragment,
+  compute,
+};
+
+enum class binding_types {
+  uniform_buffer,
+  storage_buffer,
+  read_only_storage_buffer,
+  sampler,
+  comparison_sampler,
+  texture,
+  depth_texture,
+  storage_texture,
+};
+
+enum class sample_types {
+  none,                                                                         // not a sampled texture
+  floating,
+  signed_integer,
+  unsigned_integer,
+  depth,
+};
+
+enum class texture_dimensions {
+  none,                                                                         // not a texture
+  d1,
+  d2,
+  d2_array,
+  cube,
+  cube_array,
+  d3,
+};
+
+enum class component_types {
+  f32,
+  i32,
+  u32,
+};
+
+enum class override_types {
+  boolean,
+  f32,
+  i32,
+  u32,
+};
+
+struct member {
+  std::string_view name;
+  uint32_t offset{0};
+  uint32_t size{0};
+  uint32_t alignment{0};
+};
+
+struct struct_layout {                                                          // following the WGSL memory layout rules
+  std::string_view name;
+  uint32_t size{0};
+  uint32_t alignment{0};
+  std::span<member const> members;
+};
+
+struct resource_binding {
+  uint32_t group{0};
+  uint32_t binding{0};
+  std::string_view name;
+  binding_types type{binding_types::uniform_buffer};
+  uint32_t visibility{0};                                                       // visible_in_ bits for each stage whose entry points use it
+  uint32_t min_binding_size{0};                                                 // buffers only: the size of the type, or up to the first element of a runtime sized array
+  std::string_view type_name;                                                   // as spelled in the shader, e.g. the structure name
+  sample_types sample_type{sample_types::none};
+  texture_dimensions dimension{texture_dimensions::none};
+  bool multisampled{false};
+  std::string_view texel_format;                                                // storage textures only, e.g. "rgba8unorm"
+  std::string_view access;                                                      // storage buffers and textures only, e.g. "read_write"
+};
+
+struct vertex_input {
+  uint32_t location{0};
+  std::string_view name;
+  component_types component_type{component_types::f32};
+  uint32_t components{1};
+};
+
+struct override_constant {                                                      // a pipeline-overridable constant, set by name when a pipeline is created
+  std::string_view name;
+  override_types type{override_types::f32};
+  uint32_t visibility{0};                                                       // visible_in_ bits for each stage whose entry points use it
+  bool has_default{false};                                                      // whether it has an initialiser, so pipelines may leave it unset
+};
+
+struct entry_point {
+  std::string_view name;
+  stages stage{stages::fragment};
+  std::span<vertex_input const> inputs;                                         // vertex entry points only
+};
+
+constexpr resource_binding const *find_binding(std::span<resource_binding const> bindings, uint32_t group, uint32_t binding) {
+  /// Find a binding by group and binding number, or return nullptr if there's no such binding
+  for(auto const &candidate : bindings) {
+    if(candidate.group == group && candidate.binding == binding) return &candidate;
+  }
+  return nullptr;
+}
+
+constexpr struct_layout const *find_struct(std::span<struct_layout const> structs, std::string_view name) {
+  for(auto const &candidate : structs) {
+    if(candidate.name == name) return &candidate;
+  }
+  return nullptr;
+}
+
+constexpr entry_point const *find_entry_point(std::span<entry_point const> entry_points, std::string_view name) {
+  for(auto const &candidate : entry_points) {
+    if(candidate.name == name) return &candidate;
+  }
+  return nullptr;
+}
+
+constexpr override_constant const *find_override(std::span<override_constant const> overrides, std::string_view name) {
+  for(auto const &candidate : overrides) {
+    if(candidate.name == name) return &candidate;
+  }
+  return nullptr;
+}
+
+constexpr vertex_input const *find_vertex_input(std::span<vertex_input const> inputs, uint32_t location) {
+  for(auto const &candidate : inputs) {
+    if(candidate.location == location) return &candidate;
+  }
+  return nullptr;
+}
+
+// the same interface as built by reflect(), before being written out, with names viewing the source
+struct reflected_struct {
+  std::string_view name;
+  uint32_t size{0};
+  uint32_t alignment{0};
+  std::vector<member> members;
+};
+
+struct reflected_entry_point {
+  std::string_view name;
+  stages stage{stages::fragment};
+  std::vector<vertex_input> inputs;
+};
+
+struct reflected_module {
+  std::vector<reflected_struct> structs;                                        // those with a host-shareable layout
+  std::vector<resource_binding> bindings;
+  std::vector<override_constant> overrides;
+  std::vector<reflected_entry_point> entry_points;
+};
+
+reflected_module reflect(std::string_view source);
+
+}
@@ -0,0 +1,180 @@
+#include "tokenizer.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace wgsl {
+
+namespace {
+
+constexpr std::array symbols{                                                   // longest first, so the first match is the longest
+  "<<=", ">>=",
+  "->", "&&", "||", "==", "!=", "<=", ">=", "<<", ">>", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "++", "--",
+  "(", ")", "[", "]", "{", "}", "<", ">", ",", ".", ":", ";", "=", "+", "-", "*", "/", "%", "&", "|", "^", "!", "~",
+};
+
+bool is_identifier_start(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+bool is_hex_digit(char c) {
+  return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool is_identifier_continue(char c) {
+  return is_identifier_start(c) || is_digit(c);
+}
+
+bool is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+class tokenizer {
+  std::string_view source;
+  size_t position{0};
+  unsigned int line{1};
+  size_t line_start{0};                                                         // position of the first character of the current line
+
+  char peek(size_t offset = 0) const {
+    return position + offset < source.size() ? source[position + offset] : '\0';
+  }
+
+  void advance(size_t count = 1) {
+    for(size_t i{0}; i != count && position != source.size(); ++i, ++position) {
+      if(source[position] == '\n') {
+        ++line;
+        line_start = position + 1;
+      }
+    }
+  }
+
+  unsigned int column() const {
+    return static_cast<unsigned int>(position - line_start + 1);
+  }
+
+  [[noreturn]] void fail(std::string const &message) const {
+    throw std::runtime_error{"WGSL: " + std::to_string(line) + ":" + std::to_string(column()) + ": " + message};
+  }
+
+  void skip_whitespace_and_comments() {
+    /// Skip anything that doesn't produce a token; block comments may nest
+    while(position != source.size()) {
+      if(is_whitespace(peek())) {
+        advance();
+      } else if(peek() == '/' && peek(1) == '/') {
+        while(position != source.size() && peek() != '\n') advance();
+      } else if(peek() == '/' && peek(1) == '*') {
+        unsigned int depth{0};
+        do {
+          if(position == source.size()) fail("unterminated block comment");
+          if(peek() == '/' && peek(1) == '*') {
+            ++depth;
+            advance(2);
+          } else if(peek() == '*' && peek(1) == '/') {
+            --depth;
+            advance(2);
+          } else {
+            advance();
+          }
+        } while(depth != 0);
+      } else {
+        return;
+      }
+    }
+  }
+
+  token::types read_number() {
+    /// Consume a numeric literal with any suffix, and report whether it's an integer or a float
+    auto type{token::types::integer_literal};
+    if(peek() == '0' && (peek(1) == 'x' || peek(1) == 'X')) {
+      advance(2);
+      if(!is_hex_digit(peek())) fail("malformed hexadecimal literal");
+      while(is_hex_digit(peek())) advance();
+    } else {
+      while(is_digit(peek())) advance();
+      if(peek() == '.' && !is_identifier_start(peek(1))) {                      // "1.x" is a member access on an integer, not a float
+        type = token::types::float_literal;
+        advance();
+        while(is_digit(peek())) advance();
+      }
+      if(peek() == 'e' || peek() == 'E') {
+        type = token::types::float_literal;
+        advance();
+        if(peek() == '+' || peek() == '-') advance();
+        if(!is_digit(peek())) fail("malformed exponent in float literal");
+        while(is_digit(peek())) advance();
+      }
+    }
+    switch(peek()) {
+    case 'u':
+    case 'i':
+      if(type == token::types::float_literal) fail("integer suffix on a float literal");
+      advance();
+      break;
+    case 'f':
+    case 'h':
+      type = token::types::float_literal;
+      advance();
+      break;
+    default:
+      break;
+    }
+    if(is_identifier_continue(peek())) fail("unexpected character after numeric literal");
+    return type;
+  }
+
+public:
+  explicit tokenizer(std::string_view this_source)
+    : source{this_source} {
+  }
+
+  std::vector<token> run() {
+    /// Split the whole source into tokens, ending with an end token
+    std::vector<token> tokens;
+    while(true) {
+      skip_whitespace_and_comments();
+      token current{
+        .text{},
+        .line{line},
+        .column{column()},
+      };
+      auto const start{position};
+      if(position == source.size()) {
+        tokens.emplace_back(current);
+        return tokens;
+      }
+
+      if(is_identifier_start(peek())) {
+        while(is_identifier_continue(peek())) advance();
+        current.type = token::types::identifier;
+      } else if(is_digit(peek()) || (peek() == '.' && is_digit(peek(1)))) {
+        current.type = read_number();
+      } else if(peek() == '@') {
+        advance();
+        current.type = token::types::attribute;
+      } else {
+        auto const remaining{source.substr(position)};
+        auto const match{std::find_if(symbols.begin(), symbols.end(), [&](std::string_view symbol){return remaining.starts_with(symbol);})};
+        if(match == symbols.end()) fail(std::string{"unexpected character '"} + peek() + "'");
+        advance(std::string_view{*match}.size());
+        current.type = token::types::symbol;
+      }
+      current.text = source.substr(start, position - start);
+      tokens.emplace_back(current);
+    }
+  }
+};
+
+}
+
+std::vector<token> tokenize(std::string_view source) {
+  /// Split WGSL source into tokens, discarding whitespace and comments
+  return tokenizer{source}.run();
+}
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace wgsl {
+
+struct token {
+  enum class types {
+    identifier,                                                                 // identifiers and keywords
+    integer_literal,                                                            // including any suffix, e.g. 64u
+    float_literal,                                                              // including any suffix, e.g. 1.5f
+    symbol,                                                                     // punctuation and operators, longest match first
+    attribute,                                                                  // the @ introducing an attribute
+    end,                                                                        // end of the source
+  };
+
+  types type{types::end};
+  std::string_view text;                                                        // view into the source the token was read from
+  unsigned int line{0};                                                         // 1-based position in the source, for error messages
+  unsigned int column{0};
+};
+
+std::vector<token> tokenize(std::string_view source);
+
+}
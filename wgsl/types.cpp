@@ -0,0 +1,198 @@
+#include "types.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace wgsl {
+
+unsigned int type::get_component_count() const {
+  /// Number of 32-bit components this type flattens to
+  switch(kind) {
+  case kinds::none:
+    return 0;
+  case kinds::scalar:
+  case kinds::vector:
+  case kinds::matrix:
+    return columns * rows;
+  case kinds::array:
+    return columns * element->get_component_count();
+  case kinds::structure:
+    return members->component_count;
+  }
+  return 0;
+}
+
+bool type::is_numeric_scalar_or_vector() const {
+  return (kind == kinds::scalar || kind == kinds::vector) && scalar != scalar_type::boolean;
+}
+
+std::string type::get_name() const {
+  /// The WGSL spelling of this type, for error messages
+  auto const scalar_name{[&]{
+    switch(scalar) {
+    case scalar_type::f32:            return std::string{"f32"};
+    case scalar_type::i32:            return std::string{"i32"};
+    case scalar_type::u32:            return std::string{"u32"};
+    case scalar_type::boolean:        return std::string{"bool"};
+    case scalar_type::abstract_int:   return std::string{"abstract-int"};
+    case scalar_type::abstract_float: return std::string{"abstract-float"};
+    }
+    return std::string{};
+  }};
+  switch(kind) {
+  case kinds::none:
+    return "none";
+  case kinds::scalar:
+    return scalar_name();
+  case kinds::vector:
+    return "vec" + std::to_string(rows) + "<" + scalar_name() + ">";
+  case kinds::matrix:
+    return "mat" + std::to_string(columns) + "x" + std::to_string(rows) + "<" + scalar_name() + ">";
+  case kinds::array:
+    return "array<" + element->get_name() + ", " + std::to_string(columns) + ">";
+  case kinds::structure:
+    return members->name;
+  }
+  return {};
+}
+
+structure::member const *structure::find_member(std::string_view member_name) const {
+  auto const it{std::ranges::find(members, member_name, &member::name)};
+  return it == members.end() ? nullptr : &*it;
+}
+
+type const *type_table::intern(type const &new_type) {
+  /// Return the existing copy of an equivalent type, or store this one
+  if(auto const it{std::ranges::find(types, new_type)}; it != types.end()) return &*it;
+  return &types.emplace_back(new_type);
+}
+
+type const *type_table::get_none() {
+  return intern(type{});
+}
+
+type const *type_table::get_scalar(scalar_type scalar) {
+  return intern(type{.kind{type::kinds::scalar}, .scalar{scalar}});
+}
+
+type const *type_table::get_vector(scalar_type scalar, unsigned int size) {
+  return intern(type{.kind{type::kinds::vector}, .scalar{scalar}, .rows{size}});
+}
+
+type const *type_table::get_matrix(scalar_type scalar, unsigned int columns, unsigned int rows) {
+  return intern(type{.kind{type::kinds::matrix}, .scalar{scalar}, .columns{columns}, .rows{rows}});
+}
+
+type const *type_table::get_array(type const *element, unsigned int count) {
+  return intern(type{.kind{type::kinds::array}, .columns{count}, .element{element}});
+}
+
+type const *type_table::get_structure(structure &&new_structure) {
+  /// Structures are distinct by declaration, so each one gets its own type
+  auto &stored{structures.emplace_back(std::move(new_structure))};
+  stored.component_count = 0;
+  for(auto &member : stored.members) {
+    member.component_offset = stored.component_count;
+    stored.component_count += member.member_type->get_component_count();
+  }
+  return &types.emplace_back(type{.kind{type::kinds::structure}, .members{&stored}});
+}
+
+type const *type_table::with_scalar(type const *original, scalar_type scalar) {
+  switch(original->kind) {
+  case type::kinds::scalar:
+    return get_scalar(scalar);
+  case type::kinds::vector:
+    return get_vector(scalar, original->rows);
+  case type::kinds::matrix:
+    return get_matrix(scalar, original->columns, original->rows);
+  case type::kinds::none:
+  case type::kinds::array:
+  case type::kinds::structure:
+    break;
+  }
+  return original;
+}
+
+memory_layout get_host_shareable_layout(type const &layout_type) {
+  /// Alignment and size of a type in a uniform or storage buffer, following the WGSL memory layout rules
+  switch(layout_type.kind) {
+  case type::kinds::none:
+    return {};
+  case type::kinds::scalar:
+    return {.alignment{4}, .size{4}};
+  case type::kinds::vector:
+    return {.alignment{layout_type.rows == 2 ? 8u : 16u}, .size{4 * layout_type.rows}};
+  case type::kinds::matrix: {
+    uint32_t const column_alignment{layout_type.rows == 2 ? 8u : 16u};
+    return {.alignment{column_alignment}, .size{column_alignment * layout_type.columns}};
+  }
+  case type::kinds::array: {
+    auto const element_layout{get_host_shareable_layout(*layout_type.element)};
+    uint32_t const stride{(element_layout.size + element_layout.alignment - 1) / element_layout.alignment * element_layout.alignment};
+    return {.alignment{element_layout.alignment}, .size{stride * layout_type.columns}};
+  }
+  case type::kinds::structure: {
+    memory_layout result{.alignment{1}};
+    for(auto const &member : layout_type.members->members) {
+      auto const member_layout{get_host_shareable_layout(*member.member_type)};
+      result.alignment = std::max(result.alignment, member_layout.alignment);
+      result.size = (result.size + member_layout.alignment - 1) / member_layout.alignment * member_layout.alignment + member_layout.size;
+    }
+    result.size = (result.size + result.alignment - 1) / result.alignment * result.alignment;
+    return result;
+  }
+  }
+  return {};
+}
+
+void decode_host_shareable(type const &layout_type, std::span<std::byte const> data, std::span<uint32_t> components) {
+  /// Unpack a value laid out by the WGSL memory layout rules into its flattened components
+  /// Data beyond the end of the buffer reads as zero
+  assert(components.size() == layout_type.get_component_count());
+  auto const read{[&](size_t offset){
+    uint32_t value{0};
+    if(offset + sizeof(value) <= data.size()) std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+  }};
+  switch(layout_type.kind) {
+  case type::kinds::none:
+    return;
+  case type::kinds::scalar:
+  case type::kinds::vector:
+    for(size_t i{0}; i != components.size(); ++i) {
+      components[i] = read(i * 4);
+    }
+    return;
+  case type::kinds::matrix: {
+    size_t const column_stride{layout_type.rows == 2 ? 8u : 16u};
+    for(unsigned int column{0}; column != layout_type.columns; ++column) {
+      for(unsigned int row{0}; row != layout_type.rows; ++row) {
+        components[column * layout_type.rows + row] = read(column * column_stride + row * 4);
+      }
+    }
+    return;
+  }
+  case type::kinds::array: {
+    auto const stride{get_host_shareable_layout(layout_type).size / layout_type.columns};
+    auto const element_components{layout_type.element->get_component_count()};
+    for(unsigned int i{0}; i != layout_type.columns; ++i) {
+      decode_host_shareable(*layout_type.element, data.subspan(std::min<size_t>(data.size(), i * stride)), components.subspan(i * element_components, element_components));
+    }
+    return;
+  }
+  case type::kinds::structure: {
+    uint32_t offset{0};
+    for(auto const &member : layout_type.members->members) {
+      auto const member_layout{get_host_shareable_layout(*member.member_type)};
+      offset = (offset + member_layout.alignment - 1) / member_layout.alignment * member_layout.alignment;
+      auto const member_components{member.member_type->get_component_count()};
+      decode_host_shareable(*member.member_type, data.subspan(std::min<size_t>(data.size(), offset)), components.subspan(member.component_offset, member_components));
+      offset += member_layout.size;
+    }
+    return;
+  }
+  }
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wgsl {
+
+enum class scalar_type {
+  f32,
+  i32,
+  u32,
+  boolean,
+  abstract_int,                                                                 // types of unsuffixed literals, only seen during compilation
+  abstract_float,
+};
+
+struct structure;
+
+struct type {
+  enum class kinds {
+    none,                                                                       // the "result" of a function without a return type
+    scalar,
+    vector,                                                                     // rows components
+    matrix,                                                                     // columns column vectors of rows components each, stored column major
+    array,                                                                      // columns elements of element type
+    structure,
+  };
+
+  kinds kind{kinds::none};
+  scalar_type scalar{scalar_type::f32};                                         // component type of scalars, vectors and matrices
+  unsigned int columns{1};
+  unsigned int rows{1};
+  type const *element{nullptr};                                                 // element type of arrays
+  wgsl::structure const *members{nullptr};                                      // member list of structures
+
+  unsigned int get_component_count() const;
+  bool is_numeric_scalar_or_vector() const;
+  std::string get_name() const;
+
+  bool operator==(type const&) const = default;
+};
+
+struct structure {
+  struct member {
+    std::string name;
+    type const *member_type{nullptr};
+    unsigned int component_offset{0};                                           // first component of this member within the flattened structure
+    std::optional<unsigned int> location;                                       // from @location, for entry point interfaces
+    std::string builtin;                                                        // from @builtin, for entry point interfaces
+  };
+
+  std::string name;
+  std::vector<member> members;
+  unsigned int component_count{0};
+
+  member const *find_member(std::string_view member_name) const;
+};
+
+class type_table {
+  /// Owns and deduplicates the types used by a program, so they can be compared by pointer
+  std::deque<type> types;
+  std::deque<structure> structures;
+
+  type const *intern(type const &new_type);
+
+public:
+  type const *get_none();
+  type const *get_scalar(scalar_type scalar);
+  type const *get_vector(scalar_type scalar, unsigned int size);
+  type const *get_matrix(scalar_type scalar, unsigned int columns, unsigned int rows);
+  type const *get_array(type const *element, unsigned int count);
+  type const *get_structure(structure &&new_structure);
+
+  type const *with_scalar(type const *original, scalar_type scalar);            // the same shape with a different component type
+};
+
+struct memory_layout {
+  uint32_t alignment{0};
+  uint32_t size{0};
+};
+
+memory_layout get_host_shareable_layout(type const &layout_type);
+void decode_host_shareable(type const &layout_type, std::span<std::byte const> data, std::span<uint32_t> components);
+
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "render/uniforms.h"
+#include "wgsl/minifier.h"
+#include "wgsl/program.h"
+#include "wgsl/reference_renderer.h"
+
+// native tool: renders the demo's fullscreen quad through the WGSL interpreter on the CPU, writes the result as a
+// PPM image, and optionally compares it against a golden image to catch regressions in a shader's output
+
+namespace {
+
+struct image_bytes {
+  unsigned int width{0};
+  unsigned int height{0};
+  std::vector<unsigned char> rgb;
+};
+
+image_bytes to_bytes(wgsl::reference_renderer::image const &source) {
+  /// Quantise to 8 bits per channel, as a unorm render target would
+  image_bytes result{
+    .width{source.width},
+    .height{source.height},
+    .rgb{},
+  };
+  result.rgb.reserve(static_cast<size_t>(source.width) * source.height * 3);
+  for(size_t pixel{0}; pixel != static_cast<size_t>(source.width) * source.height; ++pixel) {
+    for(size_t channel{0}; channel != 3; ++channel) {
+      auto const value{std::clamp(source.pixels[pixel * 4 + channel], 0.0f, 1.0f)};
+      result.rgb.emplace_back(static_cast<unsigned char>(std::lround(value * 255.0f)));
+    }
+  }
+  return result;
+}
+
+void write_ppm(std::string const &filename, image_bytes const &image) {
+  std::ofstream file{filename, std::ios::binary};
+  if(!file) throw std::runtime_error{"Unable to write " + filename};
+  file << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+  file.write(reinterpret_cast<char const*>(image.rgb.data()), static_cast<std::streamsize>(image.rgb.size()));
+}
+
+image_bytes read_ppm(std::string const &filename) {
+  /// Read a binary PPM with 8 bits per channel, as written by write_ppm
+  std::ifstream file{filename, std::ios::binary};
+  if(!file) throw std::runtime_error{"Unable to read " + filename};
+  std::string magic;
+  unsigned int max_value{0};
+  image_bytes result;
+  file >> magic >> result.width >> result.height >> max_value;
+  if(magic != "P6" || max_value != 255) throw std::runtime_error{filename + " is not an 8-bit binary PPM"};
+  file.get();                                                                   // the single whitespace character ending the header
+  result.rgb.resize(static_cast<size_t>(result.width) * result.height * 3);
+  file.read(reinterpret_cast<char*>(result.rgb.data()), static_cast<std::streamsize>(result.rgb.size()));
+  if(!file) throw std::runtime_error{filename + " is truncated"};
+  return result;
+}
+
+std::string read_file(std::string const &filename) {
+  std::ifstream file{filename};
+  if(!file) throw std::runtime_error{"Unable to read " + filename};
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+}
+
+auto main(int argc, char *argv[])->int {
+  std::string shader_filename{"render/shaders/default.wgsl"};
+  std::string output_filename{"reference.ppm"};
+  std::string golden_filename;
+  unsigned int width{512};
+  unsigned int height{512};
+  unsigned int threads{0};
+  int tolerance{2};                                                             // largest per-channel difference from the golden image accepted, out of 255
+  bool minify{false};                                                           // render the minified shader, to check minification doesn't change the output
+  bool fullscreen_triangle{false};                                              // draw with vs_fullscreen, as the renderer's fullscreen triangle geometry does
+  render::uniforms uniforms{};
+  std::vector<std::pair<std::string, double>> overrides;                        // override constants to specialise the shader with, as a pipeline would
+
+  std::span const args{argv + 1, static_cast<size_t>(argc - 1)};
+  for(size_t i{0}; i != args.size(); ++i) {
+    std::string const arg{args[i]};
+    auto const next{[&]{
+      if(++i == args.size()) throw std::runtime_error{arg + " needs a value"};
+      return std::string{args[i]};
+    }};
+    try {
+      if(arg == "--size") {
+        width = static_cast<unsigned int>(std::stoul(next()));
+        height = static_cast<unsigned int>(std::stoul(next()));
+      } else if(arg == "--input") {
+        uniforms.input.x = std::stof(next());
+        uniforms.input.y = std::stof(next());
+      } else if(arg == "--out") {
+        output_filename = next();
+      } else if(arg == "--golden") {
+        golden_filename = next();
+      } else if(arg == "--tolerance") {
+        tolerance = std::stoi(next());
+      } else if(arg == "--threads") {
+        threads = static_cast<unsigned int>(std::stoul(next()));
+      } else if(arg == "--override") {
+        auto name{next()};
+        overrides.emplace_back(std::move(name), std::stod(next()));
+      } else if(arg == "--minify") {
+        minify = true;
+      } else if(arg == "--fullscreen-triangle") {
+        fullscreen_triangle = true;
+      } else {
+        shader_filename = arg;
+      }
+    } catch(std::exception const &e) {
+      std::cerr << "Usage: " << argv[0] << " [shader.wgsl] [--size w h] [--input x y] [--out file.ppm] [--golden file.ppm] [--tolerance n] [--threads n] [--override name value]... [--minify] [--fullscreen-triangle]\n";
+      std::cerr << "Exception: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  try {
+    auto const compile_start{std::chrono::steady_clock::now()};
+    auto const source{read_file(shader_filename)};
+    wgsl::program shader{minify ? wgsl::minify(source) : source};
+    shader.set_uniform(0, 0, std::as_bytes(std::span{&uniforms, 1}));
+    for(auto const &[name, value] : overrides) {
+      shader.set_override(name, value);
+    }
+    std::chrono::duration<float, std::milli> const compile_time{std::chrono::steady_clock::now() - compile_start};
+
+    wgsl::reference_renderer renderer{shader, threads};
+    wgsl::reference_renderer::draw_call draw{                                   // the same fullscreen quad as the renderer's vertex buffer
+      .attributes{
+        {.location{0}, .components{2}, .values{-1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{1}, .components{2}, .values{ 0.0f,  0.0f,  1.0f,  0.0f,   0.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{2}, .components{2}, .values{ 0.0f,  0.0f,  0.0f,  0.0f,   0.0f, 0.0f,  0.0f, 0.0f}}, // a single render::instance covering the viewport
+        {.location{3}, .components{2}, .values{ 1.0f,  1.0f,  1.0f,  1.0f,   1.0f, 1.0f,  1.0f, 1.0f}},
+        {.location{4}, .components{2}, .values{ 0.0f,  0.0f,  0.0f,  0.0f,   0.0f, 0.0f,  0.0f, 0.0f}},
+        {.location{5}, .components{2}, .values{ 1.0f,  1.0f,  1.0f,  1.0f,   1.0f, 1.0f,  1.0f, 1.0f}},
+      },
+      .indices{0, 1, 2,  2, 1, 3},
+    };
+    if(fullscreen_triangle) {
+      draw = {
+        .vertex_entry_point{"vs_fullscreen"},                                   // positions and uvs come from the vertex index alone
+        .attributes{},
+        .indices{0, 1, 2},
+      };
+    }
+    auto const render_start{std::chrono::steady_clock::now()};
+    auto const image{to_bytes(renderer.render(draw, width, height))};
+    std::chrono::duration<float, std::milli> const render_time{std::chrono::steady_clock::now() - render_start};
+
+    write_ppm(output_filename, image);
+    std::cout << "Rendered " << shader_filename << " at " << width << "x" << height << " to " << output_filename << '\n';
+    std::cout << "Compile " << compile_time.count() << "ms, render " << render_time.count() << "ms; "
+              << renderer.stats.fragment_invocations << " fragments in " << renderer.stats.fragment_batches << " batches, "
+              << renderer.stats.discarded_fragments << " discarded\n";
+
+    if(golden_filename.empty()) return EXIT_SUCCESS;
+    auto const golden{read_ppm(golden_filename)};
+    if(golden.width != image.width || golden.height != image.height) {
+      std::cout << "Golden image " << golden_filename << " is " << golden.width << "x" << golden.height << ", expected " << width << "x" << height << '\n';
+      return EXIT_FAILURE;
+    }
+    int max_difference{0};
+    size_t differing_channels{0};
+    for(size_t i{0}; i != image.rgb.size(); ++i) {
+      auto const difference{std::abs(static_cast<int>(image.rgb[i]) - static_cast<int>(golden.rgb[i]))};
+      max_difference = std::max(max_difference, difference);
+      if(difference > tolerance) ++differing_channels;
+    }
+    std::cout << "Compared with " << golden_filename << ": max difference " << max_difference << ", "
+              << differing_channels << " channels beyond tolerance " << tolerance << '\n';
+    return differing_channels == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  } catch (std::exception const &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}